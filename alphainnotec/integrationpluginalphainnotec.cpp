@@ -33,6 +33,7 @@
 
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginAlphaInnotec::IntegrationPluginAlphaInnotec()
 {
@@ -296,6 +297,7 @@ void IntegrationPluginAlphaInnotec::setupThing(ThingSetupInfo *info)
         });
 
         m_connections.insert(thing, alphaConnectTcpConnection);
+        ModbusPollOrchestrator::instance()->addConnection(this, alphaConnectTcpConnection, alphaConnectTcpConnection->modbusTcpMaster()->hostAddress().toString());
         alphaConnectTcpConnection->connectDevice();
 
         // FIXME: make async and check if this is really an alpha connect
@@ -310,11 +312,7 @@ void IntegrationPluginAlphaInnotec::postSetupThing(Thing *thing)
             qCDebug(dcAlphaInnotec()) << "Starting plugin timer...";
             m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
             connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-                foreach (AlphaInnotecModbusTcpConnection *connection, m_connections) {
-                    if (connection->reachable()) {
-                        connection->update();
-                    }
-                }
+                ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
             });
 
             m_pluginTimer->start();
@@ -47,15 +47,20 @@ void AmperfiedConnectDiscovery::startDiscovery(const QString &nameFilter)
 {
     qCInfo(dcAmperfied()) << "Discovery: Searching for Amperfied" << nameFilter << "wallboxes in the network...";
     m_nameFilter = nameFilter;
-    NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &AmperfiedConnectDiscovery::checkNetworkDevice);
+    // Only hosts with the modbus port open get a connection for checking the device
+    ModbusTcpDiscovery *modbusTcpDiscovery = new ModbusTcpDiscovery(m_networkDeviceDiscovery, 502, 1, this);
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::deviceFound, this, [this](const ModbusTcpDiscovery::Result &result){
+        checkNetworkDevice(result.networkDeviceInfo);
+    });
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        qCDebug(dcAmperfied()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::discoveryFinished, this, [=](){
+        qCDebug(dcAmperfied()) << "Discovery: Network discovery finished. Found" << modbusTcpDiscovery->results().count() << "network devices with the modbus port open";
+        modbusTcpDiscovery->deleteLater();
         m_gracePeriodTimer.start();
-        discoveryReply->deleteLater();
     });
+
+    modbusTcpDiscovery->startDiscovery();
 }
 
 QList<AmperfiedConnectDiscovery::Result> AmperfiedConnectDiscovery::discoveryResults() const
@@ -35,6 +35,7 @@
 #include <QTimer>
 
 #include <network/networkdevicediscovery.h>
+#include <modbustcpdiscovery.h>
 
 #include "amperfiedmodbustcpconnection.h"
 
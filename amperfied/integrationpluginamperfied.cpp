@@ -36,6 +36,7 @@
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
 #include <hardware/modbus/modbusrtuhardwareresource.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginAmperfied::IntegrationPluginAmperfied()
 {
@@ -170,14 +171,7 @@ void IntegrationPluginAmperfied::postSetupThing(Thing *thing)
         qCDebug(dcAmperfied()) << "Starting plugin timer...";
         m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
         connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-            foreach(AmperfiedModbusRtuConnection *connection, m_rtuConnections) {
-                qCDebug(dcAmperfied()) << "Updating connection" << connection->modbusRtuMaster() << connection->slaveId();
-                connection->update();
-            }
-            foreach(AmperfiedModbusTcpConnection *connection, m_tcpConnections) {
-                qCDebug(dcAmperfied()) << "Updating connection" << connection->modbusTcpMaster()->hostAddress();
-                connection->update();
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
         });
         m_pluginTimer->start();
     }
@@ -190,32 +184,35 @@ void IntegrationPluginAmperfied::executeAction(ThingActionInfo *info)
 
         if (info->action().actionTypeId() == energyControlPowerActionTypeId) {
             bool power = info->action().paramValue(energyControlPowerActionPowerParamTypeId).toBool();
-            ModbusRtuReply *reply = connection->setChargingCurrent(power ? info->thing()->stateValue(energyControlMaxChargingCurrentStateTypeId).toUInt() * 10 : 0);
-            connect(reply, &ModbusRtuReply::finished, info, [info, reply, power](){
-                if (reply->error() == ModbusRtuReply::NoError) {
-                    info->thing()->setStateValue(energyControlPowerStateTypeId, power);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcAmperfied()) << "Error setting power:" << reply->error() << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(connection, &AmperfiedModbusRtuConnection::chargingCurrentApplied, info, [connection, info, power](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(energyControlPowerStateTypeId, power);
+                info->finish(Thing::ThingErrorNoError);
             });
+            connect(connection, &AmperfiedModbusRtuConnection::chargingCurrentApplyFailed, info, [connection, info](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                qCWarning(dcAmperfied()) << "Error setting power";
+                info->finish(Thing::ThingErrorHardwareFailure);
+            });
+            connection->applyChargingCurrent(power ? info->thing()->stateValue(energyControlMaxChargingCurrentStateTypeId).toUInt() * 10 : 0);
             return;
         }
 
         if (info->action().actionTypeId() == energyControlMaxChargingCurrentActionTypeId) {
             bool power = info->thing()->stateValue(energyControlPowerStateTypeId).toBool();
             uint max = info->action().paramValue(energyControlMaxChargingCurrentActionMaxChargingCurrentParamTypeId).toUInt() * 10;
-            ModbusRtuReply *reply = connection->setChargingCurrent(power ? max : 0);
-            connect(reply, &ModbusRtuReply::finished, info, [info, reply, max](){
-                if (reply->error() == ModbusRtuReply::NoError) {
-                    info->thing()->setStateValue(energyControlMaxChargingCurrentStateTypeId, max / 10);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcAmperfied()) << "Error setting power:" << reply->error() << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            connect(connection, &AmperfiedModbusRtuConnection::chargingCurrentApplied, info, [connection, info, max](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(energyControlMaxChargingCurrentStateTypeId, max / 10);
+                info->finish(Thing::ThingErrorNoError);
+            });
+            connect(connection, &AmperfiedModbusRtuConnection::chargingCurrentApplyFailed, info, [connection, info](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                qCWarning(dcAmperfied()) << "Error setting max charging current";
+                info->finish(Thing::ThingErrorHardwareFailure);
             });
+            connection->applyChargingCurrent(power ? max : 0);
         }
 
     }
@@ -231,29 +228,32 @@ void IntegrationPluginAmperfied::executeAction(ThingActionInfo *info)
         if (actionType.name() == "power") {
             bool power = info->action().paramValue(actionType.paramTypes().findByName("power").id()).toBool();
             uint max = info->thing()->stateValue("maxChargingCurrent").toUInt();
-            QModbusReply *reply = connection->setChargingCurrent(power ? max * 10 : 0);
-            connect(reply, &QModbusReply::finished, info, [info, reply, power](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue("power", power);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcAmperfied()) << "Error setting power:" << reply->error() << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(connection, &AmperfiedModbusTcpConnection::chargingCurrentApplied, info, [connection, info, power](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                info->thing()->setStateValue("power", power);
+                info->finish(Thing::ThingErrorNoError);
+            });
+            connect(connection, &AmperfiedModbusTcpConnection::chargingCurrentApplyFailed, info, [connection, info](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                qCWarning(dcAmperfied()) << "Error setting power";
+                info->finish(Thing::ThingErrorHardwareFailure);
             });
+            connection->applyChargingCurrent(power ? max * 10 : 0);
         } else if (actionType.name() == "maxChargingCurrent") {
             bool power = info->thing()->stateValue("power").toBool();
             uint max = info->action().paramValue(actionType.paramTypes().findByName("maxChargingCurrent").id()).toUInt();
-            QModbusReply *reply = connection->setChargingCurrent(power ? max * 10 : 0);
-            connect(reply, &QModbusReply::finished, info, [info, reply, max](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue("maxChargingCurrent", max / 10);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcAmperfied()) << "Error setting power:" << reply->error() << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            connect(connection, &AmperfiedModbusTcpConnection::chargingCurrentApplied, info, [connection, info, max](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                info->thing()->setStateValue("maxChargingCurrent", max / 10);
+                info->finish(Thing::ThingErrorNoError);
+            });
+            connect(connection, &AmperfiedModbusTcpConnection::chargingCurrentApplyFailed, info, [connection, info](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                qCWarning(dcAmperfied()) << "Error setting max charging current";
+                info->finish(Thing::ThingErrorHardwareFailure);
             });
+            connection->applyChargingCurrent(power ? max * 10 : 0);
         } else if (actionType.name() == "desiredPhaseCount") {
             uint desiredPhaseCount = info->thing()->stateValue("desiredPhaseCount").toBool();
             QModbusReply *reply = connection->setPhaseSwitchControl(desiredPhaseCount);
@@ -330,6 +330,7 @@ void IntegrationPluginAmperfied::setupRtuConnection(ThingSetupInfo *info)
                 return;
             }
             m_rtuConnections.insert(info->thing(), connection);
+            ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusRtuMaster()->serialPort(), true);
             info->finish(Thing::ThingErrorNoError);
         } else {
             info->finish(Thing::ThingErrorHardwareFailure, QT_TR_NOOP("The wallbox is not responding"));
@@ -416,6 +417,7 @@ void IntegrationPluginAmperfied::setupTcpConnection(ThingSetupInfo *info)
                 return;
             }
             m_tcpConnections.insert(info->thing(), connection);
+            ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusTcpMaster()->hostAddress().toString(), true);
             info->finish(Thing::ThingErrorNoError);
             connection->update();
         } else {
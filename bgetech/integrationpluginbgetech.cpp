@@ -31,6 +31,8 @@
 #include "integrationpluginbgetech.h"
 #include "plugininfo.h"
 
+#include <modbuspollorchestrator.h>
+
 IntegrationPluginBGETech::IntegrationPluginBGETech()
 {
 }
@@ -193,6 +195,7 @@ void IntegrationPluginBGETech::setupThing(ThingSetupInfo *info)
 
     // FIXME: try to read before setup success
     m_sdmConnections.insert(thing, sdmConnection);
+    ModbusPollOrchestrator::instance()->addConnection(this, sdmConnection, sdmConnection->modbusRtuMaster()->serialPort(), true);
     info->finish(Thing::ThingErrorNoError);
 }
 
@@ -202,9 +205,7 @@ void IntegrationPluginBGETech::postSetupThing(Thing *thing)
     if (!m_refreshTimer) {
         m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
         connect(m_refreshTimer, &PluginTimer::timeout, this, [this] {
-            foreach (Thing *thing, myThings()) {
-                m_sdmConnections.value(thing)->update();
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
         });
 
         qCDebug(dcBgeTech()) << "Starting refresh timer...";
@@ -1,8 +1,10 @@
 include(../plugins.pri)
 
-QT += \
-    serialport \
-    serialbus \
+# Generate modbus connection
+MODBUS_CONNECTIONS += x2lu-registers.json x2wp-registers.json
+#MODBUS_TOOLS_CONFIG += VERBOSE
+
+include(../modbus.pri)
 
 SOURCES += \
     integrationplugindrexelundweiss.cpp \
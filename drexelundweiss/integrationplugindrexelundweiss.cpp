@@ -32,7 +32,7 @@
 #include "plugininfo.h"
 
 #include <hardwaremanager.h>
-#include <hardware/modbus/modbusrtumaster.h>
+#include <modbuspollorchestrator.h>
 #include <hardware/modbus/modbusrtuhardwareresource.h>
 
 IntegrationPluginDrexelUndWeiss::IntegrationPluginDrexelUndWeiss()
@@ -58,11 +58,16 @@ void IntegrationPluginDrexelUndWeiss::init()
         qCDebug(dcDrexelUndWeiss()) << "Modbus RTU master has been removed" << modbusUuid.toString();
 
         // Check if there is any device using this resource
-        foreach (Thing *thing, m_modbusRtuMasters.keys()) {
-            if (m_modbusRtuMasters.value(thing)->modbusUuid() == modbusUuid) {
+        foreach (Thing *thing, myThings()) {
+            if (thing->paramValue(m_modbusUuidParamTypeIds.value(thing->thingClassId())).toUuid() == modbusUuid) {
                 qCWarning(dcDrexelUndWeiss()) << "Hardware resource removed for" << thing << ". The thing will not be functional any more until a new resource has been configured for it.";
-                m_modbusRtuMasters.remove(thing);
-                thing->setStateValue(m_connectedStateTypeIds[thing->thingClassId()], false);
+                thing->setStateValue(m_connectedStateTypeIds.value(thing->thingClassId()), false);
+                if (m_x2luConnections.contains(thing)) {
+                    delete m_x2luConnections.take(thing);
+                }
+                if (m_x2wpConnections.contains(thing)) {
+                    delete m_x2wpConnections.take(thing);
+                }
             }
         }
     });
@@ -124,34 +129,21 @@ void IntegrationPluginDrexelUndWeiss::setupThing(ThingSetupInfo *info)
         return info->finish(Thing::ThingErrorHardwareNotAvailable, QT_TR_NOOP("The Modbus RTU interface is not connected."));
     }
 
-    ModbusRtuReply *reply = modbus->readHoldingRegister(slaveAddress, ModbusRegisterX2::Geraetetyp, 2);
-    connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
-    connect(reply, &ModbusRtuReply::finished, info, [reply, modbus, info, thing, this] {
-        if (info->isFinished())
-            return; // ModbusRtuReply::finished is called for every retry
-
-        if (reply->error() != ModbusRtuReply::Error::NoError) {
-            qCWarning(dcDrexelUndWeiss()) << "Setup failed, received modbus error" << reply->errorString();
-            return info->finish(Thing::ThingErrorHardwareNotAvailable);
-        }
+    if (m_x2luConnections.contains(thing)) {
+        qCDebug(dcDrexelUndWeiss()) << "Reconfiguring existing thing" << thing->name();
+        m_x2luConnections.take(thing)->deleteLater();
+    }
 
-        if (reply->result().length() != 2) {
-            qCWarning(dcDrexelUndWeiss()) << "Setup failed, received reply has an illegal length";
-            return info->finish(Thing::ThingErrorHardwareNotAvailable);
-        }
-        if (thing->thingClassId() == x2luThingClassId && reply->result()[1] == DeviceType::X2_LU) {
-            info->finish(Thing::ThingErrorNoError);
-            m_modbusRtuMasters.insert(thing, modbus);
-        } else if (thing->thingClassId() == x2wpThingClassId && reply->result()[1] == DeviceType::X2_WP) {
-            info->finish(Thing::ThingErrorNoError);
-            m_modbusRtuMasters.insert(thing, modbus);
-        } else {
-            qCWarning(dcDrexelUndWeiss()) << "Device on slave address" << reply->slaveAddress() << "is not the wanted one.";
-            return info->finish(Thing::ThingErrorHardwareNotAvailable);
-        }
+    if (m_x2wpConnections.contains(thing)) {
+        qCDebug(dcDrexelUndWeiss()) << "Reconfiguring existing thing" << thing->name();
+        m_x2wpConnections.take(thing)->deleteLater();
+    }
 
-    });
-    connect(modbus, &ModbusRtuMaster::connectedChanged, this, &IntegrationPluginDrexelUndWeiss::onConnectionStateChanged);
+    if (thing->thingClassId() == x2luThingClassId) {
+        setupX2LuConnection(info, modbus, slaveAddress);
+    } else if (thing->thingClassId() == x2wpThingClassId) {
+        setupX2WpConnection(info, modbus, slaveAddress);
+    }
 }
 
 void IntegrationPluginDrexelUndWeiss::postSetupThing(Thing *thing)
@@ -164,17 +156,16 @@ void IntegrationPluginDrexelUndWeiss::postSetupThing(Thing *thing)
         connect(m_refreshTimer, &PluginTimer::timeout, this, &IntegrationPluginDrexelUndWeiss::onRefreshTimer);
     }
 
-    if ((thing->thingClassId() == x2luThingClassId) || (thing->thingClassId() == x2wpThingClassId)) {
-        Thing *parentThing = myThings().findById(thing->parentId());
-        if (!parentThing) {
-            qCWarning(dcDrexelUndWeiss()) << "Could not find the parent Thing";
-            return;
+    if (thing->thingClassId() == x2luThingClassId) {
+        X2LuModbusRtuConnection *connection = m_x2luConnections.value(thing);
+        if (connection) {
+            connection->update();
         }
-        ModbusRtuMaster *modbus = m_modbusRtuMasters.value(parentThing);
-        if (!modbus){
-            qCWarning(dcDrexelUndWeiss()) << "No modbus interface available";
+    } else if (thing->thingClassId() == x2wpThingClassId) {
+        X2WpModbusRtuConnection *connection = m_x2wpConnections.value(thing);
+        if (connection) {
+            connection->update();
         }
-        updateStates(thing);
     } else {
         Q_ASSERT_X(false, "postSetupThing", QString("Unhandled thingClassId: %1").arg(thing->thingClassId().toString()).toUtf8());
     }
@@ -186,38 +177,58 @@ void IntegrationPluginDrexelUndWeiss::executeAction(ThingActionInfo *info)
     Action action = info->action();
 
     if (thing->thingClassId() == x2luThingClassId) {
+        X2LuModbusRtuConnection *connection = m_x2luConnections.value(thing);
+        if (!connection || !connection->reachable()) {
+            qCWarning(dcDrexelUndWeiss()) << "Could not execute action, the device is not reachable" << thing->name();
+            info->finish(Thing::ThingErrorHardwareNotAvailable, QT_TR_NOOP("The device is not reachable."));
+            return;
+        }
 
-        uint slaveAddress = thing->paramValue(x2luThingSlaveAddressParamTypeId).toUInt();
         if (action.actionTypeId() == x2luPowerActionTypeId) {
             bool power = action.paramValue(x2luPowerActionPowerParamTypeId).toBool();
-            uint32_t data = 0;
+            X2LuModbusRtuConnection::VentilationMode mode = X2LuModbusRtuConnection::VentilationModeManualLevel0;
             if (power) {
-                data = VentilationMode::Automatikbetrieb;
-            } else {
-                data = VentilationMode::ManuellStufe0;
+                mode = X2LuModbusRtuConnection::VentilationModeAutomatic;
             }
-            sendWriteRequest(info, slaveAddress, ModbusRegisterX2::Betriebsart, data);
+            ModbusRtuReply *reply = connection->setVentilationMode(mode);
+            connect(reply, &ModbusRtuReply::finished, info, [=] {
+                if (reply->error() == ModbusRtuReply::NoError) {
+                    thing->setStateValue(x2luVentilationModeStateTypeId, getVentilationModeString(mode));
+                }
+            });
+            finishWriteRequest(info, reply, x2luPowerStateTypeId, power);
 
         } else if (action.actionTypeId() == x2luVentilationModeActionTypeId) {
-            QString mode = action.param(x2luVentilationModeActionVentilationModeParamTypeId).value().toString();
-            uint32_t data = getVentilationModeFromString(mode);
-            sendWriteRequest(info, slaveAddress, ModbusRegisterX2::Betriebsart, data);
+            QString modeString = action.param(x2luVentilationModeActionVentilationModeParamTypeId).value().toString();
+            X2LuModbusRtuConnection::VentilationMode mode = getVentilationModeFromString(modeString);
+            ModbusRtuReply *reply = connection->setVentilationMode(mode);
+            connect(reply, &ModbusRtuReply::finished, info, [=] {
+                if (reply->error() == ModbusRtuReply::NoError) {
+                    thing->setStateValue(x2luPowerStateTypeId, mode != X2LuModbusRtuConnection::VentilationModeManualLevel0);
+                }
+            });
+            finishWriteRequest(info, reply, x2luVentilationModeStateTypeId, modeString);
 
         } else {
             Q_ASSERT_X(false, "executeAction", QString("Unhandled ActionTypeId: %1").arg(action.actionTypeId().toString()).toUtf8());
         }
     } else if (thing->thingClassId() == x2wpThingClassId) {
+        X2WpModbusRtuConnection *connection = m_x2wpConnections.value(thing);
+        if (!connection || !connection->reachable()) {
+            qCWarning(dcDrexelUndWeiss()) << "Could not execute action, the device is not reachable" << thing->name();
+            info->finish(Thing::ThingErrorHardwareNotAvailable, QT_TR_NOOP("The device is not reachable."));
+            return;
+        }
 
-        uint slaveAddress = thing->paramValue(x2wpThingSlaveAddressParamTypeId).toUInt();
         if (action.actionTypeId() == x2wpTargetTemperatureActionTypeId) {
-            double targetTemp = (action.param(x2wpTargetTemperatureActionTargetTemperatureParamTypeId).value().toDouble());
-            uint32_t data = static_cast<uint32_t>(qRound(targetTemp * 1000));
-            sendWriteRequest(info, slaveAddress, ModbusRegisterX2::RaumSoll, data);
+            double targetTemp = action.param(x2wpTargetTemperatureActionTargetTemperatureParamTypeId).value().toDouble();
+            ModbusRtuReply *reply = connection->setTargetRoomTemperature(targetTemp);
+            finishWriteRequest(info, reply, x2wpTargetTemperatureStateTypeId, targetTemp);
 
         } else if (action.actionTypeId() == x2wpTargetWaterTemperatureActionTypeId) {
             double targetWaterTemp = action.param(x2wpTargetWaterTemperatureActionTargetWaterTemperatureParamTypeId).value().toDouble();
-            uint32_t data = static_cast<uint32_t>(qRound(targetWaterTemp * 1000));
-            sendWriteRequest(info, slaveAddress, ModbusRegisterX2::BrauchwasserSolltermperatur, data);
+            ModbusRtuReply *reply = connection->setTargetWaterTemperature(targetWaterTemp);
+            finishWriteRequest(info, reply, x2wpTargetWaterTemperatureStateTypeId, targetWaterTemp);
 
         } else {
             Q_ASSERT_X(false, "executeAction", QString("Unhandled ActionTypeId: %1").arg(action.actionTypeId().toString()).toUtf8());
@@ -227,354 +238,265 @@ void IntegrationPluginDrexelUndWeiss::executeAction(ThingActionInfo *info)
     }
 }
 
-void IntegrationPluginDrexelUndWeiss::sendWriteRequest(ThingActionInfo *info, uint slaveAddress, uint modbusRegister, uint32_t value)
+void IntegrationPluginDrexelUndWeiss::thingRemoved(Thing *thing)
 {
-    ModbusRtuMaster *modbus = m_modbusRtuMasters.value(info->thing());
+    qCDebug(dcDrexelUndWeiss()) << "Thing removed" << thing->name();
 
-    if (!modbus){
-        qCWarning(dcDrexelUndWeiss()) << "Modbus RTU interface available";
-        info->finish(Thing::ThingErrorHardwareFailure, tr("The Modbus RTU interface is not available."));
-        return;
+    if (m_x2luConnections.contains(thing)) {
+        m_x2luConnections.take(thing)->deleteLater();
     }
 
-    if (!modbus->connected()) {
-        qCWarning(dcDrexelUndWeiss()) << "Modbus RTU interface not connected";
-        info->finish(Thing::ThingErrorHardwareFailure, tr("The Modbus RTU interface is not connected."));
-        return;
+    if (m_x2wpConnections.contains(thing)) {
+        m_x2wpConnections.take(thing)->deleteLater();
     }
 
-    QVector<uint16_t> values;
-    values.append(static_cast<uint16_t>(value>>16));
-    values.append(static_cast<uint16_t>(value&0xffff));
-    ModbusRtuReply *reply = modbus->writeHoldingRegisters(slaveAddress, modbusRegister, values);
-    connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
-    connect(reply, &ModbusRtuReply::finished, info, [info, reply, this] {
+    if (myThings().isEmpty() && m_refreshTimer) {
+        qCDebug(dcDrexelUndWeiss()) << "Stopping refresh timer";
+        hardwareManager()->pluginTimerManager()->unregisterTimer(m_refreshTimer);
+        m_refreshTimer = nullptr;
+    }
+}
+
+void IntegrationPluginDrexelUndWeiss::setupX2LuConnection(ThingSetupInfo *info, ModbusRtuMaster *modbus, uint slaveAddress)
+{
+    Thing *thing = info->thing();
+
+    X2LuModbusRtuConnection *connection = new X2LuModbusRtuConnection(modbus, slaveAddress, this);
+    connect(info, &ThingSetupInfo::aborted, connection, &X2LuModbusRtuConnection::deleteLater);
+
+    connect(connection, &X2LuModbusRtuConnection::reachableChanged, thing, [connection, thing](bool reachable){
+        qCDebug(dcDrexelUndWeiss()) << "Reachable state changed" << thing->name() << reachable;
+        if (reachable) {
+            connection->initialize();
+        } else {
+            thing->setStateValue(x2luConnectedStateTypeId, false);
+        }
+    });
 
-        if (info->isFinished()) {
+    connect(connection, &X2LuModbusRtuConnection::initializationFinished, info, [=](bool success){
+        if (!success) {
+            qCWarning(dcDrexelUndWeiss()) << "Setup failed, could not read the device type";
+            connection->deleteLater();
+            info->finish(Thing::ThingErrorHardwareNotAvailable);
             return;
         }
 
-        if (reply->error() != ModbusRtuReply::Error::NoError) {
-            return info->finish(Thing::ThingErrorHardwareFailure);
+        if (connection->deviceType() != DeviceType::X2_LU) {
+            qCWarning(dcDrexelUndWeiss()) << "Device on slave address" << connection->slaveId() << "is not the wanted one. Device type:" << connection->deviceType();
+            connection->deleteLater();
+            info->finish(Thing::ThingErrorHardwareNotAvailable);
+            return;
         }
-        updateStates(info->thing());
+
+        m_x2luConnections.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusRtuMaster()->serialPort(), true);
         info->finish(Thing::ThingErrorNoError);
     });
-}
 
+    connect(connection, &X2LuModbusRtuConnection::initializationFinished, thing, [=](bool success){
+        thing->setStateValue(x2luConnectedStateTypeId, success);
+    });
 
-void IntegrationPluginDrexelUndWeiss::thingRemoved(Thing *thing)
-{
-    qCDebug(dcDrexelUndWeiss()) << "Thing removed" << thing->name();
+    connect(connection, &X2LuModbusRtuConnection::co2Changed, thing, [thing](quint32 co2){
+        thing->setStateValue(x2luCo2StateTypeId, co2);
+    });
 
-    if (thing->thingClassId() == x2luThingClassId || thing->thingClassId() == x2luThingClassId) {
-        m_modbusRtuMasters.remove(thing);
-    }
+    connect(connection, &X2LuModbusRtuConnection::activeVentilationLevelChanged, thing, [thing](quint32 activeVentilationLevel){
+        thing->setStateValue(x2luActiveVentilationLevelStateTypeId, activeVentilationLevel);
+    });
 
-    if (myThings().isEmpty()) {
-        qCDebug(dcDrexelUndWeiss()) << "Stopping refresh timer";
-        hardwareManager()->pluginTimerManager()->unregisterTimer(m_refreshTimer);
-        m_refreshTimer = nullptr;
+    connect(connection, &X2LuModbusRtuConnection::ventilationModeChanged, thing, [this, thing](X2LuModbusRtuConnection::VentilationMode ventilationMode){
+        thing->setStateValue(x2luVentilationModeStateTypeId, getVentilationModeString(ventilationMode));
+        thing->setStateValue(x2luPowerStateTypeId, ventilationMode != X2LuModbusRtuConnection::VentilationModeManualLevel0);
+    });
+
+    connect(connection, &X2LuModbusRtuConnection::operatingHoursSupplyFanChanged, thing, [thing](quint32 operatingHoursSupplyFan){
+        thing->setStateValue(x2luOperatingHoursSupplyFanStateTypeId, operatingHoursSupplyFan);
+    });
+
+    connect(connection, &X2LuModbusRtuConnection::operatingHoursExhaustFanChanged, thing, [thing](quint32 operatingHoursExhaustFan){
+        thing->setStateValue(x2luOperatingHoursExhaustFanStateTypeId, operatingHoursExhaustFan);
+    });
+
+    if (connection->reachable()) {
+        connection->initialize();
     }
 }
 
-void IntegrationPluginDrexelUndWeiss::onRefreshTimer()
+void IntegrationPluginDrexelUndWeiss::setupX2WpConnection(ThingSetupInfo *info, ModbusRtuMaster *modbus, uint slaveAddress)
 {
-    foreach (Thing *thing, myThings()) {
-        if (thing->thingClassId() == x2luThingClassId || thing->thingClassId() == x2wpThingClassId){
-            updateStates(thing);
+    Thing *thing = info->thing();
+
+    X2WpModbusRtuConnection *connection = new X2WpModbusRtuConnection(modbus, slaveAddress, this);
+    connect(info, &ThingSetupInfo::aborted, connection, &X2WpModbusRtuConnection::deleteLater);
+
+    connect(connection, &X2WpModbusRtuConnection::reachableChanged, thing, [connection, thing](bool reachable){
+        qCDebug(dcDrexelUndWeiss()) << "Reachable state changed" << thing->name() << reachable;
+        if (reachable) {
+            connection->initialize();
+        } else {
+            thing->setStateValue(x2wpConnectedStateTypeId, false);
         }
-    }
-}
+    });
 
-void IntegrationPluginDrexelUndWeiss::updateStates(Thing *thing)
-{
-    if (thing->thingClassId() == x2luThingClassId) {
-        ModbusRtuMaster *modbus = m_modbusRtuMasters.value(thing);
-        if (!modbus) {
+    connect(connection, &X2WpModbusRtuConnection::initializationFinished, info, [=](bool success){
+        if (!success) {
+            qCWarning(dcDrexelUndWeiss()) << "Setup failed, could not read the device type";
+            connection->deleteLater();
+            info->finish(Thing::ThingErrorHardwareNotAvailable);
             return;
         }
-        uint slaveAddress = thing->paramValue(x2luThingSlaveAddressParamTypeId).toUInt();
-
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::AktiveLuefterstufe);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Betriebsart); // Ventilation mode
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::CO2);
-    }
 
-    if (thing->thingClassId() == x2wpThingClassId) {
-        ModbusRtuMaster *modbus = m_modbusRtuMasters.value(thing);
-        if (!modbus) {
+        if (connection->deviceType() != DeviceType::X2_WP) {
+            qCWarning(dcDrexelUndWeiss()) << "Device on slave address" << connection->slaveId() << "is not the wanted one. Device type:" << connection->deviceType();
+            connection->deleteLater();
+            info->finish(Thing::ThingErrorHardwareNotAvailable);
             return;
         }
-        int slaveAddress = thing->paramValue(x2wpThingSlaveAddressParamTypeId).toUInt();
-
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Waermepumpe);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::RaumSoll);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Raum);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::TemperaturWarmwasserspeicherUnten);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::BrauchwasserSolltermperatur);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Auszenluft);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::Summenstoerung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungKompressor);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungWarmwasser);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungRaumheizung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::LeistungLuftvorwaermung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieKompressor);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieWarmwasser);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieRaumheizung);
-        readHoldingRegister(thing, modbus, slaveAddress, ModbusRegisterX2::EnergieLuftvorerwarrmung);
+
+        m_x2wpConnections.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusRtuMaster()->serialPort(), true);
+        info->finish(Thing::ThingErrorNoError);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::initializationFinished, thing, [=](bool success){
+        thing->setStateValue(x2wpConnectedStateTypeId, success);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::heatPumpChanged, thing, [thing](quint32 heatPump){
+        thing->setStateValue(x2wpPowerStateTypeId, heatPump != 0);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::targetRoomTemperatureChanged, thing, [thing](float targetRoomTemperature){
+        thing->setStateValue(x2wpTargetTemperatureStateTypeId, targetRoomTemperature);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::roomTemperatureChanged, thing, [thing](float roomTemperature){
+        thing->setStateValue(x2wpTemperatureStateTypeId, roomTemperature);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::waterTemperatureChanged, thing, [thing](float waterTemperature){
+        thing->setStateValue(x2wpWaterTemperatureStateTypeId, waterTemperature);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::targetWaterTemperatureChanged, thing, [thing](float targetWaterTemperature){
+        thing->setStateValue(x2wpTargetWaterTemperatureStateTypeId, targetWaterTemperature);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::outsideAirTemperatureChanged, thing, [thing](float outsideAirTemperature){
+        thing->setStateValue(x2wpOutsideAirTemperatureStateTypeId, outsideAirTemperature);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::collectiveFaultChanged, thing, [thing](quint32 collectiveFault){
+        if (collectiveFault == 0) {
+            thing->setStateValue(x2wpErrorStateTypeId, "No error");
+        }
+    });
+
+    // The power and energy registers are read in one block each, the sums are updated with every part
+    connect(connection, &X2WpModbusRtuConnection::powerCompressorChanged, thing, [connection, thing](float powerCompressor){
+        thing->setStateValue(x2wpPowerCompressorStateTypeId, powerCompressor);
+        thing->setStateValue(x2wpCurrentPowerStateTypeId, powerCompressor + connection->powerAirPreheating());
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::powerRoomHeatingChanged, thing, [thing](float powerRoomHeating){
+        thing->setStateValue(x2wpPowerRoomHeatingStateTypeId, powerRoomHeating);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::powerWaterHeatingChanged, thing, [thing](float powerWaterHeating){
+        thing->setStateValue(x2wpPowerWaterHeatingStateTypeId, powerWaterHeating);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::powerAirPreheatingChanged, thing, [connection, thing](float powerAirPreheating){
+        thing->setStateValue(x2wpPowerAirPreheatingStateTypeId, powerAirPreheating);
+        thing->setStateValue(x2wpCurrentPowerStateTypeId, connection->powerCompressor() + powerAirPreheating);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::energyCompressorChanged, thing, [connection, thing](float energyCompressor){
+        thing->setStateValue(x2wpEnergyCompressorStateTypeId, energyCompressor);
+        thing->setStateValue(x2wpTotalEnergyConsumedStateTypeId, energyCompressor + connection->energyAirPreheating());
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::energyRoomHeatingChanged, thing, [thing](float energyRoomHeating){
+        thing->setStateValue(x2wpEnergyRoomHeatingStateTypeId, energyRoomHeating);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::energyWaterHeatingChanged, thing, [thing](float energyWaterHeating){
+        thing->setStateValue(x2wpEnergyWaterHeatingStateTypeId, energyWaterHeating);
+    });
+
+    connect(connection, &X2WpModbusRtuConnection::energyAirPreheatingChanged, thing, [connection, thing](float energyAirPreheating){
+        thing->setStateValue(x2wpEnergyAirPreheatingStateTypeId, energyAirPreheating);
+        thing->setStateValue(x2wpTotalEnergyConsumedStateTypeId, connection->energyCompressor() + energyAirPreheating);
+    });
+
+    if (connection->reachable()) {
+        connection->initialize();
     }
 }
 
-
-void IntegrationPluginDrexelUndWeiss::readHoldingRegister(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress, uint modbusRegister)
+void IntegrationPluginDrexelUndWeiss::finishWriteRequest(ThingActionInfo *info, ModbusRtuReply *reply, const StateTypeId &stateTypeId, const QVariant &value)
 {
-    ModbusRtuReply *reply = modbus->readHoldingRegister(slaveAddress, modbusRegister, 2); // min 2 registers must be read
     connect(reply, &ModbusRtuReply::finished, reply, &ModbusRtuReply::deleteLater);
-    connect(reply, &ModbusRtuReply::finished, this, [reply, thing, this] {
-        if (reply->error() != ModbusRtuReply::Error::NoError) {
-            qCWarning(dcDrexelUndWeiss()) << "Modbus error" << reply->errorString();
-            thing->setStateValue(m_connectedStateTypeIds.value(thing->thingClassId()), false);
-            return;
-        }
-        thing->setStateValue(m_connectedStateTypeIds.value(thing->thingClassId()), true);
-        if (reply->result().length() != 2) {
+    connect(reply, &ModbusRtuReply::finished, info, [info, reply, stateTypeId, value] {
+        if (info->isFinished())
+            return; // ModbusRtuReply::finished is called for every retry
+
+        if (reply->error() != ModbusRtuReply::NoError) {
+            qCWarning(dcDrexelUndWeiss()) << "Write request failed" << reply->errorString();
+            info->finish(Thing::ThingErrorHardwareFailure);
             return;
         }
-        uint32_t value = (static_cast<uint32_t>(reply->result()[0])<<16 | reply->result()[1]);
-
-        if (thing->thingClassId() == x2wpThingClassId) {
-            switch (reply->registerAddress()) {
-            case ModbusRegisterX2::Waermepumpe:
-                thing->setStateValue(x2wpPowerStateTypeId, value);
-                break;
-
-            case ModbusRegisterX2::RaumSoll:
-                thing->setStateValue(x2wpTargetTemperatureStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::Raum:
-                thing->setStateValue(x2wpTemperatureStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::TemperaturWarmwasserspeicherUnten:
-                thing->setStateValue(x2wpWaterTemperatureStateTypeId, value/1000.00);
-                break;
-            case ModbusRegisterX2::BrauchwasserSolltermperatur:
-                thing->setStateValue(x2wpTargetWaterTemperatureStateTypeId, value/1000.00);
-                break;
-            case ModbusRegisterX2::Auszenluft:
-                thing->setStateValue(x2wpOutsideAirTemperatureStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::Summenstoerung:
-                if (value != 0) {
-                    //get actual error
-                } else {
-                    thing->setStateValue(x2wpErrorStateTypeId, "No error");
-                }
-                break;
-
-            case ModbusRegisterX2::StoerungAbluftventilator:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Exhaust fan");
-                break;
-
-            case ModbusRegisterX2::StoerungBoilerfuehlerElektroheizstab:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor electric heating element");
-                break;
-
-            case ModbusRegisterX2::StoerungBoilerfuehlerSolar:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor solar");
-                break;
-
-            case  ModbusRegisterX2::StoerungBoilerfuehlerWaermepumpe:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler sensor heat pump");
-                break;
-
-            case  ModbusRegisterX2::StoerungBoileruebertemperatur:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Boiler overtemperature");
-                break;
-
-            case  ModbusRegisterX2::StoerungCO2Sensor:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "CO2-Sensor");
-                break;
-
-            case  ModbusRegisterX2::StoerungDruckverlustAbluftZuGrosz:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Pressure loss exhaust air too big");
-                break;
-
-            case ModbusRegisterX2::StoerungDruckverlustZuluftZuGrosz:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Pressure loss supply air too large");
-                break;
-
-            case ModbusRegisterX2::StoerungDurchflussmengeHeizgkreis:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Flow rate of heating circuit");
-                break;
-
-            case ModbusRegisterX2::StoerungDurchflussmengeSolekreis:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Flow rate brine circuit");
-                break;
-
-            case ModbusRegisterX2::StoerungTeilnehmerNichtErreichbar:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Participant not available");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerAuszenluft:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor outside air");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerHeizkreisVorlauf:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor heating circuit flow");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerRaum:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor room");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerSolarkollektor:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor solar collector");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerSole:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor brine");
-                break;
-
-            case ModbusRegisterX2::StoerungTemperaturfuehlerSoleAuszenluft:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Temperature sensor brine outside air");
-                break;
-
-            case ModbusRegisterX2::StoerungWaermepumpeHochdruck:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Heat pump high pressure");
-                break;
-
-            case ModbusRegisterX2::StoerungWaermepumpeNiederdruck:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Heat pump low pressure");
-                break;
-
-            case ModbusRegisterX2::StoerungWertNichtZulaessig:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Value not allowed");
-                break;
-
-            case ModbusRegisterX2::StoerungZuluftventilator:
-                if (value != 0)
-                    thing->setStateValue(x2wpErrorStateTypeId, "Supply air fan");
-                break;
-
-            case ModbusRegisterX2::LeistungKompressor:
-                thing->setStateValue(x2wpPowerCompressorStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::LeistungWarmwasser:
-                thing->setStateValue(x2wpPowerWaterHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::LeistungRaumheizung:
-                thing->setStateValue(x2wpPowerRoomHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::LeistungLuftvorwaermung: {
-                float power = value/1000.00;
-                thing->setStateValue(x2wpPowerAirPreheatingStateTypeId, power);
-                power += thing->stateValue(x2wpPowerCompressorStateTypeId).toFloat();
-                thing->setStateValue(x2wpCurrentPowerStateTypeId, power);
-                break;
-            }
-            case ModbusRegisterX2::EnergieKompressor:
-                thing->setStateValue(x2wpEnergyCompressorStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::EnergieWarmwasser:
-                thing->setStateValue(x2wpEnergyWaterHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::EnergieRaumheizung:
-                thing->setStateValue(x2wpEnergyRoomHeatingStateTypeId, value/1000.00);
-                break;
-
-            case ModbusRegisterX2::EnergieLuftvorerwarrmung: {
-                float energy = value/1000.00;
-                thing->setStateValue(x2wpEnergyAirPreheatingStateTypeId, energy);
-                energy += thing->stateValue(x2wpEnergyCompressorStateTypeId).toFloat();
-                thing->setStateValue(x2wpTotalEnergyConsumedStateTypeId, energy);
-                break;
-            }
-            default:
-                break;
-            }
-        } else if (thing->thingClassId() == x2luThingClassId) {
-
-            switch (reply->registerAddress()) {
-            case ModbusRegisterX2::Betriebsart:
-                if (value == VentilationMode::ManuellStufe0) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 0");
-                } else if (value == VentilationMode::ManuellStufe1) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 1");
-                } else if (value == VentilationMode::ManuellStufe2) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 2");
-                } else if (value == VentilationMode::ManuellStufe3) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Manual level 3");
-                } else if (value == VentilationMode::Automatikbetrieb) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Automatic");
-                } else if (value == VentilationMode::Party) {
-                    thing->setStateValue(x2luVentilationModeStateTypeId, "Party");
-                }
-                if (value == VentilationMode::ManuellStufe0) {
-                    thing->setStateValue(x2luPowerStateTypeId, false);
-                } else {
-                    thing->setStateValue(x2luPowerStateTypeId, true);
-                }
-                break;
-            case ModbusRegisterX2::AktiveLuefterstufe:
-                thing->setStateValue(x2luActiveVentilationLevelStateTypeId, value);
-                break;
-            case ModbusRegisterX2::CO2:
-                thing->setStateValue(x2luCo2StateTypeId, value);
-                break;
-            }
-        }
+
+        info->thing()->setStateValue(stateTypeId, value);
+        info->finish(Thing::ThingErrorNoError);
     });
 }
 
-VentilationMode IntegrationPluginDrexelUndWeiss::getVentilationModeFromString(const QString &modeString)
+void IntegrationPluginDrexelUndWeiss::onRefreshTimer()
+{
+    // Each connection reads its registers in blocks, rarely changing values only on every n-th update
+    ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
+}
+
+X2LuModbusRtuConnection::VentilationMode IntegrationPluginDrexelUndWeiss::getVentilationModeFromString(const QString &modeString)
 {
     if (modeString == "Manual level 0") {
-        return VentilationMode::ManuellStufe0;
+        return X2LuModbusRtuConnection::VentilationModeManualLevel0;
     } else if(modeString == "Manual level 1") {
-        return VentilationMode::ManuellStufe1;
+        return X2LuModbusRtuConnection::VentilationModeManualLevel1;
     } else if(modeString == "Manual level 2") {
-        return VentilationMode::ManuellStufe2;
-    }else if(modeString == "Manual level 3") {
-        return VentilationMode::ManuellStufe3;
+        return X2LuModbusRtuConnection::VentilationModeManualLevel2;
+    } else if(modeString == "Manual level 3") {
+        return X2LuModbusRtuConnection::VentilationModeManualLevel3;
     } else if(modeString == "Automatic") {
-        return VentilationMode::Automatikbetrieb;
+        return X2LuModbusRtuConnection::VentilationModeAutomatic;
     } else if(modeString == "Party") {
-        return VentilationMode::Party;
+        return X2LuModbusRtuConnection::VentilationModeParty;
     } else {
         qCWarning(dcDrexelUndWeiss()) << "Unknown ventilation mode string" << modeString;
     }
-    return VentilationMode::ManuellStufe0;
+    return X2LuModbusRtuConnection::VentilationModeManualLevel0;
 }
 
+QString IntegrationPluginDrexelUndWeiss::getVentilationModeString(X2LuModbusRtuConnection::VentilationMode ventilationMode)
+{
+    switch (ventilationMode) {
+    case X2LuModbusRtuConnection::VentilationModeManualLevel0:
+        return "Manual level 0";
+    case X2LuModbusRtuConnection::VentilationModeManualLevel1:
+        return "Manual level 1";
+    case X2LuModbusRtuConnection::VentilationModeManualLevel2:
+        return "Manual level 2";
+    case X2LuModbusRtuConnection::VentilationModeManualLevel3:
+        return "Manual level 3";
+    case X2LuModbusRtuConnection::VentilationModeAutomatic:
+        return "Automatic";
+    case X2LuModbusRtuConnection::VentilationModeParty:
+        return "Party";
+    }
+    return "Manual level 0";
+}
 
 void IntegrationPluginDrexelUndWeiss::onPluginConfigurationChanged(const ParamTypeId &paramTypeId, const QVariant &value)
 {
@@ -587,12 +509,3 @@ void IntegrationPluginDrexelUndWeiss::onPluginConfigurationChanged(const ParamTy
         }
     }
 }
-
-void IntegrationPluginDrexelUndWeiss::onConnectionStateChanged(bool status)
-{
-    ModbusRtuMaster *modbusRtuMaster = static_cast<ModbusRtuMaster *>(sender());
-    Thing *thing = m_modbusRtuMasters.key(modbusRtuMaster);
-    if (!thing)
-        return;
-    thing->setStateValue(m_connectedStateTypeIds.value(thing->thingClassId()), status);
-}
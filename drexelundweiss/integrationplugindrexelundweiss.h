@@ -36,8 +36,8 @@
 #include <plugintimer.h>
 
 #include "modbusregisterdefinition.h"
-
-#include <QDateTime>
+#include "x2lumodbusrtuconnection.h"
+#include "x2wpmodbusrtuconnection.h"
 
 class IntegrationPluginDrexelUndWeiss : public IntegrationPlugin
 {
@@ -57,27 +57,25 @@ public:
     void executeAction(ThingActionInfo *info) override;
 
 private:
-    QHash<Thing *, ModbusRtuMaster *> m_modbusRtuMasters;
     PluginTimer *m_refreshTimer = nullptr;
+    QHash<Thing *, X2LuModbusRtuConnection *> m_x2luConnections;
+    QHash<Thing *, X2WpModbusRtuConnection *> m_x2wpConnections;
 
     QHash<ThingClassId, StateTypeId> m_connectedStateTypeIds;
     QHash<ThingClassId, ParamTypeId> m_discoverySlaveAddressParamTypeIds;
     QHash<ThingClassId, ParamTypeId> m_slaveIdParamTypeIds;
     QHash<ThingClassId, ParamTypeId> m_modbusUuidParamTypeIds;
-    void sendWriteRequest(ThingActionInfo *info, uint slaveAddress, uint modbusRegister, uint32_t value);
-    void updateStates(Thing *thing);
-    void discoverModbusSlaves(ModbusRtuMaster *modbus, uint slaveAddress);
-    void readHoldingRegister(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress, uint modbusRegister);
 
-    VentilationMode getVentilationModeFromString(const QString &modeString);
+    void setupX2LuConnection(ThingSetupInfo *info, ModbusRtuMaster *modbus, uint slaveAddress);
+    void setupX2WpConnection(ThingSetupInfo *info, ModbusRtuMaster *modbus, uint slaveAddress);
+    void finishWriteRequest(ThingActionInfo *info, ModbusRtuReply *reply, const StateTypeId &stateTypeId, const QVariant &value);
 
-    void readX2Energy(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress);
-    void readX2Power(Thing *thing, ModbusRtuMaster *modbus, uint slaveAddress);
+    X2LuModbusRtuConnection::VentilationMode getVentilationModeFromString(const QString &modeString);
+    QString getVentilationModeString(X2LuModbusRtuConnection::VentilationMode ventilationMode);
 
 private slots:
     void onRefreshTimer();
     void onPluginConfigurationChanged(const ParamTypeId &paramTypeId, const QVariant &value);
-    void onConnectionStateChanged(bool status);
 };
 
 #endif // INTEGRATIONPLUGINDREXELUNDWEISS_H
@@ -242,12 +242,3 @@ enum HeatPumpStatus {
     AbtauenEin,
     NachAbtauenAbtropfen
 };
-
-enum VentilationMode {
-    ManuellStufe0 = 0,
-    ManuellStufe1,
-    ManuellStufe2,
-    ManuellStufe3,
-    Automatikbetrieb,
-    Party
-};
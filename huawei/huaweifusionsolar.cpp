@@ -32,6 +32,11 @@
 #include "extern-plugininfo.h"
 #include "loggingcategories.h"
 
+#include <QtMath>
+#include <QDateTime>
+
+#include <algorithm>
+
 NYMEA_LOGGING_CATEGORY(dcHuaweiFusionSolar, "HuaweiFusionSolar")
 
 HuaweiFusionSolar::HuaweiFusionSolar(const QHostAddress &hostAddress, uint port, quint16 slaveId, QObject *parent) :
@@ -42,9 +47,35 @@ HuaweiFusionSolar::HuaweiFusionSolar(const QHostAddress &hostAddress, uint port,
     // this is a very slow or busy device since it returns quiet often that error. Don't faile with the first busy error...
     setCheckReachableRetries(3);
 
+    // Power values are most important and will be read on every update
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterInverterInputPower, 2, LaneFast, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterInverterActivePower, 2, LaneFast, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterPowerMeterActivePower, 2, LaneFast, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Power, 2, LaneFast, 1);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Power, 2, LaneFast, 2);
+
+    // Note: we constantly read the battery status in any case so we detect if a battery came online.
+    // The status has to be listed before the SoC, since the SoC will only be processed for available batteries.
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterInverterDeviceStatus, 1, LaneSlow, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterInverterEnergyProduced, 2, LaneSlow, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyReturned, 2, LaneSlow, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyAquired, 2, LaneSlow, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Status, 1, LaneSlow, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Status, 1, LaneSlow, 0);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Soc, 1, LaneSlow, 1);
+    addRegister(HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Soc, 1, LaneSlow, 2);
+
+    buildWindows();
+
+    m_tokenTimer.setSingleShot(true);
+    connect(&m_tokenTimer, &QTimer::timeout, this, &HuaweiFusionSolar::sendNextWindow);
+
     connect(modbusTcpMaster(), &ModbusTcpMaster::connectionStateChanged, this, [=](bool connected){
         if (!connected) {
-            m_registersQueue.clear();
+            m_fastQueue.clear();
+            m_slowQueue.clear();
+            m_tokenTimer.stop();
+            m_updateCycle = 0;
         }
     });
 
@@ -57,39 +88,16 @@ HuaweiFusionSolar::HuaweiFusionSolar(const QHostAddress &hostAddress, uint port,
 
 bool HuaweiFusionSolar::update()
 {
-    // Make sure there is not an update still running
-    if (!m_registersQueue.isEmpty())
-        return true;
-
-    // Add the requests to queue, begin with power values, since they are most important
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterInverterActivePower);
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterInverterInputPower);
-    if (m_battery1Available)
-        m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Power);
-
-    if (m_battery2Available)
-        m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Power);
+    // Make sure a lane gets only enqueued again once the previous cycle of it has been finished
+    if (m_fastQueue.isEmpty())
+        enqueueLane(LaneFast);
 
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterPowerMeterActivePower);
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyReturned);
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyAquired);
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterInverterEnergyProduced);
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterInverterDeviceStatus);
+    if (m_updateCycle % m_slowLaneCycles == 0 && m_slowQueue.isEmpty())
+        enqueueLane(LaneSlow);
 
-    // Note: we constantly read the status in any case so we detect if a battery came online
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Status);
-    m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Status);
+    m_updateCycle++;
 
-    if (m_battery1Available)
-        m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Soc);
-
-    if (m_battery2Available)
-        m_registersQueue.enqueue(HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Soc);
-
-    // Note: since huawei can only process one request at the time, we need to queue the requests and have some time between requests...
-
-    m_currentRegisterRequest = -1;
-    readNextRegister();
+    sendNextWindow();
     return true;
 }
 
@@ -98,652 +106,335 @@ quint16 HuaweiFusionSolar::slaveId() const
     return m_slaveId;
 }
 
-void HuaweiFusionSolar::readNextRegister()
+uint HuaweiFusionSolar::requestInterval() const
 {
-    // Check if currently a reply is pending
-    if (m_currentRegisterRequest >= 0)
-        return;
-
-    // Check if there is still a register to read
-    if (m_registersQueue.isEmpty())
-        return;
-
-    m_currentRegisterRequest = m_registersQueue.dequeue();
-
-    switch (m_currentRegisterRequest) {
-    case HuaweiFusionModbusTcpConnection::RegisterInverterActivePower: {
-        // Update registers from Inverter active power
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Inverter active power\" register:" << 32080 << "size:" << 2;
-        QModbusReply *reply = readInverterActivePower();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
+    return m_requestInterval;
+}
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+void HuaweiFusionSolar::setRequestInterval(uint requestInterval)
+{
+    m_requestInterval = qMax(requestInterval, 1u);
+}
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Inverter active power\" register" << 32080 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processInverterActivePowerRegisterValues(unit.values());
-                }
-            }
+uint HuaweiFusionSolar::requestBurst() const
+{
+    return m_requestBurst;
+}
 
-            finishRequest();
-        });
+void HuaweiFusionSolar::setRequestBurst(uint requestBurst)
+{
+    m_requestBurst = qMax(requestBurst, 1u);
+}
 
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
+uint HuaweiFusionSolar::slowLaneCycles() const
+{
+    return m_slowLaneCycles;
+}
 
-        break;
-    }
-    case HuaweiFusionModbusTcpConnection::RegisterInverterInputPower: {
-        // Update registers from Inverter active power
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Inverter input power\" register:" << 32064 << "size:" << 2;
-        QModbusReply *reply = readInverterInputPower();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter input power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
+void HuaweiFusionSolar::setSlowLaneCycles(uint slowLaneCycles)
+{
+    m_slowLaneCycles = qMax(slowLaneCycles, 1u);
+}
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+uint HuaweiFusionSolar::maxWindowGap() const
+{
+    return m_maxWindowGap;
+}
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Inverter input power\" register" << 32064 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processInverterInputPowerRegisterValues(unit.values());
-                }
-            }
+void HuaweiFusionSolar::setMaxWindowGap(uint maxWindowGap)
+{
+    if (m_maxWindowGap == maxWindowGap)
+        return;
 
-            finishRequest();
-        });
+    m_maxWindowGap = maxWindowGap;
+    buildWindows();
+}
 
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter input power\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter input power\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
+void HuaweiFusionSolar::addRegister(Registers reg, quint16 size, Lane lane, int battery)
+{
+    RegisterInfo info;
+    info.reg = reg;
+    info.size = size;
+    info.lane = lane;
+    info.battery = battery;
+    m_registers.append(info);
+}
 
-        break;
-    }
-    case HuaweiFusionModbusTcpConnection::RegisterInverterDeviceStatus: {
-        // Update registers from Inverter device status
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Inverter device status\" register:" << 32089 << "size:" << 1;
-        QModbusReply *reply = readInverterDeviceStatus();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter device status\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
+void HuaweiFusionSolar::buildWindows()
+{
+    m_windows.clear();
+    m_fastQueue.clear();
+    m_slowQueue.clear();
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+    QList<RegisterInfo> sortedRegisters = m_registers;
+    std::sort(sortedRegisters.begin(), sortedRegisters.end(), [](const RegisterInfo &a, const RegisterInfo &b){
+        return a.reg < b.reg;
+    });
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Inverter device status\" register" << 32089 << "size:" << 1 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 1)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 1 << "but received" << unit.values();
-                } else {
-                    processInverterDeviceStatusRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter device status\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
+    foreach (Lane lane, QList<Lane>() << LaneFast << LaneSlow) {
+        Window window;
+        foreach (const RegisterInfo &info, sortedRegisters) {
+            if (info.lane != lane)
+                continue;
+
+            if (!window.registers.isEmpty()) {
+                uint windowEnd = window.address + window.size;
+                // Modbus allows max 125 registers per read, stay well below
+                if (static_cast<uint>(info.reg) - windowEnd <= m_maxWindowGap && static_cast<uint>(info.reg) + info.size - window.address <= 64) {
+                    window.size = info.reg + info.size - window.address;
+                    window.registers.append(info);
+                    if (window.battery != info.battery)
+                        window.battery = 0;
+
+                    continue;
                 }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter device status\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
+
+                m_windows.append(window);
             }
-        });
 
-        break;
-    }
-    case HuaweiFusionModbusTcpConnection::RegisterInverterEnergyProduced: {
-        // Update registers from Inverter energy produced
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Inverter energy produced\" register:" << 32106 << "size:" << 2;
-        QModbusReply *reply = readInverterEnergyProduced();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Inverter energy produced\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
+            window = Window();
+            window.address = info.reg;
+            window.size = info.size;
+            window.lane = lane;
+            window.battery = info.battery;
+            window.registers.append(info);
         }
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
+        if (!window.registers.isEmpty()) {
+            m_windows.append(window);
         }
-
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Inverter energy produced\" register" << 32106 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processInverterEnergyProducedRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter energy produced\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Inverter energy produced\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
-        break;
     }
-    case HuaweiFusionModbusTcpConnection::RegisterPowerMeterActivePower: {
-        // Update registers from Power meter active power
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Power meter active power\" register:" << 37113 << "size:" << 2;
-        QModbusReply *reply = readPowerMeterActivePower();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Power meter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
-
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Power meter active power\" register" << 37113 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processPowerMeterActivePowerRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Power meter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Power meter active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
-
-        break;
+    foreach (const Window &window, m_windows) {
+        qCDebug(dcHuaweiFusionSolar()) << "Read window" << window.lane << "register:" << window.address << "size:" << window.size << "containing" << window.registers.count() << "registers";
     }
-    case HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyReturned: {
-        // Update registers from Power meter active power
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Power meter  Positive active electricity\" register:" << 37119 << "size:" << 2;
-        QModbusReply *reply = readPowerMeterEnergyReturned();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Power meter  Positive active electricity\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
+}
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
+void HuaweiFusionSolar::enqueueLane(Lane lane)
+{
+    foreach (const Window &window, m_windows) {
+        if (window.lane != lane)
+            continue;
+
+        // Don't read values from batteries which are not available
+        if ((window.battery == 1 && !m_battery1Available) || (window.battery == 2 && !m_battery2Available))
+            continue;
+
+        if (lane == LaneFast) {
+            m_fastQueue.enqueue(window);
+        } else {
+            m_slowQueue.enqueue(window);
         }
+    }
+}
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Power meter  Positive active electricity\" register" << 37119 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processPowerMeterEnergyReturnedRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Power meter  Positive active electricity\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Power meter  Positive active electricity\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
-
-        break;
+bool HuaweiFusionSolar::consumeToken()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_lastTokenRefill > 0) {
+        m_tokens = qMin(static_cast<double>(m_requestBurst), m_tokens + static_cast<double>(now - m_lastTokenRefill) / m_requestInterval);
+    }
+    m_lastTokenRefill = now;
 
+    if (m_tokens >= 1) {
+        m_tokens -= 1;
+        return true;
     }
-    case HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyAquired: {
-        // Update registers from Power meter active power
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Power meter Reverse active power\" register:" << 37121 << "size:" << 2;
-        QModbusReply *reply = readPowerMeterEnergyAquired();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Power meter Reverse active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+    // Wait until the next token is available
+    m_tokenTimer.start(qCeil((1 - m_tokens) * m_requestInterval));
+    return false;
+}
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Power meter Reverse active power\" register" << 37121 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processPowerMeterEnergyAquiredRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Power meter Reverse active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Power meter Reverse active power\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
+void HuaweiFusionSolar::sendNextWindow()
+{
+    // Note: the huawei can only process one request at the time
+    if (m_currentReply || m_tokenTimer.isActive())
+        return;
 
-        break;
+    if (m_fastQueue.isEmpty() && m_slowQueue.isEmpty())
+        return;
 
-    }
-    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Status: {
-        // Update registers from Luna 2000 Battery 1 status
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Luna 2000 Battery 1 status\" register:" << 37000 << "size:" << 1;
-        QModbusReply *reply = readLunaBattery1Status();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 1 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
+    if (!consumeToken())
+        return;
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+    // The fast lane has always priority
+    if (!m_fastQueue.isEmpty()) {
+        sendWindow(m_fastQueue.dequeue());
+    } else {
+        sendWindow(m_slowQueue.dequeue());
+    }
+}
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Luna 2000 Battery 1 status\" register" << 37000 << "size:" << 1 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 1)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 1 << "but received" << unit.values();
-                } else {
-                    processLunaBattery1StatusRegisterValues(unit.values());
-                    switch (m_lunaBattery1Status) {
-                    case HuaweiFusionSolar::BatteryDeviceStatusFault:
-                    case HuaweiFusionSolar::BatteryDeviceStatusStandby:
-                    case HuaweiFusionSolar::BatteryDeviceStatusOffline:
-                    case HuaweiFusionSolar::BatteryDeviceStatusSleepMode:
-                        m_battery1Available = false;
-                        m_lunaBattery1Power = 0;
-                        emit lunaBattery1PowerChanged(m_lunaBattery1Power);
-                        break;
-                    case HuaweiFusionSolar::BatteryDeviceStatusRunning:
-                        m_battery1Available = true;
-                        break;
-                    }
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 1 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 1 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
-        break;
+void HuaweiFusionSolar::sendWindow(const Window &window)
+{
+    qCDebug(dcHuaweiFusionSolar()) << "--> Read" << window.lane << "window register:" << window.address << "size:" << window.size;
+    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, window.address, window.size);
+    QModbusReply *reply = modbusTcpMaster()->sendReadRequest(request, m_slaveId);
+    if (!reply) {
+        qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading window" << window.address << "size:" << window.size << "from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
+        sendNextWindow();
+        return;
     }
-    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Power: {
-        // Update registers from Luna 2000 Battery 1 power
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Luna 2000 Battery 1 power\" register:" << 37001 << "size:" << 2;
-        QModbusReply *reply = readLunaBattery1Power();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 1 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+    if (reply->isFinished()) {
+        reply->deleteLater(); // Broadcast reply returns immediatly
+        sendNextWindow();
+        return;
+    }
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Luna 2000 Battery 1 power\" register" << 37001 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processLunaBattery1PowerRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 1 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
+    m_currentReply = reply;
+    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+    connect(reply, &QModbusReply::finished, this, [this, reply, window](){
+        if (m_currentReply == reply)
+            m_currentReply = nullptr;
+
+        handleModbusError(reply->error());
+        if (reply->error() == QModbusDevice::NoError) {
+            const QModbusDataUnit unit = reply->result();
+            qCDebug(dcHuaweiFusionSolar()) << "<-- Response from window register" << window.address << "size:" << window.size << "valueCount:" << unit.valueCount() << unit.values();
+            if (unit.values().count() != window.size) {
+                qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values count. Requested" << window.size << "but received" << unit.values();
             } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 1 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
+                processWindow(window, unit.values());
             }
-        });
-        break;
-    }
-    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Soc: {
-        // Update registers from Luna 2000 Battery 1 state of charge
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Luna 2000 Battery 1 state of charge\" register:" << 37004 << "size:" << 1;
-        QModbusReply *reply = readLunaBattery1Soc();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 1 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
         }
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+        sendNextWindow();
+    });
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Luna 2000 Battery 1 state of charge\" register" << 37004 << "size:" << 1 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 1)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 1 << "but received" << unit.values();
-                } else {
-                    processLunaBattery1SocRegisterValues(unit.values());
+    connect(reply, &QModbusReply::errorOccurred, this, [this, reply, window] (QModbusDevice::Error error){
+        if (reply->error() == QModbusDevice::ProtocolError) {
+            QModbusResponse response = reply->rawResult();
+            if (response.isException()) {
+                qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while reading window" << window.address << "size:" << window.size << "from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
+                // Some firmware versions don't allow reading the gaps between registers
+                if (response.exceptionCode() == QModbusPdu::IllegalDataAddress && window.registers.count() > 1) {
+                    splitWindow(window);
                 }
             }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 1 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 1 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
-        break;
-    }
-
-    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Status: {
-        // Update registers from Luna 2000 Battery 2 status
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Luna 2000 Battery 2 status\" register:" << 37741 << "size:" << 1;
-        QModbusReply *reply = readLunaBattery2Status();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 2 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
+        } else {
+            qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while reading window" << window.address << "size:" << window.size << "from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
         }
+    });
+}
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+void HuaweiFusionSolar::processWindow(const Window &window, const QVector<quint16> &values)
+{
+    // Note: process in the order of the register list, not the addresses
+    foreach (const RegisterInfo &info, m_registers) {
+        if (info.lane != window.lane || info.reg < window.address || info.reg + info.size > window.address + window.size)
+            continue;
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Luna 2000 Battery 2 status\" register" << 37741 << "size:" << 1 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 1)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values count. Requested" << 1 << "but received" << unit.values();
-                } else {
-                    processLunaBattery2StatusRegisterValues(unit.values());
-                    switch (m_lunaBattery2Status) {
-                    case HuaweiFusionSolar::BatteryDeviceStatusFault:
-                    case HuaweiFusionSolar::BatteryDeviceStatusStandby:
-                    case HuaweiFusionSolar::BatteryDeviceStatusOffline:
-                    case HuaweiFusionSolar::BatteryDeviceStatusSleepMode:
-                        m_battery2Available = false;
-                        m_lunaBattery2Power = 0;
-                        emit lunaBattery2PowerChanged(m_lunaBattery2Power);
-                        break;
-                    case HuaweiFusionSolar::BatteryDeviceStatusRunning:
-                        m_battery2Available = true;
-                        break;
-                    }
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 2 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 2 status\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
-        break;
-    }
-    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Power: {
-        // Update registers from Luna 2000 Battery 2 power
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Luna 2000 Battery 2 power\" register:" << 37743 << "size:" << 2;
-        QModbusReply *reply = readLunaBattery2Power();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 2 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
-        }
+        // Don't process values from batteries which are not available
+        if ((info.battery == 1 && !m_battery1Available) || (info.battery == 2 && !m_battery2Available))
+            continue;
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
-        }
+        // Note: invalid values will be filtered by the connection, see invalidValues in the register JSON
+        processRegisterValues(info.reg, values.mid(info.reg - window.address, info.size));
+    }
+}
 
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Luna 2000 Battery 2 power\" register" << 37743 << "size:" << 2 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 2)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values count. Requested" << 2 << "but received" << unit.values();
-                } else {
-                    processLunaBattery2PowerRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 2 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 2 power\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
+void HuaweiFusionSolar::processRegisterValues(Registers reg, const QVector<quint16> &values)
+{
+    switch (reg) {
+    case HuaweiFusionModbusTcpConnection::RegisterInverterInputPower:
+        processInverterInputPowerRegisterValues(values);
         break;
-    }
-    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Soc: {
-        // Update registers from Luna 2000 Battery 2 state of charge
-        qCDebug(dcHuaweiFusionSolar()) << "--> Read \"Luna 2000 Battery 2 state of charge\" register:" << 37738 << "size:" << 1;
-        QModbusReply *reply = readLunaBattery2Soc();
-        if (!reply) {
-            qCWarning(dcHuaweiFusionSolar()) << "Error occurred while reading \"Luna 2000 Battery 2 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << modbusTcpMaster()->errorString();
-            finishRequest();
-            return;
+    case HuaweiFusionModbusTcpConnection::RegisterInverterActivePower:
+        processInverterActivePowerRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterInverterDeviceStatus:
+        processInverterDeviceStatusRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterInverterEnergyProduced:
+        processInverterEnergyProducedRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterPowerMeterActivePower:
+        processPowerMeterActivePowerRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyReturned:
+        processPowerMeterEnergyReturnedRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterPowerMeterEnergyAquired:
+        processPowerMeterEnergyAquiredRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Status:
+        processLunaBattery1StatusRegisterValues(values);
+        // Don't act on the last known status if the device reported an invalid value
+        if (!m_lunaBattery1StatusValid)
+            break;
+
+        switch (m_lunaBattery1Status) {
+        case HuaweiFusionSolar::BatteryDeviceStatusFault:
+        case HuaweiFusionSolar::BatteryDeviceStatusStandby:
+        case HuaweiFusionSolar::BatteryDeviceStatusOffline:
+        case HuaweiFusionSolar::BatteryDeviceStatusSleepMode:
+            m_battery1Available = false;
+            m_lunaBattery1Power = 0;
+            emit lunaBattery1PowerChanged(m_lunaBattery1Power);
+            break;
+        case HuaweiFusionSolar::BatteryDeviceStatusRunning:
+            m_battery1Available = true;
+            break;
         }
-
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            finishRequest();
-            return;
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Power:
+        processLunaBattery1PowerRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery1Soc:
+        processLunaBattery1SocRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Status:
+        processLunaBattery2StatusRegisterValues(values);
+        // Don't act on the last known status if the device reported an invalid value
+        if (!m_lunaBattery2StatusValid)
+            break;
+
+        switch (m_lunaBattery2Status) {
+        case HuaweiFusionSolar::BatteryDeviceStatusFault:
+        case HuaweiFusionSolar::BatteryDeviceStatusStandby:
+        case HuaweiFusionSolar::BatteryDeviceStatusOffline:
+        case HuaweiFusionSolar::BatteryDeviceStatusSleepMode:
+            m_battery2Available = false;
+            m_lunaBattery2Power = 0;
+            emit lunaBattery2PowerChanged(m_lunaBattery2Power);
+            break;
+        case HuaweiFusionSolar::BatteryDeviceStatusRunning:
+            m_battery2Available = true;
+            break;
         }
-
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            handleModbusError(reply->error());
-            if (reply->error() == QModbusDevice::NoError) {
-                const QModbusDataUnit unit = reply->result();
-                qCDebug(dcHuaweiFusionSolar()) << "<-- Response from \"Luna 2000 Battery 2 state of charge\" register" << 37738 << "size:" << 1 << "valueCount:" << unit.valueCount() << unit.values() << unit.values().count();
-                if (!valuesAreVaild(unit.values(), 1)) {
-                    qCWarning(dcHuaweiFusionSolar()) << "<-- Received invalid values. Requested" << 1 << "but received" << unit.values();
-                } else {
-                    processLunaBattery2SocRegisterValues(unit.values());
-                }
-            }
-            finishRequest();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            if (reply->error() == QModbusDevice::ProtocolError) {
-                QModbusResponse response = reply->rawResult();
-                if (response.isException()) {
-                    qCDebug(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 2 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << exceptionToString(response.exceptionCode());
-                }
-            } else {
-                qCWarning(dcHuaweiFusionSolar()) << "Modbus reply error occurred while updating \"Luna 2000 Battery 2 state of charge\" registers from" << modbusTcpMaster()->hostAddress().toString() << error << reply->errorString();
-            }
-        });
         break;
-    }
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Power:
+        processLunaBattery2PowerRegisterValues(values);
+        break;
+    case HuaweiFusionModbusTcpConnection::RegisterLunaBattery2Soc:
+        processLunaBattery2SocRegisterValues(values);
+        break;
+    default:
+        break;
     }
 }
 
-bool HuaweiFusionSolar::valuesAreVaild(const QVector<quint16> &values, int readSize)
+void HuaweiFusionSolar::splitWindow(const Window &window)
 {
-    if (values.count() != readSize) {
-        qCDebug(dcHuaweiFusionSolar()) << "Invalid values. The received values count does not match the requested" << readSize << "registers.";
-        return false;
-    }
-
-    // According to the documentation from 2016:
-    // 0x7FFF: invalid value of the floating point type returned by one register
-    // 0xFFFF: invalid value of a type other than the floating point type returned by one register
-    // 0xFFFFFFFF: invalid value returned by two registers
-
-    if (values.count() == 2) {
-        bool floatingPointValid = (values != QVector<quint16>() << 0x7fff << 0xffff);
-        if (!floatingPointValid)
-            qCDebug(dcHuaweiFusionSolar()) << "Invalid values. The received values match the invalid for floating pointer:" << values;
-
-        bool otherTypesValid = (values != QVector<quint16>(2, 0xffff));
-        if (!otherTypesValid)
-            qCDebug(dcHuaweiFusionSolar()) << "Invalid values. The received values match the invalid registers values:" << values;
-
-        return floatingPointValid && otherTypesValid;
+    qCDebug(dcHuaweiFusionSolar()) << "Splitting window" << window.address << "size:" << window.size << "into single register reads";
+    for (int i = 0; i < m_windows.count(); i++) {
+        if (m_windows.at(i).lane != window.lane || m_windows.at(i).address != window.address)
+            continue;
+
+        m_windows.removeAt(i);
+        foreach (const RegisterInfo &info, window.registers) {
+            Window singleWindow;
+            singleWindow.address = info.reg;
+            singleWindow.size = info.size;
+            singleWindow.lane = info.lane;
+            singleWindow.battery = info.battery;
+            singleWindow.registers.append(info);
+            m_windows.insert(i++, singleWindow);
+        }
+        break;
     }
-
-    if (values.count() == 1)
-        return values.at(0) != 0x7fff && values.at(0) != 0xffff;
-
-    return true;
-}
-
-void HuaweiFusionSolar::finishRequest()
-{
-    m_currentRegisterRequest = -1;
-    QTimer::singleShot(1000, this, &HuaweiFusionSolar::readNextRegister);
 }
 
 QString HuaweiFusionSolar::exceptionToString(QModbusPdu::ExceptionCode exception)
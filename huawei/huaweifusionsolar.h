@@ -31,15 +31,27 @@
 #ifndef HUAWEIFUSIONSOLAR_H
 #define HUAWEIFUSIONSOLAR_H
 
+#include <QTimer>
 #include <QObject>
 #include <QQueue>
 
 #include "huaweifusionmodbustcpconnection.h"
 
+// The SmartDongle / SmartLogger can only process one request at the time and starts
+// to reply with "server busy" if requests come in too fast. Registers are therefore
+// read in merged windows, rate limited by a token bucket, and the power values are
+// read on a fast lane, while energy counters and states are read on a slow lane.
+
 class HuaweiFusionSolar : public HuaweiFusionModbusTcpConnection
 {
     Q_OBJECT
 public:
+    enum Lane {
+        LaneFast,
+        LaneSlow
+    };
+    Q_ENUM(Lane)
+
     explicit HuaweiFusionSolar(const QHostAddress &hostAddress, uint port, quint16 slaveId, QObject *parent = nullptr);
     ~HuaweiFusionSolar() = default;
 
@@ -47,24 +59,72 @@ public:
 
     quint16 slaveId() const;
 
+    // Minimum average time in ms between two requests, i.e. the refill time of one token
+    uint requestInterval() const;
+    void setRequestInterval(uint requestInterval);
+
+    // Maximum number of requests which can be sent right after each other after an idle period
+    uint requestBurst() const;
+    void setRequestBurst(uint requestBurst);
+
+    // The slow lane will be read every n-th update call
+    uint slowLaneCycles() const;
+    void setSlowLaneCycles(uint slowLaneCycles);
+
+    // Registers closer than this gap will be read together in one window
+    uint maxWindowGap() const;
+    void setMaxWindowGap(uint maxWindowGap);
+
 private:
+    typedef struct RegisterInfo {
+        HuaweiFusionModbusTcpConnection::Registers reg;
+        quint16 size = 0;
+        Lane lane = LaneSlow;
+        int battery = 0;
+    } RegisterInfo;
+
+    typedef struct Window {
+        quint16 address = 0;
+        quint16 size = 0;
+        Lane lane = LaneSlow;
+        int battery = 0;
+        QList<RegisterInfo> registers;
+    } Window;
+
     quint16 m_slaveId;
-    QQueue<HuaweiFusionModbusTcpConnection::Registers> m_registersQueue;
-    QModbusReply *m_initReply = nullptr;
 
-    int m_currentRegisterRequest = -1;
-    void finishRequest();
+    uint m_requestInterval = 1000;
+    uint m_requestBurst = 1;
+    uint m_slowLaneCycles = 5;
+    uint m_maxWindowGap = 16;
+    uint m_updateCycle = 0;
+
+    double m_tokens = 1;
+    qint64 m_lastTokenRefill = 0;
+    QTimer m_tokenTimer;
+
+    QList<RegisterInfo> m_registers;
+    QList<Window> m_windows;
+    QQueue<Window> m_fastQueue;
+    QQueue<Window> m_slowQueue;
+    QModbusReply *m_currentReply = nullptr;
 
     bool m_battery1Available = false;
     bool m_battery2Available = false;
 
-    double m_actualInverterPower = 0;
+    void addRegister(HuaweiFusionModbusTcpConnection::Registers reg, quint16 size, Lane lane, int battery = 0);
+    void buildWindows();
+    void enqueueLane(Lane lane);
+    bool consumeToken();
+    void sendWindow(const Window &window);
+    void processWindow(const Window &window, const QVector<quint16> &values);
+    void processRegisterValues(HuaweiFusionModbusTcpConnection::Registers reg, const QVector<quint16> &values);
+    void splitWindow(const Window &window);
 
     QString exceptionToString(QModbusPdu::ExceptionCode exception);
 
 private slots:
-    void readNextRegister();
-    bool valuesAreVaild(const QVector<quint16> &values, int readSize);
+    void sendNextWindow();
 
 };
 
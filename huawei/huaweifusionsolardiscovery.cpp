@@ -44,16 +44,25 @@ void HuaweiFusionSolarDiscovery::startDiscovery()
 {
     qCInfo(dcHuawei()) << "Discovery: Start searching for Huawei FusionSolar SmartDongle in the network...";
     m_startDateTime = QDateTime::currentDateTime();
-    NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &HuaweiFusionSolarDiscovery::checkNetworkDevice);
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
+
+    // Only hosts with the modbus port open get a connection for checking the device
+    ModbusTcpDiscovery *modbusTcpDiscovery = new ModbusTcpDiscovery(m_networkDeviceDiscovery, m_port, 1, this);
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::deviceFound, this, [this](const ModbusTcpDiscovery::Result &result){
+        checkNetworkDevice(result.networkDeviceInfo);
+    });
+
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::discoveryFinished, this, [=](){
+        qCDebug(dcHuawei()) << "Discovery: Network discovery finished. Found" << modbusTcpDiscovery->results().count() << "network devices with the modbus port open";
+        modbusTcpDiscovery->deleteLater();
+
         // Finish with some delay so the last added network device information objects still can be checked.
         QTimer::singleShot(3000, this, [this](){
             qCDebug(dcHuawei()) << "Discovery: Grace period timer triggered.";
             finishDiscovery();
         });
     });
+
+    modbusTcpDiscovery->startDiscovery();
 }
 
 QList<HuaweiFusionSolarDiscovery::Result> HuaweiFusionSolarDiscovery::results() const
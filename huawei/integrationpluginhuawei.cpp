@@ -444,6 +444,7 @@ void IntegrationPluginHuawei::setupFusionSolar(ThingSetupInfo *info)
     qCDebug(dcHuawei()) << "Setup connection to fusion solar dongle" << monitor->networkDeviceInfo().address().toString() << port << slaveId;
 
     HuaweiFusionSolar *connection = new HuaweiFusionSolar(monitor->networkDeviceInfo().address(), port, slaveId, this);
+    connection->setRequestInterval(thing->setting(huaweiFusionSolarInverterSettingsRequestIntervalParamTypeId).toUInt());
     connect(info, &ThingSetupInfo::aborted, connection, &HuaweiFusionSolar::deleteLater);
     connect(connection, &HuaweiFusionSolar::reachableChanged, info, [=](bool reachable){
         if (!reachable) {
@@ -495,6 +496,13 @@ void IntegrationPluginHuawei::setupFusionSolar(ThingSetupInfo *info)
             }
         });
 
+        connect(thing, &Thing::settingChanged, connection, [thing, connection](const ParamTypeId &paramTypeId, const QVariant &value){
+            if (paramTypeId == huaweiFusionSolarInverterSettingsRequestIntervalParamTypeId) {
+                qCDebug(dcHuawei()) << "Set request interval of" << thing->name() << "to" << value.toUInt() << "ms";
+                connection->setRequestInterval(value.toUInt());
+            }
+        });
+
         connect(monitor, &NetworkDeviceMonitor::reachableChanged, thing, [=](bool reachable){
             if (!thing->setupComplete())
                 return;
@@ -33,6 +33,7 @@
 
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginIdm::IntegrationPluginIdm()
 {
@@ -158,9 +159,7 @@ void IntegrationPluginIdm::postSetupThing(Thing *thing)
         qCDebug(dcIdm()) << "Starting refresh timer";
         m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
         connect(m_refreshTimer, &PluginTimer::timeout, this, [this](){
-            foreach (IdmModbusTcpConnection *connection, m_connections) {
-                connection->update();
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
         });
 
         m_refreshTimer->start();
@@ -299,6 +298,7 @@ void IntegrationPluginIdm::setupConnection(ThingSetupInfo *info)
 
         qCDebug(dcIdm()) << "Connection init finished successfully" << connection;
         m_connections.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusTcpMaster()->hostAddress().toString(), true);
         info->finish(Thing::ThingErrorNoError);
 
         // Set connected true
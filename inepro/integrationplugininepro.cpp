@@ -31,6 +31,8 @@
 #include "integrationplugininepro.h"
 #include "plugininfo.h"
 
+#include <modbuspollorchestrator.h>
+
 IntegrationPluginInepro::IntegrationPluginInepro()
 {
 }
@@ -195,6 +197,7 @@ void IntegrationPluginInepro::setupThing(ThingSetupInfo *info)
 
     // FIXME: try to read before setup success
     m_connections.insert(thing, proConnection);
+    ModbusPollOrchestrator::instance()->addConnection(this, proConnection, proConnection->modbusRtuMaster()->serialPort(), true);
     info->finish(Thing::ThingErrorNoError);
 }
 
@@ -204,9 +207,7 @@ void IntegrationPluginInepro::postSetupThing(Thing *thing)
     if (!m_refreshTimer) {
         m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
         connect(m_refreshTimer, &PluginTimer::timeout, this, [this] {
-            foreach (Thing *thing, myThings()) {
-                m_connections.value(thing)->update();
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
         });
 
         qCDebug(dcInepro()) << "Starting refresh timer...";
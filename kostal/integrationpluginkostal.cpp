@@ -34,6 +34,7 @@
 
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginKostal::IntegrationPluginKostal()
 {
@@ -194,10 +195,7 @@ void IntegrationPluginKostal::postSetupThing(Thing *thing)
             qCDebug(dcKostal()) << "Starting plugin timer...";
             m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
             connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-                foreach(KostalModbusTcpConnection *connection, m_kostalConnections) {
-                    qCDebug(dcKostal()) << "Update connection" << connection->modbusTcpMaster()->hostAddress().toString();
-                    connection->update();
-                }
+                ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
             });
 
             m_pluginTimer->start();
@@ -367,6 +365,7 @@ void IntegrationPluginKostal::setupKostalConnection(ThingSetupInfo *info)
 
         qCDebug(dcKostal()) << "Connection init finished successfully" << kostalConnection;
         m_kostalConnections.insert(thing, kostalConnection);
+        ModbusPollOrchestrator::instance()->addConnection(this, kostalConnection, kostalConnection->modbusTcpMaster()->hostAddress().toString(), true);
         info->finish(Thing::ThingErrorNoError);
 
         // Set connected true
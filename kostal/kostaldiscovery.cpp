@@ -33,42 +33,54 @@
 
 KostalDiscovery::KostalDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, quint16 port, quint16 modbusAddress, QObject *parent) :
     QObject{parent},
-    m_networkDeviceDiscovery{networkDeviceDiscovery},
     m_port{port},
     m_modbusAddress{modbusAddress}
 {
+    // Only hosts with the modbus port open and the KOSTAL manufacturer string get a full connection
+    m_modbusTcpDiscovery = new ModbusTcpDiscovery(networkDeviceDiscovery, m_port, m_modbusAddress, this);
+    m_modbusTcpDiscovery->setSignatureName("kostal");
+    m_modbusTcpDiscovery->setSignatureRegisters(QModbusDataUnit::HoldingRegisters, KostalModbusTcpConnection::RegisterInverterManufacturer, 16, [](const QVector<quint16> &values){
+        return ModbusDataUtils::convertToString(values, ModbusDataUtils::ByteOrderBigEndian).toUpper().contains("KOSTAL");
+    });
 
-}
-
-void KostalDiscovery::startDiscovery()
-{
-    qCInfo(dcKostal()) << "Discovery: Start searching for Kostal inverters in the network...";
-    NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
-
-    // Imedialty check any new device gets discovered
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &KostalDiscovery::checkNetworkDevice);
+    connect(m_modbusTcpDiscovery, &ModbusTcpDiscovery::deviceFound, this, [this](const ModbusTcpDiscovery::Result &result){
+        checkNetworkDevice(result.networkDeviceInfo);
+    });
 
-    // Check what might be left on finished
-        connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        qCDebug(dcKostal()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
-        m_networkDeviceInfos = discoveryReply->networkDeviceInfos();
+    connect(m_modbusTcpDiscovery, &ModbusTcpDiscovery::discoveryFinished, this, [this](){
+        evaluateFinished();
 
-        // Send a report request to nework device info not sent already...
-        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_networkDeviceInfos) {
-            if (!m_verifiedNetworkDeviceInfos.contains(networkDeviceInfo)) {
-                checkNetworkDevice(networkDeviceInfo);
-            }
+        // Give the connections of the last candidates a chance to initialize
+        if (!m_finished) {
+            m_gracePeriodTimer.start();
         }
+    });
 
-        // Give the last connections added right before the network discovery finished a chance to check the device...
-        QTimer::singleShot(3000, this, [this](){
-            qCDebug(dcKostal()) << "Discovery: Grace period timer triggered.";
-            finishDiscovery();
-        });
+    m_gracePeriodTimer.setSingleShot(true);
+    m_gracePeriodTimer.setInterval(3000);
+    connect(&m_gracePeriodTimer, &QTimer::timeout, this, [this](){
+        qCDebug(dcKostal()) << "Discovery: Grace period timer triggered.";
+        finishDiscovery();
+    });
+
+    // Make sure the discovery finishes, no matter if a host never reports back
+    m_deadlineTimer.setSingleShot(true);
+    m_deadlineTimer.setInterval(60000);
+    connect(&m_deadlineTimer, &QTimer::timeout, this, [this](){
+        qCWarning(dcKostal()) << "Discovery: Deadline reached, finishing the discovery.";
+        finishDiscovery();
     });
 }
 
+void KostalDiscovery::startDiscovery()
+{
+    qCInfo(dcKostal()) << "Discovery: Start searching for Kostal inverters in the network...";
+    m_startDateTime = QDateTime::currentDateTime();
+    m_finished = false;
+    m_deadlineTimer.start();
+    m_modbusTcpDiscovery->startDiscovery();
+}
+
 QList<KostalDiscovery::KostalDiscoveryResult> KostalDiscovery::discoveryResults() const
 {
     return m_discoveryResults;
@@ -81,12 +93,8 @@ void KostalDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceI
     // the device we can assume this is what we are locking for (ip, port, modbus address, correct registers).
     // We cloud tough also filter the result only for certain software versions, manufactueres or whatever...
 
-    if (m_verifiedNetworkDeviceInfos.contains(networkDeviceInfo))
-        return;
-
     KostalModbusTcpConnection *connection = new KostalModbusTcpConnection(networkDeviceInfo.address(), m_port, m_modbusAddress, this);
     m_connections.append(connection);
-    m_verifiedNetworkDeviceInfos.append(networkDeviceInfo);
 
     connect(connection, &KostalModbusTcpConnection::reachableChanged, this, [=](bool reachable){
         if (!reachable) {
@@ -152,13 +160,35 @@ void KostalDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDeviceI
 
 void KostalDiscovery::cleanupConnection(KostalModbusTcpConnection *connection)
 {
+    if (!m_connections.contains(connection))
+        return;
+
     m_connections.removeAll(connection);
     connection->disconnectDevice();
     connection->deleteLater();
+
+    evaluateFinished();
+}
+
+void KostalDiscovery::evaluateFinished()
+{
+    // Done as soon as the network has been probed and all candidates have been initialized
+    if (m_finished || m_modbusTcpDiscovery->running() || !m_connections.isEmpty())
+        return;
+
+    finishDiscovery();
 }
 
 void KostalDiscovery::finishDiscovery()
 {
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_gracePeriodTimer.stop();
+    m_deadlineTimer.stop();
+    m_modbusTcpDiscovery->stopDiscovery();
+
     qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
 
     // Cleanup any leftovers...we don't care any more
@@ -35,6 +35,7 @@
 #include <QTimer>
 
 #include <network/networkdevicediscovery.h>
+#include <modbustcpdiscovery.h>
 
 #include "kostalmodbustcpconnection.h"
 
@@ -61,14 +62,14 @@ signals:
     void discoveryFinished();
 
 private:
-    NetworkDeviceDiscovery *m_networkDeviceDiscovery = nullptr;
+    ModbusTcpDiscovery *m_modbusTcpDiscovery = nullptr;
     quint16 m_port;
     quint16 m_modbusAddress;
 
     QDateTime m_startDateTime;
-
-    NetworkDeviceInfos m_networkDeviceInfos;
-    NetworkDeviceInfos m_verifiedNetworkDeviceInfos;
+    QTimer m_gracePeriodTimer;
+    QTimer m_deadlineTimer;
+    bool m_finished = false;
 
     QList<KostalModbusTcpConnection *> m_connections;
 
@@ -77,6 +78,7 @@ private:
     void checkNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
     void cleanupConnection(KostalModbusTcpConnection *connection);
 
+    void evaluateFinished();
     void finishDiscovery();
 };
 
@@ -17,10 +17,16 @@ gcc {
 
 HEADERS += \
     modbusdatautils.h \
+    modbusfingerprintcache.h \
+    modbuspollorchestrator.h \
+    modbustcpdiscovery.h \
     modbustcpmaster.h
 
 SOURCES += \
     modbusdatautils.cpp \
+    modbusfingerprintcache.cpp \
+    modbuspollorchestrator.cpp \
+    modbustcpdiscovery.cpp \
     modbustcpmaster.cpp
 
 
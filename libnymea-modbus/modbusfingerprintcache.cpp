@@ -0,0 +1,155 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbusfingerprintcache.h"
+
+#include <QDateTime>
+
+Q_LOGGING_CATEGORY(dcModbusFingerprintCache, "ModbusFingerprintCache")
+
+ModbusFingerprintCache *ModbusFingerprintCache::instance()
+{
+    static ModbusFingerprintCache cache;
+    return &cache;
+}
+
+int ModbusFingerprintCache::timeToLive() const
+{
+    return m_timeToLive;
+}
+
+void ModbusFingerprintCache::setTimeToLive(int timeToLive)
+{
+    m_timeToLive = timeToLive;
+}
+
+void ModbusFingerprintCache::clear()
+{
+    m_entries.clear();
+}
+
+ModbusFingerprintCache::State ModbusFingerprintCache::portState(const QHostAddress &address, quint16 port) const
+{
+    return entryState(QString("%1:%2/port").arg(address.toString()).arg(port));
+}
+
+void ModbusFingerprintCache::setPortState(const QHostAddress &address, quint16 port, bool open)
+{
+    insertEntry(QString("%1:%2/port").arg(address.toString()).arg(port), open);
+}
+
+ModbusFingerprintCache::State ModbusFingerprintCache::registerRangeState(const QHostAddress &address, quint16 port, quint16 slaveId, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, quint16 size, QVector<quint16> *values) const
+{
+    QVector<quint16> cachedValues;
+    State state = entryState(unitKey(address, port, slaveId) + QString("/registers/%1/%2/%3").arg(registerType).arg(registerAddress).arg(size), &cachedValues);
+    if (state == StateAvailable && values)
+        *values = cachedValues;
+
+    return state;
+}
+
+void ModbusFingerprintCache::setRegisterRange(const QHostAddress &address, quint16 port, quint16 slaveId, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, const QVector<quint16> &values)
+{
+    insertEntry(unitKey(address, port, slaveId) + QString("/registers/%1/%2/%3").arg(registerType).arg(registerAddress).arg(values.count()), true, values);
+}
+
+void ModbusFingerprintCache::setRegisterRangeUnavailable(const QHostAddress &address, quint16 port, quint16 slaveId, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, quint16 size)
+{
+    insertEntry(unitKey(address, port, slaveId) + QString("/registers/%1/%2/%3").arg(registerType).arg(registerAddress).arg(size), false);
+}
+
+ModbusFingerprintCache::State ModbusFingerprintCache::signatureState(const QHostAddress &address, quint16 port, quint16 slaveId, const QString &signature) const
+{
+    return entryState(unitKey(address, port, slaveId) + "/signature/" + signature);
+}
+
+void ModbusFingerprintCache::setSignatureState(const QHostAddress &address, quint16 port, quint16 slaveId, const QString &signature, bool matches)
+{
+    insertEntry(unitKey(address, port, slaveId) + "/signature/" + signature, matches);
+}
+
+ModbusFingerprintCache::State ModbusFingerprintCache::sunSpecState(const QHostAddress &address, quint16 port, quint16 slaveId) const
+{
+    return entryState(unitKey(address, port, slaveId) + "/sunspec");
+}
+
+void ModbusFingerprintCache::setSunSpecState(const QHostAddress &address, quint16 port, quint16 slaveId, bool present)
+{
+    insertEntry(unitKey(address, port, slaveId) + "/sunspec", present);
+}
+
+void ModbusFingerprintCache::insertEntry(const QString &key, bool available, const QVector<quint16> &values)
+{
+    removeExpiredEntries();
+
+    Entry entry;
+    entry.timestamp = QDateTime::currentMSecsSinceEpoch();
+    entry.available = available;
+    entry.values = values;
+    m_entries.insert(key, entry);
+    qCDebug(dcModbusFingerprintCache()) << "Cached" << key << (available ? "available" : "unavailable") << values;
+}
+
+ModbusFingerprintCache::State ModbusFingerprintCache::entryState(const QString &key, QVector<quint16> *values) const
+{
+    if (!m_entries.contains(key))
+        return StateUnknown;
+
+    const Entry entry = m_entries.value(key);
+    if (QDateTime::currentMSecsSinceEpoch() - entry.timestamp > m_timeToLive * 1000)
+        return StateUnknown;
+
+    if (values)
+        *values = entry.values;
+
+    return entry.available ? StateAvailable : StateUnavailable;
+}
+
+void ModbusFingerprintCache::removeExpiredEntries()
+{
+    // Expired entries are ignored on lookup anyways, no need to iterate on each insert
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (now - m_lastCleanupTimestamp < 60000)
+        return;
+
+    m_lastCleanupTimestamp = now;
+    QMutableHashIterator<QString, Entry> iterator(m_entries);
+    while (iterator.hasNext()) {
+        iterator.next();
+        if (now - iterator.value().timestamp > m_timeToLive * 1000) {
+            iterator.remove();
+        }
+    }
+}
+
+QString ModbusFingerprintCache::unitKey(const QHostAddress &address, quint16 port, quint16 slaveId)
+{
+    return QString("%1:%2:%3").arg(address.toString()).arg(port).arg(slaveId);
+}
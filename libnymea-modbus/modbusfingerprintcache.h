@@ -0,0 +1,100 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSFINGERPRINTCACHE_H
+#define MODBUSFINGERPRINTCACHE_H
+
+#include <QHash>
+#include <QVector>
+#include <QHostAddress>
+#include <QModbusDataUnit>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(dcModbusFingerprintCache)
+
+// Process wide cache of what has been learned about modbus TCP hosts during discoveries.
+// All plugins share this library, so a discovery of one plugin can skip hosts, ports and
+// register probes another plugin has already done recently. Entries expire after timeToLive().
+
+class ModbusFingerprintCache
+{
+public:
+    enum State {
+        StateUnknown,
+        StateAvailable,
+        StateUnavailable
+    };
+
+    static ModbusFingerprintCache *instance();
+
+    // Time to live in seconds for all entries
+    int timeToLive() const;
+    void setTimeToLive(int timeToLive);
+
+    void clear();
+
+    // Open modbus TCP port on a host
+    State portState(const QHostAddress &address, quint16 port) const;
+    void setPortState(const QHostAddress &address, quint16 port, bool open);
+
+    // Register ranges which have been read (available with values) or returned an exception (unavailable)
+    State registerRangeState(const QHostAddress &address, quint16 port, quint16 slaveId, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, quint16 size, QVector<quint16> *values = nullptr) const;
+    void setRegisterRange(const QHostAddress &address, quint16 port, quint16 slaveId, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, const QVector<quint16> &values);
+    void setRegisterRangeUnavailable(const QHostAddress &address, quint16 port, quint16 slaveId, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, quint16 size);
+
+    // Named vendor signatures, i.e. "kostal" matched or not on this unit
+    State signatureState(const QHostAddress &address, quint16 port, quint16 slaveId, const QString &signature) const;
+    void setSignatureState(const QHostAddress &address, quint16 port, quint16 slaveId, const QString &signature, bool matches);
+
+    // SunSpec "SunS" marker presence on this unit
+    State sunSpecState(const QHostAddress &address, quint16 port, quint16 slaveId) const;
+    void setSunSpecState(const QHostAddress &address, quint16 port, quint16 slaveId, bool present);
+
+private:
+    ModbusFingerprintCache() = default;
+
+    typedef struct Entry {
+        qint64 timestamp = 0;
+        bool available = false;
+        QVector<quint16> values;
+    } Entry;
+
+    int m_timeToLive = 300;
+    qint64 m_lastCleanupTimestamp = 0;
+    QHash<QString, Entry> m_entries;
+
+    void insertEntry(const QString &key, bool available, const QVector<quint16> &values = QVector<quint16>());
+    State entryState(const QString &key, QVector<quint16> *values = nullptr) const;
+    void removeExpiredEntries();
+
+    static QString unitKey(const QHostAddress &address, quint16 port, quint16 slaveId);
+};
+
+#endif // MODBUSFINGERPRINTCACHE_H
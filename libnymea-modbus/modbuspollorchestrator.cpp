@@ -0,0 +1,264 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#include "modbuspollorchestrator.h"
+
+#include <QTimer>
+#include <QDateTime>
+#include <QRandomGenerator>
+
+Q_LOGGING_CATEGORY(dcModbusPollOrchestrator, "ModbusPollOrchestrator")
+
+ModbusPollOrchestrator *ModbusPollOrchestrator::instance()
+{
+    static ModbusPollOrchestrator orchestrator;
+    return &orchestrator;
+}
+
+ModbusPollOrchestrator::ModbusPollOrchestrator(QObject *parent) :
+    QObject(parent)
+{
+
+}
+
+int ModbusPollOrchestrator::maxConcurrentCycles() const
+{
+    return m_maxConcurrentCycles;
+}
+
+void ModbusPollOrchestrator::setMaxConcurrentCycles(int maxConcurrentCycles)
+{
+    m_maxConcurrentCycles = qMax(maxConcurrentCycles, 1);
+    foreach (const QString &endpoint, m_waitingConnections.keys()) {
+        startWaitingCycles(endpoint);
+    }
+}
+
+void ModbusPollOrchestrator::addConnection(QObject *group, QObject *connection, const QString &endpoint, UpdateFunction updateFunction)
+{
+    if (m_entries.contains(connection))
+        removeConnection(connection);
+
+    Entry entry;
+    entry.group = group;
+    entry.endpoint = endpoint;
+    entry.updateFunction = updateFunction;
+    m_entries.insert(connection, entry);
+    m_connections.append(connection);
+
+    connect(connection, &QObject::destroyed, this, [this, connection](){ removeConnection(connection); });
+    qCDebug(dcModbusPollOrchestrator()) << "Added connection" << connection << "for endpoint" << endpoint;
+}
+
+void ModbusPollOrchestrator::removeConnection(QObject *connection)
+{
+    if (!m_entries.contains(connection))
+        return;
+
+    // Release the endpoint before forgetting about the connection
+    stopCycle(connection);
+
+    Entry entry = m_entries.take(connection);
+    m_connections.removeAll(connection);
+    if (m_waitingConnections.contains(entry.endpoint)) {
+        m_waitingConnections[entry.endpoint].removeAll(connection);
+        if (m_waitingConnections.value(entry.endpoint).isEmpty()) {
+            m_waitingConnections.remove(entry.endpoint);
+        }
+    }
+
+    disconnect(connection, nullptr, this, nullptr);
+    qCDebug(dcModbusPollOrchestrator()) << "Removed connection" << connection << "for endpoint" << entry.endpoint
+                                        << "| Cycles:" << entry.statistics.cycles << "Skipped:" << entry.statistics.skippedCycles
+                                        << "Overruns:" << entry.statistics.overruns << "Timeouts:" << entry.statistics.timeouts
+                                        << "Max cycle time:" << entry.statistics.maxCycleTime << "ms";
+}
+
+void ModbusPollOrchestrator::poll(QObject *group, int interval)
+{
+    QList<QObject *> connections;
+    foreach (QObject *connection, m_connections) {
+        if (m_entries.value(connection).group == group) {
+            connections.append(connection);
+        }
+    }
+
+    if (connections.isEmpty())
+        return;
+
+    // Give each connection its own slot within the interval and add some jitter within
+    // the first quarter of it, so cycles of different groups don't line up over time
+    int slot = interval / connections.count();
+    for (int i = 0; i < connections.count(); i++) {
+        QObject *connection = connections.at(i);
+        Entry &entry = m_entries[connection];
+        entry.interval = interval * entry.pollDivider;
+        if (entry.polls++ % entry.pollDivider != 0)
+            continue;
+
+        if (entry.scheduled) {
+            entry.statistics.skippedCycles++;
+            continue;
+        }
+
+        int offset = i * slot;
+        if (slot >= 4)
+            offset += QRandomGenerator::global()->bounded(slot / 4);
+
+        entry.scheduled = true;
+        QTimer::singleShot(offset, this, [this, connection](){ startCycle(connection); });
+    }
+}
+
+int ModbusPollOrchestrator::pollDivider(QObject *connection) const
+{
+    return m_entries.value(connection).pollDivider;
+}
+
+void ModbusPollOrchestrator::setPollDivider(QObject *connection, int pollDivider)
+{
+    if (!m_entries.contains(connection))
+        return;
+
+    Entry &entry = m_entries[connection];
+    entry.pollDivider = qMax(pollDivider, 1);
+    entry.polls = 0;
+}
+
+void ModbusPollOrchestrator::finishCycle(QObject *connection)
+{
+    if (!m_entries.contains(connection) || !m_entries.value(connection).running)
+        return;
+
+    Entry &entry = m_entries[connection];
+    qint64 cycleTime = QDateTime::currentMSecsSinceEpoch() - entry.cycleStartTimestamp;
+    entry.statistics.cycles++;
+    entry.statistics.lastCycleTime = cycleTime;
+    entry.statistics.maxCycleTime = qMax(entry.statistics.maxCycleTime, cycleTime);
+
+    int interval = entry.interval;
+    if (interval > 0 && cycleTime > interval) {
+        entry.statistics.overruns++;
+        qCDebug(dcModbusPollOrchestrator()) << "Update cycle of" << connection << "took" << cycleTime << "ms which exceeds the poll interval of" << interval << "ms";
+        emit cycleOverrun(connection, cycleTime, interval);
+    }
+
+    stopCycle(connection);
+}
+
+ModbusPollOrchestrator::Statistics ModbusPollOrchestrator::statistics(QObject *connection) const
+{
+    return m_entries.value(connection).statistics;
+}
+
+void ModbusPollOrchestrator::startCycle(QObject *connection)
+{
+    if (!m_entries.contains(connection))
+        return;
+
+    Entry &entry = m_entries[connection];
+    entry.scheduled = false;
+
+    if (entry.running) {
+        // Some connections never finish a cycle if a request gets lost, don't block them forever
+        qint64 cycleTime = QDateTime::currentMSecsSinceEpoch() - entry.cycleStartTimestamp;
+        if (entry.interval > 0 && cycleTime > 3 * entry.interval) {
+            qCWarning(dcModbusPollOrchestrator()) << "Update cycle of" << connection << "did not finish within" << cycleTime << "ms. Starting a new one.";
+            entry.statistics.timeouts++;
+            stopCycle(connection);
+        } else {
+            qCDebug(dcModbusPollOrchestrator()) << "Skipping update cycle of" << connection << "because the previous one is still running since" << cycleTime << "ms";
+            entry.statistics.skippedCycles++;
+            return;
+        }
+    }
+
+    // startWaitingCycles() might have run the cycle already
+    if (m_entries.value(connection).running)
+        return;
+
+    QString endpoint = m_entries.value(connection).endpoint;
+    if (m_waitingConnections.value(endpoint).contains(connection)) {
+        m_entries[connection].statistics.skippedCycles++;
+        return;
+    }
+
+    if (m_runningCycles.value(endpoint) >= m_maxConcurrentCycles) {
+        qCDebug(dcModbusPollOrchestrator()) << "Endpoint" << endpoint << "is busy. Queuing update cycle of" << connection;
+        m_waitingConnections[endpoint].enqueue(connection);
+        return;
+    }
+
+    runCycle(connection);
+}
+
+void ModbusPollOrchestrator::runCycle(QObject *connection)
+{
+    Entry &entry = m_entries[connection];
+    entry.running = true;
+    entry.cycleStartTimestamp = QDateTime::currentMSecsSinceEpoch();
+    m_runningCycles[entry.endpoint]++;
+
+    // Copy the function, the entry might be gone once it returns
+    UpdateFunction updateFunction = entry.updateFunction;
+    if (!updateFunction()) {
+        stopCycle(connection);
+    }
+}
+
+void ModbusPollOrchestrator::stopCycle(QObject *connection)
+{
+    if (!m_entries.contains(connection) || !m_entries.value(connection).running)
+        return;
+
+    Entry &entry = m_entries[connection];
+    entry.running = false;
+
+    QString endpoint = entry.endpoint;
+    m_runningCycles[endpoint]--;
+    if (m_runningCycles.value(endpoint) <= 0)
+        m_runningCycles.remove(endpoint);
+
+    startWaitingCycles(endpoint);
+}
+
+void ModbusPollOrchestrator::startWaitingCycles(const QString &endpoint)
+{
+    while (m_waitingConnections.contains(endpoint) && m_runningCycles.value(endpoint) < m_maxConcurrentCycles) {
+        QObject *connection = m_waitingConnections[endpoint].dequeue();
+        if (m_waitingConnections.value(endpoint).isEmpty())
+            m_waitingConnections.remove(endpoint);
+
+        if (m_entries.contains(connection) && !m_entries.value(connection).running) {
+            runCycle(connection);
+        }
+    }
+}
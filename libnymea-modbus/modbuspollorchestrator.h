@@ -0,0 +1,128 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+
+#ifndef MODBUSPOLLORCHESTRATOR_H
+#define MODBUSPOLLORCHESTRATOR_H
+
+#include <QHash>
+#include <QQueue>
+#include <QObject>
+#include <QLoggingCategory>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(dcModbusPollOrchestrator)
+
+// Process wide scheduler for the update cycles of modbus connections.
+// Instead of calling update() on every connection at the same moment a plugin timer fires,
+// the plugin registers its connections once and calls poll() on each timer tick. The update
+// cycles will then be spread over the interval with a small random jitter, limited to
+// maxConcurrentCycles() per endpoint (host or serial port) across all plugins, and connections
+// still busy with the previous cycle get skipped. Connections get removed once destroyed.
+
+class ModbusPollOrchestrator : public QObject
+{
+    Q_OBJECT
+public:
+    typedef struct Statistics {
+        quint64 cycles = 0;
+        quint64 skippedCycles = 0;
+        quint64 overruns = 0;
+        quint64 timeouts = 0;
+        qint64 lastCycleTime = 0;
+        qint64 maxCycleTime = 0;
+    } Statistics;
+
+    // Starts an update cycle, returns false if no cycle has been started
+    typedef std::function<bool()> UpdateFunction;
+
+    static ModbusPollOrchestrator *instance();
+
+    // Update cycles running at the same time for one endpoint, default 1
+    int maxConcurrentCycles() const;
+    void setMaxConcurrentCycles(int maxConcurrentCycles);
+
+    // Connections generated by the modbus tool, the cycle finishes with updateFinished(). Unreachable connections
+    // will not be updated unless updateUnreachable is set, i.e. for RTU connections testing their reachability in update()
+    template <typename Connection>
+    void addConnection(QObject *group, Connection *connection, const QString &endpoint, bool updateUnreachable = false) {
+        addConnection(group, connection, endpoint, [connection, updateUnreachable](){ return (updateUnreachable || connection->reachable()) && connection->update(); });
+        connect(connection, &Connection::updateFinished, this, [this, connection](){ finishCycle(connection); });
+    }
+
+    // The cycle has to be finished by calling finishCycle()
+    void addConnection(QObject *group, QObject *connection, const QString &endpoint, UpdateFunction updateFunction);
+    void removeConnection(QObject *connection);
+
+    // Schedules one update cycle for each connection of the group within interval ms
+    void poll(QObject *group, int interval);
+
+    // Update the connection only on every divider-th poll, i.e. while it gets probed in between, default 1
+    int pollDivider(QObject *connection) const;
+    void setPollDivider(QObject *connection, int pollDivider);
+    void finishCycle(QObject *connection);
+
+    Statistics statistics(QObject *connection) const;
+
+signals:
+    // An update cycle took longer than the poll interval
+    void cycleOverrun(QObject *connection, qint64 cycleTime, int interval);
+
+private:
+    explicit ModbusPollOrchestrator(QObject *parent = nullptr);
+
+    typedef struct Entry {
+        QObject *group = nullptr;
+        QString endpoint;
+        UpdateFunction updateFunction = nullptr;
+        int interval = 0;
+        int pollDivider = 1;
+        uint polls = 0;
+        bool scheduled = false;
+        bool running = false;
+        qint64 cycleStartTimestamp = 0;
+        Statistics statistics;
+    } Entry;
+
+    int m_maxConcurrentCycles = 1;
+
+    QList<QObject *> m_connections;
+    QHash<QObject *, Entry> m_entries;
+    QHash<QString, int> m_runningCycles;
+    QHash<QString, QQueue<QObject *>> m_waitingConnections;
+
+    void startCycle(QObject *connection);
+    void runCycle(QObject *connection);
+    void stopCycle(QObject *connection);
+    void startWaitingCycles(const QString &endpoint);
+};
+
+#endif // MODBUSPOLLORCHESTRATOR_H
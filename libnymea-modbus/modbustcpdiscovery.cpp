@@ -0,0 +1,405 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "modbustcpdiscovery.h"
+
+#include <QDataStream>
+
+Q_LOGGING_CATEGORY(dcModbusTcpDiscovery, "ModbusTcpDiscovery")
+
+ModbusTcpDiscovery::ModbusTcpDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, quint16 port, quint16 slaveId, QObject *parent) :
+    QObject(parent),
+    m_networkDeviceDiscovery(networkDeviceDiscovery),
+    m_port(port),
+    m_slaveId(slaveId)
+{
+
+}
+
+ModbusTcpDiscovery::~ModbusTcpDiscovery()
+{
+    stopDiscovery();
+}
+
+quint16 ModbusTcpDiscovery::port() const
+{
+    return m_port;
+}
+
+quint16 ModbusTcpDiscovery::slaveId() const
+{
+    return m_slaveId;
+}
+
+void ModbusTcpDiscovery::setSignatureRegisters(QModbusDataUnit::RegisterType registerType, quint16 address, quint16 size, SignatureVerifier verifier)
+{
+    m_signatureRegisterType = registerType;
+    m_signatureAddress = address;
+    m_signatureSize = size;
+    m_signatureVerifier = verifier;
+}
+
+QString ModbusTcpDiscovery::signatureName() const
+{
+    return m_signatureName;
+}
+
+void ModbusTcpDiscovery::setSignatureName(const QString &signatureName)
+{
+    m_signatureName = signatureName;
+}
+
+int ModbusTcpDiscovery::maxConcurrentProbes() const
+{
+    return m_maxConcurrentProbes;
+}
+
+void ModbusTcpDiscovery::setMaxConcurrentProbes(int maxConcurrentProbes)
+{
+    m_maxConcurrentProbes = qMax(1, maxConcurrentProbes);
+}
+
+int ModbusTcpDiscovery::probeTimeout() const
+{
+    return m_probeTimeout;
+}
+
+void ModbusTcpDiscovery::setProbeTimeout(int probeTimeout)
+{
+    m_probeTimeout = probeTimeout;
+}
+
+bool ModbusTcpDiscovery::running() const
+{
+    return m_running;
+}
+
+void ModbusTcpDiscovery::startDiscovery()
+{
+    if (m_running) {
+        qCWarning(dcModbusTcpDiscovery()) << "Discovery already running. Ignoring request.";
+        return;
+    }
+
+    m_running = true;
+    m_networkDiscoveryFinished = false;
+    m_startDateTime = QDateTime::currentDateTime();
+    m_visitedAddresses.clear();
+    m_results.clear();
+
+    qCDebug(dcModbusTcpDiscovery()) << "Start probing network devices on port" << m_port << "slave ID" << m_slaveId << "using up to" << m_maxConcurrentProbes << "concurrent probes";
+    m_discoveryReply = m_networkDeviceDiscovery->discover();
+
+    // Probe each host as soon as it appears, the network discovery takes much longer than the probes
+    connect(m_discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &ModbusTcpDiscovery::enqueueNetworkDevice);
+    connect(m_discoveryReply, &NetworkDeviceDiscoveryReply::finished, m_discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
+    connect(m_discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [this](){
+        qCDebug(dcModbusTcpDiscovery()) << "Network discovery finished. Found" << m_discoveryReply->networkDeviceInfos().count() << "network devices";
+        foreach (const NetworkDeviceInfo &networkDeviceInfo, m_discoveryReply->networkDeviceInfos())
+            enqueueNetworkDevice(networkDeviceInfo);
+
+        m_discoveryReply = nullptr;
+        m_networkDiscoveryFinished = true;
+
+        // No grace period required, we are done as soon as the last probe has finished
+        evaluateFinished();
+    });
+}
+
+void ModbusTcpDiscovery::stopDiscovery()
+{
+    if (m_discoveryReply) {
+        disconnect(m_discoveryReply, nullptr, this, nullptr);
+        m_discoveryReply = nullptr;
+    }
+
+    m_pendingProbes.clear();
+    foreach (QTcpSocket *socket, m_runningProbes.keys()) {
+        Probe probe = m_runningProbes.take(socket);
+        probe.timeoutTimer->stop();
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+
+    m_running = false;
+}
+
+QList<ModbusTcpDiscovery::Result> ModbusTcpDiscovery::results() const
+{
+    return m_results;
+}
+
+void ModbusTcpDiscovery::enqueueNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo)
+{
+    if (m_visitedAddresses.contains(networkDeviceInfo.address()))
+        return;
+
+    m_visitedAddresses.insert(networkDeviceInfo.address());
+    if (evaluateCachedFingerprint(networkDeviceInfo))
+        return;
+
+    m_pendingProbes.enqueue(networkDeviceInfo);
+    startNextProbes();
+}
+
+bool ModbusTcpDiscovery::evaluateCachedFingerprint(const NetworkDeviceInfo &networkDeviceInfo)
+{
+    ModbusFingerprintCache *cache = ModbusFingerprintCache::instance();
+    const QHostAddress address = networkDeviceInfo.address();
+
+    ModbusFingerprintCache::State portState = cache->portState(address, m_port);
+    if (portState == ModbusFingerprintCache::StateUnavailable) {
+        qCDebug(dcModbusTcpDiscovery()) << "Skipping" << address.toString() << "port" << m_port << "known to be closed";
+        return true;
+    }
+
+    if (m_signatureRegisterType == QModbusDataUnit::Invalid) {
+        if (portState != ModbusFingerprintCache::StateAvailable)
+            return false;
+
+        addResult(networkDeviceInfo, QVector<quint16>());
+        return true;
+    }
+
+    if (!m_signatureName.isEmpty() && cache->signatureState(address, m_port, m_slaveId, m_signatureName) == ModbusFingerprintCache::StateUnavailable) {
+        qCDebug(dcModbusTcpDiscovery()) << "Skipping" << address.toString() << "known not to match signature" << m_signatureName;
+        return true;
+    }
+
+    QVector<quint16> values;
+    switch (cache->registerRangeState(address, m_port, m_slaveId, m_signatureRegisterType, m_signatureAddress, m_signatureSize, &values)) {
+    case ModbusFingerprintCache::StateUnavailable:
+        qCDebug(dcModbusTcpDiscovery()) << "Skipping" << address.toString() << "signature registers known to be unavailable";
+        return true;
+    case ModbusFingerprintCache::StateAvailable:
+        qCDebug(dcModbusTcpDiscovery()) << "Using cached signature registers of" << address.toString();
+        if (!m_signatureVerifier || m_signatureVerifier(values))
+            addResult(networkDeviceInfo, values);
+
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ModbusTcpDiscovery::startNextProbes()
+{
+    while (!m_pendingProbes.isEmpty() && m_runningProbes.count() < m_maxConcurrentProbes) {
+        startProbe(m_pendingProbes.dequeue());
+    }
+}
+
+void ModbusTcpDiscovery::startProbe(const NetworkDeviceInfo &networkDeviceInfo)
+{
+    QTcpSocket *socket = new QTcpSocket(this);
+
+    Probe probe;
+    probe.networkDeviceInfo = networkDeviceInfo;
+    probe.timeoutTimer = new QTimer(socket);
+    probe.timeoutTimer->setSingleShot(true);
+    probe.timeoutTimer->setInterval(m_probeTimeout);
+    m_runningProbes.insert(socket, probe);
+
+    connect(probe.timeoutTimer, &QTimer::timeout, this, [this, socket, networkDeviceInfo](){
+        qCDebug(dcModbusTcpDiscovery()) << "Probe timed out on" << networkDeviceInfo.address().toString();
+        finishProbe(socket, false);
+    });
+
+    connect(socket, &QTcpSocket::connected, this, [this, socket](){
+        m_runningProbes[socket].connected = true;
+        ModbusFingerprintCache::instance()->setPortState(m_runningProbes.value(socket).networkDeviceInfo.address(), m_port, true);
+        if (m_signatureRegisterType == QModbusDataUnit::Invalid) {
+            finishProbe(socket, true);
+            return;
+        }
+
+        sendSignatureRequest(socket);
+    });
+
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket](){
+        processSignatureResponse(socket);
+    });
+
+    connect(socket, &QAbstractSocket::errorOccurred, this, [this, socket](QAbstractSocket::SocketError error){
+        if (error == QAbstractSocket::ConnectionRefusedError && m_runningProbes.contains(socket))
+            m_runningProbes[socket].refused = true;
+
+        finishProbe(socket, false);
+    });
+
+    probe.timeoutTimer->start();
+    socket->connectToHost(networkDeviceInfo.address(), m_port);
+}
+
+void ModbusTcpDiscovery::sendSignatureRequest(QTcpSocket *socket)
+{
+    Probe &probe = m_runningProbes[socket];
+    probe.transactionId = ++m_transactionId;
+
+    // MBAP header and a read request PDU, all fields big endian
+    QByteArray request;
+    QDataStream stream(&request, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream << probe.transactionId;
+    stream << static_cast<quint16>(0); // Protocol ID
+    stream << static_cast<quint16>(6); // Remaining length
+    stream << static_cast<quint8>(m_slaveId);
+    stream << signatureFunctionCode();
+    stream << m_signatureAddress;
+    stream << m_signatureSize;
+
+    probe.timeoutTimer->start();
+    socket->write(request);
+}
+
+void ModbusTcpDiscovery::processSignatureResponse(QTcpSocket *socket)
+{
+    if (!m_runningProbes.contains(socket))
+        return;
+
+    Probe &probe = m_runningProbes[socket];
+    probe.buffer.append(socket->readAll());
+
+    // Wait until the MBAP header and the announced PDU length are complete
+    if (probe.buffer.size() < 9)
+        return;
+
+    const quint8 *data = reinterpret_cast<const quint8 *>(probe.buffer.constData());
+    quint16 transactionId = (data[0] << 8) | data[1];
+    quint16 length = (data[4] << 8) | data[5];
+    if (probe.buffer.size() < 6 + length)
+        return;
+
+    if (transactionId != probe.transactionId || length < 3) {
+        qCDebug(dcModbusTcpDiscovery()) << "Invalid response from" << probe.networkDeviceInfo.address().toString();
+        finishProbe(socket, false);
+        return;
+    }
+
+    quint8 functionCode = data[7];
+    if (functionCode & 0x80) {
+        qCDebug(dcModbusTcpDiscovery()) << "Signature probe on" << probe.networkDeviceInfo.address().toString() << "returned exception" << data[8];
+        ModbusFingerprintCache::instance()->setRegisterRangeUnavailable(probe.networkDeviceInfo.address(), m_port, m_slaveId, m_signatureRegisterType, m_signatureAddress, m_signatureSize);
+        finishProbe(socket, false);
+        return;
+    }
+
+    quint8 byteCount = data[8];
+    if (length < 3 + byteCount) {
+        finishProbe(socket, false);
+        return;
+    }
+
+    QVector<quint16> values;
+    if (m_signatureRegisterType == QModbusDataUnit::Coils || m_signatureRegisterType == QModbusDataUnit::DiscreteInputs) {
+        for (int i = 0; i < m_signatureSize && i / 8 < byteCount; i++) {
+            values.append((data[9 + i / 8] >> (i % 8)) & 0x01);
+        }
+    } else {
+        for (int i = 0; i + 1 < byteCount; i += 2) {
+            values.append((data[9 + i] << 8) | data[10 + i]);
+        }
+    }
+
+    if (values.count() != m_signatureSize) {
+        qCDebug(dcModbusTcpDiscovery()) << "Signature probe on" << probe.networkDeviceInfo.address().toString() << "returned" << values.count() << "instead of" << m_signatureSize << "values";
+        finishProbe(socket, false);
+        return;
+    }
+
+    ModbusFingerprintCache::instance()->setRegisterRange(probe.networkDeviceInfo.address(), m_port, m_slaveId, m_signatureRegisterType, m_signatureAddress, values);
+
+    bool found = !m_signatureVerifier || m_signatureVerifier(values);
+    if (!m_signatureName.isEmpty())
+        ModbusFingerprintCache::instance()->setSignatureState(probe.networkDeviceInfo.address(), m_port, m_slaveId, m_signatureName, found);
+
+    finishProbe(socket, found, values);
+}
+
+void ModbusTcpDiscovery::finishProbe(QTcpSocket *socket, bool found, const QVector<quint16> &signatureValues)
+{
+    if (!m_runningProbes.contains(socket))
+        return;
+
+    Probe probe = m_runningProbes.take(socket);
+    probe.timeoutTimer->stop();
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+
+    // Only a refused connection is a definitive answer, a timeout might just be a busy host
+    if (!probe.connected && probe.refused)
+        ModbusFingerprintCache::instance()->setPortState(probe.networkDeviceInfo.address(), m_port, false);
+
+    if (found)
+        addResult(probe.networkDeviceInfo, signatureValues);
+
+    startNextProbes();
+    evaluateFinished();
+}
+
+void ModbusTcpDiscovery::addResult(const NetworkDeviceInfo &networkDeviceInfo, const QVector<quint16> &signatureValues)
+{
+    Result result;
+    result.networkDeviceInfo = networkDeviceInfo;
+    result.port = m_port;
+    result.slaveId = m_slaveId;
+    result.signatureValues = signatureValues;
+    m_results.append(result);
+
+    qCDebug(dcModbusTcpDiscovery()) << "--> Found matching modbus device on" << networkDeviceInfo.address().toString() << m_port;
+    emit deviceFound(result);
+}
+
+void ModbusTcpDiscovery::evaluateFinished()
+{
+    if (!m_running || !m_networkDiscoveryFinished || !m_pendingProbes.isEmpty() || !m_runningProbes.isEmpty())
+        return;
+
+    m_running = false;
+    qint64 durationMilliSeconds = QDateTime::currentMSecsSinceEpoch() - m_startDateTime.toMSecsSinceEpoch();
+    qCDebug(dcModbusTcpDiscovery()) << "Probed" << m_visitedAddresses.count() << "hosts on port" << m_port << "and found" << m_results.count() << "matching devices in" << QTime::fromMSecsSinceStartOfDay(durationMilliSeconds).toString("mm:ss.zzz");
+    emit discoveryFinished();
+}
+
+quint8 ModbusTcpDiscovery::signatureFunctionCode() const
+{
+    switch (m_signatureRegisterType) {
+    case QModbusDataUnit::Coils:
+        return 0x01;
+    case QModbusDataUnit::DiscreteInputs:
+        return 0x02;
+    case QModbusDataUnit::InputRegisters:
+        return 0x04;
+    default:
+        return 0x03;
+    }
+}
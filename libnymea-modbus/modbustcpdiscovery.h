@@ -0,0 +1,151 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSTCPDISCOVERY_H
+#define MODBUSTCPDISCOVERY_H
+
+#include <QSet>
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
+#include <QObject>
+#include <QDateTime>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QModbusDataUnit>
+#include <QLoggingCategory>
+
+#include <functional>
+
+#include <network/networkdevicediscovery.h>
+
+#include "modbusfingerprintcache.h"
+
+Q_DECLARE_LOGGING_CATEGORY(dcModbusTcpDiscovery)
+
+// Scans the network for modbus TCP devices without creating a full connection for each host.
+// Each host gets a plain TCP connect probe on the modbus port first, and only if that succeeds
+// the signature registers will be read using the same socket. Only hosts where the signature
+// matches will be reported, so the caller has to create connections only for real candidates.
+// Everything learned will be stored in the ModbusFingerprintCache and reused by other discoveries.
+
+class ModbusTcpDiscovery : public QObject
+{
+    Q_OBJECT
+public:
+    typedef struct Result {
+        NetworkDeviceInfo networkDeviceInfo;
+        quint16 port = 502;
+        quint16 slaveId = 1;
+        QVector<quint16> signatureValues;
+    } Result;
+
+    // Returns true if the signature register values belong to the device we are looking for
+    typedef std::function<bool(const QVector<quint16> &values)> SignatureVerifier;
+
+    explicit ModbusTcpDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, quint16 port = 502, quint16 slaveId = 1, QObject *parent = nullptr);
+    ~ModbusTcpDiscovery();
+
+    quint16 port() const;
+    quint16 slaveId() const;
+
+    // If no signature registers are set, every host accepting the TCP connection will be reported
+    void setSignatureRegisters(QModbusDataUnit::RegisterType registerType, quint16 address, quint16 size, SignatureVerifier verifier = nullptr);
+
+    // Optional name for caching the verifier result, i.e. "kostal"
+    QString signatureName() const;
+    void setSignatureName(const QString &signatureName);
+
+    int maxConcurrentProbes() const;
+    void setMaxConcurrentProbes(int maxConcurrentProbes);
+
+    // Timeout in ms for the connect and for the signature probe each
+    int probeTimeout() const;
+    void setProbeTimeout(int probeTimeout);
+
+    bool running() const;
+
+    void startDiscovery();
+    void stopDiscovery();
+
+    QList<Result> results() const;
+
+signals:
+    void deviceFound(const ModbusTcpDiscovery::Result &result);
+    void discoveryFinished();
+
+private:
+    typedef struct Probe {
+        NetworkDeviceInfo networkDeviceInfo;
+        QTimer *timeoutTimer = nullptr;
+        QByteArray buffer;
+        quint16 transactionId = 0;
+        bool connected = false;
+        bool refused = false;
+    } Probe;
+
+    NetworkDeviceDiscovery *m_networkDeviceDiscovery = nullptr;
+    NetworkDeviceDiscoveryReply *m_discoveryReply = nullptr;
+    quint16 m_port = 502;
+    quint16 m_slaveId = 1;
+
+    QModbusDataUnit::RegisterType m_signatureRegisterType = QModbusDataUnit::Invalid;
+    quint16 m_signatureAddress = 0;
+    quint16 m_signatureSize = 0;
+    SignatureVerifier m_signatureVerifier = nullptr;
+    QString m_signatureName;
+
+    int m_maxConcurrentProbes = 32;
+    int m_probeTimeout = 1500;
+    quint16 m_transactionId = 0;
+
+    bool m_running = false;
+    bool m_networkDiscoveryFinished = false;
+    QDateTime m_startDateTime;
+
+    QSet<QHostAddress> m_visitedAddresses;
+    QQueue<NetworkDeviceInfo> m_pendingProbes;
+    QHash<QTcpSocket *, Probe> m_runningProbes;
+    QList<Result> m_results;
+
+    void enqueueNetworkDevice(const NetworkDeviceInfo &networkDeviceInfo);
+    bool evaluateCachedFingerprint(const NetworkDeviceInfo &networkDeviceInfo);
+    void startNextProbes();
+    void startProbe(const NetworkDeviceInfo &networkDeviceInfo);
+    void sendSignatureRequest(QTcpSocket *socket);
+    void processSignatureResponse(QTcpSocket *socket);
+    void finishProbe(QTcpSocket *socket, bool found, const QVector<quint16> &signatureValues = QVector<quint16>());
+    void addResult(const NetworkDeviceInfo &networkDeviceInfo, const QVector<quint16> &signatureValues);
+    void evaluateFinished();
+
+    quint8 signatureFunctionCode() const;
+};
+
+#endif // MODBUSTCPDISCOVERY_H
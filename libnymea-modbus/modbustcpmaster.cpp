@@ -184,6 +184,9 @@ QUuid ModbusTcpMaster::readCoil(uint slaveAddress, uint registerAddress, uint si
 
             connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
                 qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << error;
+                if (error == QModbusDevice::ProtocolError && reply->rawResult().isException())
+                    emit readRequestException(requestId, reply->rawResult().exceptionCode());
+
                 emit readRequestError(requestId, reply->errorString());
             });
 
@@ -280,6 +283,9 @@ QUuid ModbusTcpMaster::readDiscreteInput(uint slaveAddress, uint registerAddress
 
             connect(reply, &QModbusReply::errorOccurred, this, [requestId, reply, this] (QModbusDevice::Error error){
                 qCWarning(dcModbusTcpMaster()) << "Modbus replay error for device" << connectionUrl() << ":" << error;
+                if (error == QModbusDevice::ProtocolError && reply->rawResult().isException())
+                    emit readRequestException(requestId, reply->rawResult().exceptionCode());
+
                 emit readRequestError(requestId, reply->errorString());
             });
 
@@ -322,6 +328,9 @@ QUuid ModbusTcpMaster::readInputRegister(uint slaveAddress, uint registerAddress
 
             connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
                 qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << error;
+                if (error == QModbusDevice::ProtocolError && reply->rawResult().isException())
+                    emit readRequestException(requestId, reply->rawResult().exceptionCode());
+
                 emit readRequestError(requestId, reply->errorString());
             });
 
@@ -365,6 +374,9 @@ QUuid ModbusTcpMaster::readHoldingRegister(uint slaveAddress, uint registerAddre
             connect(reply, &QModbusReply::errorOccurred, this, [reply, requestId, this] (QModbusDevice::Error error){
 
                 qCWarning(dcModbusTcpMaster()) << "Modbus reply error for device" << connectionUrl() << ":" << error;
+                if (error == QModbusDevice::ProtocolError && reply->rawResult().isException())
+                    emit readRequestException(requestId, reply->rawResult().exceptionCode());
+
                 emit readRequestError(requestId, reply->errorString());
             });
 
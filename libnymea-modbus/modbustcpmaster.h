@@ -113,6 +113,8 @@ signals:
 
     void readRequestExecuted(const QUuid &requestId, bool success);
     void readRequestError(const QUuid &requestId, const QString &error);
+    // Emitted right before readRequestError() if the server responded with an exception
+    void readRequestException(const QUuid &requestId, QModbusPdu::ExceptionCode exceptionCode);
 
     void receivedCoil(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values);
     void receivedDiscreteInput(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values);
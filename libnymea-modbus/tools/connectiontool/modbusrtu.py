@@ -332,7 +332,7 @@ def writeInitMethodImplementationRtu(fileDescriptor, className, registerDefiniti
     # First check if there are any init registers
     initRequired = False
     for registerDefinition in registerDefinitions:
-        if registerDefinition['readSchedule'] == 'init':
+        if 'readSchedule' in registerDefinition and registerDefinition['readSchedule'] == 'init':
             initRequired = True
             break
 
@@ -473,6 +473,20 @@ def writeInitMethodImplementationRtu(fileDescriptor, className, registerDefiniti
     writeLine(fileDescriptor)
 
 
+def beginUpdateDivider(fileDescriptor, definition):
+    updateDivider = getUpdateDivider(definition)
+    if updateDivider <= 1:
+        return fileDescriptor
+
+    writeLine(fileDescriptor, '    if (updateCycle %% %s == 0) {' % updateDivider)
+    return IndentedWriter(fileDescriptor)
+
+
+def endUpdateDivider(fileDescriptor, definition):
+    if getUpdateDivider(definition) > 1:
+        writeLine(fileDescriptor, '    }')
+
+
 def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDefinitions):
     writeLine(fileDescriptor, 'bool %s::update()' % (className))
     writeLine(fileDescriptor, '{')
@@ -480,7 +494,7 @@ def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDe
     # First check if there are any init registers
     updateRequired = False
     for registerDefinition in registerDefinitions:
-        if registerDefinition['readSchedule'] == 'update':
+        if 'readSchedule' in registerDefinition and registerDefinition['readSchedule'] == 'update':
             updateRequired = True
             break
 
@@ -511,6 +525,12 @@ def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDe
 
         writeLine(fileDescriptor, '    ModbusRtuReply *reply = nullptr;')
 
+        dividerUsed = updateDividerUsed(registerDefinitions, blockDefinitions)
+        if dividerUsed:
+            writeLine(fileDescriptor)
+            writeLine(fileDescriptor, '    // Registers with an update divider will be read only on every n-th update')
+            writeLine(fileDescriptor, '    quint32 updateCycle = m_updateCycle++;')
+
         # Read individual registers
         for registerDefinition in registerDefinitions:
             propertyName = registerDefinition['id']
@@ -518,41 +538,43 @@ def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDe
 
             if 'readSchedule' in registerDefinition and registerDefinition['readSchedule'] == 'update':
                 writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    // Read %s' % registerDefinition['description'])
-                writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Read \\"%s\\" register:" << %s << "size:" << %s;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
-                writeLine(fileDescriptor, '    reply = read%s();' % (propertyName[0].upper() + propertyName[1:]))
-                writeLine(fileDescriptor, '    if (!reply) {')
-                writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading \\"%s\\" registers";' % (className, registerDefinition['description']))
-                writeLine(fileDescriptor, '        return false;')
-                writeLine(fileDescriptor, '    }')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    if (reply->isFinished()) {')
-                writeLine(fileDescriptor, '        return false; // Broadcast reply returns immediatly')
-                writeLine(fileDescriptor, '    }')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    m_pendingUpdateReplies.append(reply);')
-                writeLine(fileDescriptor, '    connect(reply, &ModbusRtuReply::finished, this, [this, reply](){')
-                writeLine(fileDescriptor, '        handleModbusError(reply->error());')
-                writeLine(fileDescriptor, '        m_pendingUpdateReplies.removeAll(reply);')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '        if (reply->error() != ModbusRtuReply::NoError) {')
-                writeLine(fileDescriptor, '            verifyUpdateFinished();')
-                writeLine(fileDescriptor, '            return;')
-                writeLine(fileDescriptor, '        }')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '        QVector<quint16> values = reply->result();')
-                writeLine(fileDescriptor, '        qCDebug(dc%s()) << "<-- Response from \\"%s\\" register" << %s << "size:" << %s << values;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
-                writeLine(fileDescriptor, '        if (values.size() == %s) {' % (registerDefinition['size']))
-                writeLine(fileDescriptor, '            process%sRegisterValues(values);' % (propertyName[0].upper() + propertyName[1:]))
-                writeLine(fileDescriptor, '        } else {')
-                writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Reading from \\"%s\\" registers" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << values;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
-                writeLine(fileDescriptor, '        }')
-                writeLine(fileDescriptor, '        verifyUpdateFinished();')
-                writeLine(fileDescriptor, '    });')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    connect(reply, &ModbusRtuReply::errorOccurred, this, [reply] (ModbusRtuReply::Error error){')
-                writeLine(fileDescriptor, '        qCWarning(dc%s()) << "ModbusRtu reply error occurred while updating \\"%s\\" registers" << error << reply->errorString();' % (className, registerDefinition['description']))
-                writeLine(fileDescriptor, '    });')
+                updateFile = beginUpdateDivider(fileDescriptor, registerDefinition)
+                writeLine(updateFile, '    // Read %s' % registerDefinition['description'])
+                writeLine(updateFile, '    qCDebug(dc%s()) << "--> Read \\"%s\\" register:" << %s << "size:" << %s;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
+                writeLine(updateFile, '    reply = read%s();' % (propertyName[0].upper() + propertyName[1:]))
+                writeLine(updateFile, '    if (!reply) {')
+                writeLine(updateFile, '        qCWarning(dc%s()) << "Error occurred while reading \\"%s\\" registers";' % (className, registerDefinition['description']))
+                writeLine(updateFile, '        return false;')
+                writeLine(updateFile, '    }')
+                writeLine(updateFile)
+                writeLine(updateFile, '    if (reply->isFinished()) {')
+                writeLine(updateFile, '        return false; // Broadcast reply returns immediatly')
+                writeLine(updateFile, '    }')
+                writeLine(updateFile)
+                writeLine(updateFile, '    m_pendingUpdateReplies.append(reply);')
+                writeLine(updateFile, '    connect(reply, &ModbusRtuReply::finished, this, [this, reply](){')
+                writeLine(updateFile, '        handleModbusError(reply->error());')
+                writeLine(updateFile, '        m_pendingUpdateReplies.removeAll(reply);')
+                writeLine(updateFile)
+                writeLine(updateFile, '        if (reply->error() != ModbusRtuReply::NoError) {')
+                writeLine(updateFile, '            verifyUpdateFinished();')
+                writeLine(updateFile, '            return;')
+                writeLine(updateFile, '        }')
+                writeLine(updateFile)
+                writeLine(updateFile, '        QVector<quint16> values = reply->result();')
+                writeLine(updateFile, '        qCDebug(dc%s()) << "<-- Response from \\"%s\\" register" << %s << "size:" << %s << values;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
+                writeLine(updateFile, '        if (values.size() == %s) {' % (registerDefinition['size']))
+                writeLine(updateFile, '            process%sRegisterValues(values);' % (propertyName[0].upper() + propertyName[1:]))
+                writeLine(updateFile, '        } else {')
+                writeLine(updateFile, '            qCWarning(dc%s()) << "Reading from \\"%s\\" registers" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << values;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
+                writeLine(updateFile, '        }')
+                writeLine(updateFile, '        verifyUpdateFinished();')
+                writeLine(updateFile, '    });')
+                writeLine(updateFile)
+                writeLine(updateFile, '    connect(reply, &ModbusRtuReply::errorOccurred, this, [reply] (ModbusRtuReply::Error error){')
+                writeLine(updateFile, '        qCWarning(dc%s()) << "ModbusRtu reply error occurred while updating \\"%s\\" registers" << error << reply->errorString();' % (className, registerDefinition['description']))
+                writeLine(updateFile, '    });')
+                endUpdateDivider(fileDescriptor, registerDefinition)
 
         # Read init blocks
         for blockDefinition in blockDefinitions:
@@ -574,51 +596,59 @@ def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDe
                     blockSize += blockRegister['size']
 
                 writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    // Read %s' % blockName)
-                writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Read block \\"%s\\" registers from:" << %s << "size:" << %s;' % (className, blockName, blockStartAddress, blockSize))
-                writeLine(fileDescriptor, '    reply = readBlock%s();' % (blockName[0].upper() + blockName[1:]))
-                writeLine(fileDescriptor, '    if (!reply) {')
-                writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading block \\"%s\\" registers";' % (className, blockName))
-                writeLine(fileDescriptor, '        return false;')
-                writeLine(fileDescriptor, '    }')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    if (reply->isFinished()) {')
-                writeLine(fileDescriptor, '        return false; // Broadcast reply returns immediatly')
-                writeLine(fileDescriptor, '    }')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    m_pendingUpdateReplies.append(reply);')
-                writeLine(fileDescriptor, '    connect(reply, &ModbusRtuReply::finished, this, [this, reply](){')
-                writeLine(fileDescriptor, '        handleModbusError(reply->error());')
-                writeLine(fileDescriptor, '        m_pendingUpdateReplies.removeAll(reply);')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '        if (reply->error() != ModbusRtuReply::NoError) {')
-                writeLine(fileDescriptor, '            verifyUpdateFinished();')
-                writeLine(fileDescriptor, '            return;')
-                writeLine(fileDescriptor, '        }')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '        QVector<quint16> blockValues = reply->result();')
-                writeLine(fileDescriptor, '        qCDebug(dc%s()) << "<-- Response from reading block \\"%s\\" register" << %s << "size:" << %s << blockValues;' % (className, blockName, blockStartAddress, blockSize))
-                writeLine(fileDescriptor, '        if (blockValues.size() == %s) {' % (blockSize))
+                updateFile = beginUpdateDivider(fileDescriptor, blockDefinition)
+                writeLine(updateFile, '    // Read %s' % blockName)
+                writeLine(updateFile, '    qCDebug(dc%s()) << "--> Read block \\"%s\\" registers from:" << %s << "size:" << %s;' % (className, blockName, blockStartAddress, blockSize))
+                writeLine(updateFile, '    reply = readBlock%s();' % (blockName[0].upper() + blockName[1:]))
+                writeLine(updateFile, '    if (!reply) {')
+                writeLine(updateFile, '        qCWarning(dc%s()) << "Error occurred while reading block \\"%s\\" registers";' % (className, blockName))
+                writeLine(updateFile, '        return false;')
+                writeLine(updateFile, '    }')
+                writeLine(updateFile)
+                writeLine(updateFile, '    if (reply->isFinished()) {')
+                writeLine(updateFile, '        return false; // Broadcast reply returns immediatly')
+                writeLine(updateFile, '    }')
+                writeLine(updateFile)
+                writeLine(updateFile, '    m_pendingUpdateReplies.append(reply);')
+                writeLine(updateFile, '    connect(reply, &ModbusRtuReply::finished, this, [this, reply](){')
+                writeLine(updateFile, '        handleModbusError(reply->error());')
+                writeLine(updateFile, '        m_pendingUpdateReplies.removeAll(reply);')
+                writeLine(updateFile)
+                writeLine(updateFile, '        if (reply->error() != ModbusRtuReply::NoError) {')
+                writeLine(updateFile, '            verifyUpdateFinished();')
+                writeLine(updateFile, '            return;')
+                writeLine(updateFile, '        }')
+                writeLine(updateFile)
+                writeLine(updateFile, '        QVector<quint16> blockValues = reply->result();')
+                writeLine(updateFile, '        qCDebug(dc%s()) << "<-- Response from reading block \\"%s\\" register" << %s << "size:" << %s << blockValues;' % (className, blockName, blockStartAddress, blockSize))
+                writeLine(updateFile, '        if (blockValues.size() == %s) {' % (blockSize))
 
                 # Start parsing the registers using offsets
                 offset = 0
                 for i, blockRegister in enumerate(blockRegisters):
                     propertyName = blockRegister['id']
                     propertyTyp = getCppDataType(blockRegister)
-                    writeLine(fileDescriptor, '        process%sRegisterValues(blockValues.mid(%s, %s));' % (propertyName[0].upper() + propertyName[1:], offset, blockRegister['size']))
+                    writeLine(updateFile, '        process%sRegisterValues(blockValues.mid(%s, %s));' % (propertyName[0].upper() + propertyName[1:], offset, blockRegister['size']))
                     offset += blockRegister['size']
 
-                writeLine(fileDescriptor, '        } else {')
-                writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Reading from \\"%s\\" register" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << blockValues;' % (className, blockName, blockStartAddress, blockSize))
-                writeLine(fileDescriptor, '        }')
-                writeLine(fileDescriptor, '        verifyUpdateFinished();')
-                writeLine(fileDescriptor, '    });')
-                writeLine(fileDescriptor)
-                writeLine(fileDescriptor, '    connect(reply, &ModbusRtuReply::errorOccurred, this, [reply] (ModbusRtuReply::Error error){')
-                writeLine(fileDescriptor, '        qCWarning(dc%s()) << "ModbusRtu reply error occurred while updating block \\"%s\\" registers" << error << reply->errorString();' % (className, blockName))
-                writeLine(fileDescriptor, '    });')
+                writeLine(updateFile, '        } else {')
+                writeLine(updateFile, '            qCWarning(dc%s()) << "Reading from \\"%s\\" register" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << blockValues;' % (className, blockName, blockStartAddress, blockSize))
+                writeLine(updateFile, '        }')
+                writeLine(updateFile, '        verifyUpdateFinished();')
+                writeLine(updateFile, '    });')
+                writeLine(updateFile)
+                writeLine(updateFile, '    connect(reply, &ModbusRtuReply::errorOccurred, this, [reply] (ModbusRtuReply::Error error){')
+                writeLine(updateFile, '        qCWarning(dc%s()) << "ModbusRtu reply error occurred while updating block \\"%s\\" registers" << error << reply->errorString();' % (className, blockName))
+                writeLine(updateFile, '    });')
+                endUpdateDivider(fileDescriptor, blockDefinition)
                 writeLine(fileDescriptor)
 
+        if dividerUsed:
+            writeLine(fileDescriptor)
+            writeLine(fileDescriptor, '    // All registers might have been skipped in this update cycle')
+            writeLine(fileDescriptor, '    verifyUpdateFinished();')
+            writeLine(fileDescriptor)
+
     else:
         writeLine(fileDescriptor, '    // No update registers defined. Nothing to be done and we are finished.')
         writeLine(fileDescriptor, '    emit updateFinished();')
@@ -626,3 +656,124 @@ def writeUpdateMethodRtu(fileDescriptor, className, registerDefinitions, blockDe
     writeLine(fileDescriptor, '    return true;')
     writeLine(fileDescriptor, '}')
     writeLine(fileDescriptor)
+
+def writeKeepAliveSendMethodImplementationRtu(fileDescriptor, className, keepAlive):
+    propertyName = keepAlive['register']
+    writeLine(fileDescriptor, 'void %s::sendKeepAlive()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    // Never stack up keep alive requests in the RTU master queue')
+    writeLine(fileDescriptor, '    if (m_keepAliveReply) {')
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "The last keep alive request is still pending. Skipping this one.";' % (className))
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeKeepAliveWriteOnValueCheck(fileDescriptor, keepAlive)
+    writeLine(fileDescriptor, '    m_keepAliveReply = set%s(%s);' % (propertyName[0].upper() + propertyName[1:], keepAlive['value']))
+    writeLine(fileDescriptor, '    if (!m_keepAliveReply) {')
+    writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while sending keep alive request";' % (className))
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (m_keepAliveReply->isFinished()) {')
+    writeLine(fileDescriptor, '        m_keepAliveReply = nullptr;')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    connect(m_keepAliveReply, &ModbusRtuReply::finished, this, [this](){')
+    writeLine(fileDescriptor, '        ModbusRtuReply *reply = m_keepAliveReply;')
+    writeLine(fileDescriptor, '        m_keepAliveReply = nullptr;')
+    writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+    writeLine(fileDescriptor, '        if (reply->error() == ModbusRtuReply::NoError) {')
+    writeLine(fileDescriptor, '            m_keepAliveTimestamp = QDateTime::currentMSecsSinceEpoch();')
+    writeKeepAliveWrittenValue(fileDescriptor, keepAlive)
+    writeLine(fileDescriptor, '            if (m_keepAliveDeadlineTimer->isActive())')
+    writeLine(fileDescriptor, '                m_keepAliveDeadlineTimer->start();')
+    writeLine(fileDescriptor, '        } else {')
+    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Keep alive request failed:" << reply->error() << reply->errorString();' % (className))
+    writeLine(fileDescriptor, '        }')
+    writeLine(fileDescriptor, '    });')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+def writeSetpointSendMethodImplementationsRtu(fileDescriptor, className, setpointRegisters):
+    for registerDefinition in setpointRegisters:
+        propertyName = registerDefinition['id']
+        propertyTyp = getCppDataType(registerDefinition)
+        methodName = propertyName[0].upper() + propertyName[1:]
+
+        writeLine(fileDescriptor, 'void %s::send%sSetpoint()' % (className, methodName))
+        writeLine(fileDescriptor, '{')
+        writeLine(fileDescriptor, '    // Only one write at the time, the latest value will be written once the current one has finished')
+        writeLine(fileDescriptor, '    if (m_%sSetpointRunning || !m_%sSetpointPending)' % (propertyName, propertyName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    m_%sSetpointPending = false;' % (propertyName))
+        writeLine(fileDescriptor, '    m_%sSetpointRunning = true;' % (propertyName))
+        writeLine(fileDescriptor, '    m_%sSetpointWritten = m_%sSetpoint;' % (propertyName, propertyName))
+        if setpointReadBack(registerDefinition):
+            writeLine(fileDescriptor, '    %s %s = m_%sSetpointWritten;' % (propertyTyp, propertyName, propertyName))
+            writeLine(fileDescriptor, '    m_%sSetpointValues = %s;' % (propertyName, getConversionToValueMethod(registerDefinition)))
+
+        writeLine(fileDescriptor, '    ModbusRtuReply *reply = set%s(m_%sSetpointWritten);' % (methodName, propertyName))
+        writeLine(fileDescriptor, '    if (!reply) {')
+        writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while writing setpoint \\"%s\\"";' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '        finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    if (reply->isFinished()) {')
+        writeLine(fileDescriptor, '        finish%sSetpoint(reply->error() == ModbusRtuReply::NoError);' % (methodName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    connect(reply, &ModbusRtuReply::finished, this, [this, reply](){')
+        writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+        writeLine(fileDescriptor, '        if (reply->error() != ModbusRtuReply::NoError) {')
+        writeLine(fileDescriptor, '            qCWarning(dc%s()) << "ModbusRtu reply error occurred while writing setpoint \\"%s\\"" << reply->error() << reply->errorString();' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '            finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor, '        }')
+        writeLine(fileDescriptor)
+        if setpointReadBack(registerDefinition):
+            writeLine(fileDescriptor, '        verify%sSetpoint();' % (methodName))
+        else:
+            writeLine(fileDescriptor, '        finish%sSetpoint(true);' % (methodName))
+        writeLine(fileDescriptor, '    });')
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+        if not setpointReadBack(registerDefinition):
+            continue
+
+        writeLine(fileDescriptor, 'void %s::verify%sSetpoint()' % (className, methodName))
+        writeLine(fileDescriptor, '{')
+        writeLine(fileDescriptor, '    // Read back the register to make sure the device accepted the value')
+        writeLine(fileDescriptor, '    ModbusRtuReply *reply = read%s();' % (methodName))
+        writeLine(fileDescriptor, '    if (!reply || reply->isFinished()) {')
+        writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading back setpoint \\"%s\\"";' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '        finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    connect(reply, &ModbusRtuReply::finished, this, [this, reply](){')
+        writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+        writeLine(fileDescriptor, '        if (reply->error() != ModbusRtuReply::NoError) {')
+        writeLine(fileDescriptor, '            qCWarning(dc%s()) << "ModbusRtu reply error occurred while reading back setpoint \\"%s\\"" << reply->error() << reply->errorString();' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '            finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor, '        }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        const QVector<quint16> values = reply->result();')
+        writeLine(fileDescriptor, '        if (values.size() == %s)' % (registerDefinition['size']))
+        writeLine(fileDescriptor, '            process%sRegisterValues(values);' % (methodName))
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        if (values != m_%sSetpointValues) {' % (propertyName))
+        writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Setpoint \\"%s\\" read back" << values << "does not match the written values" << m_%sSetpointValues;' % (className, registerDefinition['description'], propertyName))
+        writeLine(fileDescriptor, '            finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor, '        }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        finish%sSetpoint(true);' % (methodName))
+        writeLine(fileDescriptor, '    });')
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
@@ -757,14 +757,184 @@ def writeInitMethodImplementationTcp(fileDescriptor, className, registerDefiniti
 
 ##############################################################
 
-def writeUpdateMethodTcp(fileDescriptor, className, registerDefinitions, blockDefinitions, queuedRequests):
+def getRegisterTypeCpp(registerType):
+    if registerType == 'inputRegister':
+        return 'QModbusDataUnit::RegisterType::InputRegisters'
+    elif registerType == 'discreteInputs':
+        return 'QModbusDataUnit::RegisterType::DiscreteInputs'
+    elif registerType == 'coils':
+        return 'QModbusDataUnit::RegisterType::Coils'
+
+    # Default to holdingRegister
+    return 'QModbusDataUnit::RegisterType::HoldingRegisters'
+
+##############################################################
+
+def getUpdateRequestsTcp(className, registerDefinitions, blockDefinitions):
+    # All requests sent on update(), the index in this list is the index in the pending reply table
+    updateRequests = []
+    for registerDefinition in registerDefinitions:
+        if 'readSchedule' in registerDefinition and registerDefinition['readSchedule'] == 'update':
+            propertyName = registerDefinition['id']
+            updateRequest = {}
+            updateRequest['enum'] = 'UpdateRequest%s' % (propertyName[0].upper() + propertyName[1:])
+            updateRequest['description'] = registerDefinition['description']
+            updateRequest['address'] = registerDefinition['address']
+            updateRequest['size'] = registerDefinition['size']
+            updateRequest['registerType'] = getRegisterTypeCpp(registerDefinition['registerType'])
+            updateRequest['handler'] = '&%s::process%sRegisterValues' % (className, propertyName[0].upper() + propertyName[1:])
+            updateRequests.append(updateRequest)
+
+    for blockDefinition in blockDefinitions:
+        if 'readSchedule' in blockDefinition and blockDefinition['readSchedule'] == 'update':
+            blockName = blockDefinition['id']
+            blockSize = 0
+            for blockRegister in blockDefinition['registers']:
+                blockSize += blockRegister['size']
+
+            updateRequest = {}
+            updateRequest['enum'] = 'UpdateRequestBlock%s' % (blockName[0].upper() + blockName[1:])
+            updateRequest['description'] = 'block %s' % blockName
+            updateRequest['address'] = blockDefinition['registers'][0]['address']
+            updateRequest['size'] = blockSize
+            updateRequest['registerType'] = getRegisterTypeCpp(blockDefinition['registers'][0]['registerType'])
+            updateRequest['handler'] = '&%s::process%sBlockValues' % (className, blockName[0].upper() + blockName[1:])
+            updateRequest['block'] = blockDefinition
+            updateRequests.append(updateRequest)
+
+    return updateRequests
+
+##############################################################
+
+def writeUpdateDispatcherDeclarationsTcp(fileDescriptor, className, updateRequests):
+    if not updateRequests:
+        return
+
+    writeLine(fileDescriptor, '    // Update replies are dispatched by onUpdateReplyFinished() using the pending reply table')
+    writeLine(fileDescriptor, '    enum UpdateRequest {')
+    for updateRequest in updateRequests:
+        writeLine(fileDescriptor, '        %s,' % updateRequest['enum'])
+    writeLine(fileDescriptor, '        UpdateRequestCount')
+    writeLine(fileDescriptor, '    };')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    typedef struct UpdateRequestInfo {')
+    writeLine(fileDescriptor, '        const char *description;')
+    writeLine(fileDescriptor, '        QModbusDataUnit::RegisterType registerType;')
+    writeLine(fileDescriptor, '        quint16 address;')
+    writeLine(fileDescriptor, '        quint16 size;')
+    writeLine(fileDescriptor, '        void (%s::*processValues)(const QVector<quint16> &values);' % className)
+    writeLine(fileDescriptor, '    } UpdateRequestInfo;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    QHash<QModbusReply *, UpdateRequest> m_updateRequestReplies;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    static const UpdateRequestInfo &updateRequestInfo(UpdateRequest updateRequest);')
+    writeLine(fileDescriptor, '    bool sendUpdateRequest(UpdateRequest updateRequest);')
+    writeLine(fileDescriptor, '    void onUpdateReplyFinished();')
+    for updateRequest in updateRequests:
+        if 'block' in updateRequest:
+            blockName = updateRequest['block']['id']
+            writeLine(fileDescriptor, '    void process%sBlockValues(const QVector<quint16> &blockValues);' % (blockName[0].upper() + blockName[1:]))
+    writeLine(fileDescriptor)
+
+##############################################################
+
+def writeUpdateDispatcherImplementationsTcp(fileDescriptor, className, updateRequests):
+    if not updateRequests:
+        return
+
+    writeLine(fileDescriptor, 'const %s::UpdateRequestInfo &%s::updateRequestInfo(UpdateRequest updateRequest)' % (className, className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    static const UpdateRequestInfo updateRequestInfos[UpdateRequestCount] = {')
+    for i, updateRequest in enumerate(updateRequests):
+        separator = ',' if i < len(updateRequests) - 1 else ''
+        writeLine(fileDescriptor, '        { "%s", %s, %s, %s, %s }%s' % (updateRequest['description'].replace('"', '\\"'), updateRequest['registerType'], updateRequest['address'], updateRequest['size'], updateRequest['handler'], separator))
+    writeLine(fileDescriptor, '    };')
+    writeLine(fileDescriptor, '    return updateRequestInfos[updateRequest];')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'bool %s::sendUpdateRequest(UpdateRequest updateRequest)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    const UpdateRequestInfo &info = updateRequestInfo(updateRequest);')
+    writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Read" << info.description << "registers from:" << info.address << "size:" << info.size;' % (className))
+    writeLine(fileDescriptor, '    QModbusReply *reply = m_modbusTcpMaster->sendReadRequest(QModbusDataUnit(info.registerType, info.address, info.size), m_slaveId);')
+    writeLine(fileDescriptor, '    if (!reply) {')
+    writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading" << info.description << "registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();' % (className))
+    writeLine(fileDescriptor, '        return false;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (reply->isFinished()) {')
+    writeLine(fileDescriptor, '        reply->deleteLater(); // Broadcast reply returns immediatly')
+    writeLine(fileDescriptor, '        return false;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    m_updateRequestReplies.insert(reply, updateRequest);')
+    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, this, &%s::onUpdateReplyFinished);' % (className))
+    writeLine(fileDescriptor, '    return true;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::onUpdateReplyFinished()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    QModbusReply *reply = qobject_cast<QModbusReply *>(sender());')
+    writeLine(fileDescriptor, '    if (!reply)')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    reply->deleteLater();')
+    writeLine(fileDescriptor, '    if (!m_updateRequestReplies.contains(reply)) {')
+    writeLine(fileDescriptor, '        // Pending replies have been reset in the meantime, i.e. on reconnect')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    const UpdateRequestInfo &info = updateRequestInfo(m_updateRequestReplies.take(reply));')
+    writeLine(fileDescriptor, '    handleModbusError(reply->error());')
+    writeLine(fileDescriptor, '    if (reply->error() != QModbusDevice::NoError) {')
+    writeLine(fileDescriptor, '        QModbusResponse response = reply->rawResult();')
+    writeLine(fileDescriptor, '        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {')
+    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while reading" << info.description << "registers from" << m_modbusTcpMaster->hostAddress().toString() << reply->error() << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());' % (className))
+    writeLine(fileDescriptor, '        } else {')
+    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while reading" << info.description << "registers from" << m_modbusTcpMaster->hostAddress().toString() << reply->error() << reply->errorString();' % (className))
+    writeLine(fileDescriptor, '        }')
+    writeLine(fileDescriptor, '        verifyUpdateFinished();')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    const QVector<quint16> values = reply->result().values();')
+    writeLine(fileDescriptor, '    qCDebug(dc%s()) << "<-- Response from" << info.description << "registers" << info.address << "size:" << info.size << values;' % (className))
+    writeLine(fileDescriptor, '    if (values.size() == info.size) {')
+    writeLine(fileDescriptor, '        (this->*info.processValues)(values);')
+    writeLine(fileDescriptor, '    } else {')
+    writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Reading from" << info.description << "registers" << info.address << "size:" << info.size << "returned different size than requested. Ignoring incomplete data" << values;' % (className))
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor, '    verifyUpdateFinished();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    for updateRequest in updateRequests:
+        if 'block' not in updateRequest:
+            continue
+
+        blockName = updateRequest['block']['id']
+        writeLine(fileDescriptor, 'void %s::process%sBlockValues(const QVector<quint16> &blockValues)' % (className, blockName[0].upper() + blockName[1:]))
+        writeLine(fileDescriptor, '{')
+        offset = 0
+        for blockRegister in updateRequest['block']['registers']:
+            propertyName = blockRegister['id']
+            writeLine(fileDescriptor, '    process%sRegisterValues(blockValues.mid(%s, %s));' % (propertyName[0].upper() + propertyName[1:], offset, blockRegister['size']))
+            offset += blockRegister['size']
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+##############################################################
+
+def writeUpdateMethodTcp(fileDescriptor, className, registerDefinitions, blockDefinitions, queuedRequests, keepAlive = None):
     writeLine(fileDescriptor, 'bool %s::update()' % (className))
     writeLine(fileDescriptor, '{')
 
     # First check if there are any update registers
     updateRequired = False
     for registerDefinition in registerDefinitions:
-        if registerDefinition['readSchedule'] == 'update':
+        if 'readSchedule' in registerDefinition and registerDefinition['readSchedule'] == 'update':
             updateRequired = True
             break
 
@@ -807,139 +977,254 @@ def writeUpdateMethodTcp(fileDescriptor, className, registerDefinitions, blockDe
             writeLine(fileDescriptor, '        return false;')
             writeLine(fileDescriptor)
 
-            writeLine(fileDescriptor, '    if (!m_pendingUpdateReplies.isEmpty()) {')
+            writeLine(fileDescriptor, '    if (!m_updateRequestReplies.isEmpty()) {')
             writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Tried to update but there are still some update replies pending. Waiting for them to be finished...";' % className)
             writeLine(fileDescriptor, '        return true;')
             writeLine(fileDescriptor, '    }')
             writeLine(fileDescriptor)
-            writeLine(fileDescriptor, '    QModbusReply *reply = nullptr;')
+            if keepAlive:
+                # The device processes the requests in order, a keep alive sent during the update would wait behind all of them
+                writeLine(fileDescriptor, '    // Send the keep alive ahead of the update if it would become due while the update replies are pending')
+                writeLine(fileDescriptor, '    if (m_keepAliveTimer->isActive() && m_keepAliveTimer->remainingTime() <= m_modbusTcpMaster->timeout()) {')
+                writeLine(fileDescriptor, '        m_keepAliveTimer->start();')
+                writeLine(fileDescriptor, '        sendKeepAlive();')
+                writeLine(fileDescriptor, '    }')
+                writeLine(fileDescriptor)
 
-            # Read individual registers
-            for registerDefinition in registerDefinitions:
-                propertyName = registerDefinition['id']
-                propertyTyp = getCppDataType(registerDefinition)
+            # Replies get processed by onUpdateReplyFinished()
+            for updateRequest in getUpdateRequestsTcp(className, registerDefinitions, blockDefinitions):
+                writeLine(fileDescriptor, '    // Read %s' % updateRequest['description'])
+                writeLine(fileDescriptor, '    if (!sendUpdateRequest(%s))' % updateRequest['enum'])
+                writeLine(fileDescriptor, '        return false;')
+                writeLine(fileDescriptor)
 
-                if 'readSchedule' in registerDefinition and registerDefinition['readSchedule'] == 'update':
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    // Read %s' % registerDefinition['description'])
-                    writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Read \\"%s\\" register:" << %s << "size:" << %s;' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
-                    writeLine(fileDescriptor, '    reply = read%s();' % (propertyName[0].upper() + propertyName[1:]))
-                    writeLine(fileDescriptor, '    if (!reply) {')
-                    writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading \\"%s\\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();' % (className, registerDefinition['description']))
-                    writeLine(fileDescriptor, '        return false;')
-                    writeLine(fileDescriptor, '    }')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    if (reply->isFinished()) {')
-                    writeLine(fileDescriptor, '        reply->deleteLater(); // Broadcast reply returns immediatly')
-                    writeLine(fileDescriptor, '        return false;')
-                    writeLine(fileDescriptor, '    }')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    m_pendingUpdateReplies.append(reply);')
-                    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);')
-                    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, this, [this, reply](){')
-                    writeLine(fileDescriptor, '        m_pendingUpdateReplies.removeAll(reply);')
-                    writeLine(fileDescriptor, '        handleModbusError(reply->error());')
-                    writeLine(fileDescriptor, '        if (reply->error() != QModbusDevice::NoError) {')
-                    writeLine(fileDescriptor, '            verifyUpdateFinished();')
-                    writeLine(fileDescriptor, '            return;')
-                    writeLine(fileDescriptor, '        }')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '        const QModbusDataUnit unit = reply->result();')
-                    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "<-- Response from \\"%s\\" register" << %s << "size:" << %s << unit.values();' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
-                    writeLine(fileDescriptor, '        if (unit.values().size() == %s) {' % (registerDefinition['size']))
-                    writeLine(fileDescriptor, '            process%sRegisterValues(unit.values());' % (propertyName[0].upper() + propertyName[1:]))
-                    writeLine(fileDescriptor, '        } else {')
-                    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Reading from \\"%s\\" registers" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << unit.values();' % (className, registerDefinition['description'], registerDefinition['address'], registerDefinition['size']))
-                    writeLine(fileDescriptor, '        }')
-                    writeLine(fileDescriptor, '        verifyUpdateFinished();')
-                    writeLine(fileDescriptor, '    });')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){')
-                    writeLine(fileDescriptor, '        QModbusResponse response = reply->rawResult();')
-                    writeLine(fileDescriptor, '        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {')
-                    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while reading \\"%s\\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());' % (className, registerDefinition['description']))
-                    writeLine(fileDescriptor, '        } else {')
-                    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while reading \\"%s\\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();' % (className, registerDefinition['description']))
-                    writeLine(fileDescriptor, '        }')
-                    writeLine(fileDescriptor, '    });')
+    else:
+        writeLine(fileDescriptor, '    // No update registers defined. Nothing to be done and we are finished.')
+        writeLine(fileDescriptor, '    emit updateFinished();')
 
-            # Read init blocks
-            for blockDefinition in blockDefinitions:
-                blockName = blockDefinition['id']
-                blockRegisters = blockDefinition['registers']
+    writeLine(fileDescriptor, '    return true;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
 
-                if 'readSchedule' in blockDefinition and blockDefinition['readSchedule'] == 'update':
-                    blockStartAddress = 0
-                    registerCount = 0
-                    blockSize = 0
-                    registerType = ""
+def writeKeepAliveSendMethodImplementationTcp(fileDescriptor, className, keepAlive, queuedRequests, queuedRequestsDelay):
+    propertyName = keepAlive['register']
+    writeLine(fileDescriptor, 'void %s::sendKeepAlive()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (m_keepAliveReply) {')
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "The last keep alive request is still pending. Skipping this one.";' % (className))
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    m_keepAlivePending = false;')
+    writeKeepAliveWriteOnValueCheck(fileDescriptor, keepAlive)
+    writeLine(fileDescriptor, '    m_keepAliveReply = set%s(%s);' % (propertyName[0].upper() + propertyName[1:], keepAlive['value']))
+    writeLine(fileDescriptor, '    if (!m_keepAliveReply) {')
+    writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while sending keep alive request to" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();' % (className))
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (m_keepAliveReply->isFinished()) {')
+    writeLine(fileDescriptor, '        m_keepAliveReply->deleteLater(); // Broadcast reply returns immediatly')
+    writeLine(fileDescriptor, '        m_keepAliveReply = nullptr;')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    connect(m_keepAliveReply, &QModbusReply::finished, m_keepAliveReply, &QModbusReply::deleteLater);')
+    writeLine(fileDescriptor, '    connect(m_keepAliveReply, &QModbusReply::finished, this, [this](){')
+    writeLine(fileDescriptor, '        QModbusReply *reply = m_keepAliveReply;')
+    writeLine(fileDescriptor, '        m_keepAliveReply = nullptr;')
+    writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+    writeLine(fileDescriptor, '        if (reply->error() == QModbusDevice::NoError) {')
+    writeLine(fileDescriptor, '            m_keepAliveTimestamp = QDateTime::currentMSecsSinceEpoch();')
+    writeKeepAliveWrittenValue(fileDescriptor, keepAlive)
+    writeLine(fileDescriptor, '            if (m_keepAliveDeadlineTimer->isActive())')
+    writeLine(fileDescriptor, '                m_keepAliveDeadlineTimer->start();')
+    writeLine(fileDescriptor, '        } else {')
+    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Keep alive request to" << m_modbusTcpMaster->hostAddress().toString() << "failed:" << reply->error() << reply->errorString();' % (className))
+    writeLine(fileDescriptor, '        }')
+    if queuedRequests:
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        // Continue with the requests which had to wait for us')
+        writeLine(fileDescriptor, '        QTimer::singleShot(%s, this, &%s::sendNextQueuedInitRequest);' % (queuedRequestsDelay, className))
+        writeLine(fileDescriptor, '        QTimer::singleShot(%s, this, &%s::sendNextQueuedRequest);' % (queuedRequestsDelay, className))
+    writeLine(fileDescriptor, '    });')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
 
-                    for i, blockRegister in enumerate(blockRegisters):
-                        if i == 0:
-                            blockStartAddress = blockRegister['address']
-                            registerType = blockRegister['registerType']
+def writeSetpointSendMethodImplementationsTcp(fileDescriptor, className, setpointRegisters):
+    for registerDefinition in setpointRegisters:
+        propertyName = registerDefinition['id']
+        propertyTyp = getCppDataType(registerDefinition)
+        methodName = propertyName[0].upper() + propertyName[1:]
 
-                        registerCount += 1
-                        blockSize += blockRegister['size']
+        writeLine(fileDescriptor, 'void %s::send%sSetpoint()' % (className, methodName))
+        writeLine(fileDescriptor, '{')
+        writeLine(fileDescriptor, '    // Only one write at the time, the latest value will be written once the current one has finished')
+        writeLine(fileDescriptor, '    if (m_%sSetpointRunning || !m_%sSetpointPending)' % (propertyName, propertyName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    m_%sSetpointPending = false;' % (propertyName))
+        writeLine(fileDescriptor, '    m_%sSetpointRunning = true;' % (propertyName))
+        writeLine(fileDescriptor, '    m_%sSetpointWritten = m_%sSetpoint;' % (propertyName, propertyName))
+        if setpointReadBack(registerDefinition):
+            writeLine(fileDescriptor, '    %s %s = m_%sSetpointWritten;' % (propertyTyp, propertyName, propertyName))
+            writeLine(fileDescriptor, '    m_%sSetpointValues = %s;' % (propertyName, getConversionToValueMethod(registerDefinition)))
+
+        writeLine(fileDescriptor, '    QModbusReply *reply = set%s(m_%sSetpointWritten);' % (methodName, propertyName))
+        writeLine(fileDescriptor, '    if (!reply) {')
+        writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while writing setpoint \\"%s\\" to" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '        finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    if (reply->isFinished()) {')
+        writeLine(fileDescriptor, '        reply->deleteLater(); // Broadcast reply returns immediatly')
+        writeLine(fileDescriptor, '        finish%sSetpoint(reply->error() == QModbusDevice::NoError);' % (methodName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);')
+        writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, this, [this, reply](){')
+        writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+        writeLine(fileDescriptor, '        if (reply->error() != QModbusDevice::NoError) {')
+        writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while writing setpoint \\"%s\\"" << reply->error() << reply->errorString();' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '            finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor, '        }')
+        writeLine(fileDescriptor)
+        if setpointReadBack(registerDefinition):
+            writeLine(fileDescriptor, '        verify%sSetpoint();' % (methodName))
+        else:
+            writeLine(fileDescriptor, '        finish%sSetpoint(true);' % (methodName))
+        writeLine(fileDescriptor, '    });')
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
 
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    // Read %s' % blockName)
-                    writeLine(fileDescriptor, '    reply = readBlock%s();' % (blockName[0].upper() + blockName[1:]))
-                    writeLine(fileDescriptor, '    qCDebug(dc%s()) << "--> Read block \\"%s\\" registers from:" << %s << "size:" << %s;' % (className, blockName, blockStartAddress, blockSize))
-                    writeLine(fileDescriptor, '    if (!reply) {')
-                    writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading block \\"%s\\" registers";' % (className, blockName))
-                    writeLine(fileDescriptor, '        return false;')
-                    writeLine(fileDescriptor, '    }')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    if (reply->isFinished()) {')
-                    writeLine(fileDescriptor, '        reply->deleteLater(); // Broadcast reply returns immediatly')
-                    writeLine(fileDescriptor, '        return false;')
-                    writeLine(fileDescriptor, '    }')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    m_pendingUpdateReplies.append(reply);')
-                    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);')
-                    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, this, [this, reply](){')
-                    writeLine(fileDescriptor, '        m_pendingUpdateReplies.removeAll(reply);')
-                    writeLine(fileDescriptor, '        handleModbusError(reply->error());')
-                    writeLine(fileDescriptor, '        if (reply->error() != QModbusDevice::NoError) {')
-                    writeLine(fileDescriptor, '            verifyUpdateFinished();')
-                    writeLine(fileDescriptor, '            return;')
-                    writeLine(fileDescriptor, '        }')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '        const QModbusDataUnit unit = reply->result();')
-                    writeLine(fileDescriptor, '        const QVector<quint16> blockValues = unit.values();')
-                    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "<-- Response from reading block \\"%s\\" register" << %s << "size:" << %s << blockValues;' % (className, blockName, blockStartAddress, blockSize))
-                    writeLine(fileDescriptor, '        if (blockValues.size() == %s) {' % (blockSize))
+        if not setpointReadBack(registerDefinition):
+            continue
 
-                    # Start parsing the registers using offsets
-                    offset = 0
-                    for i, blockRegister in enumerate(blockRegisters):
-                        propertyName = blockRegister['id']
-                        propertyTyp = getCppDataType(blockRegister)
-                        writeLine(fileDescriptor, '            process%sRegisterValues(blockValues.mid(%s, %s));' % (propertyName[0].upper() + propertyName[1:], offset, blockRegister['size']))
-                        offset += blockRegister['size']
+        writeLine(fileDescriptor, 'void %s::verify%sSetpoint()' % (className, methodName))
+        writeLine(fileDescriptor, '{')
+        writeLine(fileDescriptor, '    // Read back the register to make sure the device accepted the value')
+        writeLine(fileDescriptor, '    QModbusReply *reply = read%s();' % (methodName))
+        writeLine(fileDescriptor, '    if (!reply) {')
+        writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while reading back setpoint \\"%s\\" from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '        finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    if (reply->isFinished()) {')
+        writeLine(fileDescriptor, '        reply->deleteLater(); // Broadcast reply returns immediatly')
+        writeLine(fileDescriptor, '        finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);')
+        writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, this, [this, reply](){')
+        writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+        writeLine(fileDescriptor, '        if (reply->error() != QModbusDevice::NoError) {')
+        writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while reading back setpoint \\"%s\\"" << reply->error() << reply->errorString();' % (className, registerDefinition['description']))
+        writeLine(fileDescriptor, '            finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor, '        }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        const QVector<quint16> values = reply->result().values();')
+        writeLine(fileDescriptor, '        if (values.size() == %s)' % (registerDefinition['size']))
+        writeLine(fileDescriptor, '            process%sRegisterValues(values);' % (methodName))
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        if (values != m_%sSetpointValues) {' % (propertyName))
+        writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Setpoint \\"%s\\" read back" << values << "does not match the written values" << m_%sSetpointValues;' % (className, registerDefinition['description'], propertyName))
+        writeLine(fileDescriptor, '            finish%sSetpoint(false);' % (methodName))
+        writeLine(fileDescriptor, '            return;')
+        writeLine(fileDescriptor, '        }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '        finish%sSetpoint(true);' % (methodName))
+        writeLine(fileDescriptor, '    });')
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
 
-                    writeLine(fileDescriptor, '        } else {')
-                    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Reading from \\"%s\\" block registers" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << blockValues;' % (className, blockName, blockStartAddress, blockSize))
-                    writeLine(fileDescriptor, '        }')
 
-                    writeLine(fileDescriptor, '        verifyUpdateFinished();')
-                    writeLine(fileDescriptor, '    });')
-                    writeLine(fileDescriptor)
-                    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::errorOccurred, this, [reply] (QModbusDevice::Error error){')
-                    writeLine(fileDescriptor, '        QModbusResponse response = reply->rawResult();')
-                    writeLine(fileDescriptor, '        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {')
-                    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while updating block \\"%s\\" registers" << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());' % (className, blockName))
-                    writeLine(fileDescriptor, '        } else {')
-                    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Modbus reply error occurred while updating block \\"%s\\" registers" << error << reply->errorString();' % (className, blockName))
-                    writeLine(fileDescriptor, '        }')
-                    writeLine(fileDescriptor, '    });')
-                    writeLine(fileDescriptor)
+def writePriorityRequestMethodImplementationsTcp(fileDescriptor, className, queuedRequestsDelay):
+    writeLine(fileDescriptor, 'bool %s::sendPriorityRequest()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    // Keep alive requests go out before any queued init or update request, but still one at the time.')
+    writeLine(fileDescriptor, '    // Returns true as long as the queued requests have to wait.')
+    writeLine(fileDescriptor, '    if (m_keepAliveReply)')
+    writeLine(fileDescriptor, '        return true;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (!m_keepAlivePending)')
+    writeLine(fileDescriptor, '        return false;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (m_currentInitReply || m_currentUpdateReply) {')
+    writeLine(fileDescriptor, '        schedulePriorityRequest();')
+    writeLine(fileDescriptor, '        return true;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    sendKeepAlive();')
+    writeLine(fileDescriptor, '    return m_keepAliveReply != nullptr;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
 
-    else:
-        writeLine(fileDescriptor, '    // No update registers defined. Nothing to be done and we are finished.')
-        writeLine(fileDescriptor, '    emit updateFinished();')
+    writeLine(fileDescriptor, 'void %s::schedulePriorityRequest()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (m_priorityRequestScheduled)')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    // Send the priority request right after the current request has finished')
+    writeLine(fileDescriptor, '    m_priorityRequestScheduled = true;')
+    writeLine(fileDescriptor, '    QModbusReply *currentReply = m_currentInitReply ? m_currentInitReply : m_currentUpdateReply;')
+    writeLine(fileDescriptor, '    connect(currentReply, &QModbusReply::finished, this, [this](){')
+    writeLine(fileDescriptor, '        m_priorityRequestScheduled = false;')
+    writeLine(fileDescriptor, '        QTimer::singleShot(%s, this, &%s::sendNextQueuedRequest);' % (queuedRequestsDelay, className))
+    writeLine(fileDescriptor, '    });')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
 
-    writeLine(fileDescriptor, '    return true;')
+def writeStatusProbeSendMethodImplementationTcp(fileDescriptor, className, probeRegisters, updateRequests):
+    startAddress = probeRegisters[0]['address']
+    size = getStatusProbeSize(probeRegisters)
+    registerType = 'InputRegisters' if probeRegisters[0].get('registerType', 'holdingRegister') == 'inputRegister' else 'HoldingRegisters'
+
+    writeLine(fileDescriptor, 'void %s::sendStatusProbe()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    // The probe should never add load while the regular requests are running')
+    if updateRequests:
+        writeLine(fileDescriptor, '    if (m_statusProbeReply || m_initializing || !m_updateRequestReplies.isEmpty())')
+    else:
+        writeLine(fileDescriptor, '    if (m_statusProbeReply || m_initializing)')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::%s, %s, %s);' % (registerType, startAddress, size))
+    writeLine(fileDescriptor, '    QModbusReply *reply = m_modbusTcpMaster->sendReadRequest(request, m_slaveId);')
+    writeLine(fileDescriptor, '    if (!reply) {')
+    writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Error occurred while probing the status registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();' % (className))
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (reply->isFinished()) {')
+    writeLine(fileDescriptor, '        reply->deleteLater(); // Broadcast reply returns immediatly')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    m_statusProbeReply = reply;')
+    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);')
+    writeLine(fileDescriptor, '    connect(reply, &QModbusReply::finished, this, [this, reply](){')
+    writeLine(fileDescriptor, '        if (m_statusProbeReply == reply)')
+    writeLine(fileDescriptor, '            m_statusProbeReply = nullptr;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        handleModbusError(reply->error());')
+    writeLine(fileDescriptor, '        if (reply->error() != QModbusDevice::NoError) {')
+    writeLine(fileDescriptor, '            qCDebug(dc%s()) << "Status probe request to" << m_modbusTcpMaster->hostAddress().toString() << "failed:" << reply->error() << reply->errorString();' % (className))
+    writeLine(fileDescriptor, '            return;')
+    writeLine(fileDescriptor, '        }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        const QModbusDataUnit unit = reply->result();')
+    writeLine(fileDescriptor, '        if (unit.values().size() != %s) {' % (size))
+    writeLine(fileDescriptor, '            qCWarning(dc%s()) << "Reading the status probe registers" << %s << "size:" << %s << "returned different size than requested. Ignoring incomplete data" << unit.values();' % (className, startAddress, size))
+    writeLine(fileDescriptor, '            return;')
+    writeLine(fileDescriptor, '        }')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        processStatusProbeValues(unit.values());')
+    writeLine(fileDescriptor, '    });')
     writeLine(fileDescriptor, '}')
     writeLine(fileDescriptor)
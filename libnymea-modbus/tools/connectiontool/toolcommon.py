@@ -242,28 +242,28 @@ def getConversionToValueMethod(registerDefinition):
         elif registerDefinition['type'] == 'int32':
             return ('ModbusDataUtils::convertFromInt32(static_cast<%s>(%s), m_endianness)' % (propertyTyp, propertyName))
 
-    # Handle scale factors
+    # Handle scale factors, round to the nearest raw value instead of truncating
     if 'scaleFactor' in registerDefinition:
         scaleFactorProperty = 'm_%s' % registerDefinition['scaleFactor']
         if registerDefinition['type'] == 'uint16':
-            return ('ModbusDataUtils::convertFromUInt16(static_cast<%s>(%s  * 1.0 / pow(10, %s)))' % (propertyTyp, propertyName, scaleFactorProperty))
+            return ('ModbusDataUtils::convertFromUInt16(static_cast<%s>(qRound(%s * 1.0 / pow(10, %s))))' % (propertyTyp, propertyName, scaleFactorProperty))
         elif registerDefinition['type'] == 'int16':
-            return ('ModbusDataUtils::convertFromInt16(static_cast<%s>(%s  * 1.0 / pow(10, %s)))' % (propertyTyp, propertyName, scaleFactorProperty))
+            return ('ModbusDataUtils::convertFromInt16(static_cast<%s>(qRound(%s * 1.0 / pow(10, %s))))' % (propertyTyp, propertyName, scaleFactorProperty))
         elif registerDefinition['type'] == 'uint32':
-            return ('ModbusDataUtils::convertFromUInt32(static_cast<%s>(%s  * 1.0 / pow(10, %s)), m_endianness)' % (propertyTyp, propertyName, scaleFactorProperty))
+            return ('ModbusDataUtils::convertFromUInt32(static_cast<%s>(qRound64(%s * 1.0 / pow(10, %s))), m_endianness)' % (propertyTyp, propertyName, scaleFactorProperty))
         elif registerDefinition['type'] == 'int32':
-            return ('ModbusDataUtils::convertFromInt32(static_cast<%s>(%s  * 1.0 / pow(10, %s)), m_endianness)' % (propertyTyp, propertyName, scaleFactorProperty))
+            return ('ModbusDataUtils::convertFromInt32(static_cast<%s>(qRound64(%s * 1.0 / pow(10, %s))), m_endianness)' % (propertyTyp, propertyName, scaleFactorProperty))
 
     elif 'staticScaleFactor' in registerDefinition:
         scaleFactor = registerDefinition['staticScaleFactor']
         if registerDefinition['type'] == 'uint16':
-            return ('ModbusDataUtils::convertFromUInt16(static_cast<%s>(%s  * 1.0 / pow(10, %s)))' % (propertyTyp, propertyName, scaleFactor))
+            return ('ModbusDataUtils::convertFromUInt16(static_cast<%s>(qRound(%s * 1.0 / pow(10, %s))))' % (propertyTyp, propertyName, scaleFactor))
         elif registerDefinition['type'] == 'int16':
-            return ('ModbusDataUtils::convertFromInt16(static_cast<%s>(%s  * 1.0 / pow(10, %s)))' % (propertyTyp, propertyName, scaleFactor))
+            return ('ModbusDataUtils::convertFromInt16(static_cast<%s>(qRound(%s * 1.0 / pow(10, %s))))' % (propertyTyp, propertyName, scaleFactor))
         elif registerDefinition['type'] == 'uint32':
-            return ('ModbusDataUtils::convertFromUInt32(static_cast<%s>(%s  * 1.0 / pow(10, %s)), m_endianness)' % (propertyTyp, propertyName, scaleFactor))
+            return ('ModbusDataUtils::convertFromUInt32(static_cast<%s>(qRound64(%s * 1.0 / pow(10, %s))), m_endianness)' % (propertyTyp, propertyName, scaleFactor))
         elif registerDefinition['type'] == 'int32':
-            return ('ModbusDataUtils::convertFromInt32(static_cast<%s>(%s  * 1.0 / pow(10, %s)), m_endianness)' % (propertyTyp, propertyName, scaleFactor))
+            return ('ModbusDataUtils::convertFromInt32(static_cast<%s>(qRound64(%s * 1.0 / pow(10, %s))), m_endianness)' % (propertyTyp, propertyName, scaleFactor))
 
     # Handle default types
     elif registerDefinition['type'] == 'uint16':
@@ -394,8 +394,9 @@ def validateBlocks(blockDefinitions):
                     logger.warning('Error: block %s has invalid register order in register %s. There seems to be a gap between the registers.' % (blockName, blockRegister['id']))
                     exit(1)
 
-                if blockRegister['access'] != registerAccess:
-                    logger.warning('Error: block %s has inconsistent register access in register %s. The block registers dont seem to have the same access rights.' % (blockName, blockRegister['id']))
+                # The block is read as a whole, single registers might still be writable on their own
+                if ('R' in blockRegister['access']) != ('R' in registerAccess):
+                    logger.warning('Error: block %s has inconsistent register access in register %s. The block registers dont seem to be all readable.' % (blockName, blockRegister['id']))
                     exit(1)
 
                 if blockRegister['registerType'] != registerType:
@@ -501,7 +502,52 @@ def writePropertyProcessMethodDeclaration(fileDescriptor, registerDefinitions):
     writeLine(fileDescriptor)
     
 
-def writePropertyProcessMethodImplementations(fileDescriptor, className, registerDefinitions):
+def getInvalidValues(registerDefinition, invalidValues = None):
+    # Register specific invalid values override the connection wide invalid values of the type
+    if 'invalidValues' in registerDefinition:
+        values = registerDefinition['invalidValues']
+    elif invalidValues and registerDefinition['type'] in invalidValues:
+        values = invalidValues[registerDefinition['type']]
+    else:
+        return []
+
+    if len(values) > 0 and registerDefinition['type'] in ['string', 'bytearray', 'raw']:
+        logger.warning('Error: Invalid values are not supported for register \"%s\" of type %s.' % (registerDefinition['id'], registerDefinition['type']))
+        exit(1)
+
+    bits = 16 * registerDefinition['size']
+    rawValues = []
+    for value in values:
+        rawValue = int(value, 0) if isinstance(value, str) else int(value)
+        if rawValue >= (1 << bits) or rawValue < -(1 << (bits - 1)):
+            logger.warning('Error: The invalid value %s does not fit into register \"%s\" of size %s.' % (value, registerDefinition['id'], registerDefinition['size']))
+            exit(1)
+
+        # Negative values will be compared as two's complement raw words
+        rawValues.append(rawValue & ((1 << bits) - 1))
+
+    return rawValues
+
+
+def getInvalidValuesCondition(registerDefinition, invalidValues = None):
+    size = registerDefinition['size']
+    conditions = []
+    for rawValue in getInvalidValues(registerDefinition, invalidValues):
+        words = [(rawValue >> (16 * (size - 1 - i))) & 0xffff for i in range(size)]
+        bigEndianCondition = ' && '.join(['values.at(%s) == 0x%04x' % (i, word) for i, word in enumerate(words)])
+        if size == 1:
+            conditions.append(bigEndianCondition)
+        elif words == words[::-1]:
+            conditions.append('(%s)' % bigEndianCondition)
+        else:
+            # The word order depends on the endianness, which can be changed at runtime
+            littleEndianCondition = ' && '.join(['values.at(%s) == 0x%04x' % (i, word) for i, word in enumerate(reversed(words))])
+            conditions.append('(m_endianness == ModbusDataUtils::ByteOrderBigEndian ? (%s) : (%s))' % (bigEndianCondition, littleEndianCondition))
+
+    return ' || '.join(conditions)
+
+
+def writePropertyProcessMethodImplementations(fileDescriptor, className, registerDefinitions, invalidValues = None):
     for registerDefinition in registerDefinitions:
         if 'access' in registerDefinition:
             if not 'R' in registerDefinition['access']:
@@ -512,7 +558,19 @@ def writePropertyProcessMethodImplementations(fileDescriptor, className, registe
 
         writeLine(fileDescriptor, 'void %s::process%sRegisterValues(const QVector<quint16> &values)' % (className, propertyName[0].upper() + propertyName[1:]))
         writeLine(fileDescriptor, '{')
+        invalidValuesCondition = getInvalidValuesCondition(registerDefinition, invalidValues)
+        if invalidValuesCondition:
+            # Check the raw words before decoding, invalid values must not change the property
+            writeLine(fileDescriptor, '    if (values.count() == %s && (%s)) {' % (registerDefinition['size'], invalidValuesCondition))
+            writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Ignoring invalid value of \\"%s\\"" << values;' % (className, registerDefinition['description']))
+            writeLine(fileDescriptor, '        m_%sValid = false;' % (propertyName))
+            writeLine(fileDescriptor, '        return;')
+            writeLine(fileDescriptor, '    }')
+            writeLine(fileDescriptor)
+
         writeLine(fileDescriptor, '    %s received%s = %s;' % (propertyTyp, propertyName[0].upper() + propertyName[1:], getValueConversionMethod(registerDefinition)))
+        if invalidValuesCondition:
+            writeLine(fileDescriptor, '    m_%sValid = true;' % (propertyName))
         writeLine(fileDescriptor, '    emit %sReadFinished(received%s);' % (propertyName, propertyName[0].upper() + propertyName[1:]))
         writeLine(fileDescriptor)
         writeLine(fileDescriptor, '    if (m_%s != received%s) {' % (propertyName, propertyName[0].upper() + propertyName[1:]))
@@ -523,9 +581,61 @@ def writePropertyProcessMethodImplementations(fileDescriptor, className, registe
         writeLine(fileDescriptor)
 
 
-def writeSendNextQueuedInitRequestMethodImplementation(fileDescriptor, className):
+def getValidatedRegisterDefinitions(registerJson, invalidValues = None):
+    # All readable registers which can report an invalid value
+    validatedRegisters = []
+    registerDefinitions = list(registerJson['registers'])
+    if 'blocks' in registerJson:
+        for blockDefinition in registerJson['blocks']:
+            registerDefinitions.extend(blockDefinition['registers'])
+
+    for registerDefinition in registerDefinitions:
+        if 'access' in registerDefinition:
+            if not 'R' in registerDefinition['access']:
+                continue
+
+        if len(getInvalidValues(registerDefinition, invalidValues)) > 0:
+            validatedRegisters.append(registerDefinition)
+
+    return validatedRegisters
+
+
+def writeValidityMethodDeclarations(fileDescriptor, validatedRegisters):
+    if len(validatedRegisters) == 0:
+        return
+
+    writeLine(fileDescriptor, '    // False until a valid value has been received, or if the last received value was invalid')
+    for registerDefinition in validatedRegisters:
+        writeLine(fileDescriptor, '    bool %sValid() const;' % (registerDefinition['id']))
+
+    writeLine(fileDescriptor)
+
+
+def writeValidityMemberDeclarations(fileDescriptor, validatedRegisters):
+    for registerDefinition in validatedRegisters:
+        writeLine(fileDescriptor, '    bool m_%sValid = false;' % (registerDefinition['id']))
+
+    if len(validatedRegisters) > 0:
+        writeLine(fileDescriptor)
+
+
+def writeValidityMethodImplementations(fileDescriptor, className, validatedRegisters):
+    for registerDefinition in validatedRegisters:
+        propertyName = registerDefinition['id']
+        writeLine(fileDescriptor, 'bool %s::%sValid() const' % (className, propertyName))
+        writeLine(fileDescriptor, '{')
+        writeLine(fileDescriptor, '    return m_%sValid;' % (propertyName))
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+
+def writeSendNextQueuedInitRequestMethodImplementation(fileDescriptor, className, priorityRequests = False):
     writeLine(fileDescriptor, 'void %s::sendNextQueuedInitRequest()' % (className))
     writeLine(fileDescriptor, '{')
+    if priorityRequests:
+        writeLine(fileDescriptor, '    if (sendPriorityRequest())')
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor)
     writeLine(fileDescriptor, '    if (m_initRequestQueue.isEmpty())')
     writeLine(fileDescriptor, '        return;')
     writeLine(fileDescriptor)
@@ -549,9 +659,13 @@ def writeEnqueueInitRequestMethodImplementation(fileDescriptor, className):
     writeLine(fileDescriptor)
 
 
-def writeSendNextQueuedRequestMethodImplementation(fileDescriptor, className):
+def writeSendNextQueuedRequestMethodImplementation(fileDescriptor, className, priorityRequests = False):
     writeLine(fileDescriptor, 'void %s::sendNextQueuedRequest()' % (className))
     writeLine(fileDescriptor, '{')
+    if priorityRequests:
+        writeLine(fileDescriptor, '    if (sendPriorityRequest())')
+        writeLine(fileDescriptor, '        return;')
+        writeLine(fileDescriptor)
     writeLine(fileDescriptor, '    if (m_updateRequestQueue.isEmpty())')
     writeLine(fileDescriptor, '        return;')
     writeLine(fileDescriptor)
@@ -572,4 +686,545 @@ def writeEnqueueRequestMethodImplementation(fileDescriptor, className):
     writeLine(fileDescriptor)
     writeLine(fileDescriptor, '    m_updateRequestQueue.enqueue(function);')
     writeLine(fileDescriptor, '}')
-    writeLine(fileDescriptor)
\ No newline at end of file
+    writeLine(fileDescriptor)
+
+def getSnapshotRegisterDefinitions(registerJson):
+    # Only plain data types, the snapshot has to stay a trivially copyable struct
+    snapshotRegisters = []
+    registerDefinitions = list(registerJson['registers'])
+    if 'blocks' in registerJson:
+        for blockDefinition in registerJson['blocks']:
+            registerDefinitions.extend(blockDefinition['registers'])
+
+    for registerDefinition in registerDefinitions:
+        if 'access' in registerDefinition:
+            if not 'R' in registerDefinition['access']:
+                continue
+
+        if getCppDataType(registerDefinition) in ['QString', 'QByteArray', 'QVector<quint16>']:
+            continue
+
+        snapshotRegisters.append(registerDefinition)
+
+    return snapshotRegisters
+
+
+def writeSnapshotStructDefinition(fileDescriptor, registerJson, invalidValues = None):
+    writeLine(fileDescriptor, '    struct Snapshot {')
+    writeLine(fileDescriptor, '        qint64 timestamp = 0;')
+    for registerDefinition in getSnapshotRegisterDefinitions(registerJson):
+        propertyName = registerDefinition['id']
+        propertyTyp = getCppDataType(registerDefinition)
+        if 'defaultValue' in registerDefinition:
+            writeLine(fileDescriptor, '        %s %s = %s;' % (propertyTyp, propertyName, registerDefinition['defaultValue']))
+        elif 'enum' in registerDefinition:
+            writeLine(fileDescriptor, '        %s %s = static_cast<%s>(0);' % (propertyTyp, propertyName, propertyTyp))
+        else:
+            writeLine(fileDescriptor, '        %s %s = 0;' % (propertyTyp, propertyName))
+
+        # Invalid values don't change the property, the flag tells if the value is current
+        if len(getInvalidValues(registerDefinition, invalidValues)) > 0:
+            writeLine(fileDescriptor, '        bool %sValid = false;' % (propertyName))
+
+    writeLine(fileDescriptor, '    };')
+    writeLine(fileDescriptor)
+
+
+def writeSnapshotMethodImplementation(fileDescriptor, className, registerJson, invalidValues = None):
+    writeLine(fileDescriptor, '%s::Snapshot %s::snapshot() const' % (className, className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    Snapshot snapshot;')
+    writeLine(fileDescriptor, '    snapshot.timestamp = m_snapshotTimestamp;')
+    for registerDefinition in getSnapshotRegisterDefinitions(registerJson):
+        propertyName = registerDefinition['id']
+        writeLine(fileDescriptor, '    snapshot.%s = m_%s;' % (propertyName, propertyName))
+        if len(getInvalidValues(registerDefinition, invalidValues)) > 0:
+            writeLine(fileDescriptor, '    snapshot.%sValid = m_%sValid;' % (propertyName, propertyName))
+
+    writeLine(fileDescriptor, '    return snapshot;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+
+def validateKeepAlive(keepAlive, registerJson):
+    for requiredProperty in ['register', 'value', 'interval']:
+        if not requiredProperty in keepAlive:
+            logger.warning('Error: The keepAlive definition requires the \"%s\" property.' % requiredProperty)
+            exit(1)
+
+    registerDefinitions = list(registerJson['registers'])
+    if 'blocks' in registerJson:
+        for blockDefinition in registerJson['blocks']:
+            registerDefinitions.extend(blockDefinition['registers'])
+
+    for registerDefinition in registerDefinitions:
+        if registerDefinition['id'] == keepAlive['register']:
+            if not 'W' in registerDefinition['access']:
+                logger.warning('Error: The keepAlive register \"%s\" is not writable.' % keepAlive['register'])
+                exit(1)
+
+            if 'writeOnValue' in keepAlive and (not 'R' in registerDefinition['access'] or registerDefinition.get('readSchedule') != 'update'):
+                logger.warning('Error: The keepAlive register \"%s\" must be readable and read on update if \"writeOnValue\" is used.' % keepAlive['register'])
+                exit(1)
+
+            return registerDefinition
+
+    logger.warning('Error: Could not find the keepAlive register \"%s\". Please make sure it matches the \"id\" of a defined register.' % keepAlive['register'])
+    exit(1)
+
+
+def getKeepAliveDeadline(keepAlive):
+    # If not specified, one missed keep alive request is still fine
+    if 'deadline' in keepAlive:
+        return keepAlive['deadline']
+
+    return 2 * keepAlive['interval']
+
+
+def writeKeepAliveWriteOnValueCheck(fileDescriptor, keepAlive):
+    if not 'writeOnValue' in keepAlive:
+        return
+
+    propertyName = keepAlive['register']
+    writeLine(fileDescriptor, '    // Only write once the device has reset the register, until then we are still alive')
+    writeLine(fileDescriptor, '    if (m_%s != %s) {' % (propertyName, keepAlive['writeOnValue']))
+    writeLine(fileDescriptor, '        m_keepAliveTimestamp = QDateTime::currentMSecsSinceEpoch();')
+    writeLine(fileDescriptor, '        if (m_keepAliveDeadlineTimer->isActive())')
+    writeLine(fileDescriptor, '            m_keepAliveDeadlineTimer->start();')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor)
+
+
+def writeKeepAliveWrittenValue(fileDescriptor, keepAlive):
+    if not 'writeOnValue' in keepAlive:
+        return
+
+    # Do not write again until the next update has read the reset value
+    writeLine(fileDescriptor, '            m_%s = %s;' % (keepAlive['register'], keepAlive['value']))
+
+
+def writeKeepAliveMethodDeclarations(fileDescriptor, keepAlive):
+    if 'writeOnValue' in keepAlive:
+        writeLine(fileDescriptor, '    /* Keep alive: write %s into \"%s\" every %s ms while reachable and the register reads %s */' % (keepAlive['value'], keepAlive['register'], keepAlive['interval'], keepAlive['writeOnValue']))
+    else:
+        writeLine(fileDescriptor, '    /* Keep alive: write %s into \"%s\" every %s ms while reachable */' % (keepAlive['value'], keepAlive['register'], keepAlive['interval']))
+    writeLine(fileDescriptor, '    // Disabled by default, so connections created for a discovery never write to a device')
+    writeLine(fileDescriptor, '    bool keepAliveEnabled() const;')
+    writeLine(fileDescriptor, '    void setKeepAliveEnabled(bool keepAliveEnabled);')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    int keepAliveInterval() const;')
+    writeLine(fileDescriptor, '    void setKeepAliveInterval(int keepAliveInterval);')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    // Maximum time in ms between 2 successful keep alive requests')
+    writeLine(fileDescriptor, '    int keepAliveDeadline() const;')
+    writeLine(fileDescriptor, '    void setKeepAliveDeadline(int keepAliveDeadline);')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    uint keepAliveMissedDeadlines() const;')
+    writeLine(fileDescriptor)
+
+
+def writeKeepAliveMemberDeclarations(fileDescriptor, keepAlive, replyType):
+    writeLine(fileDescriptor, '    QTimer *m_keepAliveTimer = nullptr;')
+    writeLine(fileDescriptor, '    QTimer *m_keepAliveDeadlineTimer = nullptr;')
+    writeLine(fileDescriptor, '    bool m_keepAliveEnabled = false;')
+    writeLine(fileDescriptor, '    bool m_keepAlivePending = false;')
+    writeLine(fileDescriptor, '    qint64 m_keepAliveTimestamp = 0;')
+    writeLine(fileDescriptor, '    uint m_keepAliveMissedDeadlines = 0;')
+    writeLine(fileDescriptor, '    %s *m_keepAliveReply = nullptr;' % replyType)
+    writeLine(fileDescriptor, '    void setupKeepAlive();')
+    writeLine(fileDescriptor, '    void evaluateKeepAlive();')
+    writeLine(fileDescriptor, '    void requestKeepAlive();')
+    writeLine(fileDescriptor, '    void sendKeepAlive();')
+    writeLine(fileDescriptor, '    void onKeepAliveDeadlineExpired();')
+    writeLine(fileDescriptor)
+
+
+def writeKeepAliveMethodImplementations(fileDescriptor, className, keepAlive, queuedRequests = False):
+    writeLine(fileDescriptor, 'bool %s::keepAliveEnabled() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_keepAliveEnabled;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setKeepAliveEnabled(bool keepAliveEnabled)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (m_keepAliveEnabled == keepAliveEnabled)')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    m_keepAliveEnabled = keepAliveEnabled;')
+    writeLine(fileDescriptor, '    evaluateKeepAlive();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'int %s::keepAliveInterval() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_keepAliveTimer->interval();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setKeepAliveInterval(int keepAliveInterval)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_keepAliveTimer->setInterval(keepAliveInterval);')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'int %s::keepAliveDeadline() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_keepAliveDeadlineTimer->interval();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setKeepAliveDeadline(int keepAliveDeadline)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_keepAliveDeadlineTimer->setInterval(keepAliveDeadline);')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'uint %s::keepAliveMissedDeadlines() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_keepAliveMissedDeadlines;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setupKeepAlive()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_keepAliveTimer = new QTimer(this);')
+    writeLine(fileDescriptor, '    m_keepAliveTimer->setTimerType(Qt::PreciseTimer);')
+    writeLine(fileDescriptor, '    m_keepAliveTimer->setInterval(%s);' % keepAlive['interval'])
+    writeLine(fileDescriptor, '    connect(m_keepAliveTimer, &QTimer::timeout, this, &%s::requestKeepAlive);' % (className))
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    // Restarted on each successful keep alive, so it only times out if we are late')
+    writeLine(fileDescriptor, '    m_keepAliveDeadlineTimer = new QTimer(this);')
+    writeLine(fileDescriptor, '    m_keepAliveDeadlineTimer->setTimerType(Qt::PreciseTimer);')
+    writeLine(fileDescriptor, '    m_keepAliveDeadlineTimer->setInterval(%s);' % getKeepAliveDeadline(keepAlive))
+    writeLine(fileDescriptor, '    connect(m_keepAliveDeadlineTimer, &QTimer::timeout, this, &%s::onKeepAliveDeadlineExpired);' % (className))
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::evaluateKeepAlive()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (m_keepAliveEnabled && m_reachable) {')
+    writeLine(fileDescriptor, '        if (m_keepAliveTimer->isActive())')
+    writeLine(fileDescriptor, '            return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Start sending keep alive requests every" << m_keepAliveTimer->interval() << "ms";' % (className))
+    writeLine(fileDescriptor, '        m_keepAliveTimestamp = QDateTime::currentMSecsSinceEpoch();')
+    writeLine(fileDescriptor, '        m_keepAliveTimer->start();')
+    writeLine(fileDescriptor, '        m_keepAliveDeadlineTimer->start();')
+    writeLine(fileDescriptor, '        requestKeepAlive();')
+    writeLine(fileDescriptor, '    } else {')
+    writeLine(fileDescriptor, '        if (m_keepAliveTimer->isActive())')
+    writeLine(fileDescriptor, '            qCDebug(dc%s()) << "Stop sending keep alive requests";' % (className))
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        m_keepAliveTimer->stop();')
+    writeLine(fileDescriptor, '        m_keepAliveDeadlineTimer->stop();')
+    writeLine(fileDescriptor, '        m_keepAlivePending = false;')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::requestKeepAlive()' % (className))
+    writeLine(fileDescriptor, '{')
+    if queuedRequests:
+        writeLine(fileDescriptor, '    m_keepAlivePending = true;')
+        writeLine(fileDescriptor, '    sendNextQueuedRequest();')
+    else:
+        writeLine(fileDescriptor, '    sendKeepAlive();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::onKeepAliveDeadlineExpired()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    qint64 elapsed = QDateTime::currentMSecsSinceEpoch() - m_keepAliveTimestamp;')
+    writeLine(fileDescriptor, '    m_keepAliveMissedDeadlines++;')
+    writeLine(fileDescriptor, '    qCWarning(dc%s()) << "Missed keep alive deadline of" << m_keepAliveDeadlineTimer->interval() << "ms. Last successful keep alive" << elapsed << "ms ago. Missed deadlines:" << m_keepAliveMissedDeadlines;' % (className))
+    writeLine(fileDescriptor, '    emit keepAliveDeadlineMissed(elapsed);')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+
+
+def validateStatusProbe(statusProbe, registerJson):
+    for requiredProperty in ['registers', 'interval']:
+        if not requiredProperty in statusProbe:
+            logger.warning('Error: The statusProbe definition requires the \"%s\" property.' % requiredProperty)
+            exit(1)
+
+    if 'queuedRequests' in registerJson and registerJson['queuedRequests']:
+        logger.warning('Error: The statusProbe can not be used together with queuedRequests.')
+        exit(1)
+
+    registerDefinitions = list(registerJson['registers'])
+    if 'blocks' in registerJson:
+        for blockDefinition in registerJson['blocks']:
+            registerDefinitions.extend(blockDefinition['registers'])
+
+    probeRegisters = []
+    for registerId in statusProbe['registers']:
+        probeRegister = None
+        for registerDefinition in registerDefinitions:
+            if registerDefinition['id'] == registerId:
+                probeRegister = registerDefinition
+                break
+
+        if not probeRegister:
+            logger.warning('Error: Could not find the statusProbe register \"%s\". Please make sure it matches the \"id\" of a defined register.' % registerId)
+            exit(1)
+
+        if 'access' in probeRegister and not 'R' in probeRegister['access']:
+            logger.warning('Error: The statusProbe register \"%s\" is not readable.' % registerId)
+            exit(1)
+
+        if probeRegister.get('registerType', 'holdingRegister') not in ['holdingRegister', 'inputRegister']:
+            logger.warning('Error: The statusProbe register \"%s\" must be a holding or input register.' % registerId)
+            exit(1)
+
+        probeRegisters.append(probeRegister)
+
+    if len(probeRegisters) == 0:
+        logger.warning('Error: The statusProbe requires at least one register.')
+        exit(1)
+
+    for probeRegister in probeRegisters:
+        if probeRegister.get('registerType', 'holdingRegister') != probeRegisters[0].get('registerType', 'holdingRegister'):
+            logger.warning('Error: All statusProbe registers must have the same register type.')
+            exit(1)
+
+    probeRegisters.sort(key=lambda registerDefinition: registerDefinition['address'])
+    if getStatusProbeSize(probeRegisters) > 125:
+        logger.warning('Error: The statusProbe registers are too far apart for reading them in one request.')
+        exit(1)
+
+    return probeRegisters
+
+
+def getStatusProbeSize(probeRegisters):
+    return probeRegisters[-1]['address'] + probeRegisters[-1]['size'] - probeRegisters[0]['address']
+
+
+def writeStatusProbeMethodDeclarations(fileDescriptor, statusProbe):
+    writeLine(fileDescriptor, '    /* Status probe: read %s every %s ms and update on change */' % (', '.join(['\"%s\"' % registerId for registerId in statusProbe['registers']]), statusProbe['interval']))
+    writeLine(fileDescriptor, '    bool statusProbeEnabled() const;')
+    writeLine(fileDescriptor, '    void setStatusProbeEnabled(bool statusProbeEnabled);')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    int statusProbeInterval() const;')
+    writeLine(fileDescriptor, '    void setStatusProbeInterval(int statusProbeInterval);')
+    writeLine(fileDescriptor)
+
+
+def writeStatusProbeMemberDeclarations(fileDescriptor, replyType):
+    writeLine(fileDescriptor, '    QTimer *m_statusProbeTimer = nullptr;')
+    writeLine(fileDescriptor, '    bool m_statusProbeEnabled = false;')
+    writeLine(fileDescriptor, '    QVector<quint16> m_statusProbeValues;')
+    writeLine(fileDescriptor, '    %s *m_statusProbeReply = nullptr;' % replyType)
+    writeLine(fileDescriptor, '    void setupStatusProbe();')
+    writeLine(fileDescriptor, '    void evaluateStatusProbe();')
+    writeLine(fileDescriptor, '    void sendStatusProbe();')
+    writeLine(fileDescriptor, '    void processStatusProbeValues(const QVector<quint16> &values);')
+    writeLine(fileDescriptor)
+
+
+def writeStatusProbeMethodImplementations(fileDescriptor, className, statusProbe, probeRegisters):
+    writeLine(fileDescriptor, 'bool %s::statusProbeEnabled() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_statusProbeEnabled;')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setStatusProbeEnabled(bool statusProbeEnabled)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (m_statusProbeEnabled == statusProbeEnabled)')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    m_statusProbeEnabled = statusProbeEnabled;')
+    writeLine(fileDescriptor, '    evaluateStatusProbe();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'int %s::statusProbeInterval() const' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    return m_statusProbeTimer->interval();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setStatusProbeInterval(int statusProbeInterval)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_statusProbeTimer->setInterval(statusProbeInterval);')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::setupStatusProbe()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    m_statusProbeTimer = new QTimer(this);')
+    writeLine(fileDescriptor, '    m_statusProbeTimer->setInterval(%s);' % statusProbe['interval'])
+    writeLine(fileDescriptor, '    connect(m_statusProbeTimer, &QTimer::timeout, this, &%s::sendStatusProbe);' % (className))
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    writeLine(fileDescriptor, 'void %s::evaluateStatusProbe()' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (m_statusProbeEnabled && m_reachable) {')
+    writeLine(fileDescriptor, '        if (m_statusProbeTimer->isActive())')
+    writeLine(fileDescriptor, '            return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Start probing the status registers every" << m_statusProbeTimer->interval() << "ms";' % (className))
+    writeLine(fileDescriptor, '        m_statusProbeTimer->start();')
+    writeLine(fileDescriptor, '    } else {')
+    writeLine(fileDescriptor, '        if (m_statusProbeTimer->isActive())')
+    writeLine(fileDescriptor, '            qCDebug(dc%s()) << "Stop probing the status registers";' % (className))
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '        m_statusProbeTimer->stop();')
+    writeLine(fileDescriptor, '        m_statusProbeValues.clear();')
+    writeLine(fileDescriptor, '    }')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+    startAddress = probeRegisters[0]['address']
+    writeLine(fileDescriptor, 'void %s::processStatusProbeValues(const QVector<quint16> &values)' % (className))
+    writeLine(fileDescriptor, '{')
+    writeLine(fileDescriptor, '    if (values == m_statusProbeValues)')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    // The first probe after becoming reachable only sets the reference, the regular update is running anyways')
+    writeLine(fileDescriptor, '    bool initialProbe = m_statusProbeValues.isEmpty();')
+    writeLine(fileDescriptor, '    m_statusProbeValues = values;')
+    for registerDefinition in probeRegisters:
+        propertyName = registerDefinition['id']
+        writeLine(fileDescriptor, '    process%sRegisterValues(values.mid(%s, %s));' % (propertyName[0].upper() + propertyName[1:], registerDefinition['address'] - startAddress, registerDefinition['size']))
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    if (initialProbe)')
+    writeLine(fileDescriptor, '        return;')
+    writeLine(fileDescriptor)
+    writeLine(fileDescriptor, '    qCDebug(dc%s()) << "Status probe registers changed" << values << "Updating all registers...";' % (className))
+    writeLine(fileDescriptor, '    emit statusProbeChanged();')
+    writeLine(fileDescriptor, '    update();')
+    writeLine(fileDescriptor, '}')
+    writeLine(fileDescriptor)
+
+
+def getSetpointRegisterDefinitions(registerJson):
+    setpointRegisters = []
+    registerDefinitions = list(registerJson['registers'])
+    if 'blocks' in registerJson:
+        for blockDefinition in registerJson['blocks']:
+            registerDefinitions.extend(blockDefinition['registers'])
+
+    for registerDefinition in registerDefinitions:
+        if not 'setpoint' in registerDefinition or not registerDefinition['setpoint']:
+            continue
+
+        if not 'W' in registerDefinition['access']:
+            logger.warning('Error: The setpoint register \"%s\" is not writable.' % registerDefinition['id'])
+            exit(1)
+
+        if 'setpointReadBack' in registerDefinition and registerDefinition['setpointReadBack'] and not 'R' in registerDefinition['access']:
+            logger.warning('Error: The setpoint register \"%s\" can not be read back since it is not readable.' % registerDefinition['id'])
+            exit(1)
+
+        setpointRegisters.append(registerDefinition)
+
+    return setpointRegisters
+
+
+def setpointReadBack(registerDefinition):
+    return 'setpointReadBack' in registerDefinition and registerDefinition['setpointReadBack']
+
+
+def writeSetpointMethodDeclarations(fileDescriptor, setpointRegisters):
+    for registerDefinition in setpointRegisters:
+        propertyName = registerDefinition['id']
+        propertyTyp = getCppDataType(registerDefinition)
+        writeLine(fileDescriptor, '    /* Latest value wins setpoint for \"%s\", finished with %sApplied() or %sApplyFailed() */' % (registerDefinition['description'], propertyName, propertyName))
+        writeLine(fileDescriptor, '    void apply%s(%s %s);' % (propertyName[0].upper() + propertyName[1:], propertyTyp, propertyName))
+        writeLine(fileDescriptor)
+
+
+def writeSetpointSignals(fileDescriptor, setpointRegisters):
+    for registerDefinition in setpointRegisters:
+        propertyName = registerDefinition['id']
+        propertyTyp = getCppDataType(registerDefinition)
+        writeLine(fileDescriptor, '    void %sApplied(%s %s);' % (propertyName, propertyTyp, propertyName))
+        writeLine(fileDescriptor, '    void %sApplyFailed(%s %s);' % (propertyName, propertyTyp, propertyName))
+
+
+def writeSetpointMemberDeclarations(fileDescriptor, setpointRegisters):
+    for registerDefinition in setpointRegisters:
+        propertyName = registerDefinition['id']
+        propertyTyp = getCppDataType(registerDefinition)
+        initialValue = registerDefinition['defaultValue'] if 'defaultValue' in registerDefinition else '%s()' % propertyTyp
+        writeLine(fileDescriptor, '    %s m_%sSetpoint = %s;' % (propertyTyp, propertyName, initialValue))
+        writeLine(fileDescriptor, '    %s m_%sSetpointWritten = %s;' % (propertyTyp, propertyName, initialValue))
+        if setpointReadBack(registerDefinition):
+            writeLine(fileDescriptor, '    QVector<quint16> m_%sSetpointValues;' % (propertyName))
+        writeLine(fileDescriptor, '    bool m_%sSetpointPending = false;' % (propertyName))
+        writeLine(fileDescriptor, '    bool m_%sSetpointRunning = false;' % (propertyName))
+        writeLine(fileDescriptor, '    void send%sSetpoint();' % (propertyName[0].upper() + propertyName[1:]))
+        if setpointReadBack(registerDefinition):
+            writeLine(fileDescriptor, '    void verify%sSetpoint();' % (propertyName[0].upper() + propertyName[1:]))
+        writeLine(fileDescriptor, '    void finish%sSetpoint(bool success);' % (propertyName[0].upper() + propertyName[1:]))
+        writeLine(fileDescriptor)
+
+
+def writeSetpointMethodImplementations(fileDescriptor, className, setpointRegisters):
+    for registerDefinition in setpointRegisters:
+        propertyName = registerDefinition['id']
+        propertyTyp = getCppDataType(registerDefinition)
+        methodName = propertyName[0].upper() + propertyName[1:]
+
+        writeLine(fileDescriptor, 'void %s::apply%s(%s %s)' % (className, methodName, propertyTyp, propertyName))
+        writeLine(fileDescriptor, '{')
+        writeLine(fileDescriptor, '    // Older values not written yet will simply be replaced')
+        writeLine(fileDescriptor, '    m_%sSetpoint = %s;' % (propertyName, propertyName))
+        writeLine(fileDescriptor, '    m_%sSetpointPending = true;' % (propertyName))
+        writeLine(fileDescriptor, '    send%sSetpoint();' % (methodName))
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+        writeLine(fileDescriptor, 'void %s::finish%sSetpoint(bool success)' % (className, methodName))
+        writeLine(fileDescriptor, '{')
+        writeLine(fileDescriptor, '    m_%sSetpointRunning = false;' % (propertyName))
+        writeLine(fileDescriptor, '    if (success) {')
+        writeLine(fileDescriptor, '        qCDebug(dc%s()) << "Setpoint \\"%s\\" applied successfully" << m_%sSetpointWritten;' % (className, registerDefinition['description'], propertyName))
+        writeLine(fileDescriptor, '        emit %sApplied(m_%sSetpointWritten);' % (propertyName, propertyName))
+        writeLine(fileDescriptor, '    } else {')
+        writeLine(fileDescriptor, '        qCWarning(dc%s()) << "Failed to apply setpoint \\"%s\\"" << m_%sSetpointWritten;' % (className, registerDefinition['description'], propertyName))
+        writeLine(fileDescriptor, '        emit %sApplyFailed(m_%sSetpointWritten);' % (propertyName, propertyName))
+        writeLine(fileDescriptor, '    }')
+        writeLine(fileDescriptor)
+        writeLine(fileDescriptor, '    // Write the latest value in case it has been changed in the meantime')
+        writeLine(fileDescriptor, '    send%sSetpoint();' % (methodName))
+        writeLine(fileDescriptor, '}')
+        writeLine(fileDescriptor)
+
+
+def getUpdateDivider(definition):
+    if not 'updateDivider' in definition:
+        return 1
+
+    updateDivider = definition['updateDivider']
+    if not isinstance(updateDivider, int) or updateDivider < 1:
+        logger.warning('Error: The updateDivider of \"%s\" must be an integer greater than 0.' % definition['id'])
+        exit(1)
+
+    return updateDivider
+
+
+def updateDividerUsed(registerDefinitions, blockDefinitions):
+    for definition in registerDefinitions + blockDefinitions:
+        if 'readSchedule' in definition and definition['readSchedule'] == 'update' and getUpdateDivider(definition) > 1:
+            return True
+
+    return False
+
+
+class IndentedWriter():
+    # Writes all lines with additional indentation, i.e. for generating code within an if scope
+    def __init__(self, fileDescriptor, indentation = '    '):
+        self.fileDescriptor = fileDescriptor
+        self.indentation = indentation
+
+    def write(self, text):
+        lines = text.split('\n')
+        self.fileDescriptor.write('\n'.join([(self.indentation + line) if line else line for line in lines]))
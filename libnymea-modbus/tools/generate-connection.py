@@ -40,7 +40,10 @@ def writeTcpHeaderFile():
     writeLine(headerFile, '#ifndef %s_H' % className.upper())
     writeLine(headerFile, '#define %s_H' % className.upper())
     writeLine(headerFile)
+    writeLine(headerFile, '#include <QHash>')
     writeLine(headerFile, '#include <QObject>')
+    if keepAlive or statusProbe:
+        writeLine(headerFile, '#include <QTimer>')
     writeLine(headerFile)
     writeLine(headerFile, '#include <modbusdatautils.h>')
     writeLine(headerFile, '#include <modbustcpmaster.h>')
@@ -62,6 +65,9 @@ def writeTcpHeaderFile():
         for enumDefinition in registerJson['enums']:
             writeEnumDefinition(headerFile, enumDefinition)
 
+    if snapshot:
+        writeSnapshotStructDefinition(headerFile, registerJson, invalidValues)
+
     if queuedRequests:
         writeLine(headerFile, '    typedef void(%s::*Function)(void);' % className)
         writeLine(headerFile)
@@ -93,6 +99,20 @@ def writeTcpHeaderFile():
     writeLine(headerFile, '    void setCheckReachableRetries(uint checkReachableRetries);')
     writeLine(headerFile)
 
+    if snapshot:
+        writeLine(headerFile, '    Snapshot snapshot() const;')
+        writeLine(headerFile)
+
+    writeValidityMethodDeclarations(headerFile, validatedRegisters)
+
+    if keepAlive:
+        writeKeepAliveMethodDeclarations(headerFile, keepAlive)
+
+    if statusProbe:
+        writeStatusProbeMethodDeclarations(headerFile, statusProbe)
+
+    writeSetpointMethodDeclarations(headerFile, setpointRegisters)
+
     # Write registers get method declarations
     writePropertyGetSetMethodDeclarationsTcp(headerFile, registerJson['registers'])
     if 'blocks' in registerJson:
@@ -134,6 +154,13 @@ def writeTcpHeaderFile():
     writeLine(headerFile)
     writeLine(headerFile, '    void initializationFinished(bool success);')
     writeLine(headerFile, '    void updateFinished();')
+    if snapshot:
+        writeLine(headerFile, '    void snapshotUpdated(const Snapshot &snapshot);')
+    if keepAlive:
+        writeLine(headerFile, '    void keepAliveDeadlineMissed(qint64 elapsed);')
+    if statusProbe:
+        writeLine(headerFile, '    void statusProbeChanged();')
+    writeSetpointSignals(headerFile, setpointRegisters)
     writeLine(headerFile)
     writeLine(headerFile, '    void endiannessChanged(ModbusDataUtils::ByteOrder endianness);')
     writeLine(headerFile, '    void stringEndiannessChanged(ModbusDataUtils::ByteOrder stringEndianness);')
@@ -189,8 +216,14 @@ def writeTcpHeaderFile():
     writeLine(headerFile, '    quint8 m_communicationFailedCounter = 0;')
     writeLine(headerFile)
     writeLine(headerFile, '    QVector<QModbusReply *> m_pendingInitReplies;')
-    writeLine(headerFile, '    QVector<QModbusReply *> m_pendingUpdateReplies;')
     writeLine(headerFile)
+    if not queuedRequests:
+        blocks = []
+        if 'blocks' in registerJson:
+            blocks = registerJson['blocks']
+
+        writeUpdateDispatcherDeclarationsTcp(headerFile, className, getUpdateRequestsTcp(className, registerJson['registers'], blocks))
+
     writeLine(headerFile, '    QObject *m_initObject = nullptr;')
     writeLine(headerFile, '    bool verifyInitFinished();')
     writeLine(headerFile, '    void finishInitialization(bool success);')
@@ -199,7 +232,18 @@ def writeTcpHeaderFile():
     writeLine(headerFile, '    void setupConnection();')
     writeLine(headerFile)
     writeLine(headerFile, '    bool verifyUpdateFinished();')
+    if snapshot:
+        writeLine(headerFile, '    qint64 m_snapshotTimestamp = 0;')
     writeLine(headerFile)
+    writeValidityMemberDeclarations(headerFile, validatedRegisters)
+    if keepAlive:
+        writeKeepAliveMemberDeclarations(headerFile, keepAlive, 'QModbusReply')
+
+    if statusProbe:
+        writeStatusProbeMemberDeclarations(headerFile, 'QModbusReply')
+
+    writeSetpointMemberDeclarations(headerFile, setpointRegisters)
+
     writeLine(headerFile, '    void onReachabilityCheckFailed();')
     writeLine(headerFile, '    void evaluateReachableState();')
 
@@ -210,10 +254,20 @@ def writeTcpHeaderFile():
         writeLine(headerFile, '    void sendNextQueuedRequest();')
         writeLine(headerFile, '    void enqueueRequest(%s::Function function);' % (className))
 
+    if priorityRequests:
+        writeLine(headerFile)
+        writeLine(headerFile, '    bool m_priorityRequestScheduled = false;')
+        writeLine(headerFile, '    bool sendPriorityRequest();')
+        writeLine(headerFile, '    void schedulePriorityRequest();')
+
     # End of class
     writeLine(headerFile)
     writeLine(headerFile, '};')
     writeLine(headerFile)
+    if snapshot:
+        writeLine(headerFile, 'Q_DECLARE_METATYPE(%s::Snapshot)' % className)
+        writeLine(headerFile)
+
     writeLine(headerFile, 'QDebug operator<<(QDebug debug, %s *%s);' % (className, className[0].lower() + className[1:]))
     writeLine(headerFile)
     writeLine(headerFile, '#endif // %s_H' % className.upper())
@@ -231,6 +285,8 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '#include <loggingcategories.h>')
     writeLine(sourceFile, '#include <math.h>')
     writeLine(sourceFile, '#include <QTimer>')
+    if snapshot or keepAlive:
+        writeLine(sourceFile, '#include <QDateTime>')
     writeLine(sourceFile, '#include <QModbusDevice>')
     writeLine(sourceFile, '#include <QModbusResponse>')
     writeLine(sourceFile)
@@ -339,8 +395,14 @@ def writeTcpSourceFile():
     if 'blocks' in registerJson:
         blocks = registerJson['blocks']
 
+    # Without queued requests the update replies are tracked by the update dispatcher
+    updateRequests = []
+    if not queuedRequests:
+        updateRequests = getUpdateRequestsTcp(className, registerJson['registers'], blocks)
+
     writeInitMethodImplementationTcp(sourceFile, className, registerJson['registers'], blocks, queuedRequests)
-    writeUpdateMethodTcp(sourceFile, className, registerJson['registers'], blocks, queuedRequests)
+    writeUpdateMethodTcp(sourceFile, className, registerJson['registers'], blocks, queuedRequests, keepAlive)
+    writeUpdateDispatcherImplementationsTcp(sourceFile, className, updateRequests)
 
     writeLine(sourceFile, 'bool %s::connectDevice()' % (className))
     writeLine(sourceFile, '{')
@@ -378,10 +440,10 @@ def writeTcpSourceFile():
         writeInternalBlockReadMethodImplementationsTcp(sourceFile, className, registerJson['blocks'])
 
     # Write internal processors of properties
-    writePropertyProcessMethodImplementations(sourceFile, className, registerJson['registers'])
+    writePropertyProcessMethodImplementations(sourceFile, className, registerJson['registers'], invalidValues)
     if 'blocks' in registerJson:
         for blockDefinition in registerJson['blocks']:
-            writePropertyProcessMethodImplementations(sourceFile, className, blockDefinition['registers'])
+            writePropertyProcessMethodImplementations(sourceFile, className, blockDefinition['registers'], invalidValues)
 
     writeLine(sourceFile, 'void %s::handleModbusError(QModbusDevice::Error error)' % (className))
     writeLine(sourceFile, '{')
@@ -449,15 +511,22 @@ def writeTcpSourceFile():
 
     writeLine(sourceFile, 'void %s::setupConnection()' % (className))
     writeLine(sourceFile, '{')
+    if keepAlive:
+        writeLine(sourceFile, '    setupKeepAlive();')
+        writeLine(sourceFile)
+    if statusProbe:
+        writeLine(sourceFile, '    setupStatusProbe();')
+        writeLine(sourceFile)
     writeLine(sourceFile, '    connect(m_modbusTcpMaster, &ModbusTcpMaster::connectionStateChanged, this, [this](bool status){')
     writeLine(sourceFile, '        if (status) {')
     writeLine(sourceFile, '           qCDebug(dc%s()) << "Modbus TCP connection" << m_modbusTcpMaster->hostAddress().toString() << "connected. Start testing if the connection is reachable...";' % (className))
     writeLine(sourceFile, '            // Cleanup before starting to initialize')
     writeLine(sourceFile, '            m_pendingInitReplies.clear();')
-    writeLine(sourceFile, '            m_pendingUpdateReplies.clear();')
     if queuedRequests:
         writeLine(sourceFile, '            m_updateRequestQueue.clear();')
         writeLine(sourceFile, '            m_initRequestQueue.clear();')
+    elif updateRequests:
+        writeLine(sourceFile, '            m_updateRequestReplies.clear();')
 
     writeLine(sourceFile, '            m_communicationWorking = false;')
     writeLine(sourceFile, '            m_communicationFailedCounter = 0;')
@@ -481,18 +550,45 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
+    if snapshot:
+        writeSnapshotMethodImplementation(sourceFile, className, registerJson, invalidValues)
+
+    writeValidityMethodImplementations(sourceFile, className, validatedRegisters)
+
+    if keepAlive:
+        writeKeepAliveMethodImplementations(sourceFile, className, keepAlive, queuedRequests)
+        writeKeepAliveSendMethodImplementationTcp(sourceFile, className, keepAlive, queuedRequests, queuedRequestsDelay)
+
+    if statusProbe:
+        writeStatusProbeMethodImplementations(sourceFile, className, statusProbe, statusProbeRegisters)
+        writeStatusProbeSendMethodImplementationTcp(sourceFile, className, statusProbeRegisters, updateRequests)
+
+    writeSetpointMethodImplementations(sourceFile, className, setpointRegisters)
+    writeSetpointSendMethodImplementationsTcp(sourceFile, className, setpointRegisters)
+    if priorityRequests:
+        writePriorityRequestMethodImplementationsTcp(sourceFile, className, queuedRequestsDelay)
+
     writeLine(sourceFile, 'bool %s::verifyUpdateFinished()' % (className))
     writeLine(sourceFile, '{')
-    if queuedRequests:
-        writeLine(sourceFile, '    if (m_updateRequestQueue.isEmpty() && !m_currentUpdateReply) {')
-        writeLine(sourceFile, '        emit updateFinished();')
-        writeLine(sourceFile, '        return true;')
+    if not queuedRequests and not updateRequests:
+        # No update requests, so there is nothing to wait for
+        if snapshot:
+            writeLine(sourceFile, '    m_snapshotTimestamp = QDateTime::currentMSecsSinceEpoch();')
+            writeLine(sourceFile, '    emit snapshotUpdated(snapshot());')
+        writeLine(sourceFile, '    emit updateFinished();')
+        writeLine(sourceFile, '    return true;')
     else:
-        writeLine(sourceFile, '    if (m_pendingUpdateReplies.isEmpty()) {')
+        if queuedRequests:
+            writeLine(sourceFile, '    if (m_updateRequestQueue.isEmpty() && !m_currentUpdateReply) {')
+        else:
+            writeLine(sourceFile, '    if (m_updateRequestReplies.isEmpty()) {')
+        if snapshot:
+            writeLine(sourceFile, '        m_snapshotTimestamp = QDateTime::currentMSecsSinceEpoch();')
+            writeLine(sourceFile, '        emit snapshotUpdated(snapshot());')
         writeLine(sourceFile, '        emit updateFinished();')
         writeLine(sourceFile, '        return true;')
-    writeLine(sourceFile, '    }')
-    writeLine(sourceFile, '    return false;')
+        writeLine(sourceFile, '    }')
+        writeLine(sourceFile, '    return false;')
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
@@ -518,15 +614,19 @@ def writeTcpSourceFile():
     writeLine(sourceFile, '        return;')
     writeLine(sourceFile)
     writeLine(sourceFile, '    m_reachable = reachable;')
+    if keepAlive:
+        writeLine(sourceFile, '    evaluateKeepAlive();')
+    if statusProbe:
+        writeLine(sourceFile, '    evaluateStatusProbe();')
     writeLine(sourceFile, '    emit reachableChanged(m_reachable);')
     writeLine(sourceFile, '    m_checkReachableRetriesCount = 0;')
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
     if queuedRequests:
-        writeSendNextQueuedInitRequestMethodImplementation(sourceFile, className)
+        writeSendNextQueuedInitRequestMethodImplementation(sourceFile, className, priorityRequests)
         writeEnqueueInitRequestMethodImplementation(sourceFile, className)
-        writeSendNextQueuedRequestMethodImplementation(sourceFile, className)
+        writeSendNextQueuedRequestMethodImplementation(sourceFile, className, priorityRequests)
         writeEnqueueRequestMethodImplementation(sourceFile, className)
 
     # Write the debug print
@@ -556,6 +656,8 @@ def writeRtuHeaderFile():
     writeLine(headerFile, '#define %s_H' % className.upper())
     writeLine(headerFile)
     writeLine(headerFile, '#include <QObject>')
+    if keepAlive:
+        writeLine(headerFile, '#include <QTimer>')
     writeLine(headerFile)
     writeLine(headerFile, '#include <modbusdatautils.h>')
     writeLine(headerFile, '#include <hardware/modbus/modbusrtumaster.h>')
@@ -578,6 +680,9 @@ def writeRtuHeaderFile():
         for enumDefinition in registerJson['enums']:
             writeEnumDefinition(headerFile, enumDefinition)
 
+    if snapshot:
+        writeSnapshotStructDefinition(headerFile, registerJson, invalidValues)
+
     # Constructor
     writeLine(headerFile, '    explicit %s(ModbusRtuMaster *modbusRtuMaster, quint16 slaveId, QObject *parent = nullptr);' % className)
     writeLine(headerFile, '    ~%s() = default;' % className)
@@ -590,6 +695,17 @@ def writeRtuHeaderFile():
     writeLine(headerFile, '    uint checkReachableRetries() const;')
     writeLine(headerFile, '    void setCheckReachableRetries(uint checkReachableRetries);')
     writeLine(headerFile)
+
+    if snapshot:
+        writeLine(headerFile, '    Snapshot snapshot() const;')
+        writeLine(headerFile)
+
+    writeValidityMethodDeclarations(headerFile, validatedRegisters)
+
+    if keepAlive:
+        writeKeepAliveMethodDeclarations(headerFile, keepAlive)
+
+    writeSetpointMethodDeclarations(headerFile, setpointRegisters)
     writeLine(headerFile, '    ModbusDataUtils::ByteOrder endianness() const;')
     writeLine(headerFile, '    void setEndianness(ModbusDataUtils::ByteOrder endianness);')
     writeLine(headerFile)
@@ -635,6 +751,11 @@ def writeRtuHeaderFile():
     writeLine(headerFile)
     writeLine(headerFile, '    void initializationFinished(bool success);')
     writeLine(headerFile, '    void updateFinished();')
+    if snapshot:
+        writeLine(headerFile, '    void snapshotUpdated(const Snapshot &snapshot);')
+    if keepAlive:
+        writeLine(headerFile, '    void keepAliveDeadlineMissed(qint64 elapsed);')
+    writeSetpointSignals(headerFile, setpointRegisters)
     writeLine(headerFile)
     writeLine(headerFile, '    void endiannessChanged(ModbusDataUtils::ByteOrder endianness);')
     writeLine(headerFile, '    void stringEndiannessChanged(ModbusDataUtils::ByteOrder stringEndianness);')
@@ -683,13 +804,23 @@ def writeRtuHeaderFile():
     writeLine(headerFile)
     writeLine(headerFile, '    QVector<ModbusRtuReply *> m_pendingInitReplies;')
     writeLine(headerFile, '    QVector<ModbusRtuReply *> m_pendingUpdateReplies;')
+    if updateDividerUsed(registerJson['registers'], registerJson.get('blocks', [])):
+        writeLine(headerFile, '    quint32 m_updateCycle = 0;')
     writeLine(headerFile)
     writeLine(headerFile, '    QObject *m_initObject = nullptr;')
     writeLine(headerFile, '    void verifyInitFinished();')
     writeLine(headerFile, '    void finishInitialization(bool success);')
     writeLine(headerFile)
     writeLine(headerFile, '    bool verifyUpdateFinished();')
+    if snapshot:
+        writeLine(headerFile, '    qint64 m_snapshotTimestamp = 0;')
     writeLine(headerFile)
+    writeValidityMemberDeclarations(headerFile, validatedRegisters)
+    if keepAlive:
+        writeKeepAliveMemberDeclarations(headerFile, keepAlive, 'ModbusRtuReply')
+
+    writeSetpointMemberDeclarations(headerFile, setpointRegisters)
+
     writeLine(headerFile, '    void onReachabilityCheckFailed();')
     writeLine(headerFile, '    void evaluateReachableState();')
 
@@ -698,6 +829,10 @@ def writeRtuHeaderFile():
     writeLine(headerFile)
     writeLine(headerFile, '};')
     writeLine(headerFile)
+    if snapshot:
+        writeLine(headerFile, 'Q_DECLARE_METATYPE(%s::Snapshot)' % className)
+        writeLine(headerFile)
+
     writeLine(headerFile, 'QDebug operator<<(QDebug debug, %s *%s);' % (className, className[0].lower() + className[1:]))
     writeLine(headerFile)
     writeLine(headerFile, '#endif // %s_H' % className.upper())
@@ -715,6 +850,8 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '#include <loggingcategories.h>')
     writeLine(sourceFile, '#include <math.h>')
     writeLine(sourceFile, '#include <QTimer>')
+    if snapshot or keepAlive:
+        writeLine(sourceFile, '#include <QDateTime>')
     writeLine(sourceFile)
     writeLine(sourceFile, 'NYMEA_LOGGING_CATEGORY(dc%s, "%s")' % (className, className))
     writeLine(sourceFile)
@@ -725,6 +862,9 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '    m_modbusRtuMaster(modbusRtuMaster),')
     writeLine(sourceFile, '    m_slaveId(slaveId)')
     writeLine(sourceFile, '{')
+    if keepAlive:
+        writeLine(sourceFile, '    setupKeepAlive();')
+        writeLine(sourceFile)
     writeLine(sourceFile, '    connect(m_modbusRtuMaster, &ModbusRtuMaster::connectedChanged, this, [=](bool connected){')
     writeLine(sourceFile, '        if (connected) {')
     writeLine(sourceFile, '            qCDebug(dc%s()) << "Modbus RTU resource" << m_modbusRtuMaster->serialPort() << "connected again. Start testing if the connection is reachable...";' % (className))
@@ -848,10 +988,10 @@ def writeRtuSourceFile():
         writeInternalBlockReadMethodImplementationsRtu(sourceFile, className, registerJson['blocks'])
 
     # Write internal processors of properties
-    writePropertyProcessMethodImplementations(sourceFile, className, registerJson['registers'])
+    writePropertyProcessMethodImplementations(sourceFile, className, registerJson['registers'], invalidValues)
     if 'blocks' in registerJson:
         for blockDefinition in registerJson['blocks']:
-            writePropertyProcessMethodImplementations(sourceFile, className, blockDefinition['registers'])
+            writePropertyProcessMethodImplementations(sourceFile, className, blockDefinition['registers'], invalidValues)
 
 
     writeLine(sourceFile, 'void %s::handleModbusError(ModbusRtuReply::Error error)' % (className))
@@ -911,9 +1051,24 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '}')
     writeLine(sourceFile)
 
+    if snapshot:
+        writeSnapshotMethodImplementation(sourceFile, className, registerJson, invalidValues)
+
+    writeValidityMethodImplementations(sourceFile, className, validatedRegisters)
+
+    if keepAlive:
+        writeKeepAliveMethodImplementations(sourceFile, className, keepAlive)
+        writeKeepAliveSendMethodImplementationRtu(sourceFile, className, keepAlive)
+
+    writeSetpointMethodImplementations(sourceFile, className, setpointRegisters)
+    writeSetpointSendMethodImplementationsRtu(sourceFile, className, setpointRegisters)
+
     writeLine(sourceFile, 'bool %s::verifyUpdateFinished()' % (className))
     writeLine(sourceFile, '{')
     writeLine(sourceFile, '    if (m_pendingUpdateReplies.isEmpty()) {')
+    if snapshot:
+        writeLine(sourceFile, '        m_snapshotTimestamp = QDateTime::currentMSecsSinceEpoch();')
+        writeLine(sourceFile, '        emit snapshotUpdated(snapshot());')
     writeLine(sourceFile, '        emit updateFinished();')
     writeLine(sourceFile, '        return true;')
     writeLine(sourceFile, '    }')
@@ -943,6 +1098,8 @@ def writeRtuSourceFile():
     writeLine(sourceFile, '        return;')
     writeLine(sourceFile)
     writeLine(sourceFile, '    m_reachable = reachable;')
+    if keepAlive:
+        writeLine(sourceFile, '    evaluateKeepAlive();')
     writeLine(sourceFile, '    emit reachableChanged(m_reachable);')
     writeLine(sourceFile, '    m_checkReachableRetriesCount = 0;')
     writeLine(sourceFile, '}')
@@ -1064,6 +1221,35 @@ if 'queuedRequests' in registerJson:
 if 'queuedRequestsDelay' in registerJson:
     queuedRequestsDelay = registerJson['queuedRequestsDelay']
 
+snapshot = False
+if 'snapshot' in registerJson:
+    snapshot = registerJson['snapshot']
+
+keepAlive = None
+if 'keepAlive' in registerJson:
+    keepAlive = registerJson['keepAlive']
+    validateKeepAlive(keepAlive, registerJson)
+
+statusProbe = None
+statusProbeRegisters = []
+if 'statusProbe' in registerJson:
+    statusProbe = registerJson['statusProbe']
+    statusProbeRegisters = validateStatusProbe(statusProbe, registerJson)
+
+setpointRegisters = getSetpointRegisterDefinitions(registerJson)
+if queuedRequests and len(setpointRegisters) > 0:
+    logger.warning('Error: Setpoint registers are not supported in combination with queued requests.')
+    exit(1)
+
+invalidValues = None
+if 'invalidValues' in registerJson:
+    invalidValues = registerJson['invalidValues']
+
+validatedRegisters = getValidatedRegisterDefinitions(registerJson, invalidValues)
+
+# Keep alive requests have to bypass the request queue
+priorityRequests = queuedRequests and keepAlive is not None
+
 # Inform about parsed and validated configs if debugging enabled
 logger.debug('Script path: %s' % scriptPath)
 logger.debug('Output directory: %s' % outputDirectory)
@@ -1072,6 +1258,14 @@ logger.debug('Endianness: %s' % endianness)
 logger.debug('String endianness: %s' % stringEndianness)
 logger.debug('Queued requests: %s' % queuedRequests)
 logger.debug('Queued requests delay: %s ms' % queuedRequestsDelay)
+logger.debug('Snapshot: %s' % snapshot)
+logger.debug('Invalid values: %s' % invalidValues)
+if statusProbe:
+    logger.debug('Status probe: %s every %s ms' % (', '.join(statusProbe['registers']), statusProbe['interval']))
+if keepAlive:
+    logger.debug('Keep alive: %s = %s every %s ms, deadline %s ms' % (keepAlive['register'], keepAlive['value'], keepAlive['interval'], getKeepAliveDeadline(keepAlive)))
+for registerDefinition in setpointRegisters:
+    logger.debug('Setpoint: %s (read back: %s)' % (registerDefinition['id'], setpointReadBack(registerDefinition)))
 
 logger.debug('Error limit until not reachable: %s' % errorLimitUntilNotReachable)
 logger.debug('Check reachable register: %s' % checkReachableRegister['id'])
@@ -1087,6 +1281,10 @@ if 'blocks' in registerJson:
 # Create classes depending on the protocol
 writeTcp = protocol in ["TCP", "BOTH"]
 writeRtu = protocol in ["RTU", "BOTH"]
+if statusProbe and writeRtu:
+    logger.info('The statusProbe is only available for modbus TCP connections and will be ignored for RTU.')
+if writeTcp and updateDividerUsed(registerJson['registers'], registerJson.get('blocks', [])):
+    logger.info('The updateDivider is only available for modbus RTU connections and will be ignored for TCP.')
 if not writeTcp and not writeRtu:
     logger.warning('Error: Invalid protocol definition. Please use TCP, RTU or BOTH in the register JSON file.')
     exit(1)
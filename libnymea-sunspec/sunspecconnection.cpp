@@ -128,6 +128,11 @@ bool SunSpecConnection::discoveryRunning() const
     return m_discoveryRunning;
 }
 
+bool SunSpecConnection::discoveryInconclusive() const
+{
+    return m_discoveryInconclusive;
+}
+
 bool SunSpecConnection::connectDevice()
 {
     m_modbusTcpClient->setConnectionParameter(QModbusDevice::NetworkPortParameter, m_port);
@@ -204,6 +209,7 @@ bool SunSpecConnection::startDiscovery()
 
     qCDebug(dcSunSpec()) << "Starting SunSpec discovery on" << this;
     m_modelDiscoveryResult.clear();
+    m_discoveryInconclusive = false;
     setDiscoveryRunning(true);
     if (!scanSunspecBaseRegister(m_baseRegisterQueue.dequeue())) {
         setDiscoveryRunning(false);
@@ -402,6 +408,10 @@ bool SunSpecConnection::scanSunspecBaseRegister(quint16 baseRegister)
             }
         } else {
             qCDebug(dcSunSpec()) << "Base register" << baseRegister << "not found on" << this;
+            // Only an exception reply tells us for sure there is nothing
+            if (reply->error() != QModbusDevice::ProtocolError)
+                m_discoveryInconclusive = true;
+
             scanNextSunspecBaseRegister();
         }
     });
@@ -471,6 +481,7 @@ void SunSpecConnection::scanModelsOnBaseRegister(quint16 offset)
                 qCDebug(dcSunSpec()) << "Scan for SunSpec models on" << this << m_baseRegister << "finished successfully";
                 processDiscoveryResult();
             } else {
+                m_discoveryInconclusive = true;
                 setDiscoveryRunning(false);
                 emit discoveryFinished(false);
             }
@@ -73,6 +73,9 @@ public:
     bool connected() const;
     bool discoveryRunning() const;
 
+    // True if the last discovery failed due to timeouts or errors instead of a definitive answer from the device
+    bool discoveryInconclusive() const;
+
     quint16 baseRegister() const;
 
     QList<SunSpecModel *> models() const;
@@ -113,6 +116,7 @@ private:
     } ModuleDiscoveryResult;
 
     bool m_discoveryRunning = false;
+    bool m_discoveryInconclusive = false;
     QList<ModuleDiscoveryResult> m_modelDiscoveryResult;
     QList<SunSpecModel *> m_models;
     QList<SunSpecModel *> m_uninitializedModels;
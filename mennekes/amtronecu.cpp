@@ -191,419 +191,42 @@ bool AmtronECU::update()
     if (!m_modbusTcpMaster->connected())
         return false;
 
-    if (!m_pendingUpdateReplies.isEmpty()) {
+    if (!m_updateRequestReplies.isEmpty()) {
         qCDebug(dcAmtronECUModbusTcpConnection()) << "Tried to update but there are still some update replies pending. Waiting for them to be finished...";
         return true;
     }
 
     // First update common registers
-    // Then update registers only available for > 5.22
-
-    QModbusReply *reply = nullptr;
-
-    // Read CP signal state
-    qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read \"CP signal state\" register:" << 122 << "size:" << 1;
-    reply = readCpSignalState();
-    if (!reply) {
-        qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading \"CP signal state\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();
+    if (!sendUpdateRequest(UpdateRequestCpSignalState))
         return false;
-    }
 
-    if (reply->isFinished()) {
-        reply->deleteLater(); // Broadcast reply returns immediatly
+    if (!sendUpdateRequest(UpdateRequestSignalledCurrent))
         return false;
-    }
-
-    m_pendingUpdateReplies.append(reply);
-    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-    connect(reply, &QModbusReply::finished, this, [this, reply](){
-        m_pendingUpdateReplies.removeAll(reply);
-        handleModbusError(reply->error());
-        if (reply->error() != QModbusDevice::NoError) {
-            verifyUpdateFinished();
-            return;
-        }
-
-        const QModbusDataUnit unit = reply->result();
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from \"CP signal state\" register" << 122 << "size:" << 1 << unit.values();
-        if (unit.values().size() == 1) {
-            processCpSignalStateRegisterValues(unit.values());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"CP signal state\" registers" << 122 << "size:" << 1 << "returned different size than requested. Ignoring incomplete data" << unit.values();
-        }
-        verifyUpdateFinished();
-    });
-
-    connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-        QModbusResponse response = reply->rawResult();
-        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"CP signal state\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"CP signal state\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();
-        }
-    });
-
 
-    // Read Signalled current to EV
-    qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read \"Signalled current to EV\" register:" << 706 << "size:" << 1;
-    reply = readSignalledCurrent();
-    if (!reply) {
-        qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading \"Signalled current to EV\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();
+    if (!sendUpdateRequest(UpdateRequestMinCurrentLimit))
         return false;
-    }
 
-    if (reply->isFinished()) {
-        reply->deleteLater(); // Broadcast reply returns immediatly
+    if (!sendUpdateRequest(UpdateRequestBlockConsumptions))
         return false;
-    }
-
-    m_pendingUpdateReplies.append(reply);
-    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-    connect(reply, &QModbusReply::finished, this, [this, reply](){
-        m_pendingUpdateReplies.removeAll(reply);
-        handleModbusError(reply->error());
-        if (reply->error() != QModbusDevice::NoError) {
-            verifyUpdateFinished();
-            return;
-        }
-
-        const QModbusDataUnit unit = reply->result();
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from \"Signalled current to EV\" register" << 706 << "size:" << 1 << unit.values();
-        if (unit.values().size() == 1) {
-            processSignalledCurrentRegisterValues(unit.values());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"Signalled current to EV\" registers" << 706 << "size:" << 1 << "returned different size than requested. Ignoring incomplete data" << unit.values();
-        }
-        verifyUpdateFinished();
-    });
 
-    connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-        QModbusResponse response = reply->rawResult();
-        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Signalled current to EV\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Signalled current to EV\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();
-        }
-    });
-
-    // Read Minimum current limit
-    qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read \"Minimum current limit\" register:" << 712 << "size:" << 1;
-    reply = readMinCurrentLimit();
-    if (!reply) {
-        qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading \"Minimum current limit\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();
+    if (!sendUpdateRequest(UpdateRequestCpAvailability))
         return false;
-    }
 
-    if (reply->isFinished()) {
-        reply->deleteLater(); // Broadcast reply returns immediatly
+    if (!sendUpdateRequest(UpdateRequestHemsCurrentLimit))
         return false;
-    }
-
-    m_pendingUpdateReplies.append(reply);
-    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-    connect(reply, &QModbusReply::finished, this, [this, reply](){
-        m_pendingUpdateReplies.removeAll(reply);
-        handleModbusError(reply->error());
-        if (reply->error() != QModbusDevice::NoError) {
-            verifyUpdateFinished();
-            return;
-        }
-
-        const QModbusDataUnit unit = reply->result();
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from \"Minimum current limit\" register" << 712 << "size:" << 1 << unit.values();
-        if (unit.values().size() == 1) {
-            processMinCurrentLimitRegisterValues(unit.values());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"Minimum current limit\" registers" << 712 << "size:" << 1 << "returned different size than requested. Ignoring incomplete data" << unit.values();
-        }
-        verifyUpdateFinished();
-    });
-
-    connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-        QModbusResponse response = reply->rawResult();
-        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Minimum current limit\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Minimum current limit\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();
-        }
-    });
-
 
-    // Read consumptions
-    reply = readBlockConsumptions();
-    qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read block \"consumptions\" registers from:" << 200 << "size:" << 18;
-    if (!reply) {
-        qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading block \"consumptions\" registers";
-        return false;
-    }
-
-    if (reply->isFinished()) {
-        reply->deleteLater(); // Broadcast reply returns immediatly
-        return false;
-    }
-
-    m_pendingUpdateReplies.append(reply);
-    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-    connect(reply, &QModbusReply::finished, this, [this, reply](){
-        m_pendingUpdateReplies.removeAll(reply);
-        handleModbusError(reply->error());
-        if (reply->error() != QModbusDevice::NoError) {
-            verifyUpdateFinished();
-            return;
-        }
-
-        const QModbusDataUnit unit = reply->result();
-        const QVector<quint16> blockValues = unit.values();
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from reading block \"consumptions\" register" << 200 << "size:" << 18 << blockValues;
-        if (blockValues.size() == 18) {
-            processMeterEnergyL1RegisterValues(blockValues.mid(0, 2));
-            processMeterEnergyL2RegisterValues(blockValues.mid(2, 2));
-            processMeterEnergyL3RegisterValues(blockValues.mid(4, 2));
-            processMeterPowerL1RegisterValues(blockValues.mid(6, 2));
-            processMeterPowerL2RegisterValues(blockValues.mid(8, 2));
-            processMeterPowerL3RegisterValues(blockValues.mid(10, 2));
-            processMeterCurrentL1RegisterValues(blockValues.mid(12, 2));
-            processMeterCurrentL2RegisterValues(blockValues.mid(14, 2));
-            processMeterCurrentL3RegisterValues(blockValues.mid(16, 2));
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"consumptions\" block registers" << 200 << "size:" << 18 << "returned different size than requested. Ignoring incomplete data" << blockValues;
-        }
-        verifyUpdateFinished();
-    });
-
-    connect(reply, &QModbusReply::errorOccurred, this, [reply] (QModbusDevice::Error error){
-        QModbusResponse response = reply->rawResult();
-        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while updating block \"consumptions\" registers" << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while updating block \"consumptions\" registers" << error << reply->errorString();
-        }
-    });
-
-
-    // Read Charge Point availability ( Version < 5.22: 0 available, 1 unavailable | Version >= 5.22 1 available, 0 unavailable )
-    qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read \"Charge Point availability ( Version < 5.22: 0 available, 1 unavailable | Version >= 5.22 1 available, 0 unavailable )\" register:" << 124 << "size:" << 1;
-    reply = readCpAvailability();
-    if (!reply) {
-        qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading \"Charge Point availability ( Version < 5.22: 0 available, 1 unavailable | Version >= 5.22 1 available, 0 unavailable )\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();
-        return false;
-    }
-
-    if (reply->isFinished()) {
-        reply->deleteLater(); // Broadcast reply returns immediatly
-        return false;
-    }
-
-    m_pendingUpdateReplies.append(reply);
-    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-    connect(reply, &QModbusReply::finished, this, [this, reply](){
-        m_pendingUpdateReplies.removeAll(reply);
-        handleModbusError(reply->error());
-        if (reply->error() != QModbusDevice::NoError) {
-            verifyUpdateFinished();
-            return;
-        }
-
-        const QModbusDataUnit unit = reply->result();
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from \"Charge Point availability ( Version < 5.22: 0 available, 1 unavailable | Version >= 5.22 1 available, 0 unavailable )\" register" << 124 << "size:" << 1 << unit.values();
-        if (unit.values().size() == 1) {
-            processCpAvailabilityRegisterValues(unit.values());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"Charge Point availability ( Version < 5.22: 0 available, 1 unavailable | Version >= 5.22 1 available, 0 unavailable )\" registers" << 124 << "size:" << 1 << "returned different size than requested. Ignoring incomplete data" << unit.values();
-        }
-        verifyUpdateFinished();
-    });
-
-    connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-        QModbusResponse response = reply->rawResult();
-        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Charge Point availability ( Version < 5.22: 0 available, 1 unavailable | Version >= 5.22 1 available, 0 unavailable )\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Charge Point availability ( Version < 5.22: 0 available, 1 unavailable | Version >= 5.22 1 available, 0 unavailable )\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();
-        }
-    });
-
-
-
-    // Read HEMS current limit
-    qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read \"HEMS current limit\" register:" << 1000 << "size:" << 1;
-    reply = readHemsCurrentLimit();
-    if (!reply) {
-        qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading \"HEMS current limit\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();
-        return false;
-    }
-
-    if (reply->isFinished()) {
-        reply->deleteLater(); // Broadcast reply returns immediatly
-        return false;
-    }
-
-    m_pendingUpdateReplies.append(reply);
-    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-    connect(reply, &QModbusReply::finished, this, [this, reply](){
-        m_pendingUpdateReplies.removeAll(reply);
-        handleModbusError(reply->error());
-        if (reply->error() != QModbusDevice::NoError) {
-            verifyUpdateFinished();
-            return;
-        }
-
-        const QModbusDataUnit unit = reply->result();
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from \"HEMS current limit\" register" << 1000 << "size:" << 1 << unit.values();
-        if (unit.values().size() == 1) {
-            processHemsCurrentLimitRegisterValues(unit.values());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"HEMS current limit\" registers" << 1000 << "size:" << 1 << "returned different size than requested. Ignoring incomplete data" << unit.values();
-        }
-        verifyUpdateFinished();
-    });
-
-    connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-        QModbusResponse response = reply->rawResult();
-        if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"HEMS current limit\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-        } else {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"HEMS current limit\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();
-        }
-    });
-
-
-
-    // Only available on >= 5.22
+    // Then update registers only available for > 5.22
     if (m_detectedVersion == VersionNew) {
-
-        // Read Maximum current limit (>= 5.22)
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read \"Maximum current limit (>= 5.22)\" register:" << 715 << "size:" << 1;
-        reply = readMaxCurrentLimit();
-        if (!reply) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading \"Maximum current limit (>= 5.22)\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();
+        if (!sendUpdateRequest(UpdateRequestMaxCurrentLimit))
             return false;
-        }
 
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
+        if (!sendUpdateRequest(UpdateRequestChargedEnergy))
             return false;
-        }
-
-        m_pendingUpdateReplies.append(reply);
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            m_pendingUpdateReplies.removeAll(reply);
-            handleModbusError(reply->error());
-            if (reply->error() != QModbusDevice::NoError) {
-                verifyUpdateFinished();
-                return;
-            }
-
-            const QModbusDataUnit unit = reply->result();
-            qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from \"Maximum current limit (>= 5.22)\" register" << 715 << "size:" << 1 << unit.values();
-            if (unit.values().size() == 1) {
-                processMaxCurrentLimitRegisterValues(unit.values());
-            } else {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"Maximum current limit (>= 5.22)\" registers" << 715 << "size:" << 1 << "returned different size than requested. Ignoring incomplete data" << unit.values();
-            }
-            verifyUpdateFinished();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            QModbusResponse response = reply->rawResult();
-            if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Maximum current limit (>= 5.22)\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-            } else {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Maximum current limit (>= 5.22)\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();
-            }
-        });
 
-        // Read Charged energy for current session (>= 5.22)
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read \"Charged energy for current session (>= 5.22)\" register:" << 716 << "size:" << 2;
-        reply = readChargedEnergy();
-        if (!reply) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading \"Charged energy for current session (>= 5.22)\" registers from" << m_modbusTcpMaster->hostAddress().toString() << m_modbusTcpMaster->errorString();
+        if (!sendUpdateRequest(UpdateRequestBlockConsumptionsTotals))
             return false;
-        }
-
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            return false;
-        }
-
-        m_pendingUpdateReplies.append(reply);
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            m_pendingUpdateReplies.removeAll(reply);
-            handleModbusError(reply->error());
-            if (reply->error() != QModbusDevice::NoError) {
-                verifyUpdateFinished();
-                return;
-            }
-
-            const QModbusDataUnit unit = reply->result();
-            qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from \"Charged energy for current session (>= 5.22)\" register" << 716 << "size:" << 2 << unit.values();
-            if (unit.values().size() == 2) {
-                processChargedEnergyRegisterValues(unit.values());
-            } else {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"Charged energy for current session (>= 5.22)\" registers" << 716 << "size:" << 2 << "returned different size than requested. Ignoring incomplete data" << unit.values();
-            }
-            verifyUpdateFinished();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [this, reply] (QModbusDevice::Error error){
-            QModbusResponse response = reply->rawResult();
-            if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Charged energy for current session (>= 5.22)\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-            } else {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while reading \"Charged energy for current session (>= 5.22)\" registers from" << m_modbusTcpMaster->hostAddress().toString() << error << reply->errorString();
-            }
-        });
-
-
-        // Read consumptionsTotals
-        reply = readBlockConsumptionsTotals();
-        qCDebug(dcAmtronECUModbusTcpConnection()) << "--> Read block \"consumptionsTotals\" registers from:" << 218 << "size:" << 10;
-        if (!reply) {
-            qCWarning(dcAmtronECUModbusTcpConnection()) << "Error occurred while reading block \"consumptionsTotals\" registers";
-            return false;
-        }
-
-        if (reply->isFinished()) {
-            reply->deleteLater(); // Broadcast reply returns immediatly
-            return false;
-        }
-
-        m_pendingUpdateReplies.append(reply);
-        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-        connect(reply, &QModbusReply::finished, this, [this, reply](){
-            m_pendingUpdateReplies.removeAll(reply);
-            handleModbusError(reply->error());
-            if (reply->error() != QModbusDevice::NoError) {
-                verifyUpdateFinished();
-                return;
-            }
-
-            const QModbusDataUnit unit = reply->result();
-            const QVector<quint16> blockValues = unit.values();
-            qCDebug(dcAmtronECUModbusTcpConnection()) << "<-- Response from reading block \"consumptionsTotals\" register" << 218 << "size:" << 10 << blockValues;
-            if (blockValues.size() == 10) {
-                processMeterTotoalEnergyRegisterValues(blockValues.mid(0, 2));
-                processMeterTotalPowerRegisterValues(blockValues.mid(2, 2));
-                processMeterVoltageL1RegisterValues(blockValues.mid(4, 2));
-                processMeterVoltageL2RegisterValues(blockValues.mid(6, 2));
-                processMeterVoltageL3RegisterValues(blockValues.mid(8, 2));
-            } else {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Reading from \"consumptionsTotals\" block registers" << 218 << "size:" << 10 << "returned different size than requested. Ignoring incomplete data" << blockValues;
-            }
-            verifyUpdateFinished();
-        });
-
-        connect(reply, &QModbusReply::errorOccurred, this, [reply] (QModbusDevice::Error error){
-            QModbusResponse response = reply->rawResult();
-            if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while updating block \"consumptionsTotals\" registers" << error << reply->errorString() << ModbusDataUtils::exceptionCodeToString(response.exceptionCode());
-            } else {
-                qCWarning(dcAmtronECUModbusTcpConnection()) << "Modbus reply error occurred while updating block \"consumptionsTotals\" registers" << error << reply->errorString();
-            }
-        });
     }
+
     return true;
 }
 
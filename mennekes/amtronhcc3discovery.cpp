@@ -46,15 +46,20 @@ AmtronHCC3Discovery::AmtronHCC3Discovery(NetworkDeviceDiscovery *networkDeviceDi
 void AmtronHCC3Discovery::startDiscovery()
 {
     qCInfo(dcMennekes()) << "Discovery: Searching for AMTRON wallboxes in the network...";
-    NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &AmtronHCC3Discovery::checkNetworkDevice);
+    // Only hosts with the modbus port open get a connection for checking the device
+    ModbusTcpDiscovery *modbusTcpDiscovery = new ModbusTcpDiscovery(m_networkDeviceDiscovery, 502, 0xff, this);
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::deviceFound, this, [this](const ModbusTcpDiscovery::Result &result){
+        checkNetworkDevice(result.networkDeviceInfo);
+    });
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        qCDebug(dcMennekes()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::discoveryFinished, this, [=](){
+        qCDebug(dcMennekes()) << "Discovery: Network discovery finished. Found" << modbusTcpDiscovery->results().count() << "network devices with the modbus port open";
+        modbusTcpDiscovery->deleteLater();
         m_gracePeriodTimer.start();
-        discoveryReply->deleteLater();
     });
+
+    modbusTcpDiscovery->startDiscovery();
 }
 
 QList<AmtronHCC3Discovery::AmtronDiscoveryResult> AmtronHCC3Discovery::discoveryResults() const
@@ -36,6 +36,7 @@
 
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
+#include <modbuspollorchestrator.h>
 
 QHash<AmtronCompact20ModbusRtuConnection::SolarChargingMode, QString> solarChargingModeMap {
     {AmtronCompact20ModbusRtuConnection::SolarChargingModeOff, "Off"},
@@ -47,7 +48,18 @@ QHash<AmtronCompact20ModbusRtuConnection::SolarChargingMode, QString> solarCharg
 
 IntegrationPluginMennekes::IntegrationPluginMennekes()
 {
+    // Charging state changes get reported late if the update cycles don't fit into the poll interval
+    connect(ModbusPollOrchestrator::instance(), &ModbusPollOrchestrator::cycleOverrun, this, [this](QObject *connection, qint64 cycleTime, int interval){
+        Thing *thing = thingForConnection(connection);
+        if (!thing)
+            return;
 
+        ModbusPollOrchestrator::Statistics statistics = ModbusPollOrchestrator::instance()->statistics(connection);
+        if (statistics.overruns == 1 || statistics.overruns % 30 == 0) {
+            qCWarning(dcMennekes()) << "Update cycle of" << thing->name() << "took" << cycleTime << "ms, the poll interval is" << interval << "ms."
+                                    << statistics.overruns << "of" << statistics.cycles << "cycles exceeded the interval, max cycle time" << statistics.maxCycleTime << "ms";
+        }
+    });
 }
 
 void IntegrationPluginMennekes::discoverThings(ThingDiscoveryInfo *info)
@@ -288,19 +300,7 @@ void IntegrationPluginMennekes::postSetupThing(Thing *thing)
         qCDebug(dcMennekes()) << "Starting plugin timer...";
         m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
         connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-            foreach(AmtronECU *connection, m_amtronECUConnections) {
-                qCDebug(dcMennekes()) << "Updating connection" << connection->modbusTcpMaster()->hostAddress().toString();
-                connection->update();
-            }
-            foreach(AmtronHCC3ModbusTcpConnection *connection, m_amtronHCC3Connections) {
-                qCDebug(dcMennekes()) << "Updating connection" << connection->modbusTcpMaster()->hostAddress().toString();
-                connection->update();
-            }
-            foreach(AmtronCompact20ModbusRtuConnection *connection, m_amtronCompact20Connections) {
-                qCDebug(dcMennekes()) << "Updating connection" << connection->modbusRtuMaster()->serialPort() << connection->slaveId();
-                connection->update();
-                connection->setHeartbeat(0x55AA);
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
         });
 
         m_pluginTimer->start();
@@ -317,31 +317,34 @@ void IntegrationPluginMennekes::executeAction(ThingActionInfo *info)
             int maxChargingCurrent = info->thing()->stateValue(amtronECUMaxChargingCurrentStateTypeId).toUInt();
             int effectiveCurrent = power ? maxChargingCurrent : 0;
             qCInfo(dcMennekes()) << "Executing power action:" << power << "max current:" << maxChargingCurrent << "-> effective current" << effectiveCurrent;
-            QModbusReply *reply = amtronECUConnection->setHemsCurrentLimit(effectiveCurrent);
-            connect(reply, &QModbusReply::finished, info, [info, reply, power](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue(amtronECUPowerStateTypeId, power);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcMennekes()) << "Error setting cp availability:" << reply->error() << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(amtronECUConnection, &AmtronECU::hemsCurrentLimitApplied, info, [amtronECUConnection, info, power](){
+                QObject::disconnect(amtronECUConnection, nullptr, info, nullptr);
+                info->thing()->setStateValue(amtronECUPowerStateTypeId, power);
+                info->finish(Thing::ThingErrorNoError);
             });
+            connect(amtronECUConnection, &AmtronECU::hemsCurrentLimitApplyFailed, info, [amtronECUConnection, info](){
+                QObject::disconnect(amtronECUConnection, nullptr, info, nullptr);
+                qCWarning(dcMennekes()) << "Error setting cp availability";
+                info->finish(Thing::ThingErrorHardwareFailure);
+            });
+            amtronECUConnection->applyHemsCurrentLimit(effectiveCurrent);
         }
         if (info->action().actionTypeId() == amtronECUMaxChargingCurrentActionTypeId) {
             bool power = info->thing()->stateValue(amtronECUPowerStateTypeId).toBool();
             int maxChargingCurrent = info->action().paramValue(amtronECUMaxChargingCurrentActionMaxChargingCurrentParamTypeId).toInt();
             int effectiveCurrent = power ? maxChargingCurrent : 0;
             qCInfo(dcMennekes()) << "Executing max current action:" << maxChargingCurrent << "Power is" << power << "-> effective:" << effectiveCurrent;
-            QModbusReply *reply = amtronECUConnection->setHemsCurrentLimit(effectiveCurrent);
-            connect(reply, &QModbusReply::finished, info, [info, reply, maxChargingCurrent](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue(amtronECUMaxChargingCurrentStateTypeId, maxChargingCurrent);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            connect(amtronECUConnection, &AmtronECU::hemsCurrentLimitApplied, info, [amtronECUConnection, info, maxChargingCurrent](){
+                QObject::disconnect(amtronECUConnection, nullptr, info, nullptr);
+                info->thing()->setStateValue(amtronECUMaxChargingCurrentStateTypeId, maxChargingCurrent);
+                info->finish(Thing::ThingErrorNoError);
             });
+            connect(amtronECUConnection, &AmtronECU::hemsCurrentLimitApplyFailed, info, [amtronECUConnection, info](){
+                QObject::disconnect(amtronECUConnection, nullptr, info, nullptr);
+                info->finish(Thing::ThingErrorHardwareFailure);
+            });
+            amtronECUConnection->applyHemsCurrentLimit(effectiveCurrent);
         }
     }
 
@@ -377,15 +380,17 @@ void IntegrationPluginMennekes::executeAction(ThingActionInfo *info)
         }
         if (info->action().actionTypeId() == amtronHCC3MaxChargingCurrentActionTypeId) {
             int maxChargingCurrent = info->action().paramValue(amtronHCC3MaxChargingCurrentActionMaxChargingCurrentParamTypeId).toInt();
-            QModbusReply *reply = amtronHCC3Connection->setCustomerCurrentLimitation(maxChargingCurrent);
-            connect(reply, &QModbusReply::finished, info, [info, reply, maxChargingCurrent](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue(amtronHCC3MaxChargingCurrentStateTypeId, maxChargingCurrent);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(amtronHCC3Connection, &AmtronHCC3ModbusTcpConnection::customerCurrentLimitationApplied, info, [amtronHCC3Connection, info, maxChargingCurrent](){
+                QObject::disconnect(amtronHCC3Connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(amtronHCC3MaxChargingCurrentStateTypeId, maxChargingCurrent);
+                info->finish(Thing::ThingErrorNoError);
             });
+            connect(amtronHCC3Connection, &AmtronHCC3ModbusTcpConnection::customerCurrentLimitationApplyFailed, info, [amtronHCC3Connection, info](){
+                QObject::disconnect(amtronHCC3Connection, nullptr, info, nullptr);
+                info->finish(Thing::ThingErrorHardwareFailure);
+            });
+            amtronHCC3Connection->applyCustomerCurrentLimitation(maxChargingCurrent);
         }
     }
 
@@ -415,15 +420,17 @@ void IntegrationPluginMennekes::executeAction(ThingActionInfo *info)
                 value = 6.01;
             }
 
-            ModbusRtuReply *reply = amtronCompact20Connection->setChargingCurrentEnergyManager(value);
-            connect(reply, &ModbusRtuReply::finished, info, [info, reply, maxChargingCurrent](){
-                if (reply->error() == ModbusRtuReply::NoError) {
-                    info->thing()->setStateValue(amtronCompact20MaxChargingCurrentStateTypeId, maxChargingCurrent);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(amtronCompact20Connection, &AmtronCompact20ModbusRtuConnection::chargingCurrentEnergyManagerApplied, info, [amtronCompact20Connection, info, maxChargingCurrent](){
+                QObject::disconnect(amtronCompact20Connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(amtronCompact20MaxChargingCurrentStateTypeId, maxChargingCurrent);
+                info->finish(Thing::ThingErrorNoError);
             });
+            connect(amtronCompact20Connection, &AmtronCompact20ModbusRtuConnection::chargingCurrentEnergyManagerApplyFailed, info, [amtronCompact20Connection, info](){
+                QObject::disconnect(amtronCompact20Connection, nullptr, info, nullptr);
+                info->finish(Thing::ThingErrorHardwareFailure);
+            });
+            amtronCompact20Connection->applyChargingCurrentEnergyManager(value);
         }
         if (info->action().actionTypeId() == amtronCompact20DesiredPhaseCountActionTypeId) {
             int desiredPhaseCount = info->action().paramValue(amtronCompact20DesiredPhaseCountActionDesiredPhaseCountParamTypeId).toInt();
@@ -599,6 +606,12 @@ void IntegrationPluginMennekes::setupAmtronECUConnection(ThingSetupInfo *info)
         qCDebug(dcMennekes()) << "Connection init finished successfully" << amtronECUConnection;
 
         m_amtronECUConnections.insert(thing, amtronECUConnection);
+        ModbusPollOrchestrator::instance()->addConnection(this, amtronECUConnection, amtronECUConnection->modbusTcpMaster()->hostAddress().toString(), true);
+
+        // The status probe catches plugging in a car right away, so the full update can run less often
+        amtronECUConnection->setStatusProbeEnabled(true);
+        ModbusPollOrchestrator::instance()->setPollDivider(amtronECUConnection, 5);
+
         info->finish(Thing::ThingErrorNoError);
 
         thing->setStateValue(amtronECUConnectedStateTypeId, true);
@@ -760,6 +773,11 @@ void IntegrationPluginMennekes::setupAmtronHCC3Connection(ThingSetupInfo *info)
 
         qCDebug(dcMennekes()) << "Connection init finished successfully" << amtronHCC3Connection;
         m_amtronHCC3Connections.insert(thing, amtronHCC3Connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, amtronHCC3Connection, amtronHCC3Connection->modbusTcpMaster()->hostAddress().toString(), true);
+
+        amtronHCC3Connection->setStatusProbeEnabled(true);
+        ModbusPollOrchestrator::instance()->setPollDivider(amtronHCC3Connection, 5);
+
         info->finish(Thing::ThingErrorNoError);
 
         thing->setStateValue(amtronHCC3ConnectedStateTypeId, true);
@@ -838,8 +856,10 @@ void IntegrationPluginMennekes::setupAmtronCompact20Connection(ThingSetupInfo *i
     }
 
     AmtronCompact20ModbusRtuConnection *compact20Connection = new AmtronCompact20ModbusRtuConnection(hardwareManager()->modbusRtuResource()->getModbusRtuMaster(uuid), slaveId, this);
+    compact20Connection->setKeepAliveEnabled(true);
     connect(info, &ThingSetupInfo::aborted, compact20Connection, &ModbusRtuMaster::deleteLater);
     m_amtronCompact20Connections.insert(thing, compact20Connection);
+    ModbusPollOrchestrator::instance()->addConnection(this, compact20Connection, compact20Connection->modbusRtuMaster()->serialPort(), true);
 
     connect(info, &ThingSetupInfo::aborted, this, [=](){
         m_amtronCompact20Connections.take(info->thing())->deleteLater();
@@ -990,3 +1010,26 @@ void IntegrationPluginMennekes::setupAmtronCompact20Connection(ThingSetupInfo *i
     });
 
 }
+
+Thing *IntegrationPluginMennekes::thingForConnection(QObject *connection) const
+{
+    foreach (Thing *thing, m_amtronECUConnections.keys()) {
+        if (m_amtronECUConnections.value(thing) == connection) {
+            return thing;
+        }
+    }
+
+    foreach (Thing *thing, m_amtronHCC3Connections.keys()) {
+        if (m_amtronHCC3Connections.value(thing) == connection) {
+            return thing;
+        }
+    }
+
+    foreach (Thing *thing, m_amtronCompact20Connections.keys()) {
+        if (m_amtronCompact20Connections.value(thing) == connection) {
+            return thing;
+        }
+    }
+
+    return nullptr;
+}
@@ -65,6 +65,7 @@ private:
     void setupAmtronECUConnection(ThingSetupInfo *info);
     void setupAmtronHCC3Connection(ThingSetupInfo *info);
     void setupAmtronCompact20Connection(ThingSetupInfo *info);
+    Thing *thingForConnection(QObject *connection) const;
 
     PluginTimer *m_pluginTimer = nullptr;
     QHash<Thing *, AmtronECU *> m_amtronECUConnections;
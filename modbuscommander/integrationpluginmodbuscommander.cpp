@@ -64,6 +64,26 @@ void IntegrationPluginModbusCommander::init()
     m_valueStateTypeId.insert(discreteInputThingClassId, discreteInputValueStateTypeId);
     m_valueStateTypeId.insert(holdingRegisterThingClassId, holdingRegisterValueStateTypeId);
 
+    m_dataTypeParamTypeId.insert(inputRegisterThingClassId, inputRegisterThingDataTypeParamTypeId);
+    m_dataTypeParamTypeId.insert(holdingRegisterThingClassId, holdingRegisterThingDataTypeParamTypeId);
+
+    m_byteOrderParamTypeId.insert(inputRegisterThingClassId, inputRegisterThingByteOrderParamTypeId);
+    m_byteOrderParamTypeId.insert(holdingRegisterThingClassId, holdingRegisterThingByteOrderParamTypeId);
+
+    m_scaleFactorParamTypeId.insert(inputRegisterThingClassId, inputRegisterThingScaleFactorParamTypeId);
+    m_scaleFactorParamTypeId.insert(holdingRegisterThingClassId, holdingRegisterThingScaleFactorParamTypeId);
+
+    m_stringLengthParamTypeId.insert(inputRegisterThingClassId, inputRegisterThingStringLengthParamTypeId);
+    m_stringLengthParamTypeId.insert(holdingRegisterThingClassId, holdingRegisterThingStringLengthParamTypeId);
+
+    m_stringValueStateTypeId.insert(inputRegisterThingClassId, inputRegisterStringValueStateTypeId);
+    m_stringValueStateTypeId.insert(holdingRegisterThingClassId, holdingRegisterStringValueStateTypeId);
+
+    m_registerType.insert(coilThingClassId, QModbusDataUnit::Coils);
+    m_registerType.insert(inputRegisterThingClassId, QModbusDataUnit::InputRegisters);
+    m_registerType.insert(discreteInputThingClassId, QModbusDataUnit::DiscreteInputs);
+    m_registerType.insert(holdingRegisterThingClassId, QModbusDataUnit::HoldingRegisters);
+
     // Plugin configuration
     connect(this, &IntegrationPluginModbusCommander::configValueChanged, this, &IntegrationPluginModbusCommander::onPluginConfigurationChanged);
 
@@ -233,12 +253,17 @@ void IntegrationPluginModbusCommander::setupThing(ThingSetupInfo *info)
 
         if (m_modbusTCPMasters.contains(thing)) {
             // In case of a rediscovery
-            m_modbusTCPMasters.take(thing)->deleteLater();
+            ModbusTcpMaster *modbusTCPMaster = m_modbusTCPMasters.take(thing);
+            if (!m_modbusTCPMasters.values().contains(modbusTCPMaster)) {
+                unindexRegisterThings(modbusTCPMaster);
+                modbusTCPMaster->deleteLater();
+            }
         }
 
         foreach (ModbusTcpMaster *modbusTCPMaster, m_modbusTCPMasters.values()) {
             if ((modbusTCPMaster->hostAddress() == hostAddress) && (modbusTCPMaster->port() == port)) {
                 m_modbusTCPMasters.insert(thing, modbusTCPMaster);
+                indexRegisterThings(thing);
                 return info->finish(Thing::ThingErrorNoError);
             }
         }
@@ -253,6 +278,8 @@ void IntegrationPluginModbusCommander::setupThing(ThingSetupInfo *info)
         connect(modbusTCPMaster, &ModbusTcpMaster::connectionStateChanged, this, &IntegrationPluginModbusCommander::onConnectionStateChanged);
         connect(modbusTCPMaster, &ModbusTcpMaster::writeRequestExecuted, this, &IntegrationPluginModbusCommander::onRequestExecuted);
         connect(modbusTCPMaster, &ModbusTcpMaster::writeRequestError, this, &IntegrationPluginModbusCommander::onRequestError);
+        connect(modbusTCPMaster, &ModbusTcpMaster::readRequestException, this, &IntegrationPluginModbusCommander::onReadRequestException);
+        connect(modbusTCPMaster, &ModbusTcpMaster::readRequestError, this, &IntegrationPluginModbusCommander::onRequestError);
         connect(modbusTCPMaster, &ModbusTcpMaster::receivedCoil, this, &IntegrationPluginModbusCommander::onReceivedCoil);
         connect(modbusTCPMaster, &ModbusTcpMaster::receivedDiscreteInput, this, &IntegrationPluginModbusCommander::onReceivedDiscreteInput);
         connect(modbusTCPMaster, &ModbusTcpMaster::receivedHoldingRegister, this, &IntegrationPluginModbusCommander::onReceivedHoldingRegister);
@@ -261,6 +288,7 @@ void IntegrationPluginModbusCommander::setupThing(ThingSetupInfo *info)
             if (connected) {
                 info->finish(Thing::ThingErrorNoError);
                 m_modbusTCPMasters.insert(info->thing(), modbusTCPMaster);
+                indexRegisterThings(info->thing());
             }
         });
         connect(thing, &Thing::settingChanged, thing, [thing, modbusTCPMaster] (const ParamTypeId &paramTypeId, const QVariant &value) {
@@ -314,6 +342,8 @@ void IntegrationPluginModbusCommander::setupThing(ThingSetupInfo *info)
                || (thing->thingClassId() == holdingRegisterThingClassId)
                || (thing->thingClassId() == inputRegisterThingClassId)) {
         qCDebug(dcModbusCommander()) << "Setting up modbus register" << thing->name();
+        indexRegisterThing(thing);
+        m_singleReadThings.remove(thing);
         info->finish(Thing::ThingErrorNoError);
 
     } else {
@@ -330,14 +360,16 @@ void IntegrationPluginModbusCommander::postSetupThing(Thing *thing)
         qCDebug(dcModbusCommander()) << "Starting refresh timer with interval" << refreshTime << "s";
         m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(refreshTime);
         connect(m_refreshTimer, &PluginTimer::timeout, this, [this] {
+            QList<Thing *> registerThings;
             foreach (Thing *thing, myThings()) {
                 if ((thing->thingClassId() == coilThingClassId) ||
                         (thing->thingClassId() == discreteInputThingClassId) ||
                         (thing->thingClassId() == holdingRegisterThingClassId) ||
                         (thing->thingClassId() == inputRegisterThingClassId)) {
-                    readRegister(thing);
+                    registerThings.append(thing);
                 }
             }
+            readRegisters(registerThings);
         });
     }
 
@@ -348,7 +380,7 @@ void IntegrationPluginModbusCommander::postSetupThing(Thing *thing)
                (thing->thingClassId() == discreteInputThingClassId) ||
                (thing->thingClassId() == holdingRegisterThingClassId) ||
                (thing->thingClassId() == inputRegisterThingClassId)) {
-        readRegister(thing);
+        readRegisters(QList<Thing *>() << thing);
     } else {
         Q_ASSERT_X(false, "postSetupThing", QString("Unhandled thingClassId: %1").arg(thing->thingClassId().toString()).toUtf8());
     }
@@ -386,9 +418,16 @@ void IntegrationPluginModbusCommander::thingRemoved(Thing *thing)
 {
     qCDebug(dcModbusCommander()) << "Removing thing" << thing->name();
     if (thing->thingClassId() == modbusTCPClientThingClassId) {
-        m_modbusTCPMasters.take(thing)->deleteLater();
+        ModbusTcpMaster *modbusTCPMaster = m_modbusTCPMasters.take(thing);
+        if (modbusTCPMaster && !m_modbusTCPMasters.values().contains(modbusTCPMaster)) {
+            unindexRegisterThings(modbusTCPMaster);
+            modbusTCPMaster->deleteLater();
+        }
     } else if (thing->thingClassId() == modbusRTUClientThingClassId) {
         m_modbusRtuMasters.take(thing)->deleteLater();
+    } else {
+        unindexRegisterThing(thing);
+        m_singleReadThings.remove(thing);
     }
 
     if (myThings().empty()) {
@@ -415,9 +454,8 @@ void IntegrationPluginModbusCommander::onPluginConfigurationChanged(const ParamT
 
 void IntegrationPluginModbusCommander::onConnectionStateChanged(bool status)
 {
-    auto modbus = sender();
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *thing = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
+    Thing *thing = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(sender()));
+    if (thing) {
         qCDebug(dcModbusCommander()) << "Connections state changed" << thing->name() << status;
         thing->setStateValue(modbusTCPClientConnectedStateTypeId, status);
     }
@@ -436,8 +474,14 @@ void IntegrationPluginModbusCommander::onRequestExecuted(QUuid requestId, bool s
     }
 
     if (m_readRequests.contains(requestId)){
-        Thing *thing = m_readRequests.take(requestId);
-        thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), success);
+        QList<Thing *> things = m_readRequests.take(requestId);
+        if (success) {
+            foreach (Thing *thing, things) {
+                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
+            }
+        } else {
+            handleReadError(things);
+        }
     }
 }
 
@@ -450,98 +494,184 @@ void IntegrationPluginModbusCommander::onRequestError(QUuid requestId, const QSt
     }
 
     if (m_readRequests.contains(requestId)){
-        Thing *thing = m_readRequests.take(requestId);
-        thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), false);
+        handleReadError(m_readRequests.take(requestId));
     }
 }
 
-void IntegrationPluginModbusCommander::onReceivedCoil(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values)
+void IntegrationPluginModbusCommander::onReadRequestException(const QUuid &requestId, QModbusPdu::ExceptionCode exceptionCode)
 {
-    auto modbus = sender();
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == coilThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
-            }
-        }
+    // Emitted right before the request error, which will find nothing left to do
+    if (m_readRequests.contains(requestId)) {
+        bool blockRejected = (exceptionCode == QModbusPdu::IllegalDataAddress || exceptionCode == QModbusPdu::IllegalDataValue);
+        handleReadError(m_readRequests.take(requestId), blockRejected);
     }
 }
 
+void IntegrationPluginModbusCommander::onReceivedCoil(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values)
+{
+    updateRegisterThings(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::Coils, slaveAddress, modbusRegister, values);
+}
+
 void IntegrationPluginModbusCommander::onReceivedDiscreteInput(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values)
 {
-    auto modbus = sender();
-
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == discreteInputThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
-            }
+    updateRegisterThings(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::DiscreteInputs, slaveAddress, modbusRegister, values);
+}
+
+void IntegrationPluginModbusCommander::onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+{
+    updateRegisterThings(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::HoldingRegisters, slaveAddress, modbusRegister, values);
+}
+
+void IntegrationPluginModbusCommander::onReceivedInputRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+{
+    updateRegisterThings(static_cast<ModbusTcpMaster *>(sender()), QModbusDataUnit::InputRegisters, slaveAddress, modbusRegister, values);
+}
+
+void IntegrationPluginModbusCommander::updateRegisterThings(ModbusTcpMaster *modbusTcpMaster, QModbusDataUnit::RegisterType registerType, uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+{
+    if (values.isEmpty() || !m_registerThings.contains(modbusTcpMaster))
+        return;
+
+    // Block reads contain the values of all registers starting at modbusRegister
+    const QMultiHash<quint32, Thing *> registerThings = m_registerThings.value(modbusTcpMaster);
+    for (int i = 0; i < values.count(); i++) {
+        foreach (Thing *thing, registerThings.values(registerKey(registerType, slaveAddress, modbusRegister + i))) {
+            setRegisterThingValue(thing, values, i);
+            thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
         }
     }
 }
 
-void IntegrationPluginModbusCommander::onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+void IntegrationPluginModbusCommander::indexRegisterThing(Thing *thing)
 {
-    auto modbus = sender();
-
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == holdingRegisterThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
-            }
+    unindexRegisterThing(thing);
+
+    Thing *parent = myThings().findById(thing->parentId());
+    if (!parent)
+        return;
+
+    // The master of a TCP client will be available once connected, see indexRegisterThings()
+    ModbusTcpMaster *modbus = m_modbusTCPMasters.value(parent);
+    if (!modbus)
+        return;
+
+    uint registerAddress = thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())).toUInt();
+    uint slaveAddress = thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())).toUInt();
+    quint32 key = registerKey(m_registerType.value(thing->thingClassId()), slaveAddress, registerAddress);
+    m_registerThings[modbus].insert(key, thing);
+    m_registerThingKeys.insert(thing, qMakePair(modbus, key));
+}
+
+void IntegrationPluginModbusCommander::unindexRegisterThing(Thing *thing)
+{
+    if (!m_registerThingKeys.contains(thing))
+        return;
+
+    QPair<ModbusTcpMaster *, quint32> registerThingKey = m_registerThingKeys.take(thing);
+    m_registerThings[registerThingKey.first].remove(registerThingKey.second, thing);
+    if (m_registerThings.value(registerThingKey.first).isEmpty()) {
+        m_registerThings.remove(registerThingKey.first);
+    }
+}
+
+void IntegrationPluginModbusCommander::indexRegisterThings(Thing *parent)
+{
+    foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
+        if (m_registerType.contains(thing->thingClassId())) {
+            indexRegisterThing(thing);
         }
     }
 }
 
-void IntegrationPluginModbusCommander::onReceivedInputRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
+void IntegrationPluginModbusCommander::unindexRegisterThings(ModbusTcpMaster *modbusTcpMaster)
 {
-    auto modbus = sender();
-
-    if (m_modbusTCPMasters.values().contains(static_cast<ModbusTcpMaster *>(modbus))) {
-        Thing *parent = m_modbusTCPMasters.key(static_cast<ModbusTcpMaster *>(modbus));
-        foreach (Thing *thing, myThings().filterByParentId(parent->id())) {
-            if (thing->thingClassId() == inputRegisterThingClassId) {
-                if ((thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())) == slaveAddress)
-                        && (thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())) == modbusRegister)) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), values[0]);
-                    thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-                    return;
-                }
+    foreach (Thing *thing, m_registerThings.value(modbusTcpMaster).values()) {
+        m_registerThingKeys.remove(thing);
+    }
+    m_registerThings.remove(modbusTcpMaster);
+}
+
+quint32 IntegrationPluginModbusCommander::registerKey(QModbusDataUnit::RegisterType registerType, uint slaveAddress, uint registerAddress)
+{
+    return (static_cast<quint32>(registerType & 0xff) << 24) | ((slaveAddress & 0xff) << 16) | (registerAddress & 0xffff);
+}
+
+void IntegrationPluginModbusCommander::readRegisters(const QList<Thing *> &things)
+{
+    uint maxGap = configValue(modbusCommanderPluginBlockReadMaxGapParamTypeId).toUInt();
+
+    // Group the things by parent, slave address and register type, sorted by register address
+    QHash<QString, QMap<uint, QList<Thing *>>> groups;
+    foreach (Thing *thing, things) {
+        uint registerAddress = thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())).toUInt();
+        if (m_singleReadThings.contains(thing)) {
+            uint cyclesLeft = m_singleReadThings.value(thing) - 1;
+            if (cyclesLeft > 0) {
+                m_singleReadThings.insert(thing, cyclesLeft);
+                readRegisterBlock(QList<Thing *>() << thing, registerAddress, registerCount(thing));
+                continue;
+            }
+
+            // Give the block read another chance
+            qCDebug(dcModbusCommander()) << "Trying to read" << thing->name() << "within a block again";
+            m_singleReadThings.remove(thing);
+        }
+
+        uint slaveAddress = thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())).toUInt();
+        QString groupKey = QString("%1/%2/%3").arg(thing->parentId().toString()).arg(slaveAddress).arg(thing->thingClassId().toString());
+        groups[groupKey][registerAddress].append(thing);
+    }
+
+    // Merge registers into blocks as long as the gap between them is small enough.
+    // 125 registers is the maximum a single read request may contain. Multi register
+    // values are always read completely within one block.
+    foreach (const QString &groupKey, groups.keys()) {
+        const QMap<uint, QList<Thing *>> group = groups.value(groupKey);
+        QList<Thing *> blockThings;
+        uint blockAddress = 0;
+        uint blockEnd = 0;
+        for (QMap<uint, QList<Thing *>>::const_iterator it = group.constBegin(); it != group.constEnd(); ++it) {
+            uint registerAddress = it.key();
+            uint registerEnd = registerAddress;
+            foreach (Thing *thing, it.value()) {
+                registerEnd = qMax(registerEnd, registerAddress + registerCount(thing) - 1);
+            }
+
+            if (!blockThings.isEmpty() && (registerAddress > blockEnd + maxGap + 1 || qMax(blockEnd, registerEnd) - blockAddress >= 125)) {
+                readRegisterBlock(blockThings, blockAddress, blockEnd - blockAddress + 1);
+                blockThings.clear();
+            }
+
+            if (blockThings.isEmpty()) {
+                blockAddress = registerAddress;
+                blockEnd = registerEnd;
             }
+
+            blockEnd = qMax(blockEnd, registerEnd);
+            blockThings.append(it.value());
+        }
+
+        if (!blockThings.isEmpty()) {
+            readRegisterBlock(blockThings, blockAddress, blockEnd - blockAddress + 1);
         }
     }
 }
 
-void IntegrationPluginModbusCommander::readRegister(Thing *thing)
+void IntegrationPluginModbusCommander::readRegisterBlock(const QList<Thing *> &things, uint registerAddress, uint size)
 {
+    // All things of a block share the parent, the slave address and the register type
+    Thing *thing = things.first();
     Thing *parent = myThings().findById(thing->parentId());
     if (!parent) {
         qCWarning(dcModbusCommander()) << "Could not find parent device" << thing->name();
         return;
     }
 
-    uint registerAddress = thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())).toUInt();;
-    uint slaveAddress = thing->paramValue(m_slaveAddressParamTypeId.value(thing->thingClassId())).toUInt();
-
-    QUuid requestId;
+    ThingClassId thingClassId = thing->thingClassId();
+    uint slaveAddress = thing->paramValue(m_slaveAddressParamTypeId.value(thingClassId)).toUInt();
+    if (size > 1) {
+        qCDebug(dcModbusCommander()) << "Reading block of" << things.count() << "things from" << parent->name() << "slave:" << slaveAddress << "register:" << registerAddress << "size:" << size;
+    }
 
     if (parent->thingClassId() == modbusTCPClientThingClassId) {
         ModbusTcpMaster *modbus = m_modbusTCPMasters.value(parent);
@@ -551,17 +681,30 @@ void IntegrationPluginModbusCommander::readRegister(Thing *thing)
         if (!modbus->connected())
             return; // Send requests only if the modbus interface is connected
 
-        if (thing->thingClassId() == coilThingClassId) {
-            requestId = modbus->readCoil(slaveAddress, registerAddress);
-        } else if (thing->thingClassId() == discreteInputThingClassId) {
-            requestId = modbus->readDiscreteInput(slaveAddress, registerAddress);
-        } else if (thing->thingClassId() == holdingRegisterThingClassId) {
-            requestId = modbus->readHoldingRegister(slaveAddress, registerAddress);
-        } else if (thing->thingClassId() == inputRegisterThingClassId) {
-            requestId = modbus->readInputRegister(slaveAddress, registerAddress);
+        QUuid requestId;
+        if (thingClassId == coilThingClassId) {
+            requestId = modbus->readCoil(slaveAddress, registerAddress, size);
+        } else if (thingClassId == discreteInputThingClassId) {
+            requestId = modbus->readDiscreteInput(slaveAddress, registerAddress, size);
+        } else if (thingClassId == holdingRegisterThingClassId) {
+            requestId = modbus->readHoldingRegister(slaveAddress, registerAddress, size);
+        } else if (thingClassId == inputRegisterThingClassId) {
+            requestId = modbus->readInputRegister(slaveAddress, registerAddress, size);
+        }
+
+        if (requestId.isNull()) {
+            // Request returned without an id
+            foreach (Thing *blockThing, things) {
+                blockThing->setStateValue(m_connectedStateTypeId.value(thingClassId), false);
+            }
+            return;
         }
-    } else if (parent->thingClassId() == modbusRTUClientThingClassId) {
 
+        // The values will be received in updateRegisterThings()
+        m_readRequests.insert(requestId, things);
+        QTimer::singleShot(5000, this, [requestId, this] {m_readRequests.remove(requestId);});
+
+    } else if (parent->thingClassId() == modbusRTUClientThingClassId) {
         ModbusRtuMaster *modbusMaster = m_modbusRtuMasters.value(parent);
         if (!modbusMaster)
             return;
@@ -569,76 +712,156 @@ void IntegrationPluginModbusCommander::readRegister(Thing *thing)
         if (!modbusMaster->connected())
             return; // Send requests only if the modbus interface is connected
 
-        if (thing->thingClassId() == coilThingClassId) {
-            ModbusRtuReply *reply = modbusMaster->readCoil(slaveAddress, registerAddress);
-            connect(reply, &ModbusRtuReply::finished, modbusMaster, [=](){
-                if (reply->error() != ModbusRtuReply::NoError) {
-                    qCWarning(dcModbusCommander()) << "Failed to read coil from" << modbusMaster << "slave:" << slaveAddress << "register:" << registerAddress;
-                    thing->setStateValue(m_connectedStateTypeId[thing->thingClassId()], false);
-                    return;
-                }
+        ModbusRtuReply *reply = nullptr;
+        if (thingClassId == coilThingClassId) {
+            reply = modbusMaster->readCoil(slaveAddress, registerAddress, size);
+        } else if (thingClassId == discreteInputThingClassId) {
+            reply = modbusMaster->readDiscreteInput(slaveAddress, registerAddress, size);
+        } else if (thingClassId == holdingRegisterThingClassId) {
+            reply = modbusMaster->readHoldingRegister(slaveAddress, registerAddress, size);
+        } else if (thingClassId == inputRegisterThingClassId) {
+            reply = modbusMaster->readInputRegister(slaveAddress, registerAddress, size);
+        }
 
-                if (!reply->result().isEmpty()) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), reply->result().at(0));
-                }
-                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-            });
-        } else if (thing->thingClassId() == discreteInputThingClassId) {
-            ModbusRtuReply *reply = modbusMaster->readDiscreteInput(slaveAddress, registerAddress);
-            connect(reply, &ModbusRtuReply::finished, modbusMaster, [=](){
-                if (reply->error() != ModbusRtuReply::NoError) {
-                    qCWarning(dcModbusCommander()) << "Failed to read discrete input from" << modbusMaster << "slave:" << slaveAddress << "register:" << registerAddress;
-                    thing->setStateValue(m_connectedStateTypeId[thing->thingClassId()], false);
-                    return;
-                }
+        if (!reply)
+            return;
 
-                if (!reply->result().isEmpty()) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), reply->result().at(0));
-                }
-                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-            });
-        } else if (thing->thingClassId() == holdingRegisterThingClassId) {
-            ModbusRtuReply *reply = modbusMaster->readHoldingRegister(slaveAddress, registerAddress);
-            connect(reply, &ModbusRtuReply::finished, modbusMaster, [=](){
-                if (reply->error() != ModbusRtuReply::NoError) {
-                    qCWarning(dcModbusCommander()) << "Failed to read holding register from" << modbusMaster << "slave:" << slaveAddress << "register:" << registerAddress;
-                    thing->setStateValue(m_connectedStateTypeId[thing->thingClassId()], false);
-                    return;
-                }
+        connect(reply, &ModbusRtuReply::finished, modbusMaster, [=](){
+            if (reply->error() != ModbusRtuReply::NoError) {
+                qCWarning(dcModbusCommander()) << "Failed to read from" << modbusMaster << "slave:" << slaveAddress << "register:" << registerAddress << "size:" << size << reply->errorString();
+                // Exception responses are reported as protocol errors, the exception code is not available here
+                handleReadError(things, reply->error() == ModbusRtuReply::ProtocolError);
+                return;
+            }
 
-                if (!reply->result().isEmpty()) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), reply->result().at(0));
-                }
-                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-            });
-        } else if (thing->thingClassId() == inputRegisterThingClassId) {
-            ModbusRtuReply *reply = modbusMaster->readInputRegister(slaveAddress, registerAddress);
-            connect(reply, &ModbusRtuReply::finished, modbusMaster, [=](){
-                if (reply->error() != ModbusRtuReply::NoError) {
-                    qCWarning(dcModbusCommander()) << "Failed to read input register from" << modbusMaster << "slave:" << slaveAddress << "register:" << registerAddress;
-                    thing->setStateValue(m_connectedStateTypeId[thing->thingClassId()], false);
-                    return;
-                }
+            setRegisterValues(things, registerAddress, reply->result());
+        });
+    }
+}
 
-                if (!reply->result().isEmpty()) {
-                    thing->setStateValue(m_valueStateTypeId.value(thing->thingClassId()), reply->result().at(0));
-                }
-                thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
-            });
+void IntegrationPluginModbusCommander::setRegisterValues(const QList<Thing *> &things, uint registerAddress, const QVector<quint16> &values)
+{
+    foreach (Thing *thing, things) {
+        uint offset = thing->paramValue(m_registerAddressParamTypeId.value(thing->thingClassId())).toUInt() - registerAddress;
+        if (offset < static_cast<uint>(values.count())) {
+            setRegisterThingValue(thing, values, offset);
         }
+        thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), true);
+    }
+}
 
-        // Note: we don't want proceed with the method here, since we are not
-        // working with the requestId any more on RTU
+uint IntegrationPluginModbusCommander::registerCount(Thing *thing) const
+{
+    ThingClassId thingClassId = thing->thingClassId();
+    if (!m_dataTypeParamTypeId.contains(thingClassId))
+        return 1;
+
+    QString dataType = thing->paramValue(m_dataTypeParamTypeId.value(thingClassId)).toString();
+    if (dataType == "uint32" || dataType == "int32" || dataType == "float32") {
+        return 2;
+    } else if (dataType == "uint64" || dataType == "int64" || dataType == "float64") {
+        return 4;
+    } else if (dataType == "string") {
+        return qBound(1u, thing->paramValue(m_stringLengthParamTypeId.value(thingClassId)).toUInt(), 125u);
+    }
+
+    return 1;
+}
+
+ModbusDataUtils::ByteOrder IntegrationPluginModbusCommander::byteOrder(Thing *thing) const
+{
+    if (thing->paramValue(m_byteOrderParamTypeId.value(thing->thingClassId())).toString() == "Little endian")
+        return ModbusDataUtils::ByteOrderLittleEndian;
+
+    return ModbusDataUtils::ByteOrderBigEndian;
+}
+
+void IntegrationPluginModbusCommander::setRegisterThingValue(Thing *thing, const QVector<quint16> &values, int offset)
+{
+    ThingClassId thingClassId = thing->thingClassId();
+    if (!m_dataTypeParamTypeId.contains(thingClassId)) {
+        thing->setStateValue(m_valueStateTypeId.value(thingClassId), values.at(offset));
         return;
     }
 
-    if (!requestId.isNull()) {
-        m_readRequests.insert(requestId, thing);
-        QTimer::singleShot(5000, this, [requestId, this] {m_readRequests.remove(requestId);});
+    int count = registerCount(thing);
+    if (values.count() - offset < count) {
+        qCWarning(dcModbusCommander()) << "Received" << values.count() - offset << "registers for" << thing->name() << "but" << count << "are required for the value";
+        return;
+    }
+
+    QVector<quint16> registers = values.mid(offset, count);
+    QString dataType = thing->paramValue(m_dataTypeParamTypeId.value(thingClassId)).toString();
+    if (dataType == "string") {
+        thing->setStateValue(m_stringValueStateTypeId.value(thingClassId), ModbusDataUtils::convertToString(registers, byteOrder(thing)));
+        return;
+    }
+
+    double value = 0;
+    if (dataType == "int16") {
+        value = ModbusDataUtils::convertToInt16(registers);
+    } else if (dataType == "uint32") {
+        value = ModbusDataUtils::convertToUInt32(registers, byteOrder(thing));
+    } else if (dataType == "int32") {
+        value = ModbusDataUtils::convertToInt32(registers, byteOrder(thing));
+    } else if (dataType == "uint64") {
+        value = ModbusDataUtils::convertToUInt64(registers, byteOrder(thing));
+    } else if (dataType == "int64") {
+        value = ModbusDataUtils::convertToInt64(registers, byteOrder(thing));
+    } else if (dataType == "float32") {
+        value = ModbusDataUtils::convertToFloat32(registers, byteOrder(thing));
+    } else if (dataType == "float64") {
+        value = ModbusDataUtils::convertToFloat64(registers, byteOrder(thing));
     } else {
-        // Request returned without an id
+        value = ModbusDataUtils::convertToUInt16(registers);
+    }
+
+    thing->setStateValue(m_valueStateTypeId.value(thingClassId), value * thing->paramValue(m_scaleFactorParamTypeId.value(thingClassId)).toDouble());
+}
+
+QVector<quint16> IntegrationPluginModbusCommander::registerValues(Thing *thing, double value) const
+{
+    ThingClassId thingClassId = thing->thingClassId();
+    QString dataType = thing->paramValue(m_dataTypeParamTypeId.value(thingClassId)).toString();
+    double scaleFactor = thing->paramValue(m_scaleFactorParamTypeId.value(thingClassId)).toDouble();
+    double rawValue = qFuzzyIsNull(scaleFactor) ? value : value / scaleFactor;
+
+    if (dataType == "int16") {
+        return ModbusDataUtils::convertFromInt16(static_cast<qint16>(qRound(rawValue)));
+    } else if (dataType == "uint32") {
+        return ModbusDataUtils::convertFromUInt32(static_cast<quint32>(qRound64(rawValue)), byteOrder(thing));
+    } else if (dataType == "int32") {
+        return ModbusDataUtils::convertFromInt32(static_cast<qint32>(qRound64(rawValue)), byteOrder(thing));
+    } else if (dataType == "uint64") {
+        return ModbusDataUtils::convertFromUInt64(static_cast<quint64>(qRound64(rawValue)), byteOrder(thing));
+    } else if (dataType == "int64") {
+        return ModbusDataUtils::convertFromInt64(qRound64(rawValue), byteOrder(thing));
+    } else if (dataType == "float32") {
+        return ModbusDataUtils::convertFromFloat32(static_cast<float>(rawValue), byteOrder(thing));
+    } else if (dataType == "float64") {
+        return ModbusDataUtils::convertFromFloat64(rawValue, byteOrder(thing));
+    } else if (dataType == "string") {
+        // Strings can not be written using the numeric value
+        return QVector<quint16>();
+    }
+
+    return ModbusDataUtils::convertFromUInt16(static_cast<quint16>(qRound(rawValue)));
+}
+
+void IntegrationPluginModbusCommander::handleReadError(const QList<Thing *> &things, bool blockRejected)
+{
+    foreach (Thing *thing, things) {
         thing->setStateValue(m_connectedStateTypeId.value(thing->thingClassId()), false);
     }
+
+    // Some devices reject reading registers which don't exist within a block, read them one by one for a while.
+    // Timeouts or an offline device are no reason for that, the block will simply be read again on the next update.
+    if (blockRejected && things.count() > 1) {
+        qCWarning(dcModbusCommander()) << "Block read of" << things.count() << "things has been rejected. Reading them one by one for the next" << BlockRetryCycles << "updates.";
+        foreach (Thing *thing, things) {
+            m_singleReadThings.insert(thing, BlockRetryCycles);
+        }
+    }
 }
 
 void IntegrationPluginModbusCommander::writeRegister(Thing *thing, ThingActionInfo *info)
@@ -656,6 +879,16 @@ void IntegrationPluginModbusCommander::writeRegister(Thing *thing, ThingActionIn
     QUuid requestId;
     Action action = info->action();
 
+    QVector<quint16> registers;
+    if (thing->thingClassId() == holdingRegisterThingClassId) {
+        registers = registerValues(thing, action.param(holdingRegisterValueActionValueParamTypeId).value().toDouble());
+        if (registers.isEmpty()) {
+            qCWarning(dcModbusCommander()) << "Cannot write value of" << thing << "with data type" << thing->paramValue(holdingRegisterThingDataTypeParamTypeId).toString();
+            info->finish(Thing::ThingErrorInvalidParameter, QT_TR_NOOP("String registers can not be written."));
+            return;
+        }
+    }
+
     if (parent->thingClassId() == modbusTCPClientThingClassId) {
         ModbusTcpMaster *modbus = m_modbusTCPMasters.value(parent);
         if (!modbus) {
@@ -667,7 +900,11 @@ void IntegrationPluginModbusCommander::writeRegister(Thing *thing, ThingActionIn
         if (thing->thingClassId() == coilThingClassId) {
             requestId = modbus->writeCoil(slaveAddress, registerAddress, action.param(coilValueActionValueParamTypeId).value().toBool());
         } else if (thing->thingClassId() == holdingRegisterThingClassId) {
-            requestId = modbus->writeHoldingRegister(slaveAddress, registerAddress, action.param(holdingRegisterValueActionValueParamTypeId).value().toUInt());
+            if (registers.count() == 1) {
+                requestId = modbus->writeHoldingRegister(slaveAddress, registerAddress, registers.first());
+            } else {
+                requestId = modbus->writeHoldingRegisters(slaveAddress, registerAddress, registers);
+            }
         }
 
     } else if (parent->thingClassId() == modbusRTUClientThingClassId) {
@@ -694,9 +931,7 @@ void IntegrationPluginModbusCommander::writeRegister(Thing *thing, ThingActionIn
                 info->finish(Thing::ThingErrorNoError);
             });
         } else if (thing->thingClassId() == holdingRegisterThingClassId) {
-            QVector<quint16> values;
-            values.append(static_cast<quint16>(action.param(holdingRegisterValueActionValueParamTypeId).value().toUInt()));
-
+            QVector<quint16> values = registers;
             ModbusRtuReply *reply = modbusMaster->writeHoldingRegisters(slaveAddress, registerAddress, values);
             connect(info, &ThingActionInfo::aborted, reply, &ModbusRtuReply::deleteLater);
             connect(reply, &ModbusRtuReply::finished, modbusMaster, [=](){
@@ -706,7 +941,7 @@ void IntegrationPluginModbusCommander::writeRegister(Thing *thing, ThingActionIn
                     return;
                 }
 
-                thing->setStateValue("value", action.param(holdingRegisterValueActionValueParamTypeId).value().toUInt());
+                thing->setStateValue("value", action.param(holdingRegisterValueActionValueParamTypeId).value().toDouble());
                 info->finish(Thing::ThingErrorNoError);
             });
         }
@@ -36,7 +36,9 @@
 #include <hardware/modbus/modbusrtumaster.h>
 
 #include <modbustcpmaster.h>
+#include <modbusdatautils.h>
 
+#include <QSet>
 #include <QUuid>
 #include <QSerialPort>
 #include <QSerialPortInfo>
@@ -64,15 +66,47 @@ private:
     QHash<Thing*, ModbusTcpMaster*> m_modbusTCPMasters;
     QHash<Thing *, ModbusRtuMaster *> m_modbusRtuMasters;
     QHash<QUuid, ThingActionInfo*> m_asyncActions;
-    QHash<QUuid, Thing*> m_readRequests;
-
-    void readRegister(Thing *thing);
+    QHash<QUuid, QList<Thing *>> m_readRequests;
+
+    // Register things of TCP clients indexed by master and register key for routing the received values
+    QHash<ModbusTcpMaster *, QMultiHash<quint32, Thing *>> m_registerThings;
+    QHash<Thing *, QPair<ModbusTcpMaster *, quint32>> m_registerThingKeys;
+
+    // Things which got rejected within a block read and will be read one by one,
+    // with the number of update cycles left until the block read will be tried again
+    QHash<Thing *, uint> m_singleReadThings;
+    static const uint BlockRetryCycles = 60;
+
+    void readRegisters(const QList<Thing *> &things);
+    void readRegisterBlock(const QList<Thing *> &things, uint registerAddress, uint size);
+    void setRegisterValues(const QList<Thing *> &things, uint registerAddress, const QVector<quint16> &values);
+    // Only if the device rejected the block the things will be read one by one for a while
+    void handleReadError(const QList<Thing *> &things, bool blockRejected = false);
     void writeRegister(Thing *thing, ThingActionInfo *info);
 
+    // Typed values of holding and input registers, coils and discrete inputs are always one register
+    uint registerCount(Thing *thing) const;
+    ModbusDataUtils::ByteOrder byteOrder(Thing *thing) const;
+    void setRegisterThingValue(Thing *thing, const QVector<quint16> &values, int offset);
+    QVector<quint16> registerValues(Thing *thing, double value) const;
+
+    void indexRegisterThing(Thing *thing);
+    void unindexRegisterThing(Thing *thing);
+    void indexRegisterThings(Thing *parent);
+    void unindexRegisterThings(ModbusTcpMaster *modbusTcpMaster);
+    void updateRegisterThings(ModbusTcpMaster *modbusTcpMaster, QModbusDataUnit::RegisterType registerType, uint slaveAddress, uint modbusRegister, const QVector<quint16> &values);
+    static quint32 registerKey(QModbusDataUnit::RegisterType registerType, uint slaveAddress, uint registerAddress);
+
     QHash<ThingClassId, ParamTypeId> m_slaveAddressParamTypeId;
     QHash<ThingClassId, ParamTypeId> m_registerAddressParamTypeId;
     QHash<ThingClassId, StateTypeId> m_connectedStateTypeId;
     QHash<ThingClassId, StateTypeId> m_valueStateTypeId;
+    QHash<ThingClassId, ParamTypeId> m_dataTypeParamTypeId;
+    QHash<ThingClassId, ParamTypeId> m_byteOrderParamTypeId;
+    QHash<ThingClassId, ParamTypeId> m_scaleFactorParamTypeId;
+    QHash<ThingClassId, ParamTypeId> m_stringLengthParamTypeId;
+    QHash<ThingClassId, StateTypeId> m_stringValueStateTypeId;
+    QHash<ThingClassId, QModbusDataUnit::RegisterType> m_registerType;
 
 private slots:
     void onPluginConfigurationChanged(const ParamTypeId &paramTypeId, const QVariant &value);
@@ -80,6 +114,7 @@ private slots:
     void onConnectionStateChanged(bool status);
     void onRequestExecuted(QUuid requestId, bool success);
     void onRequestError(QUuid requestId, const QString &error);
+    void onReadRequestException(const QUuid &requestId, QModbusPdu::ExceptionCode exceptionCode);
 
     void onReceivedCoil(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values);
     void onReceivedDiscreteInput(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values);
@@ -29,6 +29,7 @@
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include <network/networkdevicediscovery.h>
+#include <modbuspollorchestrator.h>
 
 #include "integrationpluginmtec.h"
 #include "plugininfo.h"
@@ -100,120 +101,90 @@ void IntegrationPluginMTec::setupThing(ThingSetupInfo *info)
             return;
         }
 
+        // Handle reconfigure
+        if (m_mtecConnections.contains(thing)) {
+            qCDebug(dcMTec()) << "Reconfiguring existing thing" << thing->name();
+            m_mtecConnections.take(thing)->deleteLater();
+        }
+
         qCDebug(dcMTec()) << "Using ip address" << hostAddress.toString();
 
-        MTec *mtec = new MTec(hostAddress, this);
-        connect(mtec, &MTec::connectedChanged, thing, [=](bool connected){
-            qCDebug(dcMTec()) << thing << "Connected changed to" << connected;
-            thing->setStateValue(mtecConnectedStateTypeId, connected);
+        // Modbus unit ID is undocumented, using 1 for now
+        MTecModbusTcpConnection *connection = new MTecModbusTcpConnection(hostAddress, 502, 1, this);
+        connection->modbusTcpMaster()->setTimeout(2000);
+        connection->modbusTcpMaster()->setNumberOfRetries(5);
+
+        connect(connection, &MTecModbusTcpConnection::reachableChanged, thing, [=](bool reachable){
+            qCDebug(dcMTec()) << thing << "Reachable changed to" << reachable;
+            thing->setStateValue(mtecConnectedStateTypeId, reachable);
         });
 
-        connect(mtec, &MTec::roomTemperatureChanged, thing, [=](double roomTemperature){
+        connect(connection, &MTecModbusTcpConnection::roomTemperatureChanged, thing, [=](float roomTemperature){
             qCDebug(dcMTec()) << thing << "Room temperature" << roomTemperature << "°C";
             thing->setStateValue(mtecTemperatureStateTypeId, roomTemperature);
         });
 
-        connect(mtec, &MTec::targetRoomTemperatureChanged, thing, [=](double targetRoomTemperature){
+        connect(connection, &MTecModbusTcpConnection::targetRoomTemperatureChanged, thing, [=](float targetRoomTemperature){
             qCDebug(dcMTec()) << thing << "Target room temperature" << targetRoomTemperature << "°C";
             thing->setStateValue(mtecTargetTemperatureStateTypeId, targetRoomTemperature);
         });
 
-        connect(mtec, &MTec::waterTankTopTemperatureChanged, thing, [=](double waterTankTopTemperature){
+        connect(connection, &MTecModbusTcpConnection::waterTankTopTemperatureChanged, thing, [=](float waterTankTopTemperature){
             qCDebug(dcMTec()) << thing << "Water tank top temperature" << waterTankTopTemperature << "°C";
             thing->setStateValue(mtecWaterTankTopTemperatureStateTypeId, waterTankTopTemperature);
         });
 
-        connect(mtec, &MTec::bufferTankTemperatureChanged, thing, [=](double bufferTankTemperature){
+        connect(connection, &MTecModbusTcpConnection::bufferTankTemperatureChanged, thing, [=](float bufferTankTemperature){
             qCDebug(dcMTec()) << thing << "Buffer tank temperature" << bufferTankTemperature << "°C";
             thing->setStateValue(mtecBufferTankTemperatureStateTypeId, bufferTankTemperature);
         });
 
-        connect(mtec, &MTec::totalAccumulatedHeatingEnergyChanged, thing, [=](double totalAccumulatedHeatingEnergy){
+        connect(connection, &MTecModbusTcpConnection::totalAccumulatedHeatingEnergyChanged, thing, [=](quint16 totalAccumulatedHeatingEnergy){
             qCDebug(dcMTec()) << thing << "Total accumulated heating energy" << totalAccumulatedHeatingEnergy << "kWh";
             thing->setStateValue(mtecTotalAccumulatedHeatingEnergyStateTypeId, totalAccumulatedHeatingEnergy);
         });
 
-        connect(mtec, &MTec::totalAccumulatedElectricalEnergyChanged, thing, [=](double totalAccumulatedElectricalEnergy){
+        connect(connection, &MTecModbusTcpConnection::totalAccumulatedElectricalEnergyChanged, thing, [=](quint16 totalAccumulatedElectricalEnergy){
             qCDebug(dcMTec()) << thing << "Total accumulated electrical energy" << totalAccumulatedElectricalEnergy << "kWh";
             thing->setStateValue(mtecTotalAccumulatedElectricalEnergyStateTypeId, totalAccumulatedElectricalEnergy);
         });
 
-        connect(mtec, &MTec::heatPumpStateChanged, thing, [=](MTec::HeatpumpState heatPumpState){
-            qCDebug(dcMTec()) << thing << "Heat pump state" << heatPumpState;
-            switch (heatPumpState) {
-            case MTec::HeatpumpStateStandby:
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Standby");
-                thing->setStateValue(mtecHeatingOnStateTypeId, false);
-                thing->setStateValue(mtecCoolingOnStateTypeId, false);
-                break;
-            case MTec::HeatpumpStatePreRun:
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Pre run");
-                thing->setStateValue(mtecHeatingOnStateTypeId, false);
-                thing->setStateValue(mtecCoolingOnStateTypeId, false);
-                break;
-            case MTec::HeatpumpStateAutomaticHeat:
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Automatic heat");
-                thing->setStateValue(mtecHeatingOnStateTypeId, true);
-                thing->setStateValue(mtecCoolingOnStateTypeId, false);
-                break;
-            case MTec::HeatpumpStateDefrost:
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Defrost");
-                thing->setStateValue(mtecHeatingOnStateTypeId, false);
-                thing->setStateValue(mtecCoolingOnStateTypeId, false);
-                break;
-            case MTec::HeatpumpStateAutomaticCool:
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Automatic cool");
-                thing->setStateValue(mtecHeatingOnStateTypeId, false);
-                thing->setStateValue(mtecCoolingOnStateTypeId, true);
-                break;
-            case MTec::HeatpumpStatePostRun:
-                thing->setStateValue(mtecHeatingOnStateTypeId, false);
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Post run");
-                thing->setStateValue(mtecCoolingOnStateTypeId, false);
-                break;
-            case MTec::HeatpumpStateSaftyShutdown:
-                thing->setStateValue(mtecHeatingOnStateTypeId, false);
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Safty shutdown");
-                thing->setStateValue(mtecCoolingOnStateTypeId, false);
-                break;
-            case MTec::HeatpumpStateError:
-                thing->setStateValue(mtecHeatingOnStateTypeId, false);
-                thing->setStateValue(mtecHeatPumpStateStateTypeId, "Error");
-                thing->setStateValue(mtecCoolingOnStateTypeId, false);
-                break;
-            }
+        connect(connection, &MTecModbusTcpConnection::heatpumpStateChanged, thing, [=](MTecModbusTcpConnection::HeatpumpState heatpumpState){
+            qCDebug(dcMTec()) << thing << "Heat pump state" << heatpumpState;
+            setHeatpumpState(thing, heatpumpState);
         });
 
-        connect(mtec, &MTec::heatMeterPowerConsumptionChanged, thing, [=](double heatMeterPowerConsumption){
+        connect(connection, &MTecModbusTcpConnection::heatMeterPowerConsumptionChanged, thing, [=](quint16 heatMeterPowerConsumption){
             qCDebug(dcMTec()) << thing << "Heat meter power consumption" << heatMeterPowerConsumption << "W";
             thing->setStateValue(mtecHeatMeterPowerConsumptionStateTypeId, heatMeterPowerConsumption);
         });
 
-        connect(mtec, &MTec::energyMeterPowerConsumptionChanged, thing, [=](double energyMeterPowerConsumption){
+        connect(connection, &MTecModbusTcpConnection::energyMeterPowerConsumptionChanged, thing, [=](quint16 energyMeterPowerConsumption){
             qCDebug(dcMTec()) << thing << "Energy meter power consumption" << energyMeterPowerConsumption << "W";
             thing->setStateValue(mtecEnergyMeterPowerConsumptionStateTypeId, energyMeterPowerConsumption);
         });
 
-        connect(mtec, &MTec::actualExcessEnergySmartHomeChanged, thing, [=](double actualExcessEnergySmartHome){
+        connect(connection, &MTecModbusTcpConnection::actualExcessEnergySmartHomeChanged, thing, [=](quint16 actualExcessEnergySmartHome){
             qCDebug(dcMTec()) << thing << "Smart home energy" << actualExcessEnergySmartHome << "W";
             thing->setStateValue(mtecSmartHomeEnergyStateTypeId, actualExcessEnergySmartHome);
         });
 
-        connect(mtec, &MTec::actualExcessEnergySmartHomeElectricityMeterChanged, thing, [=](double actualExcessEnergySmartHomeElectricityMeter){
+        connect(connection, &MTecModbusTcpConnection::actualExcessEnergySmartHomeElectricityMeterChanged, thing, [=](quint16 actualExcessEnergySmartHomeElectricityMeter){
             qCDebug(dcMTec()) << thing << "Smart home energy electrical meter" << actualExcessEnergySmartHomeElectricityMeter << "W";
             thing->setStateValue(mtecSmartHomeEnergyElectricityMeterStateTypeId, actualExcessEnergySmartHomeElectricityMeter);
         });
 
-        connect(mtec, &MTec::actualOutdoorTemperatureChanged, thing, [=](double actualOutdoorTemperature){
+        connect(connection, &MTecModbusTcpConnection::actualOutdoorTemperatureChanged, thing, [=](float actualOutdoorTemperature){
             qCDebug(dcMTec()) << thing << "Outdoor temperature" << actualOutdoorTemperature << "°C";
             thing->setStateValue(mtecOutdoorTemperatureStateTypeId, actualOutdoorTemperature);
         });
 
-        m_mtecConnections.insert(thing, mtec);
+        m_mtecConnections.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, hostAddress.toString(), true);
 
         // TODO: start timer and give 15 seconds until connected, since the controler is down for ~10 seconds after a disconnect
 
-        if (!mtec->connectDevice()) {
+        if (!connection->connectDevice()) {
             qCWarning(dcMTec()) << "Initial connect returned false. Lets wait 15 seconds until the connection can be established.";
         }
 
@@ -224,18 +195,16 @@ void IntegrationPluginMTec::setupThing(ThingSetupInfo *info)
 void IntegrationPluginMTec::postSetupThing(Thing *thing)
 {
     if (thing->thingClassId() == mtecThingClassId) {
-        MTec *mtec = m_mtecConnections.value(thing);
-        if (mtec) {
-            update(thing);
+        MTecModbusTcpConnection *connection = m_mtecConnections.value(thing);
+        if (connection && connection->reachable()) {
+            connection->update();
         }
 
         if (!m_pluginTimer) {
             qCDebug(dcMTec()) << "Starting plugin timer...";
             m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
             connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-                foreach (Thing *thing, myThings().filterByThingClassId(mtecThingClassId)) {
-                    update(thing);
-                }
+                ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
             });
         }
     }
@@ -244,10 +213,10 @@ void IntegrationPluginMTec::postSetupThing(Thing *thing)
 void IntegrationPluginMTec::thingRemoved(Thing *thing)
 {
     if (m_mtecConnections.contains(thing)) {
-        MTec *mtec = m_mtecConnections.take(thing);
-        if (mtec) {
-            mtec->disconnectDevice();
-            mtec->deleteLater();
+        MTecModbusTcpConnection *connection = m_mtecConnections.take(thing);
+        if (connection) {
+            connection->disconnectDevice();
+            connection->deleteLater();
         }
     }
 
@@ -262,86 +231,99 @@ void IntegrationPluginMTec::executeAction(ThingActionInfo *info)
     Thing *thing = info->thing();
     Action action = info->action();
 
-    MTec *mtec = m_mtecConnections.value(thing);
-    if (!mtec) {
+    MTecModbusTcpConnection *connection = m_mtecConnections.value(thing);
+    if (!connection) {
         qCWarning(dcMTec()) << "Could not execute action because the MTec connection could not be found for" << thing;
         info->finish(Thing::ThingErrorHardwareNotAvailable);
         return;
     }
 
     // Make sure we are connected
-    if (!mtec->connected()) {
-        qCWarning(dcMTec()) << "Could not execute action because the MTec connection is not connected" << thing;
+    if (!connection->reachable()) {
+        qCWarning(dcMTec()) << "Could not execute action because the MTec connection is not reachable" << thing;
         info->finish(Thing::ThingErrorHardwareNotAvailable);
         return;
     }
 
     if (action.actionTypeId() == mtecTargetTemperatureActionTypeId) {
-        double targetTemperature = action.paramValue(mtecTargetTemperatureActionTargetTemperatureParamTypeId).toDouble();
+        // The register has a resolution of 0.1 °C
+        double targetTemperature = qRound(action.paramValue(mtecTargetTemperatureActionTargetTemperatureParamTypeId).toDouble() * 10) / 10.0;
         qCDebug(dcMTec()) << "Setting target temperature" << targetTemperature << "°C";
-        QModbusReply *reply = mtec->setTargetRoomTemperature(targetTemperature);
+        QModbusReply *reply = connection->setTargetRoomTemperature(targetTemperature);
         if (!reply) {
             qCWarning(dcMTec()) << "Failed to send modbus request" << thing;
             info->finish(Thing::ThingErrorHardwareFailure);
             return;
         }
 
-        connect(reply, &QModbusReply::finished, this, [=]() {
-            reply->deleteLater();
-            if (reply->error() == QModbusDevice::NoError) {
-                qCDebug(dcMTec()) << "Setting target temperature" << targetTemperature << "°C" << "finished successfully";
-                thing->setStateValue(mtecTargetTemperatureStateTypeId, targetTemperature);
-                info->finish(Thing::ThingErrorNoError);
-            } else {
+        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+        connect(reply, &QModbusReply::finished, info, [=]() {
+            if (reply->error() != QModbusDevice::NoError) {
+                qCWarning(dcMTec()) << thing << "Setting target temperature finished with error:" << reply->errorString();
                 info->finish(Thing::ThingErrorHardwareFailure);
+                return;
             }
-        });
 
-        connect(reply, &QModbusReply::errorOccurred, this, [=](QModbusDevice::Error error) {
-            qCWarning(dcMTec()) << thing << "Action execution finished due to modbus replay error:" << error;
-            reply->deleteLater();
-            info->finish(Thing::ThingErrorHardwareFailure);
+            qCDebug(dcMTec()) << "Setting target temperature" << targetTemperature << "°C" << "finished successfully";
+            thing->setStateValue(mtecTargetTemperatureStateTypeId, targetTemperature);
+            info->finish(Thing::ThingErrorNoError);
         });
     } else if (action.actionTypeId() == mtecSmartHomeEnergyActionTypeId) {
         quint16 energy = action.paramValue(mtecSmartHomeEnergyActionSmartHomeEnergyParamTypeId).toUInt();
         qCDebug(dcMTec()) << "Setting smart home energy to" << energy << "W";
-        QModbusReply *reply = mtec->setSmartHomeEnergy(energy);
+        QModbusReply *reply = connection->setActualExcessEnergySmartHome(energy);
         if (!reply) {
             qCWarning(dcMTec()) << "Failed to send modbus request" << thing;
             info->finish(Thing::ThingErrorHardwareFailure);
             return;
         }
 
-        connect(reply, &QModbusReply::finished, this, [=]() {
-            reply->deleteLater();
-            if (reply->error() == QModbusDevice::NoError) {
-                qCDebug(dcMTec()) << "Setting smart home energy" << energy << "W" << "finished successfully";
-                thing->setStateValue(mtecSmartHomeEnergyStateTypeId, energy);
-                info->finish(Thing::ThingErrorNoError);
-            } else {
+        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+        connect(reply, &QModbusReply::finished, info, [=]() {
+            if (reply->error() != QModbusDevice::NoError) {
+                qCWarning(dcMTec()) << thing << "Setting smart home energy finished with error:" << reply->errorString();
                 info->finish(Thing::ThingErrorHardwareFailure);
+                return;
             }
-        });
 
-        connect(reply, &QModbusReply::errorOccurred, this, [=](QModbusDevice::Error error) {
-            qCWarning(dcMTec()) << thing << "Action execution finished due to modbus replay error:" << error;
-            reply->deleteLater();
-            info->finish(Thing::ThingErrorHardwareFailure);
+            qCDebug(dcMTec()) << "Setting smart home energy" << energy << "W" << "finished successfully";
+            thing->setStateValue(mtecSmartHomeEnergyStateTypeId, energy);
+            info->finish(Thing::ThingErrorNoError);
         });
     } else {
         Q_ASSERT_X(false, "executeAction", QString("Unhandled action: %1").arg(action.actionTypeId().toString()).toUtf8());
     }
 }
 
-void IntegrationPluginMTec::update(Thing *thing)
+void IntegrationPluginMTec::setHeatpumpState(Thing *thing, MTecModbusTcpConnection::HeatpumpState heatpumpState)
 {
-    if (thing->thingClassId() == mtecThingClassId) {
-        qCDebug(dcMTec()) << "Updating thing" << thing;
-        MTec *mtec = m_mtecConnections.value(thing);
-        if (!mtec) return;
-        mtec->updateValues();
+    switch (heatpumpState) {
+    case MTecModbusTcpConnection::HeatpumpStateStandby:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Standby");
+        break;
+    case MTecModbusTcpConnection::HeatpumpStatePreRun:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Pre run");
+        break;
+    case MTecModbusTcpConnection::HeatpumpStateAutomaticHeat:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Automatic heat");
+        break;
+    case MTecModbusTcpConnection::HeatpumpStateDefrost:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Defrost");
+        break;
+    case MTecModbusTcpConnection::HeatpumpStateAutomaticCool:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Automatic cool");
+        break;
+    case MTecModbusTcpConnection::HeatpumpStatePostRun:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Post run");
+        break;
+    case MTecModbusTcpConnection::HeatpumpStateSaftyShutdown:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Safty shutdown");
+        break;
+    case MTecModbusTcpConnection::HeatpumpStateError:
+        thing->setStateValue(mtecHeatPumpStateStateTypeId, "Error");
+        break;
     }
-}
-
-
 
+    thing->setStateValue(mtecHeatingOnStateTypeId, heatpumpState == MTecModbusTcpConnection::HeatpumpStateAutomaticHeat);
+    thing->setStateValue(mtecCoolingOnStateTypeId, heatpumpState == MTecModbusTcpConnection::HeatpumpStateAutomaticCool);
+}
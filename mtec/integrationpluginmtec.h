@@ -33,9 +33,7 @@
 #include <integrations/integrationplugin.h>
 #include <plugintimer.h>
 
-#include "mtec.h"
-
-#include <QUuid>
+#include "mtecmodbustcpconnection.h"
 
 class IntegrationPluginMTec: public IntegrationPlugin
 {
@@ -56,11 +54,9 @@ public:
 
 private:
     PluginTimer *m_pluginTimer = nullptr;
-    QHash<Thing *, MTec *> m_mtecConnections;
-
-private slots:
-    void update(Thing *thing);
+    QHash<Thing *, MTecModbusTcpConnection *> m_mtecConnections;
 
+    void setHeatpumpState(Thing *thing, MTecModbusTcpConnection::HeatpumpState heatpumpState);
 };
 
 #endif // INTEGRATIONPLUGINMTEC_H
@@ -1,11 +1,12 @@
 include(../plugins.pri)
+
+# Generate modbus connection
+MODBUS_CONNECTIONS += mtec-registers.json
+#MODBUS_TOOLS_CONFIG += VERBOSE
 include(../modbus.pri)
 
 SOURCES += \
-    mtec.cpp \
     integrationpluginmtec.cpp
 
 HEADERS += \
-    mtec.h \
     integrationpluginmtec.h
-
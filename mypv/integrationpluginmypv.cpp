@@ -31,9 +31,12 @@
 #include "plugininfo.h"
 #include "integrationpluginmypv.h"
 
+#include <QTimer>
 #include <QUdpSocket>
 #include <QHostAddress>
 
+#include <modbuspollorchestrator.h>
+
 IntegrationPluginMyPv::IntegrationPluginMyPv()
 {
 }
@@ -119,14 +122,38 @@ void IntegrationPluginMyPv::setupThing(ThingSetupInfo *info)
     Thing *thing = info->thing();
 
     if(thing->thingClassId() == elwaThingClassId) {
+        if (m_connections.contains(thing)) {
+            qCDebug(dcMypv()) << "Reconfiguring existing thing" << thing->name();
+            m_connections.take(thing)->deleteLater();
+        }
+
         QHostAddress address = QHostAddress(thing->paramValue(elwaThingIpAddressParamTypeId).toString());
-        ModbusTcpMaster *modbusTcpMaster = new ModbusTcpMaster(address, 502, this);
-        connect(modbusTcpMaster, &ModbusTcpMaster::connectionStateChanged, this, &IntegrationPluginMyPv::onConnectionStateChanged);
-        connect(modbusTcpMaster, &ModbusTcpMaster::receivedHoldingRegister, this, &IntegrationPluginMyPv::onReceivedHoldingRegister);
-        connect(modbusTcpMaster, &ModbusTcpMaster::writeRequestExecuted, this, &IntegrationPluginMyPv::onWriteRequestExecuted);
-        connect(modbusTcpMaster, &ModbusTcpMaster::writeRequestError, this, &IntegrationPluginMyPv::onWriteRequestError);
+        ElwaModbusTcpConnection *connection = new ElwaModbusTcpConnection(address, 502, 0xff, this);
+        connect(connection, &ElwaModbusTcpConnection::reachableChanged, thing, [thing](bool reachable){
+            qCDebug(dcMypv()) << "Reachable changed to" << reachable << "for" << thing;
+            thing->setStateValue(elwaConnectedStateTypeId, reachable);
+        });
+
+        connect(connection, &ElwaModbusTcpConnection::powerChanged, thing, [thing](quint16 power){
+            thing->setStateValue(elwaHeatingPowerStateTypeId, power);
+        });
+
+        connect(connection, &ElwaModbusTcpConnection::waterTemperatureChanged, thing, [thing](float waterTemperature){
+            thing->setStateValue(elwaTemperatureStateTypeId, waterTemperature);
+        });
 
-        m_modbusTcpMasters.insert(thing, modbusTcpMaster);
+        connect(connection, &ElwaModbusTcpConnection::targetWaterTemperatureChanged, thing, [thing](float targetWaterTemperature){
+            thing->setStateValue(elwaTargetWaterTemperatureStateTypeId, targetWaterTemperature);
+        });
+
+        connect(connection, &ElwaModbusTcpConnection::statusChanged, thing, [this, thing](ElwaModbusTcpConnection::Status status){
+            setStatus(thing, status);
+        });
+
+        m_connections.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, address.toString(), true);
+        connection->connectDevice();
+        info->finish(Thing::ThingErrorNoError);
     } else {
         Q_ASSERT_X(false, "setupThing", QString("Unhandled thingClassId: %1").arg(thing->thingClassId().toString()).toUtf8());
     }
@@ -136,19 +163,23 @@ void IntegrationPluginMyPv::postSetupThing(Thing *thing)
 {
     if (!m_refreshTimer) {
         m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
-        connect(m_refreshTimer, &PluginTimer::timeout, this, &IntegrationPluginMyPv::onRefreshTimer);
+        connect(m_refreshTimer, &PluginTimer::timeout, this, [this](){
+            ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
+        });
     }
 
     if (thing->thingClassId() == elwaThingClassId) {
-        update(thing);
+        ElwaModbusTcpConnection *connection = m_connections.value(thing);
+        if (connection && connection->reachable()) {
+            connection->update();
+        }
     }
 }
 
 void IntegrationPluginMyPv::thingRemoved(Thing *thing)
 {
-    if (thing->thingClassId() == elwaThingClassId) {
-        ModbusTcpMaster *modbusTCPMaster = m_modbusTcpMasters.take(thing);
-        modbusTCPMaster->deleteLater();
+    if (thing->thingClassId() == elwaThingClassId && m_connections.contains(thing)) {
+        m_connections.take(thing)->deleteLater();
     }
 
     if (myThings().isEmpty()) {
@@ -163,148 +194,92 @@ void IntegrationPluginMyPv::executeAction(ThingActionInfo *info)
     Action action = info->action();
 
     if (thing->thingClassId() == elwaThingClassId) {
+        ElwaModbusTcpConnection *connection = m_connections.value(thing);
+        if (!connection || !connection->reachable()) {
+            info->finish(Thing::ThingErrorHardwareNotAvailable);
+            return;
+        }
 
-        ModbusTcpMaster *modbusTCPMaster = m_modbusTcpMasters.value(thing);
+        QModbusReply *reply = nullptr;
         if (action.actionTypeId() == elwaHeatingPowerActionTypeId) {
             int heatingPower = action.param(elwaHeatingPowerActionHeatingPowerParamTypeId).value().toInt();
-            QUuid requestId = modbusTCPMaster->writeHoldingRegister(0xff, ElwaModbusRegisters::Power, heatingPower);
-            if (requestId.isNull()) {
-                info->finish(Thing::ThingErrorHardwareNotAvailable);
-            } else {
-                m_asyncActions.insert(requestId, info);
-                connect(info, &ThingActionInfo::aborted, this, [this, requestId] {m_asyncActions.remove(requestId);});
-            }
+            reply = connection->setPower(heatingPower);
         } else if (action.actionTypeId() == elwaPowerActionTypeId) {
-            bool power = action.param(elwaHeatingPowerActionHeatingPowerParamTypeId).value().toBool();
-            if(power) {
-                QUuid requestId = modbusTCPMaster->writeHoldingRegister(0xff, ElwaModbusRegisters::ManuelStart, 1);
-                if (requestId.isNull()) {
-                    info->finish(Thing::ThingErrorHardwareNotAvailable);
-                } else {
-                    m_asyncActions.insert(requestId, info);
-                    connect(info, &ThingActionInfo::aborted, this, [this, requestId] {m_asyncActions.remove(requestId);});
-                }
+            bool power = action.param(elwaPowerActionPowerParamTypeId).value().toBool();
+            if (!power) {
+                // There is no register for stopping, the device returns to standby on its own
+                info->finish(Thing::ThingErrorNoError);
+                return;
             }
+
+            reply = connection->setManualStart(1);
         } else {
             Q_ASSERT_X(false, "executeAction", QString("Unhandled actionTypeId: %1").arg(action.actionTypeId().toString()).toUtf8());
         }
-    } else {
-        Q_ASSERT_X(false, "executeAction", QString("Unhandled thingClassId: %1").arg(thing->thingClassId().toString()).toUtf8());
-    }
-}
-
-void IntegrationPluginMyPv::onRefreshTimer()
-{
-    foreach (Thing *thing, myThings()) {
-        update(thing);
-    }
-}
 
-void IntegrationPluginMyPv::onConnectionStateChanged(bool status)
-{
-    ModbusTcpMaster *modbusTcpMaster = static_cast<ModbusTcpMaster *>(sender());
-    Thing *thing = m_modbusTcpMasters.key(modbusTcpMaster);
-    if (!thing)
-        return;
-    thing->setStateValue(elwaConnectedStateTypeId, status);
-}
-
-void IntegrationPluginMyPv::onWriteRequestExecuted(QUuid requestId, bool success)
-{
-    if (m_asyncActions.contains(requestId)) {
-        ThingActionInfo *info = m_asyncActions.value(requestId);
-        if (success) {
-            info->finish(Thing::ThingErrorNoError);
-        } else {
+        if (!reply) {
             info->finish(Thing::ThingErrorHardwareNotAvailable);
+            return;
         }
-    }
-}
 
-void IntegrationPluginMyPv::onWriteRequestError(QUuid requestId, const QString &error)
-{
-    Q_UNUSED(requestId)
-    qCWarning(dcMypv()) << "Modbus error "<< error;
-}
+        connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+        connect(reply, &QModbusReply::finished, info, [info, reply](){
+            if (reply->error() != QModbusDevice::NoError) {
+                qCWarning(dcMypv()) << "Modbus error" << reply->errorString();
+                info->finish(Thing::ThingErrorHardwareNotAvailable);
+                return;
+            }
 
-void IntegrationPluginMyPv::onReceivedHoldingRegister(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &value)
-{
-    Q_UNUSED(slaveAddress)
-    ModbusTcpMaster *modbusTcpMaster = static_cast<ModbusTcpMaster *>(sender());
-    Thing *thing = m_modbusTcpMasters.key(modbusTcpMaster);
-    if (!thing)
-        return;
-
-    if(modbusRegister == ElwaModbusRegisters::Status) {
-        switch (ElwaStatus(value[0])) {
-        case ElwaStatus::Heating: {
-            thing->setStateValue(elwaStatusStateTypeId, "Heating");
-            thing->setStateValue(elwaPowerStateTypeId, true);
-            break;
-        }
-        case ElwaStatus::Standby:{
-            thing->setStateValue(elwaStatusStateTypeId, "Standby");
-            thing->setStateValue(elwaPowerStateTypeId, false);
-            break;
-        }
-        case ElwaStatus::Boosted:{
-            thing->setStateValue(elwaStatusStateTypeId, "Boosted");
-            thing->setStateValue(elwaPowerStateTypeId, true);
-            break;
-        }
-        case ElwaStatus::HeatFinished:{
-            thing->setStateValue(elwaStatusStateTypeId, "Heat finished");
-            thing->setStateValue(elwaPowerStateTypeId, false);
-            break;
-        }
-        case ElwaStatus::Setup:{
-            thing->setStateValue(elwaStatusStateTypeId, "Setup");
-            thing->setStateValue(elwaPowerStateTypeId, false);
-            break;
-        }
-        case ElwaStatus::ErrorOvertempFuseBlown:{
-            thing->setStateValue(elwaStatusStateTypeId, "Error Overtemp Fuse blown");
-            break;
-        }
-        case ElwaStatus::ErrorOvertempMeasured:{
-            thing->setStateValue(elwaStatusStateTypeId, "Error Overtemp measured");
-            break;
-        }
-        case ElwaStatus::ErrorOvertempElectronics:{
-            thing->setStateValue(elwaStatusStateTypeId, "Error Overtemp Electronics");
-            break;
-        }
-        case ElwaStatus::ErrorHardwareFault:{
-            thing->setStateValue(elwaStatusStateTypeId, "Error Hardware Fault");
-            break;
-        }
-        case ElwaStatus::ErrorTempSensor:{
-            thing->setStateValue(elwaStatusStateTypeId, "Error Temp Sensor");
-            break;
-        }
-        default:
-            thing->setStateValue(elwaStatusStateTypeId, "Unknown");
-        }
-    } else if(modbusRegister == ElwaModbusRegisters::WaterTemperature) {
-        thing->setStateValue(elwaTemperatureStateTypeId, value[0]/10.00);
-    } else if(modbusRegister == ElwaModbusRegisters::TargetWaterTemperature) {
-        thing->setStateValue(elwaTargetWaterTemperatureStateTypeId, value[0]/10.00);
-    } else if(modbusRegister == ElwaModbusRegisters::Power) {
-        thing->setStateValue(elwaHeatingPowerStateTypeId, value[0]);
+            // Don't wait for the next update to show the new heating power
+            if (info->action().actionTypeId() == elwaHeatingPowerActionTypeId)
+                info->thing()->setStateValue(elwaHeatingPowerStateTypeId, info->action().paramValue(elwaHeatingPowerActionHeatingPowerParamTypeId));
+
+            info->finish(Thing::ThingErrorNoError);
+        });
     } else {
-        qCWarning(dcMypv()) << "Received unhandled modbus register";
+        Q_ASSERT_X(false, "executeAction", QString("Unhandled thingClassId: %1").arg(thing->thingClassId().toString()).toUtf8());
     }
 }
 
-void IntegrationPluginMyPv::update(Thing *thing)
+void IntegrationPluginMyPv::setStatus(Thing *thing, ElwaModbusTcpConnection::Status status)
 {
-    if (thing->thingClassId() == elwaThingClassId) {
-        ModbusTcpMaster *modbusTCPMaster = m_modbusTcpMasters.value(thing);
-
-        modbusTCPMaster->readHoldingRegister(0xff, ElwaModbusRegisters::Status);
-        modbusTCPMaster->readHoldingRegister(0xff, ElwaModbusRegisters::WaterTemperature);
-        modbusTCPMaster->readHoldingRegister(0xff, ElwaModbusRegisters::TargetWaterTemperature);
-        modbusTCPMaster->readHoldingRegister(0xff, ElwaModbusRegisters::Power);
+    switch (status) {
+    case ElwaModbusTcpConnection::StatusHeating:
+        thing->setStateValue(elwaStatusStateTypeId, "Heating");
+        thing->setStateValue(elwaPowerStateTypeId, true);
+        break;
+    case ElwaModbusTcpConnection::StatusStandby:
+        thing->setStateValue(elwaStatusStateTypeId, "Standby");
+        thing->setStateValue(elwaPowerStateTypeId, false);
+        break;
+    case ElwaModbusTcpConnection::StatusBoosted:
+        thing->setStateValue(elwaStatusStateTypeId, "Boosted");
+        thing->setStateValue(elwaPowerStateTypeId, true);
+        break;
+    case ElwaModbusTcpConnection::StatusHeatFinished:
+        thing->setStateValue(elwaStatusStateTypeId, "Heat finished");
+        thing->setStateValue(elwaPowerStateTypeId, false);
+        break;
+    case ElwaModbusTcpConnection::StatusSetup:
+        thing->setStateValue(elwaStatusStateTypeId, "Setup");
+        thing->setStateValue(elwaPowerStateTypeId, false);
+        break;
+    case ElwaModbusTcpConnection::StatusErrorOvertempFuseBlown:
+        thing->setStateValue(elwaStatusStateTypeId, "Error Overtemp Fuse blown");
+        break;
+    case ElwaModbusTcpConnection::StatusErrorOvertempMeasured:
+        thing->setStateValue(elwaStatusStateTypeId, "Error Overtemp measured");
+        break;
+    case ElwaModbusTcpConnection::StatusErrorOvertempElectronics:
+        thing->setStateValue(elwaStatusStateTypeId, "Error Overtemp Electronics");
+        break;
+    case ElwaModbusTcpConnection::StatusErrorHardwareFault:
+        thing->setStateValue(elwaStatusStateTypeId, "Error Hardware Fault");
+        break;
+    case ElwaModbusTcpConnection::StatusErrorTempSensor:
+        thing->setStateValue(elwaStatusStateTypeId, "Error Temp Sensor");
+        break;
+    default:
+        thing->setStateValue(elwaStatusStateTypeId, "Unknown");
     }
 }
-
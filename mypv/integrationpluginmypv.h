@@ -34,10 +34,9 @@
 #include <integrations/integrationplugin.h>
 #include <plugintimer.h>
 
-#include <modbustcpmaster.h>
-
 #include <QUdpSocket>
-#include <QUuid>
+
+#include "elwamodbustcpconnection.h"
 
 class IntegrationPluginMyPv: public IntegrationPlugin
 {
@@ -57,42 +56,10 @@ public:
     void executeAction(ThingActionInfo *info) override;
 
 private:
-
-    enum ElwaModbusRegisters {
-        Power= 1000,
-        WaterTemperature = 1001,
-        TargetWaterTemperature = 1002,
-        Status = 1003,
-        ManuelStart = 1012
-    };
-
-    enum ElwaStatus {
-        Heating = 2,
-        Standby = 3,
-        Boosted = 4,
-        HeatFinished = 5,
-        Setup = 9,
-        ErrorOvertempFuseBlown = 201,
-        ErrorOvertempMeasured = 202,
-        ErrorOvertempElectronics = 203,
-        ErrorHardwareFault = 204,
-        ErrorTempSensor = 205
-    };
-
     PluginTimer *m_refreshTimer = nullptr;
-    QHash<Thing *, ModbusTcpMaster *> m_modbusTcpMasters;
-    QHash<QUuid, ThingActionInfo *> m_asyncActions;
-
-    void update(Thing *thing);
-
-private slots:
-    void onRefreshTimer();
-
-    void onConnectionStateChanged(bool status);
-    void onWriteRequestExecuted(QUuid requestId, bool success);
-    void onWriteRequestError(QUuid requestId, const QString &error);
+    QHash<Thing *, ElwaModbusTcpConnection *> m_connections;
 
-    void onReceivedHoldingRegister(quint32 slaveAddress, quint32 modbusRegister, const QVector<quint16> &values);
+    void setStatus(Thing *thing, ElwaModbusTcpConnection::Status status);
 };
 
 #endif // INTEGRATIONPLUGINMYPV_H
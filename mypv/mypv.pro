@@ -1,4 +1,8 @@
 include(../plugins.pri)
+
+# Generate modbus connection
+MODBUS_CONNECTIONS += mypv-registers.json
+#MODBUS_TOOLS_CONFIG += VERBOSE
 include(../modbus.pri)
 
 SOURCES += \
@@ -32,6 +32,7 @@
 #include <QCommandLineParser>
 #include <QCommandLineOption>
 
+#include <QFile>
 #include <QDebug>
 #include <QObject>
 #include <QSerialPort>
@@ -40,8 +41,13 @@
 #include <QModbusTcpClient>
 #include <QModbusRtuSerialMaster>
 
+#include "registerscanner.h"
+#include "requestbenchmark.h"
+
 void sendRequest(quint16 modbusServerAddress, QModbusDataUnit::RegisterType registerType, quint16 registerAddress, quint16 length, const QByteArray &writeData, QModbusClient *client);
 QString exceptionCodeToString(QModbusPdu::ExceptionCode exception);
+QModbusDataUnit::RegisterType registerTypeFromString(const QString &registerTypeString);
+QList<int> intListFromString(const QString &listString, bool *ok);
 
 int main(int argc, char *argv[])
 {
@@ -59,6 +65,10 @@ int main(int argc, char *argv[])
     description.append("-----------------------------------------\n");
     description.append("Example reading 2 holding registers from address 1000:\n");
     description.append("nymea-modbus-cli -a 192.168.0.10 -p 502 -r 1000 -l 2\n\n");
+    description.append("Example scanning 10000 holding registers from address 0 into a register map:\n");
+    description.append("nymea-modbus-cli -a 192.168.0.10 -r 0 -l 10000 --scan --format json -o registers.json\n\n");
+    description.append("Example benchmarking a request mix with different depths and intervals:\n");
+    description.append("nymea-modbus-cli -a 192.168.0.10 --benchmark --mix holding:1000:2,input:30:10 --depths 1,2,4 --intervals 0,50,100\n\n");
 
 
     description.append("RTU\n");
@@ -135,6 +145,43 @@ int main(int argc, char *argv[])
     QCommandLineOption writeOption(QStringList() << "w" << "write", QString("The data to be written to the given register."), "data");
     parser.addOption(writeOption);
 
+    // Scan
+    QCommandLineOption scanOption(QStringList() << "s" << "scan", QString("Scan the given length of registers starting at the given register using one connection. Unavailable registers will be skipped."));
+    parser.addOption(scanOption);
+
+    QCommandLineOption chunkSizeOption(QStringList() << "chunk-size", QString("Scan: The maximum number of registers per request. Will be halved on illegal data address exceptions. Default is 125, for coils and discrete inputs 2000."), "size");
+    parser.addOption(chunkSizeOption);
+
+    QCommandLineOption concurrentOption(QStringList() << "concurrent", QString("Scan: The number of requests sent at the same time. Default is 4 for TCP, RTU always uses 1."), "count");
+    concurrentOption.setDefaultValue("4");
+    parser.addOption(concurrentOption);
+
+    QCommandLineOption formatOption(QStringList() << "format", QString("Scan: The output format. The json format can be used as register map for generate-connection.py. Default is csv."), "csv, json");
+    formatOption.setDefaultValue("csv");
+    parser.addOption(formatOption);
+
+    QCommandLineOption outputOption(QStringList() << "o" << "output", QString("Scan: Write the result into the given file instead of stdout."), "file");
+    parser.addOption(outputOption);
+
+    // Benchmark
+    QCommandLineOption benchmarkOption(QStringList() << "b" << "benchmark", QString("Send read requests repeatedly and report throughput, latency percentiles, timeouts and exceptions."));
+    parser.addOption(benchmarkOption);
+
+    QCommandLineOption mixOption(QStringList() << "mix", QString("Benchmark: Comma separated list of read requests sent in turns. Default is the request given by type, register and length."), "type:register:length,...");
+    parser.addOption(mixOption);
+
+    QCommandLineOption depthsOption(QStringList() << "depths", QString("Benchmark: Comma separated list of requests in flight at the same time. Default is 1,2,4 for TCP, RTU always uses 1."), "depths");
+    depthsOption.setDefaultValue("1,2,4");
+    parser.addOption(depthsOption);
+
+    QCommandLineOption intervalsOption(QStringList() << "intervals", QString("Benchmark: Comma separated list of minimum intervals between two requests in ms. Default is 0,50,100."), "intervals");
+    intervalsOption.setDefaultValue("0,50,100");
+    parser.addOption(intervalsOption);
+
+    QCommandLineOption requestsOption(QStringList() << "requests", QString("Benchmark: The number of requests for each depth and interval combination. Default is 100."), "count");
+    requestsOption.setDefaultValue("100");
+    parser.addOption(requestsOption);
+
     QCommandLineOption debugOption(QStringList() << "d" << "debug", QString("Print more information."));
     parser.addOption(debugOption);
 
@@ -161,17 +208,8 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    QModbusDataUnit::RegisterType registerType = QModbusDataUnit::RegisterType::Invalid;
-    QString registerTypeString = parser.value(registerTypeOption);
-    if (registerTypeString.toLower() == "input") {
-        registerType = QModbusDataUnit::RegisterType::InputRegisters;
-    } else if (registerTypeString.toLower() == "holding") {
-        registerType = QModbusDataUnit::RegisterType::HoldingRegisters;
-    } else if (registerTypeString.toLower() == "discrete") {
-        registerType = QModbusDataUnit::RegisterType::DiscreteInputs;
-    } else if (registerTypeString.toLower() == "coils") {
-        registerType = QModbusDataUnit::RegisterType::Coils;
-    } else {
+    QModbusDataUnit::RegisterType registerType = registerTypeFromString(parser.value(registerTypeOption));
+    if (registerType == QModbusDataUnit::RegisterType::Invalid) {
         qCritical() << "Error: invalid register type:" << parser.value(registerTypeOption) << "Please select on of the valid register types: input, holding, discrete, coils";
         exit(EXIT_FAILURE);
     }
@@ -183,8 +221,9 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    // The benchmark request mix does not need a register
     quint16 registerAddress = parser.value(registerOption).toUInt(&valueOk);
-    if (!valueOk) {
+    if (!valueOk && !(parser.isSet(benchmarkOption) && parser.isSet(mixOption))) {
         qCritical() << "Error: invalid register number:" << parser.value(registerOption);
         exit(EXIT_FAILURE);
     }
@@ -201,6 +240,123 @@ int main(int argc, char *argv[])
         qDebug() << "Write data:" << writeData;
     }
 
+    RegisterScanner *scanner = nullptr;
+    if (parser.isSet(scanOption)) {
+        if (parser.isSet(writeOption)) {
+            qCritical() << "Error: invalid paramter combination. Scanning and writing can not be done at the same time.";
+            exit(EXIT_FAILURE);
+        }
+
+        QString format = parser.value(formatOption).toLower();
+        if (format != "csv" && format != "json") {
+            qCritical() << "Error: invalid output format:" << parser.value(formatOption) << "Please select on of the valid values: [csv, json].";
+            exit(EXIT_FAILURE);
+        }
+
+        scanner = new RegisterScanner(modbusServerAddress, registerType, &application);
+        if (parser.isSet(chunkSizeOption)) {
+            uint chunkSize = parser.value(chunkSizeOption).toUInt(&valueOk);
+            if (!valueOk || chunkSize < 1 || chunkSize > scanner->maxChunkSize()) {
+                qCritical() << "Error: invalid chunk size:" << parser.value(chunkSizeOption) << "Please select a value between 1 and" << scanner->maxChunkSize();
+                exit(EXIT_FAILURE);
+            }
+            scanner->setChunkSize(static_cast<quint16>(chunkSize));
+        }
+
+        // The RTU bus can only handle one request at a time
+        if (parser.isSet(addressOption)) {
+            scanner->setMaxConcurrentRequests(parser.value(concurrentOption).toInt());
+        }
+
+        QString protocol = parser.isSet(addressOption) ? "TCP" : "RTU";
+        QString outputFileName = parser.value(outputOption);
+        QObject::connect(scanner, &RegisterScanner::finished, &application, [=](){
+            QByteArray output = (format == "json" ? scanner->toRegistersJson(protocol) : scanner->toCsv());
+            if (outputFileName.isEmpty()) {
+                fprintf(stdout, "%s", output.constData());
+                fflush(stdout);
+                exit(EXIT_SUCCESS);
+            }
+
+            QFile outputFile(outputFileName);
+            if (!outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || outputFile.write(output) < 0) {
+                qCritical() << "Error: could not write output file" << outputFileName << outputFile.errorString();
+                exit(EXIT_FAILURE);
+            }
+
+            outputFile.close();
+            qInfo().noquote() << "Scan result written to" << outputFileName;
+            exit(EXIT_SUCCESS);
+        });
+    }
+
+    RequestBenchmark *benchmark = nullptr;
+    if (parser.isSet(benchmarkOption)) {
+        if (parser.isSet(writeOption) || parser.isSet(scanOption)) {
+            qCritical() << "Error: invalid paramter combination. The benchmark can not be combined with writing or scanning.";
+            exit(EXIT_FAILURE);
+        }
+
+        QList<RequestBenchmark::Request> requests;
+        if (parser.isSet(mixOption)) {
+            foreach (const QString &requestString, parser.value(mixOption).split(",")) {
+                if (requestString.trimmed().isEmpty())
+                    continue;
+
+                QStringList requestParts = requestString.trimmed().split(":");
+                RequestBenchmark::Request request;
+                bool addressOk = false;
+                bool sizeOk = false;
+                if (requestParts.count() == 3) {
+                    request.registerType = registerTypeFromString(requestParts.at(0));
+                    request.address = requestParts.at(1).toUInt(&addressOk);
+                    request.size = requestParts.at(2).toUInt(&sizeOk);
+                }
+
+                if (requestParts.count() != 3 || request.registerType == QModbusDataUnit::RegisterType::Invalid || !addressOk || !sizeOk || request.size < 1) {
+                    qCritical() << "Error: invalid benchmark request:" << requestString << "Please use the format type:register:length, i.e. holding:1000:2";
+                    exit(EXIT_FAILURE);
+                }
+
+                requests.append(request);
+            }
+        } else {
+            RequestBenchmark::Request request;
+            request.registerType = registerType;
+            request.address = registerAddress;
+            request.size = length;
+            requests.append(request);
+        }
+
+        QList<int> depths = intListFromString(parser.value(depthsOption), &valueOk);
+        if (!valueOk) {
+            qCritical() << "Error: invalid benchmark depths:" << parser.value(depthsOption);
+            exit(EXIT_FAILURE);
+        }
+
+        QList<int> intervals = intListFromString(parser.value(intervalsOption), &valueOk);
+        if (!valueOk) {
+            qCritical() << "Error: invalid benchmark intervals:" << parser.value(intervalsOption);
+            exit(EXIT_FAILURE);
+        }
+
+        int requestsPerStep = parser.value(requestsOption).toInt(&valueOk);
+        if (!valueOk || requestsPerStep < 1) {
+            qCritical() << "Error: invalid benchmark request count:" << parser.value(requestsOption);
+            exit(EXIT_FAILURE);
+        }
+
+        benchmark = new RequestBenchmark(modbusServerAddress, requests, &application);
+        // The RTU bus can only handle one request at a time
+        benchmark->setDepths(parser.isSet(addressOption) ? depths : QList<int>() << 1);
+        benchmark->setIntervals(intervals);
+        benchmark->setRequestsPerStep(requestsPerStep);
+        QObject::connect(benchmark, &RequestBenchmark::finished, &application, [=](){
+            benchmark->printResults();
+            exit(EXIT_SUCCESS);
+        });
+    }
+
     // TCP
     if (parser.isSet(addressOption)) {
         // TCP connection
@@ -225,6 +381,20 @@ int main(int argc, char *argv[])
                 return;
 
             qDebug() << "Connected successfully to" << QString("%1:%2").arg(address.toString()).arg(port);
+            if (scanner) {
+                if (!scanner->running())
+                    scanner->startScan(client, registerAddress, length);
+
+                return;
+            }
+
+            if (benchmark) {
+                if (!benchmark->running())
+                    benchmark->start(client);
+
+                return;
+            }
+
             sendRequest(modbusServerAddress, registerType, registerAddress, length, writeData, client);
         });
 
@@ -305,6 +475,20 @@ int main(int argc, char *argv[])
                 return;
 
             qDebug() << "Connected successfully to" << serialPortName << baudrate << dataBits << stopBits << parity << "modbus server address:" << modbusServerAddress;
+            if (scanner) {
+                if (!scanner->running())
+                    scanner->startScan(client, registerAddress, length);
+
+                return;
+            }
+
+            if (benchmark) {
+                if (!benchmark->running())
+                    benchmark->start(client);
+
+                return;
+            }
+
             sendRequest(modbusServerAddress, registerType, registerAddress, length, writeData, client);
         });
 
@@ -423,6 +607,44 @@ void sendRequest(quint16 modbusServerAddress, QModbusDataUnit::RegisterType regi
     }
 }
 
+QModbusDataUnit::RegisterType registerTypeFromString(const QString &registerTypeString)
+{
+    if (registerTypeString.toLower() == "input") {
+        return QModbusDataUnit::RegisterType::InputRegisters;
+    } else if (registerTypeString.toLower() == "holding") {
+        return QModbusDataUnit::RegisterType::HoldingRegisters;
+    } else if (registerTypeString.toLower() == "discrete") {
+        return QModbusDataUnit::RegisterType::DiscreteInputs;
+    } else if (registerTypeString.toLower() == "coils") {
+        return QModbusDataUnit::RegisterType::Coils;
+    }
+
+    return QModbusDataUnit::RegisterType::Invalid;
+}
+
+QList<int> intListFromString(const QString &listString, bool *ok)
+{
+    QList<int> values;
+    *ok = true;
+    foreach (const QString &valueString, listString.split(",")) {
+        if (valueString.trimmed().isEmpty())
+            continue;
+
+        bool valueOk = false;
+        int value = valueString.trimmed().toInt(&valueOk);
+        if (!valueOk || value < 0) {
+            *ok = false;
+            return QList<int>();
+        }
+        values.append(value);
+    }
+
+    if (values.isEmpty())
+        *ok = false;
+
+    return values;
+}
+
 QString exceptionCodeToString(QModbusPdu::ExceptionCode exception)
 {
     QString exceptionString;
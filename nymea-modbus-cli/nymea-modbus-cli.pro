@@ -16,7 +16,13 @@ gcc {
 }
 
 SOURCES += \
-        main.cpp
+        main.cpp \
+        registerscanner.cpp \
+        requestbenchmark.cpp
+
+HEADERS += \
+        registerscanner.h \
+        requestbenchmark.h
 
 target.path = $$[QT_INSTALL_PREFIX]/bin
 INSTALLS += target
@@ -0,0 +1,239 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "registerscanner.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+RegisterScanner::RegisterScanner(quint16 modbusServerAddress, QModbusDataUnit::RegisterType registerType, QObject *parent) :
+    QObject(parent),
+    m_modbusServerAddress(modbusServerAddress),
+    m_registerType(registerType)
+{
+    m_chunkSize = maxChunkSize();
+}
+
+quint16 RegisterScanner::chunkSize() const
+{
+    return m_chunkSize;
+}
+
+void RegisterScanner::setChunkSize(quint16 chunkSize)
+{
+    m_chunkSize = qBound(static_cast<quint16>(1), chunkSize, maxChunkSize());
+}
+
+quint16 RegisterScanner::maxChunkSize() const
+{
+    if (m_registerType == QModbusDataUnit::Coils || m_registerType == QModbusDataUnit::DiscreteInputs)
+        return 2000;
+
+    return 125;
+}
+
+int RegisterScanner::maxConcurrentRequests() const
+{
+    return m_maxConcurrentRequests;
+}
+
+void RegisterScanner::setMaxConcurrentRequests(int maxConcurrentRequests)
+{
+    m_maxConcurrentRequests = qMax(1, maxConcurrentRequests);
+}
+
+bool RegisterScanner::running() const
+{
+    return m_running;
+}
+
+void RegisterScanner::startScan(QModbusClient *client, quint16 startAddress, quint16 count)
+{
+    m_client = client;
+    m_running = true;
+    m_values.clear();
+    m_pendingRanges.clear();
+    m_requestCount = 0;
+    m_exceptionCount = 0;
+    m_errorCount = 0;
+
+    quint32 endAddress = qMin(static_cast<quint32>(startAddress) + count, static_cast<quint32>(0x10000));
+    for (quint32 address = startAddress; address < endAddress; address += m_chunkSize) {
+        Range range;
+        range.address = static_cast<quint16>(address);
+        range.size = static_cast<quint16>(qMin(static_cast<quint32>(m_chunkSize), endAddress - address));
+        m_pendingRanges.append(range);
+    }
+
+    qInfo().noquote() << "Scanning" << count << registerTypeName() << "registers starting at" << startAddress << "in chunks of" << m_chunkSize << "using" << m_maxConcurrentRequests << "concurrent requests";
+    m_scanTimer.start();
+    sendNextRequests();
+}
+
+QMap<quint16, quint16> RegisterScanner::values() const
+{
+    return m_values;
+}
+
+QByteArray RegisterScanner::toCsv() const
+{
+    QByteArray csv = "registerType,address,value,hex\n";
+    foreach (quint16 address, m_values.keys()) {
+        quint16 value = m_values.value(address);
+        csv.append(QString("%1,%2,%3,0x%4\n").arg(registerTypeName()).arg(address).arg(value).arg(value, 4, 16, QLatin1Char('0')).toUtf8());
+    }
+
+    return csv;
+}
+
+QByteArray RegisterScanner::toRegistersJson(const QString &protocol) const
+{
+    // Every readable register becomes an uint16 read only register, the types and names
+    // have to be adjusted manually once the meaning of the registers is known.
+    QJsonArray registers;
+    foreach (quint16 address, m_values.keys()) {
+        quint16 value = m_values.value(address);
+        QJsonObject registerObject;
+        registerObject.insert("id", QString("%1%2").arg(registerTypeName()).arg(address));
+        registerObject.insert("address", address);
+        registerObject.insert("size", 1);
+        registerObject.insert("type", "uint16");
+        registerObject.insert("registerType", registerTypeName());
+        registerObject.insert("readSchedule", "update");
+        registerObject.insert("description", QString("Scanned value %1 (0x%2)").arg(value).arg(value, 4, 16, QLatin1Char('0')));
+        registerObject.insert("defaultValue", "0");
+        registerObject.insert("access", "RO");
+        registers.append(registerObject);
+    }
+
+    QJsonObject registerMap;
+    registerMap.insert("className", "ScannedDevice");
+    registerMap.insert("protocol", protocol);
+    registerMap.insert("endianness", "BigEndian");
+    // The generator requires a register for verifying the connection, the first readable one will do
+    if (!m_values.isEmpty())
+        registerMap.insert("checkReachableRegister", QString("%1%2").arg(registerTypeName()).arg(m_values.firstKey()));
+
+    registerMap.insert("enums", QJsonArray());
+    registerMap.insert("registers", registers);
+    registerMap.insert("blocks", QJsonArray());
+    return QJsonDocument(registerMap).toJson(QJsonDocument::Indented);
+}
+
+void RegisterScanner::sendNextRequests()
+{
+    while (m_runningRequests < m_maxConcurrentRequests && !m_pendingRanges.isEmpty()) {
+        sendRequest(m_pendingRanges.takeFirst());
+    }
+
+    if (m_runningRequests == 0 && m_pendingRanges.isEmpty() && m_running) {
+        m_running = false;
+        qInfo().noquote() << "Scan finished after" << m_scanTimer.elapsed() << "ms." << m_values.count() << "registers readable," << m_requestCount << "requests," << m_exceptionCount << "exceptions," << m_errorCount << "errors";
+        emit finished();
+    }
+}
+
+void RegisterScanner::sendRequest(const Range &range)
+{
+    m_requestCount++;
+    QModbusReply *reply = m_client->sendReadRequest(QModbusDataUnit(m_registerType, range.address, range.size), m_modbusServerAddress);
+    if (!reply) {
+        qWarning() << "Failed to send read request for register" << range.address << "size" << range.size << m_client->errorString();
+        m_errorCount++;
+        return;
+    }
+
+    if (reply->isFinished()) {
+        reply->deleteLater(); // broadcast replies return immediately
+        m_errorCount++;
+        return;
+    }
+
+    m_runningRequests++;
+    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+    connect(reply, &QModbusReply::finished, this, [this, reply, range](){
+        m_runningRequests--;
+        processReply(reply, range);
+        sendNextRequests();
+    });
+}
+
+void RegisterScanner::processReply(QModbusReply *reply, const Range &range)
+{
+    if (reply->error() == QModbusDevice::NoError) {
+        const QModbusDataUnit unit = reply->result();
+        for (uint i = 0; i < unit.valueCount(); i++) {
+            m_values.insert(unit.startAddress() + i, unit.value(i));
+        }
+        return;
+    }
+
+    QModbusResponse response = reply->rawResult();
+    if (reply->error() == QModbusDevice::ProtocolError && response.isException()) {
+        m_exceptionCount++;
+        // Some devices report unavailable registers within a range as illegal data value
+        if (response.exceptionCode() == QModbusPdu::IllegalDataAddress || response.exceptionCode() == QModbusPdu::IllegalDataValue) {
+            if (range.size > 1) {
+                Range lower;
+                lower.address = range.address;
+                lower.size = range.size / 2;
+                Range upper;
+                upper.address = range.address + lower.size;
+                upper.size = range.size - lower.size;
+                // Continue with the halves first, so the registers will be found in order
+                m_pendingRanges.prepend(upper);
+                m_pendingRanges.prepend(lower);
+            }
+            return;
+        }
+
+        qWarning() << "Reading register" << range.address << "size" << range.size << "failed with exception" << response.exceptionCode();
+        return;
+    }
+
+    m_errorCount++;
+    qWarning() << "Reading register" << range.address << "size" << range.size << "failed:" << reply->error() << reply->errorString();
+}
+
+QString RegisterScanner::registerTypeName() const
+{
+    switch (m_registerType) {
+    case QModbusDataUnit::InputRegisters:
+        return "inputRegister";
+    case QModbusDataUnit::Coils:
+        return "coils";
+    case QModbusDataUnit::DiscreteInputs:
+        return "discreteInputs";
+    default:
+        return "holdingRegister";
+    }
+}
@@ -0,0 +1,102 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef REGISTERSCANNER_H
+#define REGISTERSCANNER_H
+
+#include <QMap>
+#include <QList>
+#include <QObject>
+#include <QElapsedTimer>
+#include <QModbusClient>
+#include <QModbusDataUnit>
+
+// Sweeps a register range on one persistent modbus connection. The range will be read in chunks,
+// if the server responds with an illegal data address exception the chunk will be halved until
+// the readable registers have been found. Unavailable single registers will be skipped.
+
+class RegisterScanner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RegisterScanner(quint16 modbusServerAddress, QModbusDataUnit::RegisterType registerType, QObject *parent = nullptr);
+
+    // Default is 125 registers, for coils and discrete inputs 2000
+    quint16 chunkSize() const;
+    void setChunkSize(quint16 chunkSize);
+    // Maximum allowed by the protocol for one read request
+    quint16 maxChunkSize() const;
+
+    // Requests in flight at the same time, RTU should always use 1
+    int maxConcurrentRequests() const;
+    void setMaxConcurrentRequests(int maxConcurrentRequests);
+
+    bool running() const;
+    void startScan(QModbusClient *client, quint16 startAddress, quint16 count);
+
+    QMap<quint16, quint16> values() const;
+
+    QByteArray toCsv() const;
+    // Register map in the format used by generate-connection.py
+    QByteArray toRegistersJson(const QString &protocol) const;
+
+signals:
+    void finished();
+
+private:
+    typedef struct Range {
+        quint16 address = 0;
+        quint16 size = 0;
+    } Range;
+
+    QModbusClient *m_client = nullptr;
+    quint16 m_modbusServerAddress = 1;
+    QModbusDataUnit::RegisterType m_registerType = QModbusDataUnit::HoldingRegisters;
+    quint16 m_chunkSize = 125;
+    int m_maxConcurrentRequests = 1;
+
+    bool m_running = false;
+    QList<Range> m_pendingRanges;
+    int m_runningRequests = 0;
+    QMap<quint16, quint16> m_values;
+
+    int m_requestCount = 0;
+    int m_exceptionCount = 0;
+    int m_errorCount = 0;
+    QElapsedTimer m_scanTimer;
+
+    void sendNextRequests();
+    void sendRequest(const Range &range);
+    void processReply(QModbusReply *reply, const Range &range);
+
+    QString registerTypeName() const;
+};
+
+#endif // REGISTERSCANNER_H
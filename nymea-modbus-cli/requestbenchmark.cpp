@@ -0,0 +1,244 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "requestbenchmark.h"
+
+#include <QDebug>
+#include <QtMath>
+
+#include <algorithm>
+
+RequestBenchmark::RequestBenchmark(quint16 modbusServerAddress, const QList<Request> &requests, QObject *parent) :
+    QObject(parent),
+    m_modbusServerAddress(modbusServerAddress),
+    m_requests(requests)
+{
+    m_depths << 1 << 2 << 4;
+    m_intervals << 0 << 50 << 100;
+
+    m_paceTimer.setSingleShot(true);
+    connect(&m_paceTimer, &QTimer::timeout, this, &RequestBenchmark::sendNextRequests);
+}
+
+void RequestBenchmark::setDepths(const QList<int> &depths)
+{
+    m_depths = depths;
+}
+
+void RequestBenchmark::setIntervals(const QList<int> &intervals)
+{
+    m_intervals = intervals;
+}
+
+void RequestBenchmark::setRequestsPerStep(int requestsPerStep)
+{
+    m_requestsPerStep = qMax(1, requestsPerStep);
+}
+
+bool RequestBenchmark::running() const
+{
+    return m_running;
+}
+
+void RequestBenchmark::start(QModbusClient *client)
+{
+    // Retries would hide timeouts and distort the latencies
+    m_client = client;
+    m_client->setNumberOfRetries(0);
+    m_running = true;
+    m_stepIndex = 0;
+    m_results.clear();
+
+    qInfo().noquote() << "Starting benchmark with" << m_depths.count() * m_intervals.count() << "steps of" << m_requestsPerStep << "requests each. Timeout is" << m_client->timeout() << "ms";
+    startStep();
+}
+
+QList<RequestBenchmark::StepResult> RequestBenchmark::results() const
+{
+    return m_results;
+}
+
+void RequestBenchmark::printResults() const
+{
+    qInfo().noquote() << "depth | interval [ms] | sent | ok   | timeouts | exceptions | errors | req/s   | p50 [ms] | p95 [ms] | p99 [ms] | max [ms]";
+    foreach (const StepResult &result, m_results) {
+        qInfo().noquote() << QString("%1 | %2 | %3 | %4 | %5 | %6 | %7 | %8 | %9 | %10 | %11 | %12")
+                             .arg(result.depth, 5)
+                             .arg(result.interval, 13)
+                             .arg(result.sent, 4)
+                             .arg(result.succeeded, 4)
+                             .arg(result.timeouts, 8)
+                             .arg(result.exceptions, 10)
+                             .arg(result.errors, 6)
+                             .arg(result.throughput, 7, 'f', 1)
+                             .arg(result.p50 / 1000.0, 8, 'f', 2)
+                             .arg(result.p95 / 1000.0, 8, 'f', 2)
+                             .arg(result.p99 / 1000.0, 8, 'f', 2)
+                             .arg(result.max / 1000.0, 8, 'f', 2);
+    }
+
+    // Derive the register JSON settings from the steps without any failed request
+    bool parallelRequestsOk = false;
+    int queuedRequestsDelay = -1;
+    qint64 worstP99 = 0;
+    foreach (const StepResult &result, m_results) {
+        if (result.succeeded != result.sent)
+            continue;
+
+        worstP99 = qMax(worstP99, result.p99);
+        if (result.depth > 1)
+            parallelRequestsOk = true;
+
+        if (result.depth == 1 && (queuedRequestsDelay < 0 || result.interval < queuedRequestsDelay))
+            queuedRequestsDelay = result.interval;
+    }
+
+    if (queuedRequestsDelay < 0 && !parallelRequestsOk) {
+        qInfo().noquote() << "No step finished without errors. Try larger intervals or a larger timeout.";
+        return;
+    }
+
+    qInfo().noquote() << "Suggested register JSON settings:";
+    qInfo().noquote() << "    \"queuedRequests\":" << (parallelRequestsOk ? "false" : "true");
+    if (queuedRequestsDelay >= 0)
+        qInfo().noquote() << "    \"queuedRequestsDelay\":" << (parallelRequestsOk ? 0 : queuedRequestsDelay);
+
+    // Leave some headroom for the worst observed p99 latency
+    qInfo().noquote() << "Suggested timeout: at least" << qMax(static_cast<qint64>(100), worstP99 * 3 / 1000) << "ms";
+}
+
+void RequestBenchmark::startStep()
+{
+    if (m_stepIndex >= m_depths.count() * m_intervals.count()) {
+        m_running = false;
+        emit finished();
+        return;
+    }
+
+    m_currentStep = StepResult();
+    m_currentStep.depth = qMax(1, m_depths.at(m_stepIndex / m_intervals.count()));
+    m_currentStep.interval = qMax(0, m_intervals.at(m_stepIndex % m_intervals.count()));
+    m_latencies.clear();
+    m_latencies.reserve(m_requestsPerStep);
+    m_requestIndex = 0;
+    m_lastSendTimestamp = -1;
+    m_stepTimer.start();
+
+    qDebug() << "Starting benchmark step with depth" << m_currentStep.depth << "and interval" << m_currentStep.interval << "ms";
+    sendNextRequests();
+}
+
+void RequestBenchmark::sendNextRequests()
+{
+    while (m_inFlight < m_currentStep.depth && m_currentStep.sent < m_requestsPerStep) {
+        // Keep the interval between two requests, independent of the depth
+        if (m_currentStep.interval > 0 && m_lastSendTimestamp >= 0) {
+            qint64 remaining = m_lastSendTimestamp + m_currentStep.interval - m_stepTimer.elapsed();
+            if (remaining > 0) {
+                if (!m_paceTimer.isActive())
+                    m_paceTimer.start(static_cast<int>(remaining));
+
+                return;
+            }
+        }
+
+        sendRequest();
+    }
+
+    if (m_inFlight == 0 && m_currentStep.sent >= m_requestsPerStep) {
+        finishStep();
+    }
+}
+
+void RequestBenchmark::sendRequest()
+{
+    const Request request = m_requests.at(m_requestIndex);
+    m_requestIndex = (m_requestIndex + 1) % m_requests.count();
+    m_currentStep.sent++;
+    m_lastSendTimestamp = m_stepTimer.elapsed();
+
+    qint64 sendTimestamp = m_stepTimer.nsecsElapsed();
+    QModbusReply *reply = m_client->sendReadRequest(QModbusDataUnit(request.registerType, request.address, request.size), m_modbusServerAddress);
+    if (!reply) {
+        m_currentStep.errors++;
+        return;
+    }
+
+    if (reply->isFinished()) {
+        reply->deleteLater(); // broadcast replies return immediately
+        m_currentStep.errors++;
+        return;
+    }
+
+    m_inFlight++;
+    connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
+    connect(reply, &QModbusReply::finished, this, [this, reply, sendTimestamp](){
+        m_inFlight--;
+        if (reply->error() == QModbusDevice::NoError) {
+            m_currentStep.succeeded++;
+            m_latencies.append((m_stepTimer.nsecsElapsed() - sendTimestamp) / 1000);
+        } else if (reply->error() == QModbusDevice::TimeoutError) {
+            m_currentStep.timeouts++;
+        } else if (reply->error() == QModbusDevice::ProtocolError && reply->rawResult().isException()) {
+            m_currentStep.exceptions++;
+        } else {
+            m_currentStep.errors++;
+        }
+
+        sendNextRequests();
+    });
+}
+
+void RequestBenchmark::finishStep()
+{
+    m_currentStep.duration = m_stepTimer.elapsed();
+    if (m_currentStep.duration > 0)
+        m_currentStep.throughput = m_currentStep.succeeded * 1000.0 / m_currentStep.duration;
+
+    std::sort(m_latencies.begin(), m_latencies.end());
+    m_currentStep.p50 = percentile(m_latencies, 50);
+    m_currentStep.p95 = percentile(m_latencies, 95);
+    m_currentStep.p99 = percentile(m_latencies, 99);
+    m_currentStep.max = m_latencies.isEmpty() ? 0 : m_latencies.last();
+    m_results.append(m_currentStep);
+
+    m_stepIndex++;
+    // Do not start the next step from within the reply finished handler
+    QTimer::singleShot(0, this, &RequestBenchmark::startStep);
+}
+
+qint64 RequestBenchmark::percentile(const QVector<qint64> &sortedValues, double percent)
+{
+    if (sortedValues.isEmpty())
+        return 0;
+
+    int index = qBound(0, static_cast<int>(qCeil(percent / 100.0 * sortedValues.count())) - 1, sortedValues.count() - 1);
+    return sortedValues.at(index);
+}
@@ -0,0 +1,115 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef REQUESTBENCHMARK_H
+#define REQUESTBENCHMARK_H
+
+#include <QList>
+#include <QTimer>
+#include <QVector>
+#include <QObject>
+#include <QElapsedTimer>
+#include <QModbusClient>
+#include <QModbusDataUnit>
+
+// Sends a mix of read requests repeatedly for each combination of in flight depth and request interval
+// and measures throughput, latency percentiles, timeouts and exceptions. The results help choosing
+// queuedRequests, queuedRequestsDelay and the timeout for a new device.
+
+class RequestBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    typedef struct Request {
+        QModbusDataUnit::RegisterType registerType = QModbusDataUnit::HoldingRegisters;
+        quint16 address = 0;
+        quint16 size = 1;
+    } Request;
+
+    typedef struct StepResult {
+        int depth = 1;
+        int interval = 0;
+        int sent = 0;
+        int succeeded = 0;
+        int timeouts = 0;
+        int exceptions = 0;
+        int errors = 0;
+        qint64 duration = 0;
+        double throughput = 0;
+        // Latencies in micro seconds
+        qint64 p50 = 0;
+        qint64 p95 = 0;
+        qint64 p99 = 0;
+        qint64 max = 0;
+    } StepResult;
+
+    explicit RequestBenchmark(quint16 modbusServerAddress, const QList<Request> &requests, QObject *parent = nullptr);
+
+    void setDepths(const QList<int> &depths);
+    void setIntervals(const QList<int> &intervals);
+    void setRequestsPerStep(int requestsPerStep);
+
+    bool running() const;
+    void start(QModbusClient *client);
+
+    QList<StepResult> results() const;
+    void printResults() const;
+
+signals:
+    void finished();
+
+private:
+    QModbusClient *m_client = nullptr;
+    quint16 m_modbusServerAddress = 1;
+    QList<Request> m_requests;
+    QList<int> m_depths;
+    QList<int> m_intervals;
+    int m_requestsPerStep = 100;
+
+    bool m_running = false;
+    int m_stepIndex = 0;
+    int m_requestIndex = 0;
+    int m_inFlight = 0;
+    StepResult m_currentStep;
+    QVector<qint64> m_latencies;
+    QElapsedTimer m_stepTimer;
+    qint64 m_lastSendTimestamp = -1;
+    QTimer m_paceTimer;
+    QList<StepResult> m_results;
+
+    void startStep();
+    void sendNextRequests();
+    void sendRequest();
+    void finishStep();
+
+    static qint64 percentile(const QVector<qint64> &sortedValues, double percent);
+};
+
+#endif // REQUESTBENCHMARK_H
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2023 nymea GmbH <developer@nymea.io>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+# Verifies that register maps written by "nymea-modbus-cli --scan --format json" are accepted
+# by generate-connection.py, for TCP and RTU. Without arguments the reference output
+# scanned-registers.json next to this script will be checked.
+
+import os
+import sys
+import json
+import tempfile
+import subprocess
+
+scriptDirectory = os.path.dirname(os.path.abspath(__file__))
+generator = os.path.join(scriptDirectory, '..', '..', 'libnymea-modbus', 'tools', 'generate-connection.py')
+
+fileNames = sys.argv[1:]
+if not fileNames:
+    fileNames = [os.path.join(scriptDirectory, 'scanned-registers.json')]
+
+failed = False
+for fileName in fileNames:
+    with open(fileName) as jsonFile:
+        registerJson = json.load(jsonFile)
+
+    for protocol in ['TCP', 'RTU']:
+        registerJson['protocol'] = protocol
+        with tempfile.TemporaryDirectory() as outputDirectory:
+            jsonFileName = os.path.join(outputDirectory, 'registers.json')
+            with open(jsonFileName, 'w') as outputFile:
+                json.dump(registerJson, outputFile)
+
+            result = subprocess.run([sys.executable, generator, '-j', jsonFileName, '-o', outputDirectory], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+            if result.returncode != 0:
+                print('FAIL %s (%s)' % (fileName, protocol))
+                print(result.stdout)
+                failed = True
+            else:
+                print('PASS %s (%s)' % (fileName, protocol))
+
+sys.exit(1 if failed else 0)
@@ -74,7 +74,7 @@ for(plugin, PLUGINS) {
         message("- $${plugin}")
         # Make sure the libs will be built before the plugins
         equals(plugin, "sunspec") {
-            $${plugin}.depends += libnymea-sunspec
+            $${plugin}.depends += libnymea-sunspec libnymea-modbus
         } else {
             $${plugin}.depends += libnymea-modbus
         }
@@ -34,6 +34,8 @@
 #include "phoenixmodbustcpconnection.h"
 #include "phoenixdiscovery.h"
 
+#include <modbuspollorchestrator.h>
+
 #include <network/networkdevicediscovery.h>
 #include <types/param.h>
 #include <plugintimer.h>
@@ -139,6 +141,21 @@ void IntegrationPluginPhoenixConnect::setupThing(ThingSetupInfo *info)
 
         m_connections.insert(thing, connection);
         m_monitors.insert(thing, monitor);
+
+        // Only update if the network device monitor sees the wallbox
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusTcpMaster()->hostAddress().toString(), [thing, connection, monitor](){
+            if (thing->setupStatus() != Thing::ThingSetupStatusComplete || !monitor->reachable()) {
+                qCDebug(dcPhoenixConnect()) << thing->name() << "isn't reachable. Not updating.";
+                return false;
+            }
+
+            qCDebug(dcPhoenixConnect()) << "Updating" << thing->name() << monitor->macAddress() << monitor->networkDeviceInfo().address().toString();
+            return connection->update();
+        });
+        connect(connection, &PhoenixModbusTcpConnection::updateFinished, ModbusPollOrchestrator::instance(), [connection](){
+            ModbusPollOrchestrator::instance()->finishCycle(connection);
+        });
+
         info->finish(Thing::ThingErrorNoError);
     });
 
@@ -220,14 +237,7 @@ void IntegrationPluginPhoenixConnect::postSetupThing(Thing *thing)
         qCDebug(dcPhoenixConnect()) << "Starting plugin timer";
         m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
         connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-            foreach (Thing *thing, myThings()) {
-                if (thing->setupStatus() == Thing::ThingSetupStatusComplete && m_monitors.value(thing)->reachable()) {
-                    qCDebug(dcPhoenixConnect()) << "Updating" << thing->name() << m_monitors.value(thing)->macAddress() << m_monitors.value(thing)->networkDeviceInfo().address().toString();
-                    m_connections.value(thing)->update();
-                } else {
-                    qCDebug(dcPhoenixConnect()) << thing->name() << "isn't reachable. Not updating.";
-                }
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
         });
     }
 }
@@ -263,17 +273,19 @@ void IntegrationPluginPhoenixConnect::executeAction(ThingActionInfo *info)
     } else if (actionType.name() == "maxChargingCurrent") {
         uint16_t current = action.param(actionType.id()).value().toUInt();
         qCDebug(dcPhoenixConnect()) << "Charging power set to" << current;
-        QModbusReply *reply = connection->setMaximumChargingCurrent(current * 10);
-        connect(reply, &QModbusReply::finished, info, [info, thing, reply, current](){
-            if (reply->error() != QModbusDevice::NoError) {
-                qCWarning(dcPhoenixConnect()) << "Error setting charging current" << reply->error() << reply->errorString();
-                info->finish(Thing::ThingErrorHardwareFailure);
-            } else {
-                qCDebug(dcPhoenixConnect()) << "Max charging current set to" << current;
-                thing->setStateValue("maxChargingCurrent", current);
-                info->finish(Thing::ThingErrorNoError);
-            }
+        // Latest value wins, a newer current written meanwhile finishes this action as well
+        connect(connection, &PhoenixModbusTcpConnection::maximumChargingCurrentApplied, info, [connection, info, thing, current](){
+            QObject::disconnect(connection, nullptr, info, nullptr);
+            qCDebug(dcPhoenixConnect()) << "Max charging current set to" << current;
+            thing->setStateValue("maxChargingCurrent", current);
+            info->finish(Thing::ThingErrorNoError);
+        });
+        connect(connection, &PhoenixModbusTcpConnection::maximumChargingCurrentApplyFailed, info, [connection, info](){
+            QObject::disconnect(connection, nullptr, info, nullptr);
+            qCWarning(dcPhoenixConnect()) << "Error setting charging current";
+            info->finish(Thing::ThingErrorHardwareFailure);
         });
+        connection->applyMaximumChargingCurrent(current * 10);
 
     } else {
         Q_ASSERT_X(false, "executeAction", QString("Unhandled action: %1").arg(actionType.name()).toUtf8());
@@ -284,7 +296,9 @@ void IntegrationPluginPhoenixConnect::thingRemoved(Thing *thing)
 {
     qCDebug(dcPhoenixConnect()) << "Removing device" << thing->name();
     if (m_connections.contains(thing)) {
-        m_connections.take(thing)->deleteLater();
+        PhoenixModbusTcpConnection *connection = m_connections.take(thing);
+        ModbusPollOrchestrator::instance()->removeConnection(connection);
+        connection->deleteLater();
         hardwareManager()->networkDeviceDiscovery()->unregisterMonitor(m_monitors.take(thing));
     }
 
@@ -35,6 +35,8 @@
 
 #include "ciondiscovery.h"
 
+#include <modbuspollorchestrator.h>
+
 IntegrationPluginSchrack::IntegrationPluginSchrack()
 {
 }
@@ -105,6 +107,7 @@ void IntegrationPluginSchrack::setupThing(ThingSetupInfo *info)
     CionModbusRtuConnection *cionConnection = new CionModbusRtuConnection(hardwareManager()->modbusRtuResource()->getModbusRtuMaster(uuid), address, this);
     if (!info->isInitialSetup()) {
         m_cionConnections.insert(thing, cionConnection);
+        ModbusPollOrchestrator::instance()->addConnection(this, cionConnection, cionConnection->modbusRtuMaster()->serialPort(), true);
         info->finish(Thing::ThingErrorNoError);
     }
 
@@ -122,6 +125,7 @@ void IntegrationPluginSchrack::setupThing(ThingSetupInfo *info)
         if (info->isInitialSetup()) {
             if (success) {
                 m_cionConnections.insert(thing, cionConnection);
+                ModbusPollOrchestrator::instance()->addConnection(this, cionConnection, cionConnection->modbusRtuMaster()->serialPort(), true);
                 info->finish(Thing::ThingErrorNoError);
                 info->thing()->setStateValue(cionCurrentVersionStateTypeId, cionConnection->firmwareVersion());
             } else {
@@ -147,7 +151,7 @@ void IntegrationPluginSchrack::setupThing(ThingSetupInfo *info)
         // As we have may set charging current to 0 ourselves, we'll want to activate it again here
         uint maxSetPoint = thing->stateValue(cionMaxChargingCurrentStateTypeId).toUInt();
         if (cionConnection->chargingCurrentSetpoint() != maxSetPoint) {
-            cionConnection->setChargingCurrentSetpoint(maxSetPoint);
+            cionConnection->applyChargingCurrentSetpoint(maxSetPoint);
         }
     });
 
@@ -246,10 +250,11 @@ void IntegrationPluginSchrack::postSetupThing(Thing *thing)
     if (!m_refreshTimer) {
         m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
         connect(m_refreshTimer, &PluginTimer::timeout, this, [this] {
+            ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
+
             foreach (Thing *thing, myThings()) {
 
                 CionModbusRtuConnection *connection = m_cionConnections.value(thing);
-                connection->update();
 
                 // The only apparent way to know whether it is charging, is to compare if lastChargingDuration has changed
                 // If it didn't change in the last cycle
@@ -318,11 +323,8 @@ void IntegrationPluginSchrack::executeAction(ThingActionInfo *info)
         });
 
         // And restore the charging current in case setting the above fails
-        reply = cionConnection->setChargingCurrentSetpoint(maxChargingCurrent);
-        waitForActionFinish(info, reply, cionPowerStateTypeId, enabled);
-        connect(reply, &ModbusRtuReply::finished, info, [reply](){
-            qCDebug(dcSchrack) << "Implicit max charging current setpoint command reply:" << reply->error() << reply->errorString();
-        });
+        waitForActionFinish(info, cionConnection, cionPowerStateTypeId, enabled);
+        cionConnection->applyChargingCurrentSetpoint(maxChargingCurrent);
 
 
     } else if (info->action().actionTypeId() == cionMaxChargingCurrentActionTypeId) {
@@ -330,11 +332,8 @@ void IntegrationPluginSchrack::executeAction(ThingActionInfo *info)
         uint maxChargingCurrent = info->action().paramValue(cionMaxChargingCurrentActionMaxChargingCurrentParamTypeId).toUInt();
         if (info->thing()->stateValue(cionPowerStateTypeId).toBool()) {
             qCDebug(dcSchrack) << "Charging is enabled. Applying max charging current setpoint of" << maxChargingCurrent << "to wallbox";
-            ModbusRtuReply *reply = cionConnection->setChargingCurrentSetpoint(maxChargingCurrent);
-            waitForActionFinish(info, reply, cionMaxChargingCurrentStateTypeId, maxChargingCurrent);
-            connect(reply, &ModbusRtuReply::finished, info, [reply](){
-                qCDebug(dcSchrack) << "Charging current setpoint command reply:" << reply->error() << reply->errorString();
-            });
+            waitForActionFinish(info, cionConnection, cionMaxChargingCurrentStateTypeId, maxChargingCurrent);
+            cionConnection->applyChargingCurrentSetpoint(maxChargingCurrent);
 
         } else { // we'll just memorize what the user wants in our state and write it when enabled is set to true
             qCDebug(dcSchrack) << "Charging is disabled, storing max charging current of" << maxChargingCurrent << "to state";
@@ -347,13 +346,19 @@ void IntegrationPluginSchrack::executeAction(ThingActionInfo *info)
     Q_ASSERT_X(false, "IntegrationPluginSchrack::executeAction", QString("Unhandled action: %1").arg(info->action().actionTypeId().toString()).toLocal8Bit());
 }
 
-void IntegrationPluginSchrack::waitForActionFinish(ThingActionInfo *info, ModbusRtuReply *reply, const StateTypeId &stateTypeId, const QVariant &value)
+void IntegrationPluginSchrack::waitForActionFinish(ThingActionInfo *info, CionModbusRtuConnection *cionConnection, const StateTypeId &stateTypeId, const QVariant &value)
 {
-    connect(reply, &ModbusRtuReply::finished, info, [=](){
-        info->finish(reply->error() == ModbusRtuReply::NoError ? Thing::ThingErrorNoError : Thing::ThingErrorHardwareFailure);
-        if (reply->error() == ModbusRtuReply::NoError) {
-            info->thing()->setStateValue(stateTypeId, value);
-        }
+    // Latest value wins, a newer setpoint written meanwhile finishes this action as well
+    connect(cionConnection, &CionModbusRtuConnection::chargingCurrentSetpointApplied, info, [=](quint16 chargingCurrentSetpoint){
+        qCDebug(dcSchrack) << "Charging current setpoint" << chargingCurrentSetpoint << "applied";
+        QObject::disconnect(cionConnection, nullptr, info, nullptr);
+        info->thing()->setStateValue(stateTypeId, value);
+        info->finish(Thing::ThingErrorNoError);
+    });
+    connect(cionConnection, &CionModbusRtuConnection::chargingCurrentSetpointApplyFailed, info, [=](quint16 chargingCurrentSetpoint){
+        qCDebug(dcSchrack) << "Failed to apply charging current setpoint" << chargingCurrentSetpoint;
+        QObject::disconnect(cionConnection, nullptr, info, nullptr);
+        info->finish(Thing::ThingErrorHardwareFailure);
     });
 }
 
@@ -75,7 +75,7 @@ public:
     void executeAction(ThingActionInfo *info) override;
 
 private:
-    void waitForActionFinish(ThingActionInfo *info, ModbusRtuReply *reply, const StateTypeId &stateTypeId, const QVariant &value);
+    void waitForActionFinish(ThingActionInfo *info, CionModbusRtuConnection *cionConnection, const StateTypeId &stateTypeId, const QVariant &value);
     void updatePhaseCount(Thing *thing, const QString &phases);
 
 private:
@@ -33,6 +33,8 @@
 #include "hardwaremanager.h"
 #include "hardware/modbus/modbusrtuhardwareresource.h"
 
+#include <modbuspollorchestrator.h>
+
 IntegrationPluginSenseAir::IntegrationPluginSenseAir()
 {
 
@@ -94,6 +96,7 @@ void IntegrationPluginSenseAir::setupThing(ThingSetupInfo *info)
         if (success) {
             qCDebug(dcSenseAir()) << "Meter status:" << s8Connection->meterStatus();
             m_s8Connections.insert(thing, s8Connection);
+            ModbusPollOrchestrator::instance()->addConnection(this, s8Connection, s8Connection->modbusRtuMaster()->serialPort());
             info->finish(Thing::ThingErrorNoError);
         } else {
             delete s8Connection;
@@ -121,12 +124,7 @@ void IntegrationPluginSenseAir::postSetupThing(Thing *thing)
         qCDebug(dcSenseAir()) << "Starting plugin timer...";
         m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(5);
         connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-            foreach(SenseAirS8ModbusRtuConnection *connection, m_s8Connections) {
-                qCDebug(dcSenseAir()) << "Updating...";
-                if (connection->reachable()) {
-                    connection->update();
-                }
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
         });
 
         m_pluginTimer->start();
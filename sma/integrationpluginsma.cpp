@@ -38,6 +38,7 @@
 #include "modbus/smamodbusbatteryinverterdiscovery.h"
 
 #include <network/networkdevicediscovery.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginSma::IntegrationPluginSma()
 {
@@ -102,8 +103,8 @@ void IntegrationPluginSma::discoverThings(ThingDiscoveryInfo *info)
             return;
         }
 
-        // Note: does not require the network device discovery...
-        SpeedwireDiscovery *speedwireDiscovery = new SpeedwireDiscovery(hardwareManager()->networkDeviceDiscovery(), speedwireInterface, getLocalSerialNumber(), info);
+        // Note: does not require the network device discovery, meters will be discovered passively by the registry
+        SpeedwireDiscovery *speedwireDiscovery = new SpeedwireDiscovery(hardwareManager()->networkDeviceDiscovery(), speedwireInterface, m_speedwireDeviceRegistry, getLocalSerialNumber(), info);
         connect(speedwireDiscovery, &SpeedwireDiscovery::discoveryFinished, this, [=](){
             qCDebug(dcSma()) << "Speed wire discovery finished.";
             speedwireDiscovery->deleteLater();
@@ -143,7 +144,7 @@ void IntegrationPluginSma::discoverThings(ThingDiscoveryInfo *info)
             info->finish(Thing::ThingErrorNoError);
         });
 
-        speedwireDiscovery->startDiscovery();
+        speedwireDiscovery->startDiscovery(Speedwire::DeviceTypeMeter);
 
     } else if (info->thingClassId() == speedwireInverterThingClassId) {
         if (!hardwareManager()->networkDeviceDiscovery()->available()) {
@@ -159,7 +160,7 @@ void IntegrationPluginSma::discoverThings(ThingDiscoveryInfo *info)
             return;
         }
 
-        SpeedwireDiscovery *speedwireDiscovery = new SpeedwireDiscovery(hardwareManager()->networkDeviceDiscovery(), speedwireInterface, getLocalSerialNumber(), info);
+        SpeedwireDiscovery *speedwireDiscovery = new SpeedwireDiscovery(hardwareManager()->networkDeviceDiscovery(), speedwireInterface, m_speedwireDeviceRegistry, getLocalSerialNumber(), info);
         connect(speedwireDiscovery, &SpeedwireDiscovery::discoveryFinished, this, [=](){
             qCDebug(dcSma()) << "Speed wire discovery finished.";
             speedwireDiscovery->deleteLater();
@@ -200,7 +201,7 @@ void IntegrationPluginSma::discoverThings(ThingDiscoveryInfo *info)
             info->finish(Thing::ThingErrorNoError);
         });
 
-        speedwireDiscovery->startDiscovery();
+        speedwireDiscovery->startDiscovery(Speedwire::DeviceTypeInverter);
 
     } else if (info->thingClassId() == modbusSolarInverterThingClassId) {
         if (!hardwareManager()->networkDeviceDiscovery()->available()) {
@@ -321,6 +322,8 @@ void IntegrationPluginSma::setupThing(ThingSetupInfo *info)
 
         SunnyWebBox *sunnyWebBox = new SunnyWebBox(hardwareManager()->networkManager(), QHostAddress(thing->paramValue(sunnyWebBoxThingHostParamTypeId).toString()), this);
         sunnyWebBox->setMacAddress(thing->paramValue(sunnyWebBoxThingMacAddressParamTypeId).toString());
+        // The WebBoxes are slow, reuse the HTTP connection and send the requests one after an other
+        sunnyWebBox->setBatchedMode(true);
 
         connect(info, &ThingSetupInfo::aborted, sunnyWebBox, &SunnyWebBox::deleteLater);
         connect(sunnyWebBox, &SunnyWebBox::destroyed, this, [thing, this] { m_sunnyWebBoxes.remove(thing);});
@@ -704,8 +707,10 @@ void IntegrationPluginSma::thingRemoved(Thing *thing)
             && myThings().filterByThingClassId(speedwireInverterThingClassId).isEmpty()
             && myThings().filterByThingClassId(speedwireBatteryThingClassId).isEmpty()) {
         // Delete shared multicast socket...
+        // ...together with the device registry living on it
         m_speedwireInterface->deleteLater();
         m_speedwireInterface = nullptr;
+        m_speedwireDeviceRegistry = nullptr;
     }
 
     if (myThings().isEmpty()) {
@@ -763,12 +768,7 @@ void IntegrationPluginSma::setupRefreshTimer()
             inverter->refresh();
         }
 
-        foreach (SmaSolarInverterModbusTcpConnection *connection, m_modbusSolarInverters) {
-            connection->update();
-        }
-        foreach (SmaBatteryInverterModbusTcpConnection *connection, m_modbusBatteryInverters) {
-            connection->update();
-        }
+        ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
     });
 
     m_refreshTimer->start();
@@ -845,6 +845,7 @@ void IntegrationPluginSma::setupModbusSolarInverterConnection(ThingSetupInfo *in
 
         qCDebug(dcSma()) << "Connection init finished successfully" << connection;
         m_modbusSolarInverters.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusTcpMaster()->hostAddress().toString(), true);
         info->finish(Thing::ThingErrorNoError);
 
         // Set connected true
@@ -853,52 +854,54 @@ void IntegrationPluginSma::setupModbusSolarInverterConnection(ThingSetupInfo *in
             childThing->setStateValue("connected", true);
         }
 
-        connect(connection, &SmaSolarInverterModbusTcpConnection::updateFinished, thing, [=](){
+        connect(connection, &SmaSolarInverterModbusTcpConnection::snapshotUpdated, thing, [=](const SmaSolarInverterModbusTcpConnection::Snapshot &snapshot){
             qCDebug(dcSma()) << "Updated" << connection;
 
+            // Note: the snapshot keeps the last valid value if the inverter reports an invalid one
+
             // Grid voltage
-            if (isModbusValueValid(connection->gridVoltagePhaseA()))
-                thing->setStateValue(modbusSolarInverterVoltagePhaseAStateTypeId, connection->gridVoltagePhaseA() / 100.0);
+            if (snapshot.gridVoltagePhaseAValid)
+                thing->setStateValue(modbusSolarInverterVoltagePhaseAStateTypeId, snapshot.gridVoltagePhaseA / 100.0);
 
-            if (isModbusValueValid(connection->gridVoltagePhaseB()))
-                thing->setStateValue(modbusSolarInverterVoltagePhaseBStateTypeId, connection->gridVoltagePhaseB() / 100.0);
+            if (snapshot.gridVoltagePhaseBValid)
+                thing->setStateValue(modbusSolarInverterVoltagePhaseBStateTypeId, snapshot.gridVoltagePhaseB / 100.0);
 
-            if (isModbusValueValid(connection->gridVoltagePhaseC()))
-                thing->setStateValue(modbusSolarInverterVoltagePhaseCStateTypeId, connection->gridVoltagePhaseC() / 100.0);
+            if (snapshot.gridVoltagePhaseCValid)
+                thing->setStateValue(modbusSolarInverterVoltagePhaseCStateTypeId, snapshot.gridVoltagePhaseC / 100.0);
 
             // Grid current
-            if (isModbusValueValid(connection->gridCurrentPhaseA()))
-                thing->setStateValue(modbusSolarInverterCurrentPhaseAStateTypeId, connection->gridCurrentPhaseA() / 1000.0);
+            if (snapshot.gridCurrentPhaseAValid)
+                thing->setStateValue(modbusSolarInverterCurrentPhaseAStateTypeId, snapshot.gridCurrentPhaseA / 1000.0);
 
-            if (isModbusValueValid(connection->gridCurrentPhaseB()))
-                thing->setStateValue(modbusSolarInverterCurrentPhaseBStateTypeId, connection->gridCurrentPhaseB() / 1000.0);
+            if (snapshot.gridCurrentPhaseBValid)
+                thing->setStateValue(modbusSolarInverterCurrentPhaseBStateTypeId, snapshot.gridCurrentPhaseB / 1000.0);
 
-            if (isModbusValueValid(connection->gridCurrentPhaseC()))
-                thing->setStateValue(modbusSolarInverterCurrentPhaseCStateTypeId, connection->gridCurrentPhaseC() / 1000.0);
+            if (snapshot.gridCurrentPhaseCValid)
+                thing->setStateValue(modbusSolarInverterCurrentPhaseCStateTypeId, snapshot.gridCurrentPhaseC / 1000.0);
 
             // Phase power
-            if (isModbusValueValid(connection->currentPowerPhaseA()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseAStateTypeId, connection->currentPowerPhaseA());
+            if (snapshot.currentPowerPhaseAValid)
+                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseAStateTypeId, snapshot.currentPowerPhaseA);
 
-            if (isModbusValueValid(connection->currentPowerPhaseB()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseBStateTypeId, connection->currentPowerPhaseB());
+            if (snapshot.currentPowerPhaseBValid)
+                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseBStateTypeId, snapshot.currentPowerPhaseB);
 
-            if (isModbusValueValid(connection->currentPowerPhaseC()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseCStateTypeId, connection->currentPowerPhaseC());
+            if (snapshot.currentPowerPhaseCValid)
+                thing->setStateValue(modbusSolarInverterCurrentPowerPhaseCStateTypeId, snapshot.currentPowerPhaseC);
 
             // Others
-            if (isModbusValueValid(connection->totalYield()))
-                thing->setStateValue(modbusSolarInverterTotalEnergyProducedStateTypeId, connection->totalYield() / 1000.0); // kWh
+            if (snapshot.totalYieldValid)
+                thing->setStateValue(modbusSolarInverterTotalEnergyProducedStateTypeId, snapshot.totalYield / 1000.0); // kWh
 
-            if (isModbusValueValid(connection->dailyYield()))
-                thing->setStateValue(modbusSolarInverterEnergyProducedTodayStateTypeId, connection->dailyYield() / 1000.0); // kWh
+            if (snapshot.dailyYieldValid)
+                thing->setStateValue(modbusSolarInverterEnergyProducedTodayStateTypeId, snapshot.dailyYield / 1000.0); // kWh
 
             // Power
-            if (isModbusValueValid(connection->currentPower()))
-                thing->setStateValue(modbusSolarInverterCurrentPowerStateTypeId, -connection->currentPower());
+            if (snapshot.currentPowerValid)
+                thing->setStateValue(modbusSolarInverterCurrentPowerStateTypeId, -snapshot.currentPower);
 
             // Version
-            thing->setStateValue(modbusSolarInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(connection->softwarePackage()));
+            thing->setStateValue(modbusSolarInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(snapshot.softwarePackage));
         });
 
         // Update registers
@@ -976,18 +979,24 @@ void IntegrationPluginSma::setupModbusBatteryInverterConnection(ThingSetupInfo *
 
         qCDebug(dcSma()) << "Connection init finished successfully" << connection;
         m_modbusBatteryInverters.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusTcpMaster()->hostAddress().toString(), true);
         info->finish(Thing::ThingErrorNoError);
 
         thing->setStateValue("connected", true);
 
-        connect(connection, &SmaBatteryInverterModbusTcpConnection::updateFinished, thing, [=](){
+        connect(connection, &SmaBatteryInverterModbusTcpConnection::snapshotUpdated, thing, [=](const SmaBatteryInverterModbusTcpConnection::Snapshot &snapshot){
             qCDebug(dcSma()) << "Updated" << connection;
-            thing->setStateValue(modbusBatteryInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(connection->softwarePackage()));
+            thing->setStateValue(modbusBatteryInverterFirmwareVersionStateTypeId, Sma::buildSoftwareVersionString(snapshot.softwarePackage));
+
+            if (snapshot.batterySOCValid) {
+                thing->setStateValue(modbusBatteryInverterBatteryLevelStateTypeId, snapshot.batterySOC);
+                thing->setStateValue(modbusBatteryInverterBatteryCriticalStateTypeId, snapshot.batterySOC <= 5);
+            }
 
-            thing->setStateValue(modbusBatteryInverterBatteryLevelStateTypeId, connection->batterySOC());
-            thing->setStateValue(modbusBatteryInverterBatteryCriticalStateTypeId, connection->batterySOC() <= 5);
-            thing->setStateValue(modbusBatteryInverterCurrentPowerStateTypeId, -connection->currentPower());
-            thing->setStateValue(modbusBatteryInverterChargingStateStateTypeId, connection->currentPower() == 0 ? "idle" : (connection->currentPower() > 0 ? "charging" : "discharging"));
+            if (snapshot.currentPowerValid) {
+                thing->setStateValue(modbusBatteryInverterCurrentPowerStateTypeId, -snapshot.currentPower);
+                thing->setStateValue(modbusBatteryInverterChargingStateStateTypeId, snapshot.currentPower == 0 ? "idle" : (snapshot.currentPower > 0 ? "charging" : "discharging"));
+            }
 
         });
 
@@ -1000,8 +1009,21 @@ void IntegrationPluginSma::setupModbusBatteryInverterConnection(ThingSetupInfo *
 
 SpeedwireInterface *IntegrationPluginSma::getSpeedwireInterface()
 {
-    if (!m_speedwireInterface)
-        m_speedwireInterface = new SpeedwireInterface(getLocalSerialNumber(), this);
+    if (!m_speedwireInterface) {
+        // Busy multicast segments can be drained in batches instead of one datagram per event loop iteration
+        SpeedwireInterface::ReceiveBackend receiveBackend = SpeedwireInterface::ReceiveBackendQt;
+        if (configValue(smaPluginSpeedwireBatchedReceiveParamTypeId).toBool())
+            receiveBackend = SpeedwireInterface::ReceiveBackendBatched;
+
+        m_speedwireInterface = new SpeedwireInterface(getLocalSerialNumber(), receiveBackend, this);
+
+        // For development: record the speedwire traffic for replaying it using sma/test/speedwire-replay.py
+        QString captureFileName = QString::fromLocal8Bit(qgetenv("NYMEA_SMA_SPEEDWIRE_CAPTURE"));
+        if (!captureFileName.isEmpty())
+            m_speedwireInterface->startCapture(captureFileName);
+
+        m_speedwireDeviceRegistry = new SpeedwireDeviceRegistry(m_speedwireInterface, m_speedwireInterface);
+    }
 
     if (!m_speedwireInterface->available())
         m_speedwireInterface->initialize();
@@ -1085,19 +1107,3 @@ quint64 IntegrationPluginSma::getLocalSerialNumber()
     qCInfo(dcSma()) << "Using local serial number" << m_localSerialNumber;
     return m_localSerialNumber;
 }
-
-bool IntegrationPluginSma::isModbusValueValid(quint32 value)
-{
-    return value != 0xffffffff;
-}
-
-bool IntegrationPluginSma::isModbusValueValid(qint32 value)
-{
-    return value != static_cast<qint32>(0x80000000);
-}
-
-bool IntegrationPluginSma::isModbusValueValid(quint64 value)
-{
-    return value != 0xffffffffffffffff;
-}
-
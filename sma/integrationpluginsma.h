@@ -41,6 +41,7 @@
 #include "speedwire/speedwiremeter.h"
 #include "speedwire/speedwireinverter.h"
 #include "speedwire/speedwireinterface.h"
+#include "speedwire/speedwiredeviceregistry.h"
 
 #include "smasolarinvertermodbustcpconnection.h"
 #include "smabatteryinvertermodbustcpconnection.h"
@@ -89,6 +90,9 @@ private:
     SpeedwireInterface *m_speedwireInterface = nullptr;
     SpeedwireInterface *getSpeedwireInterface();
 
+    // Passively learns all speedwire devices from the traffic on the shared interface
+    SpeedwireDeviceRegistry *m_speedwireDeviceRegistry = nullptr;
+
     void markSpeedwireMeterAsDisconnected(Thing *thing);
     void markSpeedwireInverterAsDisconnected(Thing *thing);
     void markSpeedwireBatteryAsDisconnected(Thing *thing);
@@ -96,11 +100,6 @@ private:
     void markModbusBatteryInverterAsDisconnected(Thing *thing);
 
     quint64 getLocalSerialNumber();
-
-    // Sma modbus data validation
-    bool isModbusValueValid(quint32 value);
-    bool isModbusValueValid(qint32 value);
-    bool isModbusValueValid(quint64 value);
 };
 
 #endif // INTEGRATIONPLUGINSMA_H
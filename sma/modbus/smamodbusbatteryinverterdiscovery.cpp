@@ -51,15 +51,24 @@ SmaModbusBatteryInverterDiscovery::SmaModbusBatteryInverterDiscovery(NetworkDevi
 void SmaModbusBatteryInverterDiscovery::startDiscovery()
 {
     qCInfo(dcSma()) << "Discovery: Searching for SMA battery inverters in the network...";
-    NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &SmaModbusBatteryInverterDiscovery::checkNetworkDevice);
+    // Only hosts with the modbus port open and a matching signature get a connection for checking the device
+    ModbusTcpDiscovery *modbusTcpDiscovery = new ModbusTcpDiscovery(m_networkDeviceDiscovery, m_port, m_modbusAddress, this);
+    modbusTcpDiscovery->setSignatureName("sma-battery-inverter");
+    modbusTcpDiscovery->setSignatureRegisters(QModbusDataUnit::HoldingRegisters, SmaBatteryInverterModbusTcpConnection::RegisterDeviceClass, 2, [](const QVector<quint16> &values){
+        return ModbusDataUtils::convertToUInt32(values, ModbusDataUtils::ByteOrderBigEndian) == Sma::DeviceClassBatteryInverter;
+    });
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::deviceFound, this, [this](const ModbusTcpDiscovery::Result &result){
+        checkNetworkDevice(result.networkDeviceInfo);
+    });
 
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        qCDebug(dcSma()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::discoveryFinished, this, [=](){
+        qCDebug(dcSma()) << "Discovery: Network discovery finished. Found" << modbusTcpDiscovery->results().count() << "network devices with the modbus port open";
+        modbusTcpDiscovery->deleteLater();
         m_gracePeriodTimer.start();
-        discoveryReply->deleteLater();
     });
+
+    modbusTcpDiscovery->startDiscovery();
 }
 
 QList<SmaModbusBatteryInverterDiscovery::Result> SmaModbusBatteryInverterDiscovery::discoveryResults() const
@@ -32,6 +32,7 @@
 #define SMAMODBUSBATTERYINVERTERDISCOVERY_H
 
 #include <network/networkdevicediscovery.h>
+#include <modbustcpdiscovery.h>
 
 #include <QObject>
 
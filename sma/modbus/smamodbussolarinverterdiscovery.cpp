@@ -46,22 +46,20 @@ SmaModbusSolarInverterDiscovery::SmaModbusSolarInverterDiscovery(NetworkDeviceDi
 void SmaModbusSolarInverterDiscovery::startDiscovery()
 {
     qCInfo(dcSma()) << "Discovery: Start searching for SMA modbus inverters in the network...";
-    NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
 
-    // Imedialty check any new device gets discovered
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &SmaModbusSolarInverterDiscovery::checkNetworkDevice);
-
-    // Check what might be left on finished
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        qCDebug(dcSma()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
+    // Only hosts with the modbus port open and a matching signature get a connection for checking the device
+    ModbusTcpDiscovery *modbusTcpDiscovery = new ModbusTcpDiscovery(m_networkDeviceDiscovery, m_port, m_modbusAddress, this);
+    modbusTcpDiscovery->setSignatureName("sma-solar-inverter");
+    modbusTcpDiscovery->setSignatureRegisters(QModbusDataUnit::HoldingRegisters, SmaSolarInverterModbusTcpConnection::RegisterDeviceClass, 2, [](const QVector<quint16> &values){
+        return ModbusDataUtils::convertToUInt32(values, ModbusDataUtils::ByteOrderBigEndian) == Sma::DeviceClassSolarInverter;
+    });
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::deviceFound, this, [this](const ModbusTcpDiscovery::Result &result){
+        checkNetworkDevice(result.networkDeviceInfo);
+    });
 
-        // Send a report request to nework device info not sent already...
-        foreach (const NetworkDeviceInfo &networkDeviceInfo, discoveryReply->networkDeviceInfos()) {
-            if (!m_verifiedNetworkDeviceInfos.contains(networkDeviceInfo)) {
-                checkNetworkDevice(networkDeviceInfo);
-            }
-        }
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::discoveryFinished, this, [=](){
+        qCDebug(dcSma()) << "Discovery: Network discovery finished. Found" << modbusTcpDiscovery->results().count() << "network devices with the modbus port open";
+        modbusTcpDiscovery->deleteLater();
 
         // Give the last connections added right before the network discovery finished a chance to check the device...
         QTimer::singleShot(3000, this, [this](){
@@ -69,6 +67,8 @@ void SmaModbusSolarInverterDiscovery::startDiscovery()
             finishDiscovery();
         });
     });
+
+    modbusTcpDiscovery->startDiscovery();
 }
 
 QList<SmaModbusSolarInverterDiscovery::SmaModbusDiscoveryResult> SmaModbusSolarInverterDiscovery::discoveryResults() const
@@ -11,6 +11,7 @@ SOURCES += \
     integrationpluginsma.cpp \
     modbus/smamodbusbatteryinverterdiscovery.cpp \
     modbus/smamodbussolarinverterdiscovery.cpp \
+    speedwire/speedwiredeviceregistry.cpp \
     speedwire/speedwirediscovery.cpp \
     speedwire/speedwireinterface.cpp \
     speedwire/speedwireinverter.cpp \
@@ -26,6 +27,7 @@ HEADERS += \
     modbus/smamodbussolarinverterdiscovery.h \
     sma.h \
     speedwire/speedwire.h \
+    speedwire/speedwiredeviceregistry.h \
     speedwire/speedwirediscovery.h \
     speedwire/speedwireinterface.h \
     speedwire/speedwireinverter.h \
@@ -34,3 +36,8 @@ HEADERS += \
     speedwire/speedwiremeter.h \
     sunnywebbox/sunnywebbox.h \
     sunnywebbox/sunnywebboxdiscovery.h
+
+linux {
+    SOURCES += speedwire/speedwirebatchreceiver.cpp
+    HEADERS += speedwire/speedwirebatchreceiver.h
+}
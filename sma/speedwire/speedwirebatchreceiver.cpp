@@ -0,0 +1,261 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "speedwirebatchreceiver.h"
+#include "extern-plugininfo.h"
+
+#include <QDateTime>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include <vector>
+
+SpeedwireBatchReceiver::SpeedwireBatchReceiver(QObject *parent) :
+    QThread(parent)
+{
+    qRegisterMetaType<SpeedwireBatchReceiver::Datagrams>();
+}
+
+SpeedwireBatchReceiver::~SpeedwireBatchReceiver()
+{
+    close();
+}
+
+bool SpeedwireBatchReceiver::available() const
+{
+    return m_socketDescriptor >= 0 && isRunning();
+}
+
+bool SpeedwireBatchReceiver::initialize(quint16 port)
+{
+    if (m_socketDescriptor >= 0)
+        return true;
+
+    int socketDescriptor = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (socketDescriptor < 0) {
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to create socket:" << strerror(errno);
+        return false;
+    }
+
+    // Same behavior as QAbstractSocket::ShareAddress | QAbstractSocket::ReuseAddressHint
+    int enable = 1;
+    if (::setsockopt(socketDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0)
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to enable address reuse:" << strerror(errno);
+
+    // Required for telling multicast and unicast datagrams apart on one socket
+    if (::setsockopt(socketDescriptor, IPPROTO_IP, IP_PKTINFO, &enable, sizeof(enable)) < 0)
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to enable packet info:" << strerror(errno);
+
+    if (::setsockopt(socketDescriptor, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0)
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to enable kernel timestamps:" << strerror(errno);
+
+    // Give the kernel some room for bursts on busy multicast segments
+    int receiveBufferSize = 1024 * 1024;
+    if (::setsockopt(socketDescriptor, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize)) < 0)
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to set the receive buffer size:" << strerror(errno);
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(socketDescriptor, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0) {
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Socket could not be bound to port" << port << strerror(errno);
+        ::close(socketDescriptor);
+        return false;
+    }
+
+    m_socketDescriptor = socketDescriptor;
+    m_running.storeRelease(1);
+    start();
+
+    qCDebug(dcSma()) << "SpeedwireBatchReceiver: Receiving on port" << port << "in batches of" << batchSize() << "datagrams";
+    return true;
+}
+
+void SpeedwireBatchReceiver::close()
+{
+    if (m_socketDescriptor < 0)
+        return;
+
+    // The receive loop polls with a timeout, it will notice within a few ms
+    m_running.storeRelease(0);
+    wait();
+
+    ::close(m_socketDescriptor);
+    m_socketDescriptor = -1;
+}
+
+bool SpeedwireBatchReceiver::joinMulticastGroup(const QHostAddress &groupAddress)
+{
+    if (m_socketDescriptor < 0)
+        return false;
+
+    struct ip_mreqn request;
+    memset(&request, 0, sizeof(request));
+    request.imr_multiaddr.s_addr = htonl(groupAddress.toIPv4Address());
+    request.imr_address.s_addr = htonl(INADDR_ANY);
+    if (::setsockopt(m_socketDescriptor, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request)) < 0 && errno != EADDRINUSE) {
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to join multicast group" << groupAddress.toString() << strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+bool SpeedwireBatchReceiver::leaveMulticastGroup(const QHostAddress &groupAddress)
+{
+    if (m_socketDescriptor < 0)
+        return false;
+
+    struct ip_mreqn request;
+    memset(&request, 0, sizeof(request));
+    request.imr_multiaddr.s_addr = htonl(groupAddress.toIPv4Address());
+    request.imr_address.s_addr = htonl(INADDR_ANY);
+    if (::setsockopt(m_socketDescriptor, IPPROTO_IP, IP_DROP_MEMBERSHIP, &request, sizeof(request)) < 0) {
+        qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to leave multicast group" << groupAddress.toString() << strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+qint64 SpeedwireBatchReceiver::sendDatagram(const QByteArray &data, const QHostAddress &address, quint16 port)
+{
+    if (m_socketDescriptor < 0)
+        return -1;
+
+    struct sockaddr_in target;
+    memset(&target, 0, sizeof(target));
+    target.sin_family = AF_INET;
+    target.sin_port = htons(port);
+    target.sin_addr.s_addr = htonl(address.toIPv4Address());
+    return ::sendto(m_socketDescriptor, data.constData(), data.size(), 0, reinterpret_cast<struct sockaddr *>(&target), sizeof(target));
+}
+
+void SpeedwireBatchReceiver::run()
+{
+    const int controlSize = CMSG_SPACE(sizeof(struct in_pktinfo)) + CMSG_SPACE(sizeof(struct timespec));
+
+    // Preallocate all buffers once, the kernel fills them on each recvmmsg call
+    std::vector<char> buffers(batchSize() * maxDatagramSize());
+    std::vector<char> controls(batchSize() * controlSize);
+    std::vector<struct iovec> iovecs(batchSize());
+    std::vector<struct sockaddr_in> senders(batchSize());
+    std::vector<struct mmsghdr> messages(batchSize());
+
+    for (int i = 0; i < batchSize(); i++) {
+        iovecs[i].iov_base = buffers.data() + i * maxDatagramSize();
+        iovecs[i].iov_len = maxDatagramSize();
+        memset(&messages[i], 0, sizeof(struct mmsghdr));
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &senders[i];
+        messages[i].msg_hdr.msg_control = controls.data() + i * controlSize;
+    }
+
+    struct pollfd pollDescriptor;
+    pollDescriptor.fd = m_socketDescriptor;
+    pollDescriptor.events = POLLIN;
+
+    while (m_running.loadAcquire()) {
+        pollDescriptor.revents = 0;
+        int result = ::poll(&pollDescriptor, 1, 100);
+        if (result < 0 && errno != EINTR) {
+            qCWarning(dcSma()) << "SpeedwireBatchReceiver: Poll failed:" << strerror(errno);
+            msleep(100);
+            continue;
+        }
+
+        if (result <= 0)
+            continue;
+
+        // Drain the socket completely before handing the batch over
+        Datagrams datagrams;
+        forever {
+            for (int i = 0; i < batchSize(); i++) {
+                messages[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+                messages[i].msg_hdr.msg_controllen = controlSize;
+                messages[i].msg_hdr.msg_flags = 0;
+            }
+
+            int count = ::recvmmsg(m_socketDescriptor, messages.data(), batchSize(), MSG_DONTWAIT, nullptr);
+            if (count <= 0) {
+                if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                    qCWarning(dcSma()) << "SpeedwireBatchReceiver: Failed to receive datagrams:" << strerror(errno);
+
+                break;
+            }
+
+            datagrams.reserve(datagrams.count() + count);
+            for (int i = 0; i < count; i++) {
+                struct msghdr &header = messages[i].msg_hdr;
+                if (header.msg_flags & MSG_TRUNC) {
+                    qCWarning(dcSma()) << "SpeedwireBatchReceiver: Datagram exceeds" << maxDatagramSize() << "bytes. Ignoring data...";
+                    continue;
+                }
+
+                Datagram datagram;
+                datagram.senderAddress = QHostAddress(ntohl(senders[i].sin_addr.s_addr));
+                datagram.senderPort = ntohs(senders[i].sin_port);
+                datagram.data = QByteArray(static_cast<const char *>(iovecs[i].iov_base), static_cast<int>(messages[i].msg_len));
+
+                for (struct cmsghdr *message = CMSG_FIRSTHDR(&header); message; message = CMSG_NXTHDR(&header, message)) {
+                    if (message->cmsg_level == IPPROTO_IP && message->cmsg_type == IP_PKTINFO) {
+                        struct in_pktinfo packetInfo;
+                        memcpy(&packetInfo, CMSG_DATA(message), sizeof(packetInfo));
+                        datagram.multicast = IN_MULTICAST(ntohl(packetInfo.ipi_addr.s_addr));
+                    } else if (message->cmsg_level == SOL_SOCKET && message->cmsg_type == SCM_TIMESTAMPNS) {
+                        struct timespec timestamp;
+                        memcpy(&timestamp, CMSG_DATA(message), sizeof(timestamp));
+                        datagram.timestamp = static_cast<qint64>(timestamp.tv_sec) * 1000 + timestamp.tv_nsec / 1000000;
+                    }
+                }
+
+                if (datagram.timestamp == 0)
+                    datagram.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+                datagrams.append(datagram);
+            }
+
+            if (count < batchSize())
+                break;
+        }
+
+        if (!datagrams.isEmpty()) {
+            emit datagramsReceived(datagrams);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SPEEDWIREBATCHRECEIVER_H
+#define SPEEDWIREBATCHRECEIVER_H
+
+#include <QThread>
+#include <QVector>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHostAddress>
+
+// Linux only receive backend for the speedwire interface. The socket will be drained
+// in a dedicated thread using recvmmsg into preallocated buffers, the received datagrams
+// get delivered as one batch to the interface instead of one readyRead per datagram.
+
+class SpeedwireBatchReceiver : public QThread
+{
+    Q_OBJECT
+public:
+    typedef struct Datagram {
+        QHostAddress senderAddress;
+        quint16 senderPort = 0;
+        QByteArray data;
+        bool multicast = false;
+        qint64 timestamp = 0; // Kernel receive timestamp in ms since epoch
+    } Datagram;
+
+    typedef QVector<Datagram> Datagrams;
+
+    explicit SpeedwireBatchReceiver(QObject *parent = nullptr);
+    ~SpeedwireBatchReceiver() override;
+
+    static int batchSize() { return 64; }
+    static int maxDatagramSize() { return 2048; }
+
+    bool available() const;
+
+    bool initialize(quint16 port);
+    void close();
+
+    bool joinMulticastGroup(const QHostAddress &groupAddress);
+    bool leaveMulticastGroup(const QHostAddress &groupAddress);
+
+    qint64 sendDatagram(const QByteArray &data, const QHostAddress &address, quint16 port);
+
+signals:
+    void datagramsReceived(const SpeedwireBatchReceiver::Datagrams &datagrams);
+
+protected:
+    void run() override;
+
+private:
+    int m_socketDescriptor = -1;
+    QAtomicInt m_running;
+
+};
+
+Q_DECLARE_METATYPE(SpeedwireBatchReceiver::Datagrams)
+
+#endif // SPEEDWIREBATCHRECEIVER_H
@@ -0,0 +1,180 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "speedwiredeviceregistry.h"
+#include "extern-plugininfo.h"
+
+#include <QDateTime>
+#include <QDataStream>
+
+SpeedwireDeviceRegistry::SpeedwireDeviceRegistry(SpeedwireInterface *speedwireInterface, QObject *parent) :
+    QObject(parent),
+    m_speedwireInterface(speedwireInterface)
+{
+    m_listeningTimestamp = QDateTime::currentMSecsSinceEpoch();
+    connect(m_speedwireInterface, &SpeedwireInterface::dataReceived, this, &SpeedwireDeviceRegistry::processDatagram);
+
+    m_cleanupTimer.setInterval(60000);
+    m_cleanupTimer.setSingleShot(false);
+    connect(&m_cleanupTimer, &QTimer::timeout, this, &SpeedwireDeviceRegistry::cleanUp);
+    m_cleanupTimer.start();
+}
+
+qint64 SpeedwireDeviceRegistry::listeningDuration() const
+{
+    return QDateTime::currentMSecsSinceEpoch() - m_listeningTimestamp;
+}
+
+bool SpeedwireDeviceRegistry::hasDevice(Speedwire::DeviceType deviceType, const QHostAddress &address) const
+{
+    switch (deviceType) {
+    case Speedwire::DeviceTypeMeter:
+        return m_meters.contains(address);
+    case Speedwire::DeviceTypeInverter:
+        return m_inverters.contains(address);
+    default:
+        return m_meters.contains(address) || m_inverters.contains(address);
+    }
+}
+
+QList<SpeedwireDeviceRegistry::Device> SpeedwireDeviceRegistry::devices(Speedwire::DeviceType deviceType, qint64 maxAge) const
+{
+    QList<Device> devices;
+    qint64 minTimestamp = QDateTime::currentMSecsSinceEpoch() - maxAge;
+
+    if (deviceType != Speedwire::DeviceTypeInverter) {
+        foreach (const Device &device, m_meters) {
+            if (device.lastSeenTimestamp >= minTimestamp) {
+                devices.append(device);
+            }
+        }
+    }
+
+    if (deviceType != Speedwire::DeviceTypeMeter) {
+        foreach (const Device &device, m_inverters) {
+            if (device.lastSeenTimestamp >= minTimestamp) {
+                devices.append(device);
+            }
+        }
+    }
+
+    return devices;
+}
+
+void SpeedwireDeviceRegistry::updateDevice(QHash<QHostAddress, Device> &devices, const QHostAddress &address, Speedwire::DeviceType deviceType, quint16 modelId, quint32 serialNumber, bool multicast)
+{
+    qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    QHash<QHostAddress, Device>::iterator it = devices.find(address);
+    if (it != devices.end()) {
+        it->modelId = modelId;
+        it->serialNumber = serialNumber;
+        it->multicast = it->multicast || multicast;
+        it->lastSeenTimestamp = timestamp;
+        return;
+    }
+
+    Device device;
+    device.address = address;
+    device.deviceType = deviceType;
+    device.modelId = modelId;
+    device.serialNumber = serialNumber;
+    device.multicast = multicast;
+    device.firstSeenTimestamp = timestamp;
+    device.lastSeenTimestamp = timestamp;
+    devices.insert(address, device);
+
+    qCDebug(dcSma()) << "SpeedwireDeviceRegistry: Learned new device" << device;
+    emit deviceAdded(device);
+}
+
+void SpeedwireDeviceRegistry::processDatagram(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &datagram, bool multicast)
+{
+    Q_UNUSED(senderPort)
+
+    // Check min size of SMA datagrams, silently ignore anything else, the consumers will complain if required
+    if (datagram.size() < 18)
+        return;
+
+    QDataStream stream(datagram);
+    Speedwire::Header header = Speedwire::parseHeader(stream);
+    if (!header.isValid())
+        return;
+
+    if (header.protocolId == Speedwire::ProtocolIdMeter) {
+        quint16 modelId;
+        quint32 serialNumber;
+        stream >> modelId >> serialNumber;
+        updateDevice(m_meters, senderAddress, Speedwire::DeviceTypeMeter, modelId, serialNumber, multicast);
+    } else if (header.protocolId == Speedwire::ProtocolIdInverter) {
+        Speedwire::InverterPacket inverterPacket = Speedwire::parseInverterPacket(stream);
+
+        // Ignore our own requests looping back through the multicast group
+        if (inverterPacket.sourceSerialNumber == m_speedwireInterface->sourceSerialNumber())
+            return;
+
+        updateDevice(m_inverters, senderAddress, Speedwire::DeviceTypeInverter, inverterPacket.sourceModelId, inverterPacket.sourceSerialNumber, multicast);
+    }
+}
+
+void SpeedwireDeviceRegistry::removeStaleDevices(QHash<QHostAddress, Device> &devices, qint64 minTimestamp)
+{
+    QHash<QHostAddress, Device>::iterator it = devices.begin();
+    while (it != devices.end()) {
+        if (it->lastSeenTimestamp < minTimestamp) {
+            Device device = it.value();
+            it = devices.erase(it);
+            qCDebug(dcSma()) << "SpeedwireDeviceRegistry: Removing device which has not been seen for" << deviceTimeout() / 1000 << "seconds" << device;
+            emit deviceRemoved(device);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SpeedwireDeviceRegistry::cleanUp()
+{
+    qint64 minTimestamp = QDateTime::currentMSecsSinceEpoch() - deviceTimeout();
+    removeStaleDevices(m_meters, minTimestamp);
+    removeStaleDevices(m_inverters, minTimestamp);
+}
+
+QDebug operator<<(QDebug debug, const SpeedwireDeviceRegistry::Device &device)
+{
+    debug.nospace() << "SpeedwireDevice(" << device.deviceType;
+    debug.nospace() << ", " << device.address.toString();
+    debug.nospace() << ", Model ID: " << device.modelId;
+    debug.nospace() << ", serial number: " << device.serialNumber;
+    if (device.multicast)
+        debug.nospace() << ", multicast";
+
+    debug.nospace() << ")";
+    return debug.maybeSpace();
+}
@@ -0,0 +1,97 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2022, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SPEEDWIREDEVICEREGISTRY_H
+#define SPEEDWIREDEVICEREGISTRY_H
+
+#include <QHash>
+#include <QTimer>
+#include <QObject>
+#include <QHostAddress>
+
+#include "speedwire.h"
+#include "speedwireinterface.h"
+
+// Passively learns all speedwire devices from the traffic received on the shared interface.
+// Meters announce them self every second on the multicast group, inverters show up whenever
+// they answer any request. The registry lives as long as the interface and can be used by the
+// discovery in order to answer without probing the network.
+
+class SpeedwireDeviceRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    typedef struct Device {
+        QHostAddress address;
+        Speedwire::DeviceType deviceType = Speedwire::DeviceTypeUnknown;
+        quint16 modelId = 0;
+        quint32 serialNumber = 0;
+        bool multicast = false;
+        qint64 firstSeenTimestamp = 0;
+        qint64 lastSeenTimestamp = 0;
+    } Device;
+
+    explicit SpeedwireDeviceRegistry(SpeedwireInterface *speedwireInterface, QObject *parent = nullptr);
+
+    // Meters send their data every second, after this time we know all meters in the network
+    static int meterAnnounceInterval() { return 5000; }
+
+    // Devices not seen for this time will be removed from the registry
+    static int deviceTimeout() { return 300000; }
+
+    qint64 listeningDuration() const;
+
+    bool hasDevice(Speedwire::DeviceType deviceType, const QHostAddress &address) const;
+    QList<Device> devices(Speedwire::DeviceType deviceType, qint64 maxAge = deviceTimeout()) const;
+
+signals:
+    void deviceAdded(const SpeedwireDeviceRegistry::Device &device);
+    void deviceRemoved(const SpeedwireDeviceRegistry::Device &device);
+
+private:
+    SpeedwireInterface *m_speedwireInterface = nullptr;
+    qint64 m_listeningTimestamp = 0;
+
+    QTimer m_cleanupTimer;
+    QHash<QHostAddress, Device> m_meters;
+    QHash<QHostAddress, Device> m_inverters;
+
+    void updateDevice(QHash<QHostAddress, Device> &devices, const QHostAddress &address, Speedwire::DeviceType deviceType, quint16 modelId, quint32 serialNumber, bool multicast);
+    void removeStaleDevices(QHash<QHostAddress, Device> &devices, qint64 minTimestamp);
+
+private slots:
+    void processDatagram(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &datagram, bool multicast);
+    void cleanUp();
+
+};
+
+QDebug operator<<(QDebug debug, const SpeedwireDeviceRegistry::Device &device);
+
+#endif // SPEEDWIREDEVICEREGISTRY_H
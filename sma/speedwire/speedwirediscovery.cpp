@@ -34,10 +34,11 @@
 
 #include <QDataStream>
 
-SpeedwireDiscovery::SpeedwireDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, SpeedwireInterface *speedwireInterface, quint32 localSerialNumber, QObject *parent) :
+SpeedwireDiscovery::SpeedwireDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, SpeedwireInterface *speedwireInterface, SpeedwireDeviceRegistry *deviceRegistry, quint32 localSerialNumber, QObject *parent) :
     QObject(parent),
     m_networkDeviceDiscovery(networkDeviceDiscovery),
     m_speedwireInterface(speedwireInterface),
+    m_deviceRegistry(deviceRegistry),
     m_localSerialNumber(localSerialNumber)
 {
     // More details: https://github.com/RalfOGit/libspeedwire/
@@ -45,11 +46,7 @@ SpeedwireDiscovery::SpeedwireDiscovery(NetworkDeviceDiscovery *networkDeviceDisc
     // Request: 534d4100000402a00000000100260010 606509a0 ffffffffffff0000 7d0052be283a0000 000000000180 00020000 00000000 00000000 00000000  => command = 0x00000200, first = 0x00000000; last = 0x00000000; trailer = 0x00000000
     // Response 534d4100000402a000000001004e0010 606513a0 7d0052be283a00c0 7a01842a71b30000 000000000180 01020000 00000000 00000000 00030000 00ff0000 00000000 01007a01 842a71b3 00000a00 0c000000 00000000 00000000 01010000 00000000
 
-    m_multicastSearchRequestTimer.setInterval(1000);
-    m_multicastSearchRequestTimer.setSingleShot(false);
-
     connect(m_speedwireInterface, &SpeedwireInterface::dataReceived, this, &SpeedwireDiscovery::processDatagram);
-    connect(&m_multicastSearchRequestTimer, &QTimer::timeout, this, &SpeedwireDiscovery::sendDiscoveryRequest);
 }
 
 SpeedwireDiscovery::~SpeedwireDiscovery()
@@ -57,7 +54,7 @@ SpeedwireDiscovery::~SpeedwireDiscovery()
 
 }
 
-bool SpeedwireDiscovery::startDiscovery()
+bool SpeedwireDiscovery::startDiscovery(Speedwire::DeviceType deviceType)
 {
     if (discoveryRunning())
         return true;
@@ -69,8 +66,19 @@ bool SpeedwireDiscovery::startDiscovery()
 
     // Start clean
     m_results.clear();
+    m_resultMeters.clear();
+    m_resultInverters.clear();
     m_networkDeviceInfos.clear();
 
+    // Everything the registry has learned so far from the traffic is a valid result right away
+    loadRegistryResults();
+
+    if (deviceType == Speedwire::DeviceTypeMeter) {
+        // Meters announce them self continuously on the multicast group, no need to probe the network
+        startPassiveDiscovery();
+        return true;
+    }
+
     startUnicastDiscovery();
     startMulticastDiscovery();
     return true;
@@ -78,7 +86,7 @@ bool SpeedwireDiscovery::startDiscovery()
 
 bool SpeedwireDiscovery::discoveryRunning() const
 {
-    return m_unicastRunning || m_multicastRunning;
+    return m_unicastRunning || m_multicastRunning || m_passiveRunning;
 }
 
 QList<SpeedwireDiscovery::SpeedwireDiscoveryResult> SpeedwireDiscovery::discoveryResult() const
@@ -90,12 +98,25 @@ void SpeedwireDiscovery::startMulticastDiscovery()
 {
     qCDebug(dcSma()) << "SpeedwireDiscovery: Start multicast discovery...";
     m_multicastRunning = true;
-    m_multicastSearchRequestTimer.start();
 
-    // Start sending multicast messages periodically
+    // One request is enough, meters are streaming anyway and the inverters get probed using unicast
     sendDiscoveryRequest();
 }
 
+void SpeedwireDiscovery::startPassiveDiscovery()
+{
+    m_passiveRunning = true;
+
+    // Give the registry at least one meter announce interval before trusting the result
+    qint64 remainingTime = qMax<qint64>(0, SpeedwireDeviceRegistry::meterAnnounceInterval() - m_deviceRegistry->listeningDuration());
+    qCDebug(dcSma()) << "SpeedwireDiscovery: Start passive discovery using the device registry. Waiting" << remainingTime << "ms for meter announcements...";
+    QTimer::singleShot(remainingTime, this, [this](){
+        loadRegistryResults();
+        m_passiveRunning = false;
+        evaluateDiscoveryFinished();
+    });
+}
+
 
 void SpeedwireDiscovery::startUnicastDiscovery()
 {
@@ -106,6 +127,11 @@ void SpeedwireDiscovery::startUnicastDiscovery()
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
     connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, [this](const NetworkDeviceInfo &networkDeviceInfo){
         m_networkDeviceInfos.append(networkDeviceInfo);
+
+        // Only probe silent hosts, the registry knows already about this inverter
+        if (m_resultInverters.contains(networkDeviceInfo.address()))
+            return;
+
         sendUnicastDiscoveryRequest(networkDeviceInfo.address());
     });
 
@@ -113,7 +139,6 @@ void SpeedwireDiscovery::startUnicastDiscovery()
         qCDebug(dcSma()) << "Discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices for unicast requests.";
         // Wait some extra second in otder to give the last hosts joined some time to respond.
         QTimer::singleShot(3000, this, [this](){
-            m_multicastSearchRequestTimer.stop();
             m_multicastRunning = false;
 
             m_unicastRunning = false;
@@ -128,6 +153,23 @@ void SpeedwireDiscovery::sendUnicastDiscoveryRequest(const QHostAddress &targetH
     m_speedwireInterface->sendDataUnicast(targetHostAddress, Speedwire::pingRequest(Speedwire::sourceModelId(), m_localSerialNumber));
 }
 
+void SpeedwireDiscovery::loadRegistryResults()
+{
+    foreach (const SpeedwireDeviceRegistry::Device &device, m_deviceRegistry->devices(Speedwire::DeviceTypeUnknown)) {
+        QHash<QHostAddress, SpeedwireDiscoveryResult> &results = (device.deviceType == Speedwire::DeviceTypeMeter ? m_resultMeters : m_resultInverters);
+        if (results.contains(device.address))
+            continue;
+
+        qCDebug(dcSma()) << "SpeedwireDiscovery: Using known device from registry" << device;
+        SpeedwireDiscoveryResult result;
+        result.address = device.address;
+        result.deviceType = device.deviceType;
+        result.modelId = device.modelId;
+        result.serialNumber = device.serialNumber;
+        results.insert(device.address, result);
+    }
+}
+
 void SpeedwireDiscovery::processDatagram(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &datagram, bool multicast)
 {
     Q_UNUSED(multicast)
@@ -203,15 +245,12 @@ void SpeedwireDiscovery::processDatagram(const QHostAddress &senderAddress, quin
         m_resultInverters[senderAddress].modelId = inverterPacket.sourceModelId;
         m_resultInverters[senderAddress].serialNumber = inverterPacket.sourceSerialNumber;
 
-        // Send the default login request, maybe it activates the Energy meter measurment data streaming
+        // Send the identify request only once for each inverter, the response would end up here again
+        if (m_inverters.contains(senderAddress))
+            return;
 
-        SpeedwireInverter *inverter = nullptr;
-        if (m_inverters.contains(senderAddress)) {
-            inverter = m_inverters.value(senderAddress);
-        } else {
-            inverter = new SpeedwireInverter(m_speedwireInterface, senderAddress, Speedwire::sourceModelId(), m_localSerialNumber, this);
-            m_inverters.insert(senderAddress, inverter);
-        }
+        SpeedwireInverter *inverter = new SpeedwireInverter(m_speedwireInterface, senderAddress, Speedwire::sourceModelId(), m_localSerialNumber, this);
+        m_inverters.insert(senderAddress, inverter);
 
         SpeedwireInverterReply *reply = inverter->sendIdentifyRequest();
         qCDebug(dcSma()) << "SpeedwireDiscovery: Send identify request to" << senderAddress.toString();
@@ -246,10 +285,16 @@ void SpeedwireDiscovery::evaluateDiscoveryFinished()
 
 void SpeedwireDiscovery::finishDiscovery()
 {
+    // Results from the registry might have been added before the host showed up in the network device discovery
+    foreach (const QHostAddress &address, m_resultInverters.keys()) {
+        if (!m_resultInverters.value(address).networkDeviceInfo.isValid() && m_networkDeviceInfos.hasHostAddress(address)) {
+            m_resultInverters[address].networkDeviceInfo = m_networkDeviceInfos.get(address);
+        }
+    }
+
     m_results = m_resultMeters.values() + m_resultInverters.values();
 
     qCDebug(dcSma()) << "SpeedwireDiscovery: Discovey finished. Found" << m_results.count() << "SMA devices in the network";
-    m_multicastSearchRequestTimer.stop();
 
     foreach (const SpeedwireDiscoveryResult &result, m_results) {
         qCDebug(dcSma()) << "SpeedwireDiscovery: ============================================";
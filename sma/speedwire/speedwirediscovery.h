@@ -40,6 +40,7 @@
 #include "speedwire.h"
 #include "speedwireinverter.h"
 #include "speedwireinterface.h"
+#include "speedwiredeviceregistry.h"
 
 class SpeedwireDiscovery : public QObject
 {
@@ -53,10 +54,11 @@ public:
         quint32 serialNumber = 0;
     } SpeedwireDiscoveryResult;
 
-    explicit SpeedwireDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, SpeedwireInterface *speedwireInterface, quint32 localSerialNumber, QObject *parent = nullptr);
+    explicit SpeedwireDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, SpeedwireInterface *speedwireInterface, SpeedwireDeviceRegistry *deviceRegistry, quint32 localSerialNumber, QObject *parent = nullptr);
     ~SpeedwireDiscovery();
 
-    bool startDiscovery();
+    // Meters will be discovered passively using the device registry, everything else requires probing the network
+    bool startDiscovery(Speedwire::DeviceType deviceType = Speedwire::DeviceTypeUnknown);
     bool discoveryRunning() const;
 
     QList<SpeedwireDiscoveryResult> discoveryResult() const;
@@ -67,23 +69,26 @@ signals:
 private:
     NetworkDeviceDiscovery *m_networkDeviceDiscovery = nullptr;
     SpeedwireInterface *m_speedwireInterface = nullptr;
+    SpeedwireDeviceRegistry *m_deviceRegistry = nullptr;
     quint32 m_localSerialNumber = 0;
 
     // Discovery
-    QTimer m_multicastSearchRequestTimer;
     NetworkDeviceInfos m_networkDeviceInfos;
     QList<SpeedwireDiscoveryResult> m_results;
     QHash<QHostAddress, SpeedwireDiscoveryResult> m_resultMeters;
     QHash<QHostAddress, SpeedwireDiscoveryResult> m_resultInverters;
     bool m_unicastRunning = false;
     bool m_multicastRunning = false;
+    bool m_passiveRunning = false;
 
     QHash<QHostAddress, SpeedwireInverter *> m_inverters;
     void sendUnicastDiscoveryRequest(const QHostAddress &targetHostAddress);
+    void loadRegistryResults();
 
 private slots:
     void startUnicastDiscovery();
     void startMulticastDiscovery();
+    void startPassiveDiscovery();
 
     void processDatagram(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &datagram, bool multicast);
 
@@ -31,12 +31,41 @@
 #include "speedwireinterface.h"
 #include "extern-plugininfo.h"
 
+#include <QDateTime>
 #include <QNetworkInterface>
 
-SpeedwireInterface::SpeedwireInterface(quint32 sourceSerialNumber, QObject *parent) :
+SpeedwireInterface::SpeedwireInterface(quint32 sourceSerialNumber, ReceiveBackend receiveBackend, QObject *parent) :
     QObject(parent),
-    m_sourceSerialNumber(sourceSerialNumber)
+    m_sourceSerialNumber(sourceSerialNumber),
+    m_receiveBackend(receiveBackend)
 {
+    // Flushing the capture file for every datagram is too expensive at the meter multicast rate
+    m_captureFlushTimer.setInterval(5000);
+    connect(&m_captureFlushTimer, &QTimer::timeout, this, [this](){
+        if (m_captureFile) {
+            m_captureFile->flush();
+        }
+    });
+
+    if (m_receiveBackend == ReceiveBackendBatched) {
+#ifdef Q_OS_LINUX
+        // One socket for unicast and multicast, drained in batches from a dedicated thread
+        m_batchReceiver = new SpeedwireBatchReceiver(this);
+        connect(m_batchReceiver, &SpeedwireBatchReceiver::datagramsReceived, this, &SpeedwireInterface::processDatagrams);
+        m_statisticsTimer.start();
+
+        if (initialize()) {
+            qCDebug(dcSma()) << "SpeedwireInterface: Initialized sucessfully batched receive interface.";
+        } else {
+            qCWarning(dcSma()) << "SpeedwireInterface: Failed to initialize.";
+        }
+        return;
+#else
+        qCWarning(dcSma()) << "SpeedwireInterface: The batched receive backend is only available on Linux. Falling back to the default backend.";
+        m_receiveBackend = ReceiveBackendQt;
+#endif
+    }
+
     m_unicast = new QUdpSocket(this);
     connect(m_unicast, &QUdpSocket::readyRead, this, [=](){
         QByteArray datagram;
@@ -46,10 +75,12 @@ SpeedwireInterface::SpeedwireInterface(quint32 sourceSerialNumber, QObject *pare
         while (m_unicast->hasPendingDatagrams()) {
             datagram.resize(m_unicast->pendingDatagramSize());
             m_unicast->readDatagram(datagram.data(), datagram.size(), &senderAddress, &senderPort);
+            qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
 
             qCDebug(dcSma()).noquote() << "SpeedwireInterface: Unicast socket received data from" << QString("%1:%2").arg(senderAddress.toString()).arg(senderPort);
             qCDebug(dcSma()) << "SpeedwireInterface: " << datagram.toHex();
-            emit dataReceived(senderAddress, senderPort, datagram, false);
+            captureDatagram(true, false, senderAddress, senderPort, datagram, timestamp);
+            emit dataReceived(senderAddress, senderPort, datagram, false, timestamp);
         }
     });
 
@@ -71,10 +102,12 @@ SpeedwireInterface::SpeedwireInterface(quint32 sourceSerialNumber, QObject *pare
         while (m_multicast->hasPendingDatagrams()) {
             datagram.resize(m_multicast->pendingDatagramSize());
             m_multicast->readDatagram(datagram.data(), datagram.size(), &senderAddress, &senderPort);
+            qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
 
             qCDebug(dcSma()).noquote() << "SpeedwireInterface: Multicast socket received data from" << QString("%1:%2").arg(senderAddress.toString()).arg(senderPort);
             //qCDebug(dcSma()) << "SpeedwireInterface: " << datagram.toHex();
-            emit dataReceived(senderAddress, senderPort, datagram, true);
+            captureDatagram(true, true, senderAddress, senderPort, datagram, timestamp);
+            emit dataReceived(senderAddress, senderPort, datagram, true, timestamp);
         }
     });
 
@@ -94,6 +127,15 @@ SpeedwireInterface::SpeedwireInterface(quint32 sourceSerialNumber, QObject *pare
 
 SpeedwireInterface::~SpeedwireInterface()
 {
+    stopCapture();
+
+#ifdef Q_OS_LINUX
+    if (m_batchReceiver) {
+        m_batchReceiver->leaveMulticastGroup(Speedwire::multicastAddress());
+        m_batchReceiver->close();
+    }
+#endif
+
     if (m_unicast)
         m_unicast->close();
 
@@ -114,6 +156,18 @@ bool SpeedwireInterface::available() const
 void SpeedwireInterface::reconfigureMulticastGroup()
 {
     qCDebug(dcSma()) << "Reconfigure multicast interfaces";
+#ifdef Q_OS_LINUX
+    if (m_batchReceiver) {
+        if (m_batchReceiver->joinMulticastGroup(Speedwire::multicastAddress())) {
+            qCDebug(dcSma()) << "SpeedwireInterface: Joined successfully multicast group" << Speedwire::multicastAddress().toString();
+        } else {
+            qCWarning(dcSma()) << "SpeedwireInterface: Failed to join multicast group" << Speedwire::multicastAddress().toString() << "Retrying in 5 seconds...";
+            QTimer::singleShot(5000, this, &SpeedwireInterface::reconfigureMulticastGroup);
+        }
+        return;
+    }
+#endif
+
     if (m_multicast->joinMulticastGroup(Speedwire::multicastAddress())) {
         qCDebug(dcSma()) << "SpeedwireInterface: Joined successfully multicast group" << Speedwire::multicastAddress().toString();
     } else {
@@ -149,8 +203,23 @@ quint32 SpeedwireInterface::sourceSerialNumber() const
     return m_sourceSerialNumber;
 }
 
+SpeedwireInterface::ReceiveBackend SpeedwireInterface::receiveBackend() const
+{
+    return m_receiveBackend;
+}
+
 bool SpeedwireInterface::initialize()
 {
+#ifdef Q_OS_LINUX
+    if (m_batchReceiver) {
+        m_available = m_batchReceiver->initialize(Speedwire::port());
+        if (m_available)
+            reconfigureMulticastGroup();
+
+        return m_available;
+    }
+#endif
+
     bool success = true;
     if (m_unicast->state() != QUdpSocket::BoundState) {
         m_unicast->close();
@@ -173,9 +242,62 @@ bool SpeedwireInterface::initialize()
     return success;
 }
 
+bool SpeedwireInterface::startCapture(const QString &fileName)
+{
+    stopCapture();
+
+    m_captureFile = new QFile(fileName, this);
+    if (!m_captureFile->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qCWarning(dcSma()) << "SpeedwireInterface: Failed to open capture file" << fileName << m_captureFile->errorString();
+        delete m_captureFile;
+        m_captureFile = nullptr;
+        return false;
+    }
+
+    // Format: <timestamp ms> <rx|tx> <multicast|unicast> <address> <port> <hex data>
+    m_captureFile->write("# speedwire capture 1\n");
+    m_captureFlushTimer.start();
+    qCDebug(dcSma()) << "SpeedwireInterface: Capturing datagrams into" << fileName;
+    return true;
+}
+
+void SpeedwireInterface::stopCapture()
+{
+    if (!m_captureFile)
+        return;
+
+    qCDebug(dcSma()) << "SpeedwireInterface: Stop capturing datagrams into" << m_captureFile->fileName();
+    m_captureFlushTimer.stop();
+    m_captureFile->close();
+    delete m_captureFile;
+    m_captureFile = nullptr;
+}
+
+void SpeedwireInterface::captureDatagram(bool received, bool multicast, const QHostAddress &address, quint16 port, const QByteArray &data, qint64 timestamp)
+{
+    if (!m_captureFile)
+        return;
+
+    QByteArray line = QByteArray::number(timestamp);
+    line += (received ? " rx" : " tx");
+    line += (multicast ? " multicast " : " unicast ");
+    line += address.toString().toLatin1() + ' ' + QByteArray::number(port) + ' ' + data.toHex() + '\n';
+    m_captureFile->write(line);
+}
+
 void SpeedwireInterface::sendDataUnicast(const QHostAddress &address, const QByteArray &data)
 {
     qCDebug(dcSma()) << "SpeedwireInterface: Unicast -->" << address.toString() << Speedwire::port() << data.toHex();
+    captureDatagram(false, false, address, Speedwire::port(), data, QDateTime::currentMSecsSinceEpoch());
+
+#ifdef Q_OS_LINUX
+    if (m_batchReceiver) {
+        if (m_batchReceiver->sendDatagram(data, address, Speedwire::port()) < 0)
+            qCWarning(dcSma()) << "SpeedwireInterface: Failed to send unicast data to" << address.toString();
+
+        return;
+    }
+#endif
 
     if (!m_unicast) {
         qCWarning(dcSma()) << "SpeedwireInterface: Failed to send unicast data, the socket is not available";
@@ -190,6 +312,17 @@ void SpeedwireInterface::sendDataUnicast(const QHostAddress &address, const QByt
 void SpeedwireInterface::sendDataMulticast(const QByteArray &data)
 {
     qCDebug(dcSma()) << "SpeedwireInterface: Multicast -->" << Speedwire::multicastAddress().toString() << Speedwire::port() << data.toHex();
+    captureDatagram(false, true, Speedwire::multicastAddress(), Speedwire::port(), data, QDateTime::currentMSecsSinceEpoch());
+
+#ifdef Q_OS_LINUX
+    if (m_batchReceiver) {
+        if (m_batchReceiver->sendDatagram(data, Speedwire::multicastAddress(), Speedwire::port()) < 0)
+            qCWarning(dcSma()) << "SpeedwireInterface: Failed to send multicast data to" << Speedwire::multicastAddress().toString();
+
+        return;
+    }
+#endif
+
     if (!m_multicast) {
         qCWarning(dcSma()) << "SpeedwireInterface: Failed to send multicast data, the socket is not available";
         return;
@@ -199,3 +332,24 @@ void SpeedwireInterface::sendDataMulticast(const QByteArray &data)
         qCWarning(dcSma()) << "SpeedwireInterface: Failed to send multicast data to" << Speedwire::multicastAddress().toString() << m_multicast->errorString();
     }
 }
+
+#ifdef Q_OS_LINUX
+void SpeedwireInterface::processDatagrams(const SpeedwireBatchReceiver::Datagrams &datagrams)
+{
+    // Demultiplex the batch to the devices within one slot invocation
+    foreach (const SpeedwireBatchReceiver::Datagram &datagram, datagrams) {
+        captureDatagram(true, datagram.multicast, datagram.senderAddress, datagram.senderPort, datagram.data, datagram.timestamp);
+        emit dataReceived(datagram.senderAddress, datagram.senderPort, datagram.data, datagram.multicast, datagram.timestamp);
+    }
+
+    m_statisticsDatagrams += datagrams.count();
+    m_statisticsBatches++;
+    if (m_statisticsTimer.elapsed() >= 60000) {
+        double seconds = m_statisticsTimer.restart() / 1000.0;
+        qCDebug(dcSma()) << "SpeedwireInterface: Received" << m_statisticsDatagrams << "datagrams in" << m_statisticsBatches << "batches"
+                         << QString("(%1 packets/s, %2 datagrams per batch)").arg(m_statisticsDatagrams / seconds, 0, 'f', 1).arg(static_cast<double>(m_statisticsDatagrams) / m_statisticsBatches, 0, 'f', 1);
+        m_statisticsDatagrams = 0;
+        m_statisticsBatches = 0;
+    }
+}
+#endif
@@ -31,33 +31,50 @@
 #ifndef SPEEDWIREINTERFACE_H
 #define SPEEDWIREINTERFACE_H
 
+#include <QFile>
 #include <QObject>
 #include <QUdpSocket>
 #include <QDataStream>
 #include <QTimer>
+#include <QElapsedTimer>
 
 #include "speedwire.h"
 
+#ifdef Q_OS_LINUX
+#include "speedwirebatchreceiver.h"
+#endif
+
 class SpeedwireInterface : public QObject
 {
     Q_OBJECT
 public:
+    enum ReceiveBackend {
+        ReceiveBackendQt,
+        ReceiveBackendBatched // Linux only, falls back to ReceiveBackendQt on other platforms
+    };
+    Q_ENUM(ReceiveBackend)
 
-    explicit SpeedwireInterface(quint32 sourceSerialNumber, QObject *parent = nullptr);
+    explicit SpeedwireInterface(quint32 sourceSerialNumber, ReceiveBackend receiveBackend = ReceiveBackendQt, QObject *parent = nullptr);
     ~SpeedwireInterface();
 
     bool available() const;
 
     quint32 sourceSerialNumber() const;
+    ReceiveBackend receiveBackend() const;
 
     bool initialize();
 
+    // Records all sent and received datagrams for offline replay using sma/test/speedwire-replay.py
+    bool startCapture(const QString &fileName);
+    void stopCapture();
+
 public slots:
     void sendDataUnicast(const QHostAddress &address, const QByteArray &data);
     void sendDataMulticast(const QByteArray &data);
 
 signals:
-    void dataReceived(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &data, bool multicast = false);
+    // The timestamp is the receive time in ms since epoch, taken by the kernel if the batched receive backend is used
+    void dataReceived(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &data, bool multicast, qint64 timestamp);
 
 private slots:
     void reconfigureMulticastGroup();
@@ -68,6 +85,22 @@ private:
     quint32 m_sourceSerialNumber = 0;
     bool m_available = false;
     QTimer m_multicastReconfigureationTimer;
+    ReceiveBackend m_receiveBackend = ReceiveBackendQt;
+
+    QFile *m_captureFile = nullptr;
+    QTimer m_captureFlushTimer;
+    void captureDatagram(bool received, bool multicast, const QHostAddress &address, quint16 port, const QByteArray &data, qint64 timestamp);
+
+#ifdef Q_OS_LINUX
+    SpeedwireBatchReceiver *m_batchReceiver = nullptr;
+
+    // Receive statistics of the batched backend
+    QElapsedTimer m_statisticsTimer;
+    quint64 m_statisticsDatagrams = 0;
+    quint64 m_statisticsBatches = 0;
+
+    void processDatagrams(const SpeedwireBatchReceiver::Datagrams &datagrams);
+#endif
 };
 
 
@@ -172,7 +172,7 @@ void SpeedwireMeter::evaluateReachable()
     }
 }
 
-void SpeedwireMeter::processData(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &data, bool multicast)
+void SpeedwireMeter::processData(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &data, bool multicast, qint64 timestamp)
 {
     Q_UNUSED(multicast)
 
@@ -199,16 +199,17 @@ void SpeedwireMeter::processData(const QHostAddress &senderAddress, quint16 send
     //qCDebug(dcSma()) << "Meter: data received" << data.toHex();
     qCDebug(dcSma()).noquote() << "Meter: Measurements received from" << QString("%1:%2").arg(senderAddress.toString()).arg(senderPort) <<  "Serial number:" << serialNumber << "Model ID:" << modelId;
 
-    // Make sure the rate is at max 1Hz, some meters send much more data, which creates an uneccessary load
-    if (QDateTime::currentDateTime().toMSecsSinceEpoch() - m_lastSeenTimestamp < 1000)
+    // Make sure the rate is at max 1Hz, some meters send much more data, which creates an uneccessary load.
+    // Use the receive timestamp, datagrams of one receive batch are processed at the same time.
+    if (timestamp - m_lastSeenTimestamp < 1000)
         return;
 
     // Parse the packet data
     // Timestamp e618a416
     qCDebug(dcSma()) << "Meter: ======================= Meter measurements";
-    quint32 timestamp;
-    stream >> timestamp;
-    qCDebug(dcSma()) << "Meter: Timestamp:" << timestamp << QDateTime::fromMSecsSinceEpoch(static_cast<qulonglong>(timestamp) * 1000);
+    quint32 meterTimestamp;
+    stream >> meterTimestamp;
+    qCDebug(dcSma()) << "Meter: Timestamp:" << meterTimestamp << QDateTime::fromMSecsSinceEpoch(static_cast<qulonglong>(meterTimestamp) * 1000);
 
     // Obis data
     //00 01 04 00 00000000 00 01 08 00 0000002139122910 00 02 04 00 00004415 00 02 08 00 0000001575a137d8 00 03 04 00 00000000 00 03 08 00 00000003debed0e8 00040400000017c6000408000000001008c2070000090400000000000009080000000027c77bed20000a04000000481d000a08000000001722823410000d0400000003b00015040000000000001508000000000d1e1e0e3000160400000015120016080000000006c5a2d8b800170400000000000017080000000001bd6f680000180400000007990018080000000004def712b8001d040000000000001d08000000000eeefaafd0001e040000001666001e0800000000074b38bf88001f040000000a300020040000037bcb00210400000003ad0029040000000000002908000000000a9b1afec8002a040000001a81002a08000000000803e62b88002b040000000000002b080000000001511459b8002c0400000006d5002c0800000000052c8455b80031040000000000003108000000000cf83b37100032040000001b5f0032080000000008a6e257f80033040000000c3f003404000003747900350400000003c8003d040000000000003d08000000000a53d0ba08003e040000001482003e080000000007800fd188003f040000000000003f080000000001185820c8004004000000095800400800000000064563b1900045040000000000004508000000000d26d3eae0004604000000168900460800000000082b4fc5a80047040000000a440048040000037ed1004904000000038e90000000 01020852 00000000
@@ -318,8 +319,8 @@ void SpeedwireMeter::processData(const QHostAddress &senderAddress, quint16 send
         }
     }
 
-    // Save the current timestamp for reachable evaluation
-    m_lastSeenTimestamp = QDateTime::currentDateTime().toMSecsSinceEpoch();
+    // Save the receive timestamp for reachable evaluation
+    m_lastSeenTimestamp = timestamp;
     evaluateReachable();
 
     emit valuesUpdated();
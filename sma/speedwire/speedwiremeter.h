@@ -115,7 +115,7 @@ private:
 
 private slots:
     void evaluateReachable();
-    void processData(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &data, bool multicast);
+    void processData(const QHostAddress &senderAddress, quint16 senderPort, const QByteArray &data, bool multicast, qint64 timestamp);
 
 };
 
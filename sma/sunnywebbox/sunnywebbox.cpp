@@ -41,6 +41,16 @@ SunnyWebBox::SunnyWebBox(NetworkAccessManager *networkAccessManager, const QHost
     m_hostAddresss(hostAddress)
 {
     qCDebug(dcSma()) << "SunnyWebBox: Creating Sunny Web Box connection";
+
+    // Don't let a hanging reply block the queue, the aborted request fails and the next one gets sent
+    m_requestTimeoutTimer.setInterval(requestTimeout());
+    m_requestTimeoutTimer.setSingleShot(true);
+    connect(&m_requestTimeoutTimer, &QTimer::timeout, this, [this](){
+        if (m_currentReply) {
+            qCWarning(dcSma()) << "SunnyWebBox: Request timed out. Aborting it...";
+            m_currentReply->abort();
+        }
+    });
 }
 
 SunnyWebBox::~SunnyWebBox()
@@ -77,15 +87,7 @@ QString SunnyWebBox::getProcessDataChannels(const QString &deviceId)
 
 QString SunnyWebBox::getProcessData(const QStringList &deviceKeys)
 {
-    QJsonObject paramsObj;
-    QJsonArray devicesArray;
-    foreach (const QString &key, deviceKeys) {
-        QJsonObject deviceObj;
-        deviceObj["key"] = key;
-        devicesArray.append(deviceObj);
-    }
-    paramsObj["devices"] = devicesArray;
-    return sendMessage(m_hostAddresss, "GetProcessData", paramsObj);
+    return sendMessage(m_hostAddresss, "GetProcessData", devicesParams(deviceKeys));
 }
 
 QString SunnyWebBox::getParameterChannels(const QString &deviceKey)
@@ -101,15 +103,7 @@ QString SunnyWebBox::getParameterChannels(const QString &deviceKey)
 
 QString SunnyWebBox::getParameters(const QStringList &deviceKeys)
 {
-    QJsonObject paramsObj;
-    QJsonArray devicesArray;
-    foreach (const QString &key, deviceKeys) {
-        QJsonObject deviceObj;
-        deviceObj["key"] = key;
-        devicesArray.append(deviceObj);
-    }
-    paramsObj["devices"] = devicesArray;
-    return sendMessage(m_hostAddresss, "GetParameter", paramsObj);
+    return sendMessage(m_hostAddresss, "GetParameter", devicesParams(deviceKeys));
 }
 
 QString SunnyWebBox::setParameters(const QString &deviceKey, const QHash<QString, QVariant> &channels)
@@ -131,6 +125,26 @@ QString SunnyWebBox::setParameters(const QString &deviceKey, const QHash<QString
     return sendMessage(m_hostAddresss, "SetParameter", paramsObj);
 }
 
+bool SunnyWebBox::batchedMode() const
+{
+    return m_batchedMode;
+}
+
+void SunnyWebBox::setBatchedMode(bool batchedMode)
+{
+    if (m_batchedMode == batchedMode)
+        return;
+
+    qCDebug(dcSma()) << "SunnyWebBox: Batched mode" << (batchedMode ? "enabled" : "disabled");
+    m_batchedMode = batchedMode;
+    if (!m_batchedMode) {
+        // Send whatever is left, the replies will be handled as usual
+        while (!m_requestQueue.isEmpty()) {
+            dispatchRequest(m_requestQueue.dequeue());
+        }
+    }
+}
+
 QHostAddress SunnyWebBox::hostAddress() const
 {
     return m_hostAddresss;
@@ -163,7 +177,7 @@ QNetworkReply *SunnyWebBox::sendRequest(const QHostAddress &address, const QStri
     QJsonDocument doc;
     QJsonObject obj;
     obj["format"] = "JSON";
-    obj["id"] = requestId;
+    obj["id"] = finalRequestId;
     obj["proc"] = procedure;
     obj["version"] = "1.0";
 
@@ -189,32 +203,65 @@ QString SunnyWebBox::generateRequestId()
     return QUuid::createUuid().toString().remove('{').remove('-').left(14);
 }
 
-void SunnyWebBox::parseMessage(const QString &messageId, const QString &messageType, const QVariantMap &result)
+QJsonObject SunnyWebBox::devicesParams(const QStringList &deviceKeys)
+{
+    QJsonObject paramsObj;
+    QJsonArray devicesArray;
+    foreach (const QString &key, deviceKeys) {
+        QJsonObject deviceObj;
+        deviceObj["key"] = key;
+        devicesArray.append(deviceObj);
+    }
+    paramsObj["devices"] = devicesArray;
+    return paramsObj;
+}
+
+double SunnyWebBox::toDouble(const QJsonValue &value, bool *ok)
+{
+    // The WebBox delivers the values usually as strings
+    if (value.isDouble()) {
+        if (ok)
+            *ok = true;
+
+        return value.toDouble();
+    }
+
+    return value.toString().toDouble(ok);
+}
+
+QStringList SunnyWebBox::toStringList(const QJsonValue &value)
+{
+    QStringList list;
+    foreach (const QJsonValue &entry, value.toArray()) {
+        list.append(entry.toString());
+    }
+    return list;
+}
+
+void SunnyWebBox::parseMessage(const QString &messageId, const QString &messageType, const QJsonObject &result)
 {
     if (messageType == "GetPlantOverview") {
         Overview overview;
-        QVariantList overviewList = result.value("overview").toList();
+        QJsonArray overviewArray = result.value("overview").toArray();
         qCDebug(dcSma()) << "SunnyWebBox: GetPlantOverview";
-        foreach (const QVariant &value, overviewList) {
-            QVariantMap map = value.toMap();
-
-            if (map["meta"].toString() == "GriPwr") {
-                overview.power = map["value"].toString().toDouble();
-                QString unit = map["unit"].toString();
-                qCDebug(dcSma()) << "SunnyWebBox:       - Power" << overview.power << unit;
-            } else if (map["meta"].toString() == "GriEgyTdy") {
-                overview.dailyYield = map["value"].toString().toDouble();
-                QString unit = map["unit"].toString();
-                qCDebug(dcSma()) << "SunnyWebBox:       - Daily yield" << overview.dailyYield << unit;
-            } else if (map["meta"].toString() == "GriEgyTot") {
-                overview.totalYield = map["value"].toString().toDouble();
-                QString unit = map["unit"].toString();
-                qCDebug(dcSma()) << "SunnyWebBox:       - Total yield" << overview.totalYield << unit;
-            } else if (map["meta"].toString() == "OpStt") {
-                overview.status = map["value"].toString();
+        foreach (const QJsonValue &value, overviewArray) {
+            QJsonObject channelObject = value.toObject();
+            QString meta = channelObject.value("meta").toString();
+
+            if (meta == "GriPwr") {
+                overview.power = toDouble(channelObject.value("value"));
+                qCDebug(dcSma()) << "SunnyWebBox:       - Power" << overview.power << channelObject.value("unit").toString();
+            } else if (meta == "GriEgyTdy") {
+                overview.dailyYield = toDouble(channelObject.value("value"));
+                qCDebug(dcSma()) << "SunnyWebBox:       - Daily yield" << overview.dailyYield << channelObject.value("unit").toString();
+            } else if (meta == "GriEgyTot") {
+                overview.totalYield = toDouble(channelObject.value("value"));
+                qCDebug(dcSma()) << "SunnyWebBox:       - Total yield" << overview.totalYield << channelObject.value("unit").toString();
+            } else if (meta == "OpStt") {
+                overview.status = channelObject.value("value").toString();
                 qCDebug(dcSma()) << "SunnyWebBox:       - Status" << overview.status;
-            } else if (map["meta"].toString() == "Msg") {
-                overview.error = map["value"].toString();
+            } else if (meta == "Msg") {
+                overview.error = channelObject.value("value").toString();
                 qCDebug(dcSma()) << "SunnyWebBox:       - Error" << overview.error;
             }
         }
@@ -222,21 +269,19 @@ void SunnyWebBox::parseMessage(const QString &messageId, const QString &messageT
 
     } else if (messageType == "GetDevices") {
         QList<Device> devices;
-        QVariantList deviceList = result.value("devices").toList();
+        QJsonArray devicesArray = result.value("devices").toArray();
         qCDebug(dcSma()) << "SunnyWebBox: GetDevices" << result.value("totalDevicesReturned").toInt();
-        foreach (const QVariant &value, deviceList) {
+        foreach (const QJsonValue &value, devicesArray) {
+            QJsonObject deviceObject = value.toObject();
             Device device;
-            QVariantMap map = value.toMap();
-            device.name = map["name"].toString();
+            device.name = deviceObject.value("name").toString();
             qCDebug(dcSma()) << "SunnyWebBox:       - Name" << device.name;
-            device.key = map["key"].toString();
+            device.key = deviceObject.value("key").toString();
             qCDebug(dcSma()) << "SunnyWebBox:       - Key" << device.key;
-            QVariantList childrenList = map["children"].toList();
-            foreach (const QVariant &childValue, childrenList) {
+            foreach (const QJsonValue &childValue, deviceObject.value("children").toArray()) {
                 Device child;
-                QVariantMap childMap = childValue.toMap();
-                device.name = childMap["name"].toString();
-                device.key = childMap["key"].toString();
+                child.name = childValue.toObject().value("name").toString();
+                child.key = childValue.toObject().value("key").toString();
                 device.childrens.append(child);
             }
             devices.append(device);
@@ -247,47 +292,54 @@ void SunnyWebBox::parseMessage(const QString &messageId, const QString &messageT
     } else if (messageType == "GetProcessDataChannels" ||
                messageType == "GetProDataChannels") {
         foreach (const QString &deviceKey, result.keys()) {
-            QStringList processDataChannels = result.value(deviceKey).toStringList();
+            QStringList processDataChannels = toStringList(result.value(deviceKey));
             if (!processDataChannels.isEmpty())
                 emit processDataChannelsReceived(messageId, deviceKey, processDataChannels);
         }
     } else if (messageType == "GetProcessData") {
-        QVariantList devicesList = result.value("devices").toList();
-        qCDebug(dcSma()) << "SunnyWebBox: GetProcessData response received";
-        foreach (const QVariant &value, devicesList) {
-
-            QString key = value.toMap().value("key").toString();
-            QVariantList channelsList =  value.toMap().value("channels").toList();
-            QHash<QString, QVariant> channels;
-            foreach (const QVariant &channel, channelsList) {
-                channels.insert(channel.toMap().value("meta").toString(), channel.toMap().value("value"));
+        QJsonArray devicesArray = result.value("devices").toArray();
+        qCDebug(dcSma()) << "SunnyWebBox: GetProcessData response received for" << devicesArray.count() << "devices";
+        foreach (const QJsonValue &deviceValue, devicesArray) {
+            QJsonObject deviceObject = deviceValue.toObject();
+            QJsonArray channelsArray = deviceObject.value("channels").toArray();
+
+            QVector<ProcessDataChannel> channels;
+            channels.reserve(channelsArray.count());
+            foreach (const QJsonValue &channelValue, channelsArray) {
+                QJsonObject channelObject = channelValue.toObject();
+                ProcessDataChannel channel;
+                channel.meta = channelObject.value("meta").toString();
+                channel.name = channelObject.value("name").toString();
+                channel.unit = channelObject.value("unit").toString();
+                channel.numericValue = toDouble(channelObject.value("value"), &channel.numeric);
+                channel.value = channelObject.value("value").isDouble() ? QString::number(channel.numericValue) : channelObject.value("value").toString();
+                channels.append(channel);
             }
-            emit processDataReceived(messageId, key, channels);
+            emit processDataReceived(messageId, deviceObject.value("key").toString(), channels);
         }
     } else if (messageType == "GetParameterChannels") {
         foreach (const QString &deviceKey, result.keys()) {
-            QStringList parameterChannels = result.value(deviceKey).toStringList();
+            QStringList parameterChannels = toStringList(result.value(deviceKey));
             if (!parameterChannels.isEmpty())
                 emit parameterChannelsReceived(messageId, deviceKey, parameterChannels);
         }
     } else if (messageType == "GetParameter"|| messageType == "SetParameter") {
-        QVariantList devicesList = result.value("devices").toList();
-        foreach (const QVariant &value, devicesList) {
-
-            QString key = value.toMap().value("key").toString();
-            QVariantList channelsList =  value.toMap().value("channels").toList();
+        QJsonArray devicesArray = result.value("devices").toArray();
+        foreach (const QJsonValue &deviceValue, devicesArray) {
+            QJsonObject deviceObject = deviceValue.toObject();
             QList<Parameter> parameters;
-            foreach (const QVariant &channel, channelsList) {
+            foreach (const QJsonValue &channelValue, deviceObject.value("channels").toArray()) {
+               QJsonObject channelObject = channelValue.toObject();
                Parameter parameter;
-               parameter.meta = channel.toMap().value("meta").toString();
-               parameter.name = channel.toMap().value("name").toString();
-               parameter.unit = channel.toMap().value("unit").toString();
-               parameter.min = channel.toMap().value("min").toDouble();
-               parameter.max = channel.toMap().value("max").toDouble();
-               parameter.value = channel.toMap().value("value").toDouble();
+               parameter.meta = channelObject.value("meta").toString();
+               parameter.name = channelObject.value("name").toString();
+               parameter.unit = channelObject.value("unit").toString();
+               parameter.min = toDouble(channelObject.value("min"));
+               parameter.max = toDouble(channelObject.value("max"));
+               parameter.value = toDouble(channelObject.value("value"));
                parameters.append(parameter);
             }
-            emit parametersReceived(messageId, key, parameters);
+            emit parametersReceived(messageId, deviceObject.value("key").toString(), parameters);
         }
     } else {
         qCWarning(dcSma()) << "SunnyWebBox: Unknown message type" << messageType;
@@ -310,47 +362,105 @@ QString SunnyWebBox::sendMessage(const QHostAddress &address, const QString &pro
 
 QString SunnyWebBox::sendMessage(const QHostAddress &address, const QString &procedure, const QJsonObject &params)
 {
-    QString requestId = generateRequestId();
-    QNetworkReply *reply = sendRequest(m_hostAddresss, procedure, params, requestId);
-    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
-    connect(reply, &QNetworkReply::finished, this, [this, address, requestId, reply]{
+    if (m_batchedMode) {
+        // The refresh timer keeps requesting while the WebBox is slow or gone, don't queue the same request twice
+        foreach (const QueuedRequest &queuedRequest, m_requestQueue) {
+            if (queuedRequest.procedure == procedure && queuedRequest.params == params) {
+                qCDebug(dcSma()) << "SunnyWebBox:" << procedure << "is already queued";
+                return queuedRequest.requestId;
+            }
+        }
 
-        if (reply->error() != QNetworkReply::NoError) {
-            setConnectionStatus(false);
-            return;
+        if (m_requestQueue.count() >= maxQueuedRequests()) {
+            qCWarning(dcSma()) << "SunnyWebBox: Request queue is full. Dropping" << procedure;
+            return QString();
         }
 
-        setConnectionStatus(true);
+        QueuedRequest request;
+        request.procedure = procedure;
+        request.params = params;
+        request.requestId = generateRequestId();
+        m_requestQueue.enqueue(request);
+        sendNextRequest();
+        return request.requestId;
+    }
 
-        QByteArray data = reply->readAll();
-        qCDebug(dcSma()) << "SunnyWebBox: Received reply" << data;
+    QString requestId = generateRequestId();
+    QNetworkReply *reply = sendRequest(address, procedure, params, requestId);
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]{
+        processReply(reply);
+    });
+    return requestId;
+}
 
-        QJsonParseError error;
-        QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-        if (error.error != QJsonParseError::NoError) {
-            qCWarning(dcSma()) << "SunnyWebBox: Could not parse JSON" << error.errorString();
-            return;
-        }
-        if (!doc.isObject()) {
-            qCWarning(dcSma()) << "SunnyWebBox: JSON is not an Object";
-            return;
-        }
-        QVariantMap map = doc.toVariant().toMap();
-        if (map["version"] != "1.0") {
-            qCWarning(dcSma()) << "SunnyWebBox: API version not supported" << map["version"];
-            return;
-        }
+void SunnyWebBox::sendNextRequest()
+{
+    // Only one request at the time, this way the persistent connection gets reused for all of them
+    if (m_currentReply || m_requestQueue.isEmpty())
+        return;
+
+    QueuedRequest request = m_requestQueue.dequeue();
+    QNetworkReply *reply = dispatchRequest(request);
+    m_currentReply = reply;
+    m_requestTimeoutTimer.start();
+    connect(reply, &QNetworkReply::finished, this, [this]{
+        m_requestTimeoutTimer.stop();
+        m_currentReply = nullptr;
+        sendNextRequest();
+    });
+}
 
-        if (map.contains("proc") && map.contains("result")) {
-            QString requestType = map["proc"].toString();
-            QString requestId = map["id"].toString();
-            QVariantMap result = map.value("result").toMap();
-            parseMessage(requestId, requestType, result);
-        } else if (map.contains("proc") && map.contains("error")) {
-        } else {
-            qCWarning(dcSma()) << "SunnyWebBox: Missing proc or result value";
-        }
+QNetworkReply *SunnyWebBox::dispatchRequest(const QueuedRequest &request)
+{
+    QNetworkReply *reply = sendRequest(m_hostAddresss, request.procedure, request.params, request.requestId);
+    connect(reply, &QNetworkReply::finished, reply, &QNetworkReply::deleteLater);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]{
+        if (reply->error() != QNetworkReply::NoError)
+            qCDebug(dcSma()) << "SunnyWebBox: Request failed" << reply->errorString();
+
+        // A failed request only affects itself, the remaining queue continues
+        processReply(reply);
     });
-    return requestId;
+    return reply;
 }
 
+void SunnyWebBox::processReply(QNetworkReply *reply)
+{
+    if (reply->error() != QNetworkReply::NoError) {
+        setConnectionStatus(false);
+        return;
+    }
+
+    setConnectionStatus(true);
+
+    QByteArray data = reply->readAll();
+    qCDebug(dcSma()) << "SunnyWebBox: Received reply" << data;
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(dcSma()) << "SunnyWebBox: Could not parse JSON" << error.errorString();
+        return;
+    }
+    if (!doc.isObject()) {
+        qCWarning(dcSma()) << "SunnyWebBox: JSON is not an Object";
+        return;
+    }
+
+    QJsonObject response = doc.object();
+    if (response.value("version").toString() != "1.0") {
+        qCWarning(dcSma()) << "SunnyWebBox: API version not supported" << response.value("version");
+        return;
+    }
+
+    if (response.contains("proc") && response.contains("result")) {
+        QString requestType = response.value("proc").toString();
+        QString requestId = response.value("id").toString();
+        parseMessage(requestId, requestType, response.value("result").toObject());
+    } else if (response.contains("proc") && response.contains("error")) {
+        qCWarning(dcSma()) << "SunnyWebBox: Request" << response.value("proc").toString() << "failed" << response.value("error");
+    } else {
+        qCWarning(dcSma()) << "SunnyWebBox: Missing proc or result value";
+    }
+}
@@ -34,11 +34,14 @@
 #include "integrations/thing.h"
 #include "network/networkaccessmanager.h"
 
+#include <QQueue>
 #include <QObject>
+#include <QVector>
 #include <QJsonObject>
 #include <QHostAddress>
 #include <QUdpSocket>
 #include <QDateTime>
+#include <QTimer>
 
 class SunnyWebBox : public QObject
 {
@@ -65,6 +68,15 @@ public:
         QString unit;
     };
 
+    struct ProcessDataChannel {
+        QString meta;
+        QString name;
+        QString unit;
+        QString value;
+        double numericValue = 0;
+        bool numeric = false;
+    };
+
     struct Parameter {
         QString meta;
         QString name;
@@ -77,10 +89,18 @@ public:
     explicit SunnyWebBox(NetworkAccessManager *networkAccessManager, const QHostAddress &hostAddress, QObject *parrent = 0);
     ~SunnyWebBox();
 
+    // Batched mode: requests will be sent one after an other, this way QNetworkAccessManager reuses
+    // the HTTP connection for all of them. A request without reply within requestTimeout() gets aborted.
+    bool batchedMode() const;
+    void setBatchedMode(bool batchedMode);
+
+    static int requestTimeout() { return 15000; }
+    static int maxQueuedRequests() { return 20; }
+
     QString getPlantOverview(); // Returns an object with the following plant data: PAC, E-TODAY, E-TOTAL, MODE, ERROR
     QString getDevices();       // Returns a hierarchical list of all detected plant devices.
     QString getProcessDataChannels(const QString &deviceKey); //Returns a list with the meta names of the available process data channels for a particular device type.
-    QString getProcessData(const QStringList &deviceKeys);    //Returns process data for up to 5 devices per request.
+    QString getProcessData(const QStringList &deviceKeys);    //Returns process data for the given devices within one request.
     QString getParameterChannels(const QString &deviceKey);   //Returns a list with the meta names of the available parameter channels for a particular device type
     QString getParameters(const QStringList &deviceKeys);     //Returns the parameter values of up to 5 devices
     QString setParameters(const QString &deviceKeys, const QHash<QString, QVariant> &channels); //Sets parameter values
@@ -102,9 +122,27 @@ private:
     QString m_macAddress;
     QDateTime m_lastRequest;
 
+    struct QueuedRequest {
+        QString procedure;
+        QJsonObject params;
+        QString requestId;
+    };
+
+    bool m_batchedMode = false;
+    QQueue<QueuedRequest> m_requestQueue;
+    QNetworkReply *m_currentReply = nullptr;
+    QTimer m_requestTimeoutTimer;
+
+    void sendNextRequest();
+    QNetworkReply *dispatchRequest(const QueuedRequest &request);
+    void processReply(QNetworkReply *reply);
+
     QString sendMessage(const QHostAddress &address, const QString &procedure);
     QString sendMessage(const QHostAddress &address, const QString &procedure, const QJsonObject &params);
-    void parseMessage(const QString &messageId, const QString &messageType, const QVariantMap &result);
+    static QJsonObject devicesParams(const QStringList &deviceKeys);
+    static double toDouble(const QJsonValue &value, bool *ok = nullptr);
+    static QStringList toStringList(const QJsonValue &value);
+    void parseMessage(const QString &messageId, const QString &messageType, const QJsonObject &result);
     void setConnectionStatus(bool connected);
 
 signals:
@@ -113,7 +151,7 @@ signals:
     void plantOverviewReceived(const QString &messageId, Overview overview);
     void devicesReceived(const QString &messageId, QList<Device> devices);
     void processDataChannelsReceived(const QString &messageId, const QString &deviceKey, QStringList processDataChanels);
-    void processDataReceived(const QString &messageId, const QString &deviceKey, const QHash<QString, QVariant> &channels);
+    void processDataReceived(const QString &messageId, const QString &deviceKey, const QVector<SunnyWebBox::ProcessDataChannel> &channels);
     void parameterChannelsReceived(const QString &messageId, const QString &deviceKey, QStringList parameterChannels);
     void parametersReceived(const QString &messageId, const QString &deviceKey, const QList<Parameter> &parameters);
 };
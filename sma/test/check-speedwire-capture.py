@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2023 nymea GmbH <developer@nymea.io>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+# Verifies that speedwire-replay.py parses the capture format written by SpeedwireInterface.
+# A short capture will be loaded, written again and compared with the original, and the
+# recorded inverter request has to be paired with its response.
+
+import os
+import sys
+import struct
+import tempfile
+import importlib.util
+
+scriptDirectory = os.path.dirname(os.path.abspath(__file__))
+spec = importlib.util.spec_from_file_location('speedwirereplay', os.path.join(scriptDirectory, 'speedwire-replay.py'))
+speedwireReplay = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(speedwireReplay)
+
+
+def speedwirePacket(protocolId, payload):
+    # SMA header, tag 0x02a0 with group 1, data tag 0x0010 followed by the protocol id
+    return b'SMA\x00' + struct.pack('>HHIHHH', 4, 0x02a0, 1, len(payload) + 2, 0x0010, protocolId) + payload
+
+
+def inverterPacket(packetId, command):
+    payload = bytearray(28)
+    struct.pack_into('<H', payload, speedwireReplay.offsetPacketId - 18, packetId)
+    struct.pack_into('<I', payload, speedwireReplay.offsetCommand - 18, command)
+    return speedwirePacket(speedwireReplay.protocolIdInverter, bytes(payload))
+
+
+meterPacket = speedwirePacket(speedwireReplay.protocolIdMeter, bytes.fromhex('015d7130c7b800000004' + '00010400000012ab'))
+requestPacket = inverterPacket(0x8001, 0x52000200)
+responsePacket = inverterPacket(0x8001, 0x52000201) + bytes.fromhex('01234567')
+
+# Written the same way as SpeedwireInterface::captureDatagram()
+captureLines = [
+    '1697730306000 rx multicast 192.168.0.20 9522 %s' % meterPacket.hex(),
+    '1697730306012 tx unicast 192.168.0.30 9522 %s' % requestPacket.hex(),
+    '1697730306047 rx unicast 192.168.0.30 9522 %s' % responsePacket.hex(),
+    '1697730307001 rx multicast 192.168.0.20 9522 %s' % meterPacket.hex(),
+]
+
+failures = []
+def check(condition, description):
+    if not condition:
+        failures.append(description)
+
+with tempfile.TemporaryDirectory() as captureDirectory:
+    captureFileName = os.path.join(captureDirectory, 'test.capture')
+    with open(captureFileName, 'w') as captureFile:
+        captureFile.write('# speedwire capture 1\n')
+        captureFile.write('\n'.join(captureLines) + '\n')
+        # Truncated line from an interrupted capture
+        captureFile.write('1697730307010 rx multicast 192.168.0.20')
+
+    datagrams = speedwireReplay.loadCapture(captureFileName)
+
+check(len(datagrams) == len(captureLines), 'Loaded %s datagrams instead of %s' % (len(datagrams), len(captureLines)))
+check([datagram.captureLine() for datagram in datagrams] == captureLines, 'Written capture lines differ from the original ones')
+
+if len(datagrams) == len(captureLines):
+    check(datagrams[0].timestamp == 1697730306000, 'Wrong timestamp %s' % datagrams[0].timestamp)
+    check(datagrams[0].direction == 'rx' and datagrams[0].multicast, 'Meter datagram not received via multicast')
+    check(datagrams[0].address == '192.168.0.20' and datagrams[0].port == 9522, 'Wrong meter sender')
+    check(datagrams[0].data == meterPacket, 'Meter data differs')
+    check(datagrams[0].protocolId() == speedwireReplay.protocolIdMeter, 'Wrong meter protocol id 0x%04x' % datagrams[0].protocolId())
+    check(datagrams[1].direction == 'tx' and not datagrams[1].multicast, 'Inverter request not sent via unicast')
+    check(datagrams[1].packetId() == 0x8001 and datagrams[1].command() == 0x52000200, 'Wrong inverter request header')
+
+    exactResponses, commandResponses = speedwireReplay.buildResponseTable(datagrams)
+    check(exactResponses.get(requestPacket[speedwireReplay.offsetCommand:]) == responsePacket, 'Inverter request not paired with the recorded response')
+    check(commandResponses.get(0x52000200) == responsePacket, 'Inverter command not paired with the recorded response')
+
+if failures:
+    for failure in failures:
+        print('FAIL %s' % failure)
+    sys.exit(1)
+
+print('PASS speedwire capture round trip')
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2023 nymea GmbH <developer@nymea.io>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+# Replays a speedwire capture into a running nymea instance. Captures can be recorded by
+# starting nymea with NYMEA_SMA_SPEEDWIRE_CAPTURE=/path/to/file.capture
+#
+# Capture format, one datagram per line:
+#   <timestamp ms> <rx|tx> <multicast|unicast> <address> <port> <hex data>
+#
+# The received meter datagrams will be sent again to the multicast group (or an unicast target)
+# at real or accelerated speed. Optionally an inverter stand-in can be started on a local address,
+# answering the queries of the speedwire inverter using the responses found in the capture.
+#
+# Example: replay at 100x speed and answer inverter queries on 127.0.0.2 (use this address as inverter host)
+#   ./speedwire-replay.py -c sma.capture -s 100 --inverter 127.0.0.2
+
+import sys
+import time
+import socket
+import struct
+import argparse
+import logging
+import threading
+
+speedwirePort = 9522
+multicastAddress = '239.12.255.254'
+
+protocolIdMeter = 0x6069
+protocolIdInverter = 0x6065
+
+# Offsets within the speedwire inverter packet
+offsetDestinationModelId = 20
+offsetDestinationSerialNumber = 22
+offsetSourceModelId = 28
+offsetSourceSerialNumber = 30
+offsetPacketId = 40
+offsetCommand = 42
+inverterPacketMinSize = 46
+
+
+class Datagram:
+    def __init__(self, timestamp, direction, multicast, address, port, data):
+        self.timestamp = timestamp
+        self.direction = direction
+        self.multicast = multicast
+        self.address = address
+        self.port = port
+        self.data = data
+
+    def protocolId(self):
+        if len(self.data) < 18 or self.data[0:4] != b'SMA\x00':
+            return 0
+
+        return struct.unpack_from('>H', self.data, 16)[0]
+
+    def packetId(self):
+        return struct.unpack_from('<H', self.data, offsetPacketId)[0]
+
+    def command(self):
+        return struct.unpack_from('<I', self.data, offsetCommand)[0]
+
+    def captureLine(self):
+        # Same format as written by SpeedwireInterface::captureDatagram()
+        return '%s %s %s %s %s %s' % (self.timestamp, self.direction, 'multicast' if self.multicast else 'unicast', self.address, self.port, self.data.hex())
+
+
+def loadCapture(fileName):
+    datagrams = []
+    with open(fileName, 'r') as captureFile:
+        for lineNumber, line in enumerate(captureFile, 1):
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+
+            tokens = line.split()
+            if len(tokens) != 6:
+                logger.warning('Invalid capture line %s. Ignoring line...' % lineNumber)
+                continue
+
+            datagrams.append(Datagram(int(tokens[0]), tokens[1], tokens[2] == 'multicast', tokens[3], int(tokens[4]), bytes.fromhex(tokens[5])))
+
+    logger.info('Loaded %s datagrams from %s' % (len(datagrams), fileName))
+    return datagrams
+
+
+def buildResponseTable(datagrams):
+    # Pair each inverter request with the response carrying the same packet id from the same host
+    exactResponses = {}
+    commandResponses = {}
+    pendingRequests = {}
+    for datagram in datagrams:
+        if datagram.protocolId() != protocolIdInverter or len(datagram.data) < inverterPacketMinSize:
+            continue
+
+        if datagram.direction == 'tx':
+            pendingRequests[(datagram.address, datagram.packetId())] = datagram
+            continue
+
+        request = pendingRequests.pop((datagram.address, datagram.packetId()), None)
+        if request is None:
+            continue
+
+        exactResponses[request.data[offsetCommand:]] = datagram.data
+        commandResponses[request.command()] = datagram.data
+
+    logger.info('Found %s inverter responses for %s different commands' % (len(exactResponses), len(commandResponses)))
+    return exactResponses, commandResponses
+
+
+def runInverterStandIn(address, exactResponses, commandResponses, statistics):
+    serverSocket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    serverSocket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    serverSocket.bind((address, speedwirePort))
+    logger.info('Inverter stand-in listening on %s:%s' % (address, speedwirePort))
+
+    while True:
+        data, sender = serverSocket.recvfrom(2048)
+        request = Datagram(0, 'rx', False, sender[0], sender[1], data)
+        if request.protocolId() != protocolIdInverter or len(data) < inverterPacketMinSize:
+            continue
+
+        response = exactResponses.get(data[offsetCommand:], commandResponses.get(request.command()))
+        if response is None:
+            logger.debug('No recorded response for command 0x%08x from %s' % (request.command(), sender[0]))
+            statistics['unanswered'] += 1
+            continue
+
+        # Address the response to the requester and let it match the pending request
+        response = bytearray(response)
+        response[offsetDestinationModelId:offsetDestinationModelId + 2] = data[offsetSourceModelId:offsetSourceModelId + 2]
+        response[offsetDestinationSerialNumber:offsetDestinationSerialNumber + 4] = data[offsetSourceSerialNumber:offsetSourceSerialNumber + 4]
+        response[offsetPacketId:offsetPacketId + 2] = data[offsetPacketId:offsetPacketId + 2]
+        serverSocket.sendto(bytes(response), sender)
+        statistics['answered'] += 1
+        logger.debug('Answered command 0x%08x from %s' % (request.command(), sender[0]))
+
+
+def replay(datagrams, target, speed, loop):
+    replaySocket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    replaySocket.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+    replaySocket.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_LOOP, 1)
+
+    sentDatagrams = 0
+    startTime = time.monotonic()
+    while True:
+        cycleStartTime = time.monotonic()
+        firstTimestamp = datagrams[0].timestamp
+        for datagram in datagrams:
+            if speed > 0:
+                delay = (datagram.timestamp - firstTimestamp) / 1000.0 / speed - (time.monotonic() - cycleStartTime)
+                if delay > 0:
+                    time.sleep(delay)
+
+            replaySocket.sendto(datagram.data, (target, speedwirePort))
+            sentDatagrams += 1
+
+        if not loop:
+            break
+
+    duration = time.monotonic() - startTime
+    return sentDatagrams, duration
+
+
+logger = logging.getLogger('speedwire-replay')
+
+
+def main():
+    logger.setLevel(logging.INFO)
+    ch = logging.StreamHandler(sys.stdout)
+    ch.setFormatter(logging.Formatter('%(message)s'))
+    logger.addHandler(ch)
+
+    parser = argparse.ArgumentParser(description='Replay a speedwire capture and optionally answer inverter queries using the recorded responses.')
+    parser.add_argument('-c', '--capture', metavar='<file>', required=True, help='The capture file recorded using NYMEA_SMA_SPEEDWIRE_CAPTURE.')
+    parser.add_argument('-s', '--speed', metavar='<factor>', type=float, default=1.0, help='Replay speed factor, 1 is real time, 0 sends as fast as possible. Default 1.')
+    parser.add_argument('-t', '--target', metavar='<address>', default=multicastAddress, help='The target address for the replayed datagrams. Default is the speedwire multicast group %s.' % multicastAddress)
+    parser.add_argument('-i', '--inverter', metavar='<address>', help='Start an inverter stand-in on the given local address, i.e. 127.0.0.2.')
+    parser.add_argument('-a', '--all', dest='replayAll', action='store_true', help='Replay all received datagrams, not only the meter measurements.')
+    parser.add_argument('-l', '--loop', action='store_true', help='Replay the capture in an endless loop.')
+    parser.add_argument('-v', '--verbose', dest='verboseOutput', action='store_true', help='More verbose output.')
+    args = parser.parse_args()
+
+    if args.verboseOutput:
+        logger.setLevel(logging.DEBUG)
+
+    datagrams = loadCapture(args.capture)
+
+    statistics = { 'answered': 0, 'unanswered': 0 }
+    if args.inverter:
+        exactResponses, commandResponses = buildResponseTable(datagrams)
+        standInThread = threading.Thread(target=runInverterStandIn, args=(args.inverter, exactResponses, commandResponses, statistics), daemon=True)
+        standInThread.start()
+
+    replayDatagrams = [datagram for datagram in datagrams if datagram.direction == 'rx' and (args.replayAll or datagram.protocolId() == protocolIdMeter)]
+    if not replayDatagrams:
+        logger.info('Nothing to replay.')
+    else:
+        logger.info('Replaying %s datagrams to %s:%s (speed %s)' % (len(replayDatagrams), args.target, speedwirePort, args.speed if args.speed > 0 else 'unlimited'))
+        try:
+            sentDatagrams, duration = replay(replayDatagrams, args.target, args.speed, args.loop)
+            logger.info('Sent %s datagrams in %.3f s (%.1f packets/s)' % (sentDatagrams, duration, sentDatagrams / duration if duration > 0 else 0))
+        except KeyboardInterrupt:
+            pass
+
+    if args.inverter:
+        try:
+            logger.info('Inverter stand-in still running, press Ctrl+C to quit.')
+            while True:
+                time.sleep(1)
+        except KeyboardInterrupt:
+            logger.info('Answered %s inverter queries, %s without recorded response.' % (statistics['answered'], statistics['unanswered']))
+
+
+if __name__ == '__main__':
+    main()
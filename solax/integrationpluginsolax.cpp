@@ -34,6 +34,7 @@
 
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginSolax::IntegrationPluginSolax()
 {
@@ -329,6 +330,12 @@ void IntegrationPluginSolax::setupThing(ThingSetupInfo *info)
         });
 
         m_tcpConnections.insert(thing, solaxConnection);
+        ModbusPollOrchestrator::instance()->addConnection(this, solaxConnection, solaxConnection->modbusTcpMaster()->hostAddress().toString(), [solaxConnection](){
+            return !solaxConnection->initializing() && solaxConnection->update();
+        });
+        connect(solaxConnection, &SolaxModbusTcpConnection::updateFinished, ModbusPollOrchestrator::instance(), [solaxConnection](){
+            ModbusPollOrchestrator::instance()->finishCycle(solaxConnection);
+        });
 
         if (monitor->reachable())
             solaxConnection->connectDevice();
@@ -419,13 +426,7 @@ void IntegrationPluginSolax::postSetupThing(Thing *thing)
             qCDebug(dcSolax()) << "Starting plugin timer...";
             m_refreshTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
             connect(m_refreshTimer, &PluginTimer::timeout, this, [this] {
-                foreach(SolaxModbusTcpConnection *connection, m_tcpConnections) {
-                    if (connection->initializing())
-                        continue;
-
-                    //qCDebug(dcSolax()) << "Update connection" << connection->modbusTcpMaster()->hostAddress().toString();
-                    connection->update();
-                }
+                ModbusPollOrchestrator::instance()->poll(this, m_refreshTimer->interval() * 1000);
             });
 
             m_refreshTimer->start();
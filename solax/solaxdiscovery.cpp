@@ -45,11 +45,20 @@ void SolaxDiscovery::startDiscovery()
     qCInfo(dcSolax()) << "Discovery: Start searching for Solax inverters in the network...";
     m_startDateTime = QDateTime::currentDateTime();
 
-    NetworkDeviceDiscoveryReply *discoveryReply = m_networkDeviceDiscovery->discover();
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::networkDeviceInfoAdded, this, &SolaxDiscovery::checkNetworkDevice);
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, discoveryReply, &NetworkDeviceDiscoveryReply::deleteLater);
-    connect(discoveryReply, &NetworkDeviceDiscoveryReply::finished, this, [=](){
-        qCDebug(dcSolax()) << "Discovery: Network discovery finished. Found" << discoveryReply->networkDeviceInfos().count() << "network devices";
+    // Only hosts with the modbus port open and a matching signature get a connection for checking the device
+    ModbusTcpDiscovery *modbusTcpDiscovery = new ModbusTcpDiscovery(m_networkDeviceDiscovery, m_port, m_modbusAddress, this);
+    // Factory name, registers 7 to 13
+    modbusTcpDiscovery->setSignatureName("solax");
+    modbusTcpDiscovery->setSignatureRegisters(QModbusDataUnit::HoldingRegisters, 7, 7, [](const QVector<quint16> &values){
+        return ModbusDataUtils::convertToString(values, ModbusDataUtils::ByteOrderBigEndian).toLower().contains("solax");
+    });
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::deviceFound, this, [this](const ModbusTcpDiscovery::Result &result){
+        checkNetworkDevice(result.networkDeviceInfo);
+    });
+
+    connect(modbusTcpDiscovery, &ModbusTcpDiscovery::discoveryFinished, this, [=](){
+        qCDebug(dcSolax()) << "Discovery: Network discovery finished. Found" << modbusTcpDiscovery->results().count() << "network devices with the modbus port open";
+        modbusTcpDiscovery->deleteLater();
 
         // Give the last connections added right before the network discovery finished a chance to check the device...
         QTimer::singleShot(3000, this, [this](){
@@ -57,6 +66,8 @@ void SolaxDiscovery::startDiscovery()
             finishDiscovery();
         });
     });
+
+    modbusTcpDiscovery->startDiscovery();
 }
 
 QList<SolaxDiscovery::SolaxDiscoveryResult> SolaxDiscovery::discoveryResults() const
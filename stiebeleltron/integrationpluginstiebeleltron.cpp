@@ -33,6 +33,7 @@
 
 #include <hardwaremanager.h>
 #include <network/networkdevicediscovery.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginStiebelEltron::IntegrationPluginStiebelEltron() {}
 
@@ -255,6 +256,7 @@ void IntegrationPluginStiebelEltron::setupThing(ThingSetupInfo *info) {
                 });
 
         m_connections.insert(thing, connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusTcpMaster()->hostAddress().toString());
         connection->connectDevice();
 
         info->finish(Thing::ThingErrorNoError);
@@ -267,11 +269,7 @@ void IntegrationPluginStiebelEltron::postSetupThing(Thing *thing) {
             qCDebug(dcStiebelEltron()) << "Starting plugin timer...";
             m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(10);
             connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-                foreach (StiebelEltronModbusTcpConnection *connection, m_connections) {
-                    if (connection->reachable()) {
-                        connection->update();
-                    }
-                }
+                ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
             });
 
             m_pluginTimer->start();
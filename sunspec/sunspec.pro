@@ -1,5 +1,6 @@
 include(../plugins.pri)
 include(../sunspec.pri)
+include(../modbus.pri)
 
 SOURCES += \
     integrationpluginsunspec.cpp \
@@ -34,6 +34,8 @@
 #include <models/sunspecmodelfactory.h>
 #include <models/sunspeccommonmodel.h>
 
+#include <modbusfingerprintcache.h>
+
 SunSpecDiscovery::SunSpecDiscovery(NetworkDeviceDiscovery *networkDeviceDiscovery, const QList<quint16> &slaveIds, SunSpecDataPoint::ByteOrder byteOrder, QObject *parent)
     : QObject{parent},
       m_networkDeviceDiscovery{networkDeviceDiscovery},
@@ -102,12 +104,24 @@ void SunSpecDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDevice
     // Create a connection queue for this network device
 
     QQueue<SunSpecConnection *> connectionQueue;
+    ModbusFingerprintCache *fingerprintCache = ModbusFingerprintCache::instance();
 
     // Check all ports for this host
     foreach (quint16 port, m_scanPorts) {
 
+        // Skip what other discoveries already found out recently
+        if (fingerprintCache->portState(networkDeviceInfo.address(), port) == ModbusFingerprintCache::StateUnavailable) {
+            qCDebug(dcSunSpec()) << "Discovery: Skipping" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "since the port is known to be closed";
+            continue;
+        }
+
         foreach (quint16 slaveId, m_slaveIds) {
 
+            if (fingerprintCache->sunSpecState(networkDeviceInfo.address(), port, slaveId) == ModbusFingerprintCache::StateUnavailable) {
+                qCDebug(dcSunSpec()) << "Discovery: Skipping" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "since it is known to have no SunSpec data";
+                continue;
+            }
+
             SunSpecConnection *connection = new SunSpecConnection(networkDeviceInfo.address(), port, slaveId, m_byteOrder, this);
             connection->setNumberOfRetries(1);
             connection->setTimeout(500);
@@ -122,7 +136,12 @@ void SunSpecDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDevice
                 }
 
                 // Modbus TCP connected, try to discovery sunspec models...
+                ModbusFingerprintCache::instance()->setPortState(networkDeviceInfo.address(), port, true);
                 connect(connection, &SunSpecConnection::discoveryFinished, this, [=](bool success){
+                    // Don't hide a slow or busy device from the next discoveries
+                    if (success || !connection->discoveryInconclusive())
+                        ModbusFingerprintCache::instance()->setSunSpecState(networkDeviceInfo.address(), port, slaveId, success);
+
                     if (!success) {
                         qCDebug(dcSunSpec()) << "Discovery: SunSpec discovery failed on" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
                         cleanupConnection(connection);
@@ -163,6 +182,8 @@ void SunSpecDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDevice
             // If we get any error...skip this host...
             connect(connection->modbusTcpClient(), &QModbusTcpClient::errorOccurred, this, [=](QModbusDevice::Error error){
                 if (error != QModbusDevice::NoError) {
+                    // Note: the modbus client does not tell a refused connection apart from a timeout,
+                    // so the port state will not be cached as unavailable here.
                     qCDebug(dcSunSpec()) << "Discovery: Connection error on" << QString("%1:%2").arg(networkDeviceInfo.address().toString()).arg(port) << "slave ID:" << slaveId << "Continue...";;
                     cleanupConnection(connection);
                 }
@@ -170,6 +191,9 @@ void SunSpecDiscovery::checkNetworkDevice(const NetworkDeviceInfo &networkDevice
         }
     }
 
+    if (connectionQueue.isEmpty())
+        return;
+
     m_pendingConnectionAttempts[networkDeviceInfo.address()] = connectionQueue;
     testNextConnection(networkDeviceInfo.address());
 }
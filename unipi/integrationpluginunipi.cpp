@@ -433,6 +433,7 @@ void IntegrationPluginUniPi::setupThing(ThingSetupInfo *info)
             neuron = nullptr;
             return info->finish(Thing::ThingErrorSetupFailed, QT_TR_NOOP("Error setting up Neuron Thing."));
         }
+        neuron->setAdaptivePolling(configValue(uniPiPluginAdaptivePollingParamTypeId).toBool());
         m_neurons.insert(thing->id(), neuron);
         connect(neuron, &Neuron::requestExecuted, this, &IntegrationPluginUniPi::onRequestExecuted);
         connect(neuron, &Neuron::requestError, this, &IntegrationPluginUniPi::onRequestError);
@@ -492,6 +493,7 @@ void IntegrationPluginUniPi::setupThing(ThingSetupInfo *info)
             neuronExtension = nullptr;
             return info->finish(Thing::ThingErrorSetupFailed, QT_TR_NOOP("Error loading modbus map."));
         }
+        neuronExtension->setAdaptivePolling(configValue(uniPiPluginAdaptivePollingParamTypeId).toBool());
         connect(neuronExtension, &NeuronExtension::requestExecuted, this, &IntegrationPluginUniPi::onRequestExecuted);
         connect(neuronExtension, &NeuronExtension::requestError, this, &IntegrationPluginUniPi::onRequestError);
         connect(neuronExtension, &NeuronExtension::connectionStateChanged, this, &IntegrationPluginUniPi::onNeuronExtensionConnectionStateChanged);
@@ -731,6 +733,15 @@ void IntegrationPluginUniPi::onPluginConfigurationChanged(const ParamTypeId &par
             }
         }
     }
+
+    if (paramTypeId == uniPiPluginAdaptivePollingParamTypeId) {
+        foreach (Neuron *neuron, m_neurons) {
+            neuron->setAdaptivePolling(value.toBool());
+        }
+        foreach (NeuronExtension *neuronExtension, m_neuronExtensions) {
+            neuronExtension->setAdaptivePolling(value.toBool());
+        }
+    }
 }
 
 void IntegrationPluginUniPi::onNeuronConnectionStateChanged(bool state)
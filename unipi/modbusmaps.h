@@ -0,0 +1,77 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+*
+* Copyright 2013 - 2023, nymea GmbH
+* Contact: contact@nymea.io
+*
+* This file is part of nymea.
+* This project including source code and documentation is protected by
+* copyright law, and remains the property of nymea GmbH. All rights, including
+* reproduction, publication, editing and translation, are reserved. The use of
+* this project is subject to the terms of a license agreement to be concluded
+* with nymea GmbH in accordance with the terms of use of nymea GmbH, available
+* under https://nymea.io/license
+*
+* GNU Lesser General Public License Usage
+* Alternatively, this project may be redistributed and/or modified under the
+* terms of the GNU Lesser General Public License as published by the Free
+* Software Foundation; version 3. This project is distributed in the hope that
+* it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+* warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this project. If not, see <https://www.gnu.org/licenses/>.
+*
+* For any further details and any questions please contact us under
+* contact@nymea.io or see our FAQ/Licensing Information on
+* https://nymea.io/license/faq
+*
+* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MODBUSMAPS_H
+#define MODBUSMAPS_H
+
+#include <QString>
+
+// The UniPi modbus maps are converted from the CSV files in modbus_maps at build time
+// by tools/generate-modbus-maps.py. The generated tables can be found in unipimodbusmaps.cpp.
+
+namespace UniPiModbusMaps {
+
+enum CircuitType {
+    CircuitTypeDigitalInput,
+    CircuitTypeDigitalOutput,
+    CircuitTypeUserLED,
+    CircuitTypeAnalogInput,
+    CircuitTypeAnalogOutput
+};
+
+enum Access {
+    AccessNone,
+    AccessRead,
+    AccessReadWrite,
+    AccessWrite
+};
+
+typedef struct Circuit {
+    CircuitType type;
+    quint16 address;
+    quint16 registerCount;
+    Access access;
+    quint16 nameIndex; // Index of the circuit name, only used for displaying
+} Circuit;
+
+typedef struct ModbusMap {
+    const char *model;
+    const Circuit *circuits;
+    int circuitCount;
+} ModbusMap;
+
+// Returns the map for the given model, i.e. "Neuron_M103", or nullptr if there is none
+const ModbusMap *findModbusMap(const QString &model);
+
+QString circuitName(const Circuit &circuit);
+
+}
+
+#endif // MODBUSMAPS_H
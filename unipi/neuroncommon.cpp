@@ -29,8 +29,11 @@
 * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "neuroncommon.h"
+#include "modbusmaps.h"
 #include "extern-plugininfo.h"
 
+#include <QDateTime>
+
 NeuronCommon::NeuronCommon(QModbusClient *modbusInterface, int slaveAddress, QObject *parent) :
     QObject(parent),
     m_slaveAddress(slaveAddress),
@@ -39,13 +42,18 @@ NeuronCommon::NeuronCommon(QModbusClient *modbusInterface, int slaveAddress, QOb
     m_inputPollingTimer = new QTimer(this);
     connect(m_inputPollingTimer, &QTimer::timeout, this, &NeuronCommon::onInputPollingTimer);
     m_inputPollingTimer->setTimerType(Qt::TimerType::PreciseTimer);
-    m_inputPollingTimer->setInterval(200);
+    m_inputPollingTimer->setInterval(m_inputPollingInterval);
 
     m_outputPollingTimer = new QTimer(this);
     connect(m_outputPollingTimer, &QTimer::timeout, this, &NeuronCommon::onOutputPollingTimer);
     m_outputPollingTimer->setTimerType(Qt::TimerType::PreciseTimer);
     m_outputPollingTimer->setInterval(1000);
 
+    m_writeCombineTimer = new QTimer(this);
+    m_writeCombineTimer->setSingleShot(true);
+    m_writeCombineTimer->setInterval(m_writeCombineWindow);
+    connect(m_writeCombineTimer, &QTimer::timeout, this, &NeuronCommon::sendPendingWriteRequests);
+
     if (m_modbusInterface->state() == QModbusDevice::State::ConnectedState) {
         m_inputPollingTimer->start();
         m_outputPollingTimer->start();
@@ -74,6 +82,7 @@ bool NeuronCommon::init()
     if (!loadModbusMap()) {
         return false;
     }
+    buildReadPlan();
 
     if (!m_modbusInterface) {
         qWarning(dcUniPi()) << "Neuron: Modbus interface not available";
@@ -131,30 +140,66 @@ QList<QString> NeuronCommon::userLEDs()
     return m_modbusUserLEDRegisters.keys();
 }
 
-NeuronCommon::RegisterDescriptor NeuronCommon::registerDescriptorFromStringList(const QStringList &data)
+bool NeuronCommon::loadModbusMapTable(const QString &model)
 {
-    RegisterDescriptor descriptor;
-    if (data.count() < 7) {
-        return descriptor;
-    }
-    descriptor.address = data[0].toInt();
-    descriptor.count = data[2].toInt();
-    if (data[3] == "RW") {
-        descriptor.readWrite = RWPermissionReadWrite;
-    } else if (data[3] == "W") {
-        descriptor.readWrite = RWPermissionWrite;
-    } else if (data[3] == "R") {
-        descriptor.readWrite = RWPermissionRead;
+    const UniPiModbusMaps::ModbusMap *modbusMap = UniPiModbusMaps::findModbusMap(model);
+    if (!modbusMap) {
+        qCWarning(dcUniPi()) << "Neuron: There is no modbus map available for" << model;
+        return false;
     }
-    descriptor.circuit = data[5].split(" ").last();
-    descriptor.category = data.last();
 
-    if (data[5].contains("Analog Input Value", Qt::CaseSensitivity::CaseInsensitive)) {
-        descriptor.registerType = QModbusDataUnit::RegisterType::InputRegisters;
-    } else if (data[5].contains("Analog Output Value", Qt::CaseSensitivity::CaseInsensitive)) {
-        descriptor.registerType = QModbusDataUnit::RegisterType::HoldingRegisters;
+    for (int i = 0; i < modbusMap->circuitCount; i++) {
+        const UniPiModbusMaps::Circuit &circuit = modbusMap->circuits[i];
+        QString circuitName = UniPiModbusMaps::circuitName(circuit);
+
+        switch (circuit.type) {
+        case UniPiModbusMaps::CircuitTypeDigitalInput:
+            m_modbusDigitalInputRegisters.insert(circuitName, circuit.address);
+            break;
+        case UniPiModbusMaps::CircuitTypeDigitalOutput:
+            m_modbusDigitalOutputRegisters.insert(circuitName, circuit.address);
+            break;
+        case UniPiModbusMaps::CircuitTypeUserLED:
+            m_modbusUserLEDRegisters.insert(circuitName, circuit.address);
+            break;
+        case UniPiModbusMaps::CircuitTypeAnalogInput:
+        case UniPiModbusMaps::CircuitTypeAnalogOutput: {
+            RegisterDescriptor descriptor;
+            descriptor.address = circuit.address;
+            descriptor.count = circuit.registerCount;
+            descriptor.circuit = circuitName;
+            descriptor.category = "Basic";
+            switch (circuit.access) {
+            case UniPiModbusMaps::AccessNone:
+                descriptor.readWrite = RWPermissionNone;
+                break;
+            case UniPiModbusMaps::AccessRead:
+                descriptor.readWrite = RWPermissionRead;
+                break;
+            case UniPiModbusMaps::AccessReadWrite:
+                descriptor.readWrite = RWPermissionReadWrite;
+                break;
+            case UniPiModbusMaps::AccessWrite:
+                descriptor.readWrite = RWPermissionWrite;
+                break;
+            }
+
+            if (circuit.type == UniPiModbusMaps::CircuitTypeAnalogInput) {
+                descriptor.registerType = QModbusDataUnit::RegisterType::InputRegisters;
+                m_modbusAnalogInputRegisters.insert(descriptor.address, descriptor);
+            } else {
+                descriptor.registerType = QModbusDataUnit::RegisterType::HoldingRegisters;
+                m_modbusAnalogOutputRegisters.insert(descriptor.address, descriptor);
+            }
+            break;
+        }
+        }
     }
-    return descriptor;
+
+    qCDebug(dcUniPi()) << "Neuron: Loaded modbus map" << model << "with" << m_modbusDigitalInputRegisters.count() << "digital inputs,"
+                       << m_modbusDigitalOutputRegisters.count() << "digital outputs," << m_modbusUserLEDRegisters.count() << "user LEDs,"
+                       << m_modbusAnalogInputRegisters.count() << "analog inputs and" << m_modbusAnalogOutputRegisters.count() << "analog outputs";
+    return true;
 }
 
 bool NeuronCommon::circuitValueChanged(const QString &circuit, quint32 value)
@@ -175,26 +220,22 @@ bool NeuronCommon::circuitValueChanged(const QString &circuit, quint32 value)
 
 void NeuronCommon::getAllDigitalInputs()
 {
-    getCoils(m_modbusDigitalInputRegisters.values());
+    sendReadPlan(m_digitalInputReadPlan);
 }
 
 void NeuronCommon::getAllDigitalOutputs()
 {
-    getCoils(m_modbusDigitalOutputRegisters.values());
+    sendReadPlan(m_digitalOutputReadPlan);
 }
 
 void NeuronCommon::getAllAnalogInputs()
 {
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogInputRegisters.values()) {
-        getAnalogIO(descriptor);
-    }
+    sendReadPlan(m_analogInputReadPlan);
 }
 
 void NeuronCommon::getAllAnalogOutputs()
 {
-    Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogOutputRegisters.values()) {
-        getAnalogIO(descriptor);
-    }
+    sendReadPlan(m_analogOutputReadPlan);
 }
 
 bool NeuronCommon::getDigitalInput(const QString &circuit)
@@ -240,19 +281,9 @@ QUuid NeuronCommon::setDigitalOutput(const QString &circuit, bool value)
     int modbusAddress = m_modbusDigitalOutputRegisters.value(circuit);
     //qDebug(dcUniPi()) << "Neuron: Setting digital ouput" << circuit << modbusAddress << value;
 
-    Request request;
-    request.data = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, modbusAddress, 1);
-    request.data.setValue(0, static_cast<uint16_t>(value));
-    request.id = QUuid::createUuid();
-
-    if (m_writeRequestQueue.isEmpty()) {
-        modbusWriteRequest(request);
-    } else if (m_writeRequestQueue.length() > 100) {
-        return "";
-    } else {
-        m_writeRequestQueue.append(request);
-    }
-    return request.id;
+    QModbusDataUnit data(QModbusDataUnit::RegisterType::Coils, modbusAddress, 1);
+    data.setValue(0, static_cast<uint16_t>(value));
+    return queueWriteRequest(data);
 }
 
 
@@ -284,24 +315,14 @@ QUuid NeuronCommon::setAnalogOutput(const QString &circuit, double value)
 
     Q_FOREACH(RegisterDescriptor descriptor, m_modbusAnalogOutputRegisters) {
         if (descriptor.circuit == circuit) {
-            Request request;
-            request.id = QUuid::createUuid();
-            request.data = QModbusDataUnit(QModbusDataUnit::RegisterType::HoldingRegisters, descriptor.address, descriptor.count);
+            QModbusDataUnit data(QModbusDataUnit::RegisterType::HoldingRegisters, descriptor.address, descriptor.count);
             if (descriptor.count == 1) {
-                request.data.setValue(0, (static_cast<uint>(value*400))); // 0 to 4000 = 0 to 10.0 V
+                data.setValue(0, (static_cast<uint>(value*400))); // 0 to 4000 = 0 to 10.0 V
             } else if (descriptor.count == 2) {
-                request.data.setValue(0, (static_cast<uint32_t>(value) >> 16));
-                request.data.setValue(1, (static_cast<uint32_t>(value) & 0xffff));
-            }
-
-            if (m_writeRequestQueue.isEmpty()) {
-                modbusWriteRequest(request);
-            } else if (m_writeRequestQueue.length() > 100) {
-                return "";
-            } else {
-                m_writeRequestQueue.append(request);
+                data.setValue(0, (static_cast<uint32_t>(value) >> 16));
+                data.setValue(1, (static_cast<uint32_t>(value) & 0xffff));
             }
-            return request.id;
+            return queueWriteRequest(data);
         }
     }
     qCWarning(dcUniPi()) << "Neuron: Analog output circuit not found" << circuit;
@@ -329,23 +350,9 @@ QUuid NeuronCommon::setUserLED(const QString &circuit, bool value)
     if (!m_modbusInterface)
         return "";
 
-    Request request;
-    request.id = QUuid::createUuid();
-
-    request.data = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, modbusAddress, 1);
-    request.data.setValue(0, static_cast<uint16_t>(value));
-
-    if (m_writeRequestQueue.isEmpty()) {
-        if (!modbusWriteRequest(request)) {
-            return "";
-        }
-    } else if (m_writeRequestQueue.length() > 100) {
-        return "";
-    } else {
-        m_writeRequestQueue.append(request);
-    }
-
-    return request.id;
+    QModbusDataUnit data(QModbusDataUnit::RegisterType::Coils, modbusAddress, 1);
+    data.setValue(0, static_cast<uint16_t>(value));
+    return queueWriteRequest(data);
 }
 
 
@@ -386,46 +393,118 @@ bool NeuronCommon::getAnalogIO(const RegisterDescriptor &descriptor)
     return true;
 }
 
-bool NeuronCommon::modbusWriteRequest(const Request &request)
+QUuid NeuronCommon::queueWriteRequest(const QModbusDataUnit &data)
+{
+    if (m_pendingWriteRequests.length() > 100) {
+        qCWarning(dcUniPi()) << "Neuron: Too many pending write requests";
+        return "";
+    }
+
+    Request request;
+    request.id = QUuid::createUuid();
+    request.data = data;
+    m_pendingWriteRequests.append(request);
+
+    // Collect all writes within the combine window, i.e. from a scene switching many relays at once
+    if (!m_writeCombineTimer->isActive())
+        m_writeCombineTimer->start();
+
+    return request.id;
+}
+
+void NeuronCommon::sendPendingWriteRequests()
+{
+    QList<Request> requests = m_pendingWriteRequests;
+    m_pendingWriteRequests.clear();
+
+    // Stable sort, so a later write to the same address replaces the earlier value
+    std::stable_sort(requests.begin(), requests.end(), [](const Request &first, const Request &second) {
+        if (first.data.registerType() != second.data.registerType())
+            return first.data.registerType() < second.data.registerType();
+
+        return first.data.startAddress() < second.data.startAddress();
+    });
+
+    QList<WriteBatch> batches;
+    foreach (const Request &request, requests) {
+        if (!batches.isEmpty()) {
+            WriteBatch &batch = batches.last();
+            int maxCount = batch.data.registerType() == QModbusDataUnit::RegisterType::Coils ? 1968 : 123;
+            int offset = request.data.startAddress() - batch.data.startAddress();
+            int count = qMax(static_cast<int>(batch.data.valueCount()), offset + static_cast<int>(request.data.valueCount()));
+            // Only contiguous addresses can be written in one request
+            if (batch.data.registerType() == request.data.registerType() && offset <= static_cast<int>(batch.data.valueCount()) && count <= maxCount) {
+                QVector<quint16> values = batch.data.values();
+                values.resize(count);
+                for (uint i = 0; i < request.data.valueCount(); i++) {
+                    values[offset + i] = request.data.value(i);
+                }
+                batch.data.setValues(values);
+                batch.requestIds.append(request.id);
+                continue;
+            }
+        }
+
+        WriteBatch batch;
+        batch.requestIds.append(request.id);
+        batch.data = request.data;
+        batches.append(batch);
+    }
+
+    if (requests.count() != batches.count()) {
+        qCDebug(dcUniPi()) << "Neuron: Combined" << requests.count() << "write requests into" << batches.count() << "modbus requests";
+    }
+
+    foreach (const WriteBatch &batch, batches) {
+        modbusWriteRequest(batch);
+    }
+}
+
+bool NeuronCommon::modbusWriteRequest(const WriteBatch &batch)
 {
     if (!m_modbusInterface) {
-        emit requestExecuted(request.id, false);
-        emit requestError(request.id, "Modbus interface not available");
+        foreach (const QUuid &requestId, batch.requestIds) {
+            emit requestExecuted(requestId, false);
+            emit requestError(requestId, "Modbus interface not available");
+        }
         return false;
     }
     if (m_modbusInterface->state() != QModbusDevice::State::ConnectedState) {
-        emit requestExecuted(request.id, false);
-        emit requestError(request.id, "Device not connected");
+        foreach (const QUuid &requestId, batch.requestIds) {
+            emit requestExecuted(requestId, false);
+            emit requestError(requestId, "Device not connected");
+        }
         return false;
     };
 
-    if (QModbusReply *reply = m_modbusInterface->sendWriteRequest(request.data, m_slaveAddress)) {
+    if (QModbusReply *reply = m_modbusInterface->sendWriteRequest(batch.data, m_slaveAddress)) {
         if (!reply->isFinished()) {
             connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, this, [reply, request, this] {
-
-                if (!m_writeRequestQueue.isEmpty()) {
-                    modbusWriteRequest(m_writeRequestQueue.takeFirst());
-                }
-
+            connect(reply, &QModbusReply::finished, this, [reply, batch, this] {
                 if (reply->error() == QModbusDevice::NoError) {
-                    emit requestExecuted(request.id, true);
-                    const QModbusDataUnit unit = reply->result();
-                    int modbusAddress = unit.startAddress();
-                    if(m_modbusDigitalOutputRegisters.values().contains(modbusAddress)){
-                        QString circuit = m_modbusDigitalOutputRegisters.key(modbusAddress);
-                        emit digitalOutputStatusChanged(circuit, unit.value(0));
-                    } else if(m_modbusAnalogOutputRegisters.contains(modbusAddress)){
-                        QString circuit = m_modbusAnalogOutputRegisters.value(modbusAddress).circuit;
-                        emit analogOutputStatusChanged(circuit, unit.value(0));
-                    } else if(m_modbusUserLEDRegisters.values().contains(modbusAddress)){
-                        QString circuit = m_modbusUserLEDRegisters.key(modbusAddress);
-                        emit userLEDStatusChanged(circuit, unit.value(0));
+                    foreach (const QUuid &requestId, batch.requestIds) {
+                        emit requestExecuted(requestId, true);
+                    }
+
+                    const QModbusDataUnit unit = batch.data;
+                    for (uint i = 0; i < unit.valueCount(); i++) {
+                        int modbusAddress = unit.startAddress() + i;
+                        if (unit.registerType() == QModbusDataUnit::RegisterType::Coils) {
+                            if (m_digitalOutputCircuits.contains(modbusAddress)) {
+                                emit digitalOutputStatusChanged(m_digitalOutputCircuits.value(modbusAddress), unit.value(i));
+                            } else if (m_userLEDCircuits.contains(modbusAddress)) {
+                                emit userLEDStatusChanged(m_userLEDCircuits.value(modbusAddress), unit.value(i));
+                            }
+                        } else if (m_modbusAnalogOutputRegisters.contains(modbusAddress)) {
+                            emit analogOutputStatusChanged(m_modbusAnalogOutputRegisters.value(modbusAddress).circuit, unit.value(i));
+                        }
                     }
                 } else {
-                    emit requestExecuted(request.id, false);
                     qCWarning(dcUniPi()) << "Neuron: Write response error:" << reply->error();
-                    emit requestError(request.id, reply->errorString());
+                    foreach (const QUuid &requestId, batch.requestIds) {
+                        emit requestExecuted(requestId, false);
+                        emit requestError(requestId, reply->errorString());
+                    }
                 }
             });
             QTimer::singleShot(m_responseTimeoutTime, reply, &QModbusReply::deleteLater);
@@ -434,7 +513,11 @@ bool NeuronCommon::modbusWriteRequest(const Request &request)
             return false;
         }
     } else {
-        qCWarning(dcUniPi()) << "Neuron: Read error: " << m_modbusInterface->errorString();
+        qCWarning(dcUniPi()) << "Neuron: Write error: " << m_modbusInterface->errorString();
+        foreach (const QUuid &requestId, batch.requestIds) {
+            emit requestExecuted(requestId, false);
+            emit requestError(requestId, m_modbusInterface->errorString());
+        }
         return false;
     }
     return true;
@@ -466,16 +549,18 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
                         QString circuit;
                         switch (unit.registerType()) {
                         case QModbusDataUnit::RegisterType::Coils:
-                            if(m_modbusDigitalInputRegisters.values().contains(modbusAddress)){
-                                circuit = m_modbusDigitalInputRegisters.key(modbusAddress);
-                                if (circuitValueChanged(circuit, unit.value(i)))
+                            if(m_digitalInputCircuits.contains(modbusAddress)){
+                                circuit = m_digitalInputCircuits.value(modbusAddress);
+                                if (circuitValueChanged(circuit, unit.value(i))) {
+                                    onInputActivity();
                                     emit digitalInputStatusChanged(circuit, unit.value(i));
-                            } else if(m_modbusDigitalOutputRegisters.values().contains(modbusAddress)){
-                                circuit = m_modbusDigitalOutputRegisters.key(modbusAddress);
+                                }
+                            } else if(m_digitalOutputCircuits.contains(modbusAddress)){
+                                circuit = m_digitalOutputCircuits.value(modbusAddress);
                                 if (circuitValueChanged(circuit, unit.value(i)))
                                     emit digitalOutputStatusChanged(circuit, unit.value(i));
-                            } else if(m_modbusUserLEDRegisters.values().contains(modbusAddress)){
-                                circuit = m_modbusUserLEDRegisters.key(modbusAddress);
+                            } else if(m_userLEDCircuits.contains(modbusAddress)){
+                                circuit = m_userLEDCircuits.value(modbusAddress);
                                 if (circuitValueChanged(circuit, unit.value(i)))
                                     emit userLEDStatusChanged(circuit, unit.value(i));
                             } else {
@@ -484,7 +569,7 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
                             break;
 
                         case QModbusDataUnit::RegisterType::HoldingRegisters: {
-                            if (m_modbusAnalogOutputRegisters.keys().contains(modbusAddress)) {
+                            if (m_modbusAnalogOutputRegisters.contains(modbusAddress)) {
                                 RegisterDescriptor descriptor =  m_modbusAnalogOutputRegisters.value(modbusAddress);
                                 circuit = descriptor.circuit;
                                 quint32 value = 0;
@@ -506,7 +591,7 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
                             }
                         } break;
                         case QModbusDataUnit::RegisterType::InputRegisters:
-                            if(m_modbusAnalogInputRegisters.keys().contains(modbusAddress)){
+                            if(m_modbusAnalogInputRegisters.contains(modbusAddress)){
                                 RegisterDescriptor descriptor = m_modbusAnalogInputRegisters.value(modbusAddress);
                                 circuit = descriptor.circuit;
                                 quint32 value = 0;
@@ -551,35 +636,86 @@ bool NeuronCommon::modbusReadRequest(const QModbusDataUnit &request)
     return true;
 }
 
-void NeuronCommon::getCoils(QList<int> registerList)
+void NeuronCommon::buildReadPlan()
 {
-    if (registerList.isEmpty()) {
-        return;
+    m_digitalInputCircuits.clear();
+    foreach (const QString &circuit, m_modbusDigitalInputRegisters.keys()) {
+        m_digitalInputCircuits.insert(m_modbusDigitalInputRegisters.value(circuit), circuit);
     }
 
-    std::sort(registerList.begin(), registerList.end());
-    int previousReg = registerList.first(); //first register to read and starting point to get the following registers
-    int startAddress;
-
-    QHash<int, int> registerGroups;
-
-    foreach (int reg, registerList) {
-        //qDebug(dcUniPi()) << "Register" << reg << "previous Register" << previousReg;
-        if (reg == previousReg) { //first register
-            startAddress = reg;
-            registerGroups.insert(startAddress, 1);
-        } else if (reg == (previousReg + 1)) { //next register in block
-            previousReg = reg;
-            registerGroups.insert(startAddress, (registerGroups.value(startAddress) + 1)); //update block length
-        } else {    // new block
-            startAddress = reg;
-            previousReg = reg;
-            registerGroups.insert(startAddress, 1);
+    m_digitalOutputCircuits.clear();
+    foreach (const QString &circuit, m_modbusDigitalOutputRegisters.keys()) {
+        m_digitalOutputCircuits.insert(m_modbusDigitalOutputRegisters.value(circuit), circuit);
+    }
+
+    m_userLEDCircuits.clear();
+    foreach (const QString &circuit, m_modbusUserLEDRegisters.keys()) {
+        m_userLEDCircuits.insert(m_modbusUserLEDRegisters.value(circuit), circuit);
+    }
+
+    m_digitalInputReadPlan = coilReadPlan(m_modbusDigitalInputRegisters.values());
+    m_digitalOutputReadPlan = coilReadPlan(m_modbusDigitalOutputRegisters.values());
+    m_analogInputReadPlan = registerReadPlan(m_modbusAnalogInputRegisters);
+    m_analogOutputReadPlan = registerReadPlan(m_modbusAnalogOutputRegisters);
+
+    qCDebug(dcUniPi()) << "Neuron: Read plan built. Digital inputs:" << m_digitalInputReadPlan.count() << "requests, digital outputs:" << m_digitalOutputReadPlan.count()
+                       << "requests, analog inputs:" << m_analogInputReadPlan.count() << "requests, analog outputs:" << m_analogOutputReadPlan.count() << "requests";
+}
+
+QList<QModbusDataUnit> NeuronCommon::coilReadPlan(QList<int> addresses) const
+{
+    QList<QModbusDataUnit> readPlan;
+    if (addresses.isEmpty())
+        return readPlan;
+
+    std::sort(addresses.begin(), addresses.end());
+
+    int startAddress = addresses.first();
+    int count = 0;
+    foreach (int address, addresses) {
+        // Start a new request on each gap, a single request can read up to 2000 coils
+        if (address != startAddress + count || count >= 2000) {
+            readPlan.append(QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, startAddress, count));
+            startAddress = address;
+            count = 0;
         }
+        count++;
     }
+    readPlan.append(QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, startAddress, count));
+    return readPlan;
+}
+
+QList<QModbusDataUnit> NeuronCommon::registerReadPlan(const QHash<int, RegisterDescriptor> &descriptors) const
+{
+    QList<QModbusDataUnit> readPlan;
+    QList<int> addresses = descriptors.keys();
+    if (addresses.isEmpty())
+        return readPlan;
+
+    std::sort(addresses.begin(), addresses.end());
+
+    RegisterDescriptor first = descriptors.value(addresses.first());
+    QModbusDataUnit::RegisterType registerType = first.registerType;
+    int startAddress = first.address;
+    int count = 0;
+    foreach (int address, addresses) {
+        RegisterDescriptor descriptor = descriptors.value(address);
+        // Start a new request on each gap, a single request can read up to 125 registers
+        if (descriptor.address != startAddress + count || descriptor.registerType != registerType || count + static_cast<int>(descriptor.count) > 125) {
+            readPlan.append(QModbusDataUnit(registerType, startAddress, count));
+            registerType = descriptor.registerType;
+            startAddress = descriptor.address;
+            count = 0;
+        }
+        count += descriptor.count;
+    }
+    readPlan.append(QModbusDataUnit(registerType, startAddress, count));
+    return readPlan;
+}
 
-    foreach (int startAddress, registerGroups.keys()) {
-        QModbusDataUnit request = QModbusDataUnit(QModbusDataUnit::RegisterType::Coils, startAddress, registerGroups.value(startAddress));
+void NeuronCommon::sendReadPlan(const QList<QModbusDataUnit> &readPlan)
+{
+    foreach (const QModbusDataUnit &request, readPlan) {
         if (m_readRequestQueue.isEmpty()) {
             modbusReadRequest(request);
         } else if (m_readRequestQueue.length() > 100) {
@@ -590,6 +726,48 @@ void NeuronCommon::getCoils(QList<int> registerList)
     }
 }
 
+bool NeuronCommon::adaptivePolling() const
+{
+    return m_adaptivePolling;
+}
+
+void NeuronCommon::setAdaptivePolling(bool adaptivePolling)
+{
+    qCDebug(dcUniPi()) << "Neuron: Set adaptive polling" << adaptivePolling;
+    m_adaptivePolling = adaptivePolling;
+    if (m_adaptivePolling) {
+        m_lastInputActivity = QDateTime::currentMSecsSinceEpoch();
+        m_inputPollingTimer->setInterval(m_activeInputPollingInterval);
+    } else {
+        m_inputPollingTimer->setInterval(m_inputPollingInterval);
+    }
+}
+
+void NeuronCommon::onInputActivity()
+{
+    m_lastInputActivity = QDateTime::currentMSecsSinceEpoch();
+    if (m_adaptivePolling && m_inputPollingTimer->interval() != m_activeInputPollingInterval) {
+        qCDebug(dcUniPi()) << "Neuron: Input activity detected, polling inputs every" << m_activeInputPollingInterval << "ms";
+        m_inputPollingTimer->setInterval(m_activeInputPollingInterval);
+    }
+}
+
+void NeuronCommon::updateInputPollingInterval()
+{
+    if (QDateTime::currentMSecsSinceEpoch() - m_lastInputActivity < m_inputActivityTimeout)
+        return;
+
+    // No recent input changes, back off step by step until the idle interval has been reached
+    int interval = m_inputPollingTimer->interval();
+    if (interval < m_idleInputPollingInterval) {
+        interval = qMin(interval * 2, m_idleInputPollingInterval);
+        if (interval == m_idleInputPollingInterval) {
+            qCDebug(dcUniPi()) << "Neuron: Inputs idle, polling inputs every" << interval << "ms";
+        }
+        m_inputPollingTimer->setInterval(interval);
+    }
+}
+
 void NeuronCommon::onOutputPollingTimer()
 {
     getAllDigitalOutputs();
@@ -598,6 +776,9 @@ void NeuronCommon::onOutputPollingTimer()
 
 void NeuronCommon::onInputPollingTimer()
 {
+    if (m_adaptivePolling)
+        updateInputPollingInterval();
+
     getAllDigitalInputs();
     getAllAnalogInputs();
 }
@@ -66,6 +66,10 @@ public:
 
     bool getUserLED(const QString &circuit);
 
+    // Poll the inputs faster after digital input changes and slow down while idle
+    bool adaptivePolling() const;
+    void setAdaptivePolling(bool adaptivePolling);
+
 protected:
     enum RWPermission {
         RWPermissionNone,
@@ -84,7 +88,7 @@ protected:
     };
 
     virtual bool loadModbusMap() = 0;
-    RegisterDescriptor registerDescriptorFromStringList(const QStringList &data);
+    bool loadModbusMapTable(const QString &model);
 
     QHash<QString, int> m_modbusDigitalOutputRegisters;
     QHash<QString, int> m_modbusDigitalInputRegisters;
@@ -98,6 +102,12 @@ private:
         QModbusDataUnit data;
     };
 
+    // Combined write of contiguous coils or registers, i.e. 0x0F or 0x10
+    struct WriteBatch {
+        QList<QUuid> requestIds;
+        QModbusDataUnit data;
+    };
+
     int m_slaveAddress = 0;
     uint m_responseTimeoutTime = 2000;
     QModbusClient *m_modbusInterface = nullptr;
@@ -105,7 +115,27 @@ private:
     QTimer *m_inputPollingTimer = nullptr;
     QTimer *m_outputPollingTimer = nullptr;
 
-    QList<Request> m_writeRequestQueue;
+    int m_inputPollingInterval = 200;
+    bool m_adaptivePolling = false;
+    int m_activeInputPollingInterval = 100;
+    int m_idleInputPollingInterval = 1000;
+    int m_inputActivityTimeout = 5000;
+    qint64 m_lastInputActivity = 0;
+
+    // Prebuilt after loading the modbus map, contiguous addresses are read in one request
+    QList<QModbusDataUnit> m_digitalInputReadPlan;
+    QList<QModbusDataUnit> m_digitalOutputReadPlan;
+    QList<QModbusDataUnit> m_analogInputReadPlan;
+    QList<QModbusDataUnit> m_analogOutputReadPlan;
+
+    QHash<int, QString> m_digitalInputCircuits;
+    QHash<int, QString> m_digitalOutputCircuits;
+    QHash<int, QString> m_userLEDCircuits;
+
+    // Write requests within this window will be combined into as few modbus requests as possible
+    QTimer *m_writeCombineTimer = nullptr;
+    int m_writeCombineWindow = 10;
+    QList<Request> m_pendingWriteRequests;
     QList<QModbusDataUnit> m_readRequestQueue;
 
     QHash<QString, uint16_t> m_previousCircuitValue;
@@ -113,8 +143,17 @@ private:
     bool circuitValueChanged(const QString &circuit, quint32 value);
     bool getAnalogIO(const RegisterDescriptor &descriptor);
     bool modbusReadRequest(const QModbusDataUnit &request);
-    bool modbusWriteRequest(const Request &request);
-    void getCoils(QList<int> registers);
+    QUuid queueWriteRequest(const QModbusDataUnit &data);
+    void sendPendingWriteRequests();
+    bool modbusWriteRequest(const WriteBatch &batch);
+
+    void buildReadPlan();
+    QList<QModbusDataUnit> coilReadPlan(QList<int> addresses) const;
+    QList<QModbusDataUnit> registerReadPlan(const QHash<int, RegisterDescriptor> &descriptors) const;
+    void sendReadPlan(const QList<QModbusDataUnit> &readPlan);
+
+    void onInputActivity();
+    void updateInputPollingInterval();
 
 signals:
     void requestExecuted(const QUuid &requestId, bool success);
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2023 nymea GmbH <developer@nymea.io>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+# Converts the UniPi modbus map CSV files into constant C++ tables, so the plugin
+# does not have to parse them on each startup. See modbusmaps.h for the table layout.
+
+import os
+import re
+import sys
+import argparse
+
+
+def groupFiles(modelDirectory, model, kind):
+    fileNames = []
+    for fileName in os.listdir(modelDirectory):
+        match = re.match('^%s-%s-group-(\\d+)\\.csv$' % (re.escape(model), kind), fileName)
+        if match:
+            fileNames.append((int(match.group(1)), fileName))
+
+    return [os.path.join(modelDirectory, fileName) for index, fileName in sorted(fileNames)]
+
+
+def readCsvLines(filePath, minimumColumns):
+    lines = []
+    with open(filePath, 'r') as csvFile:
+        for line in csvFile.read().splitlines():
+            columns = line.split(',')
+            if len(columns) < minimumColumns:
+                print('Error: Corrupted CSV file %s: %s' % (filePath, line))
+                sys.exit(1)
+            lines.append(columns)
+    return lines
+
+
+def loadModel(modelDirectory, model):
+    circuits = []
+    isExtension = 'xS' in model
+
+    for filePath in groupFiles(modelDirectory, model, 'Coils'):
+        for columns in readCsvLines(filePath, 5):
+            if columns[4] != 'Basic':
+                continue
+
+            content = columns[3].lower()
+            circuitType = None
+            if 'digital input' in content:
+                circuitType = 'CircuitTypeDigitalInput'
+            elif 'digital output' in content or 'relay output' in content:
+                circuitType = 'CircuitTypeDigitalOutput'
+            elif 'user programmable led' in content:
+                circuitType = 'CircuitTypeUserLED'
+
+            if circuitType:
+                circuits.append((circuitType, int(columns[0]), 1, 'AccessReadWrite', columns[3].split(' ')[-1]))
+
+    for filePath in groupFiles(modelDirectory, model, 'Registers'):
+        for columns in readCsvLines(filePath, 6):
+            if columns[-1] != 'Basic':
+                continue
+
+            # The extension maps contain some unnamed values which have to be skipped
+            if isExtension and len(columns[5].split(' ')) <= 3:
+                continue
+
+            content = columns[5].lower()
+            circuitType = None
+            if 'analog input value' in content:
+                circuitType = 'CircuitTypeAnalogInput'
+            elif 'analog output value' in content:
+                circuitType = 'CircuitTypeAnalogOutput'
+
+            if circuitType:
+                access = { 'R': 'AccessRead', 'RW': 'AccessReadWrite', 'W': 'AccessWrite' }.get(columns[3], 'AccessNone')
+                circuits.append((circuitType, int(columns[0]), int(columns[2]), access, columns[5].split(' ')[-1]))
+
+    return circuits
+
+
+def variableName(model):
+    return re.sub('[^A-Za-z0-9]', '', model[0].lower() + model[1:]) + 'Circuits'
+
+
+def writeModbusMaps(inputDirectory, outputFilePath):
+    models = sorted([entry for entry in os.listdir(inputDirectory) if os.path.isdir(os.path.join(inputDirectory, entry))])
+
+    circuitNames = []
+    modelCircuits = {}
+    for model in models:
+        modelCircuits[model] = loadModel(os.path.join(inputDirectory, model), model)
+        for circuit in modelCircuits[model]:
+            if circuit[4] not in circuitNames:
+                circuitNames.append(circuit[4])
+
+    os.makedirs(os.path.dirname(os.path.abspath(outputFilePath)), exist_ok=True)
+    with open(outputFilePath, 'w') as outputFile:
+        outputFile.write('// This file has been generated by generate-modbus-maps.py, do not edit it.\n\n')
+        outputFile.write('#include "modbusmaps.h"\n\n')
+        outputFile.write('namespace UniPiModbusMaps {\n\n')
+
+        outputFile.write('static constexpr const char *circuitNames[] = {\n')
+        for name in circuitNames:
+            outputFile.write('    "%s",\n' % name)
+        outputFile.write('};\n\n')
+
+        for model in models:
+            outputFile.write('static constexpr Circuit %s[] = {\n' % variableName(model))
+            for circuitType, address, registerCount, access, name in modelCircuits[model]:
+                outputFile.write('    { %s, %s, %s, %s, %s },\n' % (circuitType, address, registerCount, access, circuitNames.index(name)))
+            outputFile.write('};\n\n')
+
+        outputFile.write('static constexpr ModbusMap modbusMaps[] = {\n')
+        for model in models:
+            outputFile.write('    { "%s", %s, %s },\n' % (model, variableName(model), len(modelCircuits[model])))
+        outputFile.write('};\n\n')
+
+        outputFile.write('const ModbusMap *findModbusMap(const QString &model)\n')
+        outputFile.write('{\n')
+        outputFile.write('    for (const ModbusMap &modbusMap : modbusMaps) {\n')
+        outputFile.write('        if (model == QLatin1String(modbusMap.model)) {\n')
+        outputFile.write('            return &modbusMap;\n')
+        outputFile.write('        }\n')
+        outputFile.write('    }\n')
+        outputFile.write('    return nullptr;\n')
+        outputFile.write('}\n\n')
+
+        outputFile.write('QString circuitName(const Circuit &circuit)\n')
+        outputFile.write('{\n')
+        outputFile.write('    return QString::fromLatin1(circuitNames[circuit.nameIndex]);\n')
+        outputFile.write('}\n\n')
+
+        outputFile.write('}\n')
+
+    print('Generated %s circuits for %s modbus maps into %s' % (sum([len(circuits) for circuits in modelCircuits.values()]), len(models), outputFilePath))
+
+
+parser = argparse.ArgumentParser(description='Generate the UniPi modbus map tables from the CSV map files.')
+parser.add_argument('-i', '--input-directory', metavar='<directory>', help='The directory containing the modbus map folders.')
+parser.add_argument('-o', '--output', metavar='<file>', help='The generated C++ source file.')
+args = parser.parse_args()
+
+if not args.input_directory or not args.output:
+    parser.print_help()
+    sys.exit(1)
+
+writeModbusMaps(args.input_directory, args.output)
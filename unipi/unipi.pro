@@ -31,9 +31,13 @@ HEADERS += \
     unipi.h \
     i2cport_p.h \
     mcp342xchannel.h \
-    unipipwm.h
+    unipipwm.h \
+    modbusmaps.h
 
-MAP_FILES.files = files(modbus_maps/*)
-MAP_FILES.path = [QT_INSTALL_PREFIX]/share/nymea/modbus/
-INSTALLS += MAP_FILES
+# Convert the modbus map CSV files into C++ tables
+message("Generating UniPi modbus map tables")
+system(python3 $${PWD}/tools/generate-modbus-maps.py -i $${PWD}/modbus_maps -o $${OUT_PWD}/autogenerated/unipimodbusmaps.cpp)
+INCLUDEPATH += $${PWD}
+SOURCES += $${OUT_PWD}/autogenerated/unipimodbusmaps.cpp
+OTHER_FILES += tools/generate-modbus-maps.py
 
@@ -36,6 +36,7 @@
 #include <QLoggingCategory>
 
 #include <network/networkdevicediscovery.h>
+#include <modbustcpdiscovery.h>
 
 #include "evc04modbustcpconnection.h"
 
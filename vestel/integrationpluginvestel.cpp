@@ -34,6 +34,7 @@
 
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginVestel::IntegrationPluginVestel()
 {
@@ -133,11 +134,7 @@ void IntegrationPluginVestel::postSetupThing(Thing *thing)
         qCDebug(dcVestel()) << "Starting plugin timer...";
         m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
         connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-            foreach(EVC04ModbusTcpConnection *connection, m_evc04Connections) {
-                qCDebug(dcVestel()) << "Updating connection" << connection->modbusTcpMaster()->hostAddress().toString();
-                connection->update();
-                connection->setAliveRegister(1);
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
         });
 
         m_pluginTimer->start();
@@ -160,28 +157,31 @@ void IntegrationPluginVestel::executeAction(ThingActionInfo *info)
                 return;
             }
 
-            QModbusReply *reply = evc04Connection->setChargingCurrent(power ? info->thing()->stateValue(evc04MaxChargingCurrentStateTypeId).toUInt() : 0);
-            connect(reply, &QModbusReply::finished, info, [info, reply, power](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue(evc04PowerStateTypeId, power);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcVestel()) << "Error setting power:" << reply->error() << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplied, info, [evc04Connection, info, power](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(evc04PowerStateTypeId, power);
+                info->finish(Thing::ThingErrorNoError);
+            });
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplyFailed, info, [evc04Connection, info](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                qCWarning(dcVestel()) << "Error setting power";
+                info->finish(Thing::ThingErrorHardwareFailure);
             });
+            evc04Connection->applyChargingCurrent(power ? info->thing()->stateValue(evc04MaxChargingCurrentStateTypeId).toUInt() : 0);
         }
         if (info->action().actionTypeId() == evc04MaxChargingCurrentActionTypeId) {
             int maxChargingCurrent = info->action().paramValue(evc04MaxChargingCurrentActionMaxChargingCurrentParamTypeId).toInt();
-            QModbusReply *reply = evc04Connection->setChargingCurrent(maxChargingCurrent);
-            connect(reply, &QModbusReply::finished, info, [info, reply, maxChargingCurrent](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue(evc04MaxChargingCurrentStateTypeId, maxChargingCurrent);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplied, info, [evc04Connection, info, maxChargingCurrent](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(evc04MaxChargingCurrentStateTypeId, maxChargingCurrent);
+                info->finish(Thing::ThingErrorNoError);
+            });
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplyFailed, info, [evc04Connection, info](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                info->finish(Thing::ThingErrorHardwareFailure);
             });
+            evc04Connection->applyChargingCurrent(maxChargingCurrent);
         }
     }
 }
@@ -211,6 +211,7 @@ void IntegrationPluginVestel::setupEVC04Connection(ThingSetupInfo *info)
 
     qCDebug(dcVestel()) << "Setting up EVC04 wallbox on" << address.toString();
     EVC04ModbusTcpConnection *evc04Connection = new EVC04ModbusTcpConnection(address, 502, 0xff, this);
+    evc04Connection->setKeepAliveEnabled(true);
     connect(info, &ThingSetupInfo::aborted, evc04Connection, &EVC04ModbusTcpConnection::deleteLater);
 
     // Reconnect on monitor reachable changed
@@ -267,6 +268,7 @@ void IntegrationPluginVestel::setupEVC04Connection(ThingSetupInfo *info)
         qCDebug(dcVestel()) << "Connection init finished successfully" << evc04Connection;
 
         m_evc04Connections.insert(thing, evc04Connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, evc04Connection, evc04Connection->modbusTcpMaster()->hostAddress().toString(), true);
         info->finish(Thing::ThingErrorNoError);
 
         thing->setStateValue(evc04ConnectedStateTypeId, true);
@@ -381,7 +383,7 @@ void IntegrationPluginVestel::setupEVC04Connection(ThingSetupInfo *info)
             // The car was plugged in, sync the power state now as the wallbox only allows to set that when the car is connected
             if (thing->stateValue(evc04PowerStateTypeId).toBool() == false) {
                 qCInfo(dcVestel()) << "Car plugged in. Syncing cached power off state to wallbox";
-                evc04Connection->setChargingCurrent(0);
+                evc04Connection->applyChargingCurrent(0);
             }
 
             break;
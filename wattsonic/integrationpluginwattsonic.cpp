@@ -34,6 +34,7 @@
 
 #include <network/networkdevicediscovery.h>
 #include <hardwaremanager.h>
+#include <modbuspollorchestrator.h>
 
 IntegrationPluginWattsonic::IntegrationPluginWattsonic()
 {
@@ -129,10 +130,7 @@ void IntegrationPluginWattsonic::postSetupThing(Thing *thing)
         qCDebug(dcWattsonic()) << "Starting plugin timer...";
         m_pluginTimer = hardwareManager()->pluginTimerManager()->registerTimer(2);
         connect(m_pluginTimer, &PluginTimer::timeout, this, [this] {
-            foreach(WattsonicModbusRtuConnection *connection, m_connections) {
-                qCDebug(dcWattsonic()) << "Updating connection" << connection->modbusRtuMaster()->serialPort() << connection->slaveId();
-                connection->update();
-            }
+            ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
         });
 
         m_pluginTimer->start();
@@ -173,6 +171,7 @@ void IntegrationPluginWattsonic::setupWattsonicConnection(ThingSetupInfo *info)
     connect(info, &ThingSetupInfo::aborted, connection, &ModbusRtuMaster::deleteLater);
 
     m_connections.insert(thing, connection);
+    ModbusPollOrchestrator::instance()->addConnection(this, connection, connection->modbusRtuMaster()->serialPort(), true);
     connect(info, &ThingSetupInfo::aborted, this, [=](){
         m_connections.take(info->thing())->deleteLater();
     });
@@ -36,6 +36,7 @@
 #include <hardware/electricity.h>
 #include <network/networkdevicediscovery.h>
 #include <network/networkaccessmanager.h>
+#include <modbuspollorchestrator.h>
 
 #include <QDebug>
 #include <QStringList>
@@ -344,17 +345,8 @@ void IntegrationPluginWebasto::postSetupThing(Thing *thing)
                 }
             }
 
-            foreach(WebastoNextModbusTcpConnection *webastoNext, m_webastoNextConnections) {
-                if (webastoNext->reachable()) {
-                    webastoNext->update();
-                }
-            }
-
-            foreach(EVC04ModbusTcpConnection *connection, m_evc04Connections) {
-                qCDebug(dcWebasto()) << "Updating connection" << connection->modbusTcpMaster()->hostAddress().toString();
-                connection->update();
-                connection->setAliveRegister(1);
-            }
+            // Webasto Next and Unite are generated modbus connections
+            ModbusPollOrchestrator::instance()->poll(this, m_pluginTimer->interval() * 1000);
 
         });
 
@@ -496,18 +488,19 @@ void IntegrationPluginWebasto::executeAction(ThingActionInfo *info)
         } else if (action.actionTypeId() == webastoNextMaxChargingCurrentActionTypeId) {
             quint16 chargingCurrent = action.paramValue(webastoNextMaxChargingCurrentActionMaxChargingCurrentParamTypeId).toUInt();
             qCDebug(dcWebasto()) << "Set max charging current of" << thing << "to" << chargingCurrent << "ampere";
-            QModbusReply *reply = connection->setChargeCurrent(chargingCurrent);
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, info, [info, reply, chargingCurrent](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    qCDebug(dcWebasto()) << "Set max charging current finished successfully.";
-                    info->thing()->setStateValue(webastoNextMaxChargingCurrentStateTypeId, chargingCurrent);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcWebasto()) << "Set max charging current request finished with error:" << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(connection, &WebastoNextModbusTcpConnection::chargeCurrentApplied, info, [connection, info, chargingCurrent](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                qCDebug(dcWebasto()) << "Set max charging current finished successfully.";
+                info->thing()->setStateValue(webastoNextMaxChargingCurrentStateTypeId, chargingCurrent);
+                info->finish(Thing::ThingErrorNoError);
             });
+            connect(connection, &WebastoNextModbusTcpConnection::chargeCurrentApplyFailed, info, [connection, info](){
+                QObject::disconnect(connection, nullptr, info, nullptr);
+                qCWarning(dcWebasto()) << "Set max charging current request finished with error";
+                info->finish(Thing::ThingErrorHardwareFailure);
+            });
+            connection->applyChargeCurrent(chargingCurrent);
 
         } else {
             Q_ASSERT_X(false, "executeAction", QString("Unhandled actionTypeId: %1").arg(action.actionTypeId().toString()).toUtf8());
@@ -531,28 +524,31 @@ void IntegrationPluginWebasto::executeAction(ThingActionInfo *info)
                 return;
             }
 
-            QModbusReply *reply = evc04Connection->setChargingCurrent(power ? info->thing()->stateValue(webastoUniteMaxChargingCurrentStateTypeId).toUInt() : 0);
-            connect(reply, &QModbusReply::finished, info, [info, reply, power](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue(webastoUnitePowerStateTypeId, power);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    qCWarning(dcWebasto()) << "Error setting power:" << reply->error() << reply->errorString();
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            // Latest value wins, a newer current written meanwhile finishes this action as well
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplied, info, [evc04Connection, info, power](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(webastoUnitePowerStateTypeId, power);
+                info->finish(Thing::ThingErrorNoError);
+            });
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplyFailed, info, [evc04Connection, info](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                qCWarning(dcWebasto()) << "Error setting power";
+                info->finish(Thing::ThingErrorHardwareFailure);
             });
+            evc04Connection->applyChargingCurrent(power ? info->thing()->stateValue(webastoUniteMaxChargingCurrentStateTypeId).toUInt() : 0);
         }
         if (info->action().actionTypeId() == webastoUniteMaxChargingCurrentActionTypeId) {
             int maxChargingCurrent = info->action().paramValue(webastoUniteMaxChargingCurrentActionMaxChargingCurrentParamTypeId).toInt();
-            QModbusReply *reply = evc04Connection->setChargingCurrent(maxChargingCurrent);
-            connect(reply, &QModbusReply::finished, info, [info, reply, maxChargingCurrent](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    info->thing()->setStateValue(webastoUniteMaxChargingCurrentStateTypeId, maxChargingCurrent);
-                    info->finish(Thing::ThingErrorNoError);
-                } else {
-                    info->finish(Thing::ThingErrorHardwareFailure);
-                }
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplied, info, [evc04Connection, info, maxChargingCurrent](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                info->thing()->setStateValue(webastoUniteMaxChargingCurrentStateTypeId, maxChargingCurrent);
+                info->finish(Thing::ThingErrorNoError);
+            });
+            connect(evc04Connection, &EVC04ModbusTcpConnection::chargingCurrentApplyFailed, info, [evc04Connection, info](){
+                QObject::disconnect(evc04Connection, nullptr, info, nullptr);
+                info->finish(Thing::ThingErrorHardwareFailure);
             });
+            evc04Connection->applyChargingCurrent(maxChargingCurrent);
         }
         if (info->action().actionTypeId() == webastoUniteDesiredPhaseCountActionTypeId) {
             if (validTokenAvailable(thing)) {
@@ -620,7 +616,9 @@ void IntegrationPluginWebasto::setupWebastoNextConnection(ThingSetupInfo *info)
     WebastoNextModbusTcpConnection *webastoNextConnection = new WebastoNextModbusTcpConnection(address, port, slaveId, this);
     webastoNextConnection->modbusTcpMaster()->setTimeout(500);
     webastoNextConnection->modbusTcpMaster()->setNumberOfRetries(3);
+    webastoNextConnection->setKeepAliveEnabled(true);
     m_webastoNextConnections.insert(thing, webastoNextConnection);
+    ModbusPollOrchestrator::instance()->addConnection(this, webastoNextConnection, address.toString());
     connect(info, &ThingSetupInfo::aborted, webastoNextConnection, [=](){
         webastoNextConnection->deleteLater();
         m_webastoNextConnections.remove(thing);
@@ -808,21 +806,6 @@ void IntegrationPluginWebasto::setupWebastoNextConnection(ThingSetupInfo *info)
                 break;
             }
         }
-
-        // Handle life bit (keep alive mechanism if there is a HEMS activated)
-        if (webastoNextConnection->lifeBit() == 0) {
-            // Let's reset the life bit so the wallbox knows we are still here,
-            // otherwise the wallbox goes into the failsave mode and limits the charging to the configured
-            QModbusReply *reply = webastoNextConnection->setLifeBit(1);
-            connect(reply, &QModbusReply::finished, reply, &QModbusReply::deleteLater);
-            connect(reply, &QModbusReply::finished, webastoNextConnection, [reply, webastoNextConnection](){
-                if (reply->error() == QModbusDevice::NoError) {
-                    qCDebug(dcWebasto()) << "Resetted life bit watchdog on" << webastoNextConnection << "finished successfully";
-                } else {
-                    qCWarning(dcWebasto()) << "Resetted life bit watchdog on" << webastoNextConnection << "finished with error:" << reply->errorString();
-                }
-            });
-        }
     });
 
     connect(thing, &Thing::settingChanged, webastoNextConnection, [webastoNextConnection](const ParamTypeId &paramTypeId, const QVariant &value){
@@ -871,23 +854,7 @@ void IntegrationPluginWebasto::setupWebastoNextConnection(ThingSetupInfo *info)
 
 void IntegrationPluginWebasto::update(Webasto *webasto)
 {
-    webasto->getRegister(Webasto::TqChargePointState);
-    webasto->getRegister(Webasto::TqCableState);
-    webasto->getRegister(Webasto::TqEVSEError);
-
-    webasto->getRegister(Webasto::TqCurrentL1);
-    webasto->getRegister(Webasto::TqCurrentL2);
-    webasto->getRegister(Webasto::TqCurrentL3);
-
-    webasto->getRegister(Webasto::TqActivePower, 2);
-    webasto->getRegister(Webasto::TqEnergyMeter, 2);
-
-    webasto->getRegister(Webasto::TqMaxCurrent);
-
-    webasto->getRegister(Webasto::TqChargedEnergy);
-    webasto->getRegister(Webasto::TqChargingTime, 2);
-
-    webasto->getRegister(Webasto::TqUserId, 10);
+    webasto->update();
 }
 
 void IntegrationPluginWebasto::evaluatePhaseCount(Thing *thing)
@@ -1172,6 +1139,7 @@ void IntegrationPluginWebasto::setupEVC04Connection(ThingSetupInfo *info)
     QHostAddress address = m_monitors.value(thing)->networkDeviceInfo().address();
 
     EVC04ModbusTcpConnection *evc04Connection = new EVC04ModbusTcpConnection(address, 502, 0xff, this);
+    evc04Connection->setKeepAliveEnabled(true);
     connect(info, &ThingSetupInfo::aborted, evc04Connection, &EVC04ModbusTcpConnection::deleteLater);
 
     // Reconnect on monitor reachable changed
@@ -1228,6 +1196,7 @@ void IntegrationPluginWebasto::setupEVC04Connection(ThingSetupInfo *info)
         qCDebug(dcWebasto()) << "Connection init finished successfully" << evc04Connection;
 
         m_evc04Connections.insert(thing, evc04Connection);
+        ModbusPollOrchestrator::instance()->addConnection(this, evc04Connection, evc04Connection->modbusTcpMaster()->hostAddress().toString(), true);
         info->finish(Thing::ThingErrorNoError);
 
         thing->setStateValue(webastoUniteConnectedStateTypeId, true);
@@ -1343,7 +1312,7 @@ void IntegrationPluginWebasto::setupEVC04Connection(ThingSetupInfo *info)
             // The car was plugged in, sync the power state now as the wallbox only allows to set that when the car is connected
             if (thing->stateValue(webastoUnitePowerStateTypeId).toBool() == false) {
                 qCInfo(dcWebasto()) << "Car plugged in. Syncing cached power off state to wallbox";
-                evc04Connection->setChargingCurrent(0);
+                evc04Connection->applyChargingCurrent(0);
             }
 
             break;
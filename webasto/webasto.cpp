@@ -42,6 +42,16 @@ Webasto::Webasto(const QHostAddress &address, uint port, QObject *parent) :
     connect(m_modbusConnection, &ModbusTcpMaster::receivedHoldingRegister, this, &Webasto::onReceivedHoldingRegister);
     connect(m_modbusConnection, &ModbusTcpMaster::writeRequestExecuted, this, &Webasto::writeRequestExecuted);
     connect(m_modbusConnection, &ModbusTcpMaster::writeRequestError, this, &Webasto::writeRequestError);
+    connect(m_modbusConnection, &ModbusTcpMaster::readRequestException, this, &Webasto::onReadRequestException);
+    connect(m_modbusConnection, &ModbusTcpMaster::readRequestError, this, &Webasto::onReadRequestError);
+
+    // Contiguous ranges covering all registers required for an update, 5 requests instead of 12 single reads
+    addReadBlock(TqChargePointState, 13, { qMakePair(TqChargePointState, 1u), qMakePair(TqCableState, 1u), qMakePair(TqEVSEError, 1u),
+                                           qMakePair(TqCurrentL1, 1u), qMakePair(TqCurrentL2, 1u), qMakePair(TqCurrentL3, 1u) });
+    addReadBlock(TqActivePower, 18, { qMakePair(TqActivePower, 2u), qMakePair(TqEnergyMeter, 2u) });
+    addReadBlock(TqMaxCurrent, 1, { qMakePair(TqMaxCurrent, 1u) });
+    addReadBlock(TqChargedEnergy, 8, { qMakePair(TqChargedEnergy, 1u), qMakePair(TqChargingTime, 2u) });
+    addReadBlock(TqUserId, 10, { qMakePair(TqUserId, 10u) });
 
     m_lifeBitTimer = new QTimer(this);
     m_lifeBitTimer->start(10000);
@@ -88,6 +98,38 @@ void Webasto::getRegister(Webasto::TqModbusRegister modbusRegister, uint length)
     m_modbusConnection->readHoldingRegister(m_unitId, modbusRegister, length);
 }
 
+void Webasto::update()
+{
+    for (int i = 0; i < m_readPlan.count(); i++) {
+        ReadBlock &block = m_readPlan[i];
+        if (block.split && ++block.splitCycles >= BlockRetryCycles) {
+            // Give the block another chance, one more exception will split it again
+            qCDebug(dcWebasto()) << "Webasto: Retrying to read register block" << block.startRegister << block.length;
+            block.split = false;
+            block.splitCycles = 0;
+            block.exceptionCount = 2;
+        }
+
+        if (block.split) {
+            // This device does not like reading this range in one go, fall back to the single registers
+            for (int j = 0; j < block.registers.count(); j++) {
+                getRegister(block.registers.at(j).first, block.registers.at(j).second);
+            }
+            continue;
+        }
+
+        if (block.skipCycles > 0) {
+            block.skipCycles--;
+            continue;
+        }
+
+        QUuid requestId = m_modbusConnection->readHoldingRegister(m_unitId, block.startRegister, block.length);
+        if (!requestId.isNull()) {
+            m_pendingBlockReads.insert(requestId, i);
+        }
+    }
+}
+
 QUuid Webasto::setSafeCurrent(quint16 ampere) const
 {
     return m_modbusConnection->writeHoldingRegister(m_unitId, TqSafeCurrent, ampere);
@@ -127,9 +169,38 @@ void Webasto::setLiveBit()
     }
 }
 
+void Webasto::addReadBlock(TqModbusRegister startRegister, uint length, const QList<QPair<TqModbusRegister, uint>> &registers)
+{
+    ReadBlock block;
+    block.startRegister = startRegister;
+    block.length = length;
+    block.registers = registers;
+    m_readPlan.append(block);
+}
+
 void Webasto::onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values)
 {
     Q_UNUSED(slaveAddress)
+    for (int i = 0; i < m_readPlan.count(); i++) {
+        ReadBlock &block = m_readPlan[i];
+        if (block.split || block.startRegister != static_cast<int>(modbusRegister) || static_cast<uint>(values.count()) != block.length)
+            continue;
+
+        // Slice the block into the registers the plugin is interested in
+        block.exceptionCount = 0;
+        block.errorCount = 0;
+        foreach (const QUuid &requestId, m_pendingBlockReads.keys(i)) {
+            m_pendingBlockReads.remove(requestId);
+        }
+
+        for (int j = 0; j < block.registers.count(); j++) {
+            TqModbusRegister blockRegister = block.registers.at(j).first;
+            uint offset = blockRegister - block.startRegister;
+            emit receivedRegister(blockRegister, values.mid(offset, block.registers.at(j).second));
+        }
+        return;
+    }
+
     if (modbusRegister == TqLifeBit) {
         m_awaitingLiveBitResponse = false;
         if (!m_connected) {
@@ -139,3 +210,35 @@ void Webasto::onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister,
     }
     emit receivedRegister(TqModbusRegister(modbusRegister), values);
 }
+
+void Webasto::onReadRequestException(const QUuid &requestId, QModbusPdu::ExceptionCode exceptionCode)
+{
+    if (!m_pendingBlockReads.contains(requestId))
+        return;
+
+    // Only a definitive answer from the device is a reason for splitting the block
+    if (exceptionCode != QModbusPdu::IllegalDataAddress && exceptionCode != QModbusPdu::IllegalDataValue)
+        return;
+
+    ReadBlock &block = m_readPlan[m_pendingBlockReads.take(requestId)];
+    block.exceptionCount++;
+    qCDebug(dcWebasto()) << "Webasto: Reading register block" << block.startRegister << block.length << "failed" << block.exceptionCount << "times in a row with exception" << exceptionCode;
+    if (block.exceptionCount >= 3) {
+        qCWarning(dcWebasto()) << "Webasto: Reading register block" << block.startRegister << "keeps failing. Reading the registers individually for the next" << BlockRetryCycles << "updates.";
+        block.split = true;
+        block.splitCycles = 0;
+    }
+}
+
+void Webasto::onReadRequestError(const QUuid &requestId, const QString &error)
+{
+    // Exceptions have already been handled in onReadRequestException()
+    if (!m_pendingBlockReads.contains(requestId))
+        return;
+
+    // Timeouts, disconnects or reboots, back off and read the block again afterwards (1, 2, 4, 8 cycles)
+    ReadBlock &block = m_readPlan[m_pendingBlockReads.take(requestId)];
+    block.errorCount = qMin(block.errorCount + 1, 4u);
+    block.skipCycles = (1u << (block.errorCount - 1)) - 1;
+    qCDebug(dcWebasto()) << "Webasto: Reading register block" << block.startRegister << block.length << "failed:" << error << "Skipping the next" << block.skipCycles << "updates.";
+}
@@ -35,6 +35,8 @@
 #include <QHostAddress>
 #include <QTimer>
 #include <QUuid>
+#include <QHash>
+#include <QPair>
 
 #include <modbustcpmaster.h>
 
@@ -123,6 +125,9 @@ public:
 
     void getRegister(TqModbusRegister modbusRegister, uint length = 1);
 
+    // Reads all registers required for the periodic update in a few contiguous blocks
+    void update();
+
     QUuid setSafeCurrent(quint16 ampere) const;
     QUuid seComTimeout(quint16 seconds) const;
     QUuid setChargePower(quint32 watt) const;
@@ -131,10 +136,30 @@ public:
 
 private:
 
+    typedef struct ReadBlock {
+        TqModbusRegister startRegister;
+        uint length = 0;
+        QList<QPair<TqModbusRegister, uint>> registers;
+        // Exception replies in a row, only these make us fall back to single registers
+        uint exceptionCount = 0;
+        bool split = false;
+        uint splitCycles = 0;
+        // Timeouts or connection errors in a row, the block read will be skipped for a few cycles
+        uint errorCount = 0;
+        uint skipCycles = 0;
+    } ReadBlock;
+
     ModbusTcpMaster *m_modbusConnection = nullptr;
     QHostAddress m_address;
     uint m_unitId = 255;
 
+    QList<ReadBlock> m_readPlan;
+    QHash<QUuid, int> m_pendingBlockReads;
+    // Split blocks will be read in one request again after this number of update cycles
+    static const uint BlockRetryCycles = 60;
+
+    void addReadBlock(TqModbusRegister startRegister, uint length, const QList<QPair<TqModbusRegister, uint>> &registers);
+
 private:
     QTimer *m_lifeBitTimer = nullptr;
     bool m_connected = false;
@@ -147,6 +172,8 @@ signals:
 
 private slots:
     void onReceivedHoldingRegister(uint slaveAddress, uint modbusRegister, const QVector<quint16> &values);
+    void onReadRequestException(const QUuid &requestId, QModbusPdu::ExceptionCode exceptionCode);
+    void onReadRequestError(const QUuid &requestId, const QString &error);
 };
 
 #endif // WEBASTO_H
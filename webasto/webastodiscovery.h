@@ -34,6 +34,7 @@
 #include <QObject>
 
 #include <network/networkdevicediscovery.h>
+#include <modbustcpdiscovery.h>
 
 #include "webastonextmodbustcpconnection.h"
 